@@ -14,11 +14,12 @@ namespace Trick {
     class ClientConnection {
         public: 
 
+            ClientConnection() : _connection_type(TCP) { }
             virtual ~ClientConnection() { }
             
             static const unsigned int MAX_CMD_LEN = 200000 ;
 
-            enum ConnectionType { TCP, UDP, MCAST, WS } ;
+            enum ConnectionType { TCP, UDP, MCAST, WS, SHM } ;
 
             // Pure virtual methods
             virtual int start() = 0;
@@ -41,6 +42,11 @@ namespace Trick {
             virtual std::string getClientHostname() = 0;
             virtual int getClientPort() = 0;
 
+            // The socket of the connection for servers that wait on it, -1 if there is none
+            virtual int getSocket() { return -1; }
+
+            virtual ConnectionType getConnectionType() { return _connection_type; }
+
         protected:
             ConnectionType _connection_type;
             std::string _client_tag;
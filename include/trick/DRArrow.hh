@@ -0,0 +1,154 @@
+/*
+PURPOSE:
+    (Data Record Arrow class.)
+*/
+
+#ifndef DRARROW_HH
+#define DRARROW_HH
+
+#include <string>
+#include <vector>
+
+#include "trick/DataRecordGroup.hh"
+
+#ifdef SWIG
+%feature("compactdefaultargs","0") ;
+%feature("shadow") Trick::DRArrow::DRArrow(std::string in_name) %{
+    def __init__(self, *args):
+        this = $action(*args)
+        try: self.this.append(this)
+        except: self.this = this
+        this.own(0)
+        self.this.own(0)
+%}
+#endif
+
+namespace Trick {
+
+    /**
+      The DRArrow recording format writes a group to log_<group_name>.arrows in the Apache Arrow IPC streaming
+      format, so the log can be loaded by Arrow based analysis tools without conversion.  The stream holds:
+
+      - a schema message with one non nullable field per recorded parameter.  Integers, enumerations and
+        bitfields are Arrow Int of the parameter's size, floats and doubles are Arrow FloatingPoint and one
+        byte booleans are Arrow Bool.  The units of each field are stored in its "units" metadata.
+      - a record batch message for the records written each write cycle, each parameter a column
+      - the end of stream marker, written at shutdown
+
+      Values are written in the byte order of the simulation, which is given by the schema.  The messages are
+      encoded by this class, no Arrow library is needed.
+    */
+    class DRArrow : public Trick::DataRecordGroup {
+
+        public:
+
+            #ifndef SWIG
+            /**
+             @brief DRArrow default constructor.
+             */
+            DRArrow() : max_batch_rows(65536), fd(-1), batch_buff(NULL), batch_capacity(0), batch_rows(0) {}
+            #endif
+            ~DRArrow() {}
+
+            /**
+             @brief @userdesc Create a new Arrow data recording group.
+             @par Python Usage:
+             @code <my_drg> = trick.DRArrow("<in_name>") @endcode
+             @copydoc Trick::DataRecordGroup::DataRecordGroup(string in_name)
+             */
+            DRArrow( std::string in_name ) ;
+
+            /**
+             @brief @userdesc Command to set the most records in a record batch (default is 65536).  A batch is
+             written every write cycle, or sooner when it is full.  Batches also hold no more than the max
+             buffer size.  Must be called before the group is initialized.
+             @par Python Usage:
+             @code <my_drg>.set_max_batch_rows(<rows>) @endcode
+             @param rows - records per batch, at least 1
+             @return always 0
+             */
+            int set_max_batch_rows(unsigned int rows) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_header
+             */
+            virtual int format_specific_header(std::fstream & outstream) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_init
+             */
+            virtual int format_specific_init() ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_write_data
+             */
+            virtual int format_specific_write_data(unsigned int writer_offset) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_flush
+             */
+            virtual int format_specific_flush() ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::shutdown
+             */
+            virtual int format_specific_shutdown() ;
+
+            /** Most records in a record batch.\n */
+            unsigned int max_batch_rows ;   /**< trick_io(*io) trick_units(--) */
+
+        protected:
+            /**
+             @brief Arrow columns are integers, floating point or booleans.  Rejects the types that do not map
+             to one of them, such as long double and void pointers.
+            */
+            virtual bool isSupportedType(REF2 * ref2, std::string& message) ;
+
+            /**
+             @brief Writes the schema message describing the recorded parameters.
+             @return 0 on success, -1 if the write failed
+            */
+            int write_schema() ;
+
+            /**
+             @brief Writes the records gathered in the batch as a record batch message and empties the batch.
+             @return 0 on success, -1 if the write failed
+            */
+            int write_batch() ;
+
+            /**
+             @brief Writes a message, its metadata followed by its body, continuing after partial writes.
+             @param metadata - the encoded Message, padded to 8 bytes
+             @param body - message body
+             @return 0 on success, -1 if the write failed
+            */
+            int write_message( const std::vector <unsigned char> & metadata , const std::vector <unsigned char> & body ) ;
+
+            /** File descriptor of the stream.  */
+            int fd ;                        /**< trick_io(**) */
+
+            /** Columns of the batch being gathered.  Column n starts at batch_capacity times the offset of
+                parameter n in a record.  */
+            char * batch_buff ;             /**< trick_io(**) */
+
+            /** Records the batch holds.  */
+            unsigned int batch_capacity ;   /**< trick_io(**) */
+
+            /** Records in the batch.  */
+            unsigned int batch_rows ;       /**< trick_io(**) */
+
+            /** Encoded metadata of the message being written.  */
+            std::vector <unsigned char> metadata ; /**< trick_io(**) */
+
+            /** Body of the message being written.  */
+            std::vector <unsigned char> body ; /**< trick_io(**) */
+
+    } ;
+
+} ;
+
+#ifdef SWIG
+%feature("compactdefaultargs","1") ;
+#endif
+
+#endif
@@ -54,11 +54,14 @@ namespace Trick {
             /** Delimiter for separating ascii format fields.\n */
             std::string delimiter;           /**< trick_units(--) */
 
+            /** Size of the output stream buffer in bytes, 0 = default stream buffer.\n */
+            unsigned int block_size ;        /**< trick_units(--) */
+
             #ifndef SWIG
             /**
              @brief DRAscii default constructor.
              */
-            DRAscii() {}
+            DRAscii() : block_size(1 << 20), block_buff(NULL) {}
             #endif
             ~DRAscii() {}
 
@@ -85,11 +88,28 @@ namespace Trick {
              */
             virtual int format_specific_write_data(unsigned int writer_offset) ;
 
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_flush
+             */
+            virtual int format_specific_flush() ;
+
             /**
              @copybrief Trick::DataRecordGroup::format_specific_shutdown
              */
             virtual int format_specific_shutdown() ;
 
+            /**
+             @brief @userdesc Command to set the size of the output stream buffer used to gather records before
+             they are written to the log file (default is 1048576).  The buffer is always flushed at the end of
+             each write cycle.  A size of 0 uses the default stream buffer.
+             The block size will be set during initialization in Trick::DRAscii::format_specific_init.
+             @par Python Usage:
+             @code <dr_group>.set_block_size(<bytes>) @endcode
+             @param bytes - the block size in bytes
+             @return always 0
+            */
+            int set_block_size(unsigned int bytes) ;
+
             /**
              @brief @userdesc Command to set the printf format for the group's float variable values in the
              log file (default is "%20.8g").
@@ -135,13 +155,16 @@ namespace Trick {
 
             /**
              @brief Copies value of variable to ascii buffer
-             @return always 0
+             @return number of characters written to buf
             */
             int copy_data_ascii_item( Trick::DataRecordBuffer * DI, int item_num, char *buf ) ;
 
             /** Output stream for the log file */
             std::fstream out_stream ; /**< trick_io(**)  */
 
+            /** Buffer given to the output stream to gather records */
+            char * block_buff ;       /**< trick_io(**)  */
+
     } ;
 
 } ;
@@ -10,6 +10,7 @@ PROGRAMMERS:
 
 #include <stdio.h>
 #include <string>
+#include <vector>
 
 #include "trick/DataRecordGroup.hh"
 
@@ -74,6 +75,11 @@ namespace Trick {
       </center>
 
       See Trick::MemoryManager::TRICK_TYPE for a definition of the Trick data <type> values used in the above table.
+
+      A DRBinary group with compression turned on writes log_<group_name>.trkz instead.  The header is the same,
+      except the keyword is Trick-Z1-\<e\>.  Each block of records gathered by the group is written as the number
+      of records in the block (int), the encoded length of each parameter's column (int each), then the encoded
+      columns.  See Trick/DRCompression.hh for the column encodings.
     */
     class DRBinary : public Trick::DataRecordGroup {
 
@@ -83,7 +89,7 @@ namespace Trick {
             /**
              @brief DRBinary default constructor.
              */
-            DRBinary() {}
+            DRBinary() : block_size(1 << 20), compress(false), min_block_size(1 << 16), fd(-1), has_bitfields(false), block_buff(NULL), block_buff_size(0), block_len(0) {}
             #endif
             ~DRBinary() {}
 
@@ -110,15 +116,101 @@ namespace Trick {
              */
             virtual int format_specific_write_data(unsigned int writer_offset) ;
 
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_flush
+             */
+            virtual int format_specific_flush() ;
+
             /**
              @copybrief Trick::DataRecordGroup::shutdown
              */
             virtual int format_specific_shutdown() ;
 
+            /**
+             @brief @userdesc Command to set the size of the block used to gather records before writing them
+             to the log file (default is 1048576).  Records are written with one system call per block instead of
+             one per record.  The block is always written out at the end of each write cycle, so data reaches the
+             file as soon as it did with per record writes.  A size of 0 writes each record individually.
+             The block size will be set during initialization in Trick::DRBinary::format_specific_init.
+             @par Python Usage:
+             @code <dr_group>.set_block_size(<bytes>) @endcode
+             @param bytes - the block size in bytes
+             @return always 0
+            */
+            int set_block_size(unsigned int bytes) ;
+
+            /**
+             @brief @userdesc Command to write the log file compressed (default is false).  Each block of records is
+             stored column by column, integers as varint deltas and floating point values XORed with the previous
+             value.  Compression is lossless.  The file is named log_<group_name>.trkz.
+             The setting takes effect during initialization in Trick::DRBinary::format_specific_init.
+             @par Python Usage:
+             @code <dr_group>.set_compression(<on>) @endcode
+             @param on - true to compress the log file
+             @return always 0
+            */
+            int set_compression(bool on) ;
+
+            /**
+             @brief @userdesc Command to set the least number of bytes of records gathered before a compressed
+             block is written (default is 65536).  Small blocks compress poorly, so a compressed group holds its
+             records across write cycles until the block holds this much.  Records still waiting are written when
+             the file is closed.  The size is limited to the block size.  Has no effect without compression.
+             @par Python Usage:
+             @code <dr_group>.set_min_block_size(<bytes>) @endcode
+             @param bytes - the least size of a compressed block in bytes
+             @return always 0
+            */
+            int set_min_block_size(unsigned int bytes) ;
+
+            /** Size of the write block in bytes, 0 = write every record individually.\n */
+            unsigned int block_size ;  /**< trick_io(*io) trick_units(--) */
+
+            /** Write compressed blocks to a .trkz file.\n */
+            bool compress ;            /**< trick_io(*io) trick_units(--) */
+
+            /** Least bytes of records in a compressed block before it is written.\n */
+            unsigned int min_block_size ;  /**< trick_io(*io) trick_units(--) */
+
+        protected:
+            /**
+             @brief Copies one time homogeneous record from the recording buffers to @c dest.
+             @param dest - destination, must hold at least #record_bytes bytes
+             @param writer_offset - index of the record in the recording buffers
+             @return number of bytes copied
+            */
+            unsigned int copy_record(char * dest, unsigned int writer_offset) ;
+
+            /**
+             @brief Writes all records gathered in #block_buff to the log file.
+             @return number of bytes written
+            */
+            int write_block() ;
+
+            /**
+             @brief Encodes the records gathered in #block_buff into #compressed_block.
+            */
+            void compress_block() ;
+
         private:
             /** The log file.\n */
             int fd ;             /**< trick_io(**) trick_units(--) */
 
+            /** The group records bitfields, records must be copied value by value.\n */
+            bool has_bitfields ;         /**< trick_io(**) trick_units(--) */
+
+            /** Buffer that gathers records before they are written.\n */
+            char * block_buff ;          /**< trick_io(**) trick_units(--) */
+
+            /** Allocated size of #block_buff in bytes.\n */
+            unsigned int block_buff_size ;  /**< trick_io(**) trick_units(--) */
+
+            /** Number of bytes currently held in #block_buff.\n */
+            unsigned int block_len ;     /**< trick_io(**) trick_units(--) */
+
+            /** The encoded block when compression is on.\n */
+            std::vector <unsigned char> compressed_block ; /**< trick_io(**) trick_units(--) */
+
     } ;
 
 } ;
@@ -0,0 +1,134 @@
+/*
+PURPOSE:
+    (Data Record Columnar class.)
+*/
+
+#ifndef DRCOLUMNAR_HH
+#define DRCOLUMNAR_HH
+
+#include <string>
+#include <vector>
+
+#include "trick/DataRecordGroup.hh"
+
+#ifdef SWIG
+%feature("compactdefaultargs","0") ;
+%feature("shadow") Trick::DRColumnar::DRColumnar(std::string in_name) %{
+    def __init__(self, *args):
+        this = $action(*args)
+        try: self.this.append(this)
+        except: self.this = this
+        this.own(0)
+        self.this.own(0)
+%}
+#endif
+
+namespace Trick {
+
+    /**
+     One memory mapped column file of a DRColumnar group.
+     */
+    class DRColumnarColumn {
+        public:
+            int fd ;                    /* ** column file descriptor */
+            char * map ;                /* ** mapped column file, NULL if not mapped */
+            size_t map_size ;           /* ** bytes of the column file mapped */
+            DRColumnarColumn() : fd(-1), map(NULL), map_size(0) {}
+    } ;
+
+    /**
+      The DRColumnar recording format stores each recorded parameter in its own file so data products can
+      read one parameter without reading every record.  A group is written to a directory named
+      log_<group_name>.col containing:
+
+      - index - the header of a DRBinary log file: the Trick-10-[LB] keyword followed by the number of
+        parameters and the name, units, type and size of each parameter.  Parameters are numbered in this order,
+        the first is always sys.exec.out.time.
+      - col_<n> - the values of parameter <n>.  Each file starts with the 8 character keyword "TrickCol" and
+        the number of values in the file as an 8 byte unsigned integer.  The values follow, <size> bytes each,
+        in the byte order given in the index.
+
+      Column files are memory mapped and grow as records are added.  The number of values in each column is
+      updated at the end of every write cycle, so the files can be read while the simulation runs.  At shutdown
+      the files are truncated to the values written.
+    */
+    class DRColumnar : public Trick::DataRecordGroup {
+
+        public:
+
+            #ifndef SWIG
+            /**
+             @brief DRColumnar default constructor.
+             */
+            DRColumnar() : num_rows(0), capacity_rows(0) {}
+            #endif
+            ~DRColumnar() {}
+
+            /**
+             @brief @userdesc Create a new Columnar data recording group.
+             @par Python Usage:
+             @code <my_drg> = trick.DRColumnar("<in_name>") @endcode
+             @copydoc Trick::DataRecordGroup::DataRecordGroup(string in_name)
+             */
+            DRColumnar( std::string in_name ) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_header
+             */
+            virtual int format_specific_header(std::fstream & outstream) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_init
+             */
+            virtual int format_specific_init() ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_write_data
+             */
+            virtual int format_specific_write_data(unsigned int writer_offset) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_flush
+             */
+            virtual int format_specific_flush() ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::shutdown
+             */
+            virtual int format_specific_shutdown() ;
+
+            /** Size of the column file header, the keyword followed by the number of values.\n */
+            static const unsigned int column_header_size = 16 ; /**< trick_io(**) trick_units(--) */
+
+        protected:
+            /**
+             @brief Grows every column file to hold at least @c rows values and maps it again.
+             @param rows - number of values to hold
+             @return 0 on success, -1 if a column could not be grown
+            */
+            int grow_columns(unsigned long long rows) ;
+
+            /**
+             @brief Writes the number of values in the column files to their headers.
+            */
+            void write_row_counts() ;
+
+        private:
+            /** One column file per recorded variable, in rec_buffer order.\n */
+            std::vector <Trick::DRColumnarColumn> columns ; /**< trick_io(**) trick_units(--) */
+
+            /** Number of values written to each column.\n */
+            unsigned long long num_rows ;      /**< trick_io(**) trick_units(--) */
+
+            /** Number of values the mapped columns hold.\n */
+            unsigned long long capacity_rows ; /**< trick_io(**) trick_units(--) */
+
+    } ;
+
+} ;
+
+#ifdef SWIG
+%feature("compactdefaultargs","1") ;
+#endif
+
+#endif
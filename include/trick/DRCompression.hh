@@ -0,0 +1,301 @@
+/*
+    PURPOSE:
+        (Lossless column encodings for compressed data recording.)
+    ICG: (No)
+*/
+
+#ifndef DRCOMPRESSION_HH
+#define DRCOMPRESSION_HH
+
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+#include "trick/parameter_types.h"
+
+namespace Trick {
+
+    /*
+     * A column of a compressed block is encoded one of two ways.
+     *
+     * Integers, including enumerations, booleans and bitfields, are widened to 64 bits.  The difference from
+     * the previous value is zigzag encoded so small negative differences stay small, then written as a
+     * little endian base 128 varint.  A column that does not change costs one byte per value.
+     *
+     * Floats and doubles are XORed with the previous value's bit pattern (Gorilla encoding).  An unchanged
+     * value is a single '0' bit.  Otherwise a '1' bit is followed by the meaningful bits of the XOR, either
+     * inside the previous value's window of leading and trailing zeros ('0' control bit), or with a new
+     * window ('1' control bit, 5 bits of leading zeros, 6 bits of length - 1).  The column is padded to a
+     * whole byte.
+     *
+     * Each block starts fresh, the first value of a column is encoded against 0.  The encoding does not
+     * depend on the byte order of the machine.
+     */
+
+    /* Returns true if values of this type are XOR encoded, false for delta encoded integers. */
+    inline bool dr_compression_is_float( int type , int size ) {
+        return (type == TRICK_FLOAT and size == 4) or (type == TRICK_DOUBLE and size == 8) ;
+    }
+
+    inline bool dr_compression_is_unsigned( int type ) {
+        switch ( type ) {
+            case TRICK_UNSIGNED_CHARACTER:
+            case TRICK_UNSIGNED_SHORT:
+            case TRICK_UNSIGNED_INTEGER:
+            case TRICK_UNSIGNED_LONG:
+            case TRICK_UNSIGNED_LONG_LONG:
+            case TRICK_UNSIGNED_BITFIELD:
+            case TRICK_BOOLEAN:
+                return true ;
+            default:
+                return false ;
+        }
+    }
+
+    /* Reads a value of @c size bytes at @c addr, widened to 64 bits. */
+    inline uint64_t dr_compression_load( const char * addr , int type , int size ) {
+        bool is_unsigned = dr_compression_is_unsigned(type) ;
+        switch ( size ) {
+            case 1 : { int8_t v ; memcpy(&v, addr, 1) ; return is_unsigned ? (uint64_t)(uint8_t)v : (uint64_t)(int64_t)v ; }
+            case 2 : { int16_t v ; memcpy(&v, addr, 2) ; return is_unsigned ? (uint64_t)(uint16_t)v : (uint64_t)(int64_t)v ; }
+            case 4 : { int32_t v ; memcpy(&v, addr, 4) ; return is_unsigned ? (uint64_t)(uint32_t)v : (uint64_t)(int64_t)v ; }
+            case 8 : { uint64_t v ; memcpy(&v, addr, 8) ; return v ; }
+        }
+        return 0 ;
+    }
+
+    /* Converts a decoded value to a double for data products. */
+    inline double dr_compression_to_double( uint64_t value , int type , int size ) {
+        if ( dr_compression_is_float(type, size) ) {
+            if ( size == 4 ) {
+                uint32_t bits = (uint32_t)value ;
+                float f ;
+                memcpy(&f, &bits, sizeof(f)) ;
+                return f ;
+            }
+            double d ;
+            memcpy(&d, &value, sizeof(d)) ;
+            return d ;
+        }
+        if ( dr_compression_is_unsigned(type) ) {
+            return (double)value ;
+        }
+        return (double)(int64_t)value ;
+    }
+
+    /* Appends bits most significant first. */
+    class DRBitWriter {
+        public:
+            DRBitWriter( std::vector<unsigned char> & in_out ) : out(in_out), acc(0), num_bits(0) {}
+
+            void write( uint64_t bits , unsigned int count ) {
+                while ( count > 0 ) {
+                    unsigned int take = count < (8 - num_bits) ? count : (8 - num_bits) ;
+                    count -= take ;
+                    acc = (acc << take) | (unsigned char)((bits >> count) & ((1u << take) - 1)) ;
+                    num_bits += take ;
+                    if ( num_bits == 8 ) {
+                        out.push_back(acc) ;
+                        acc = 0 ;
+                        num_bits = 0 ;
+                    }
+                }
+            }
+
+            /* Pads the last byte with zeros. */
+            void flush() {
+                if ( num_bits > 0 ) {
+                    out.push_back(acc << (8 - num_bits)) ;
+                    acc = 0 ;
+                    num_bits = 0 ;
+                }
+            }
+
+        private:
+            std::vector<unsigned char> & out ;
+            unsigned char acc ;
+            unsigned int num_bits ;
+    } ;
+
+    /* Reads bits most significant first.  Reading past the end returns zeros and sets overrun. */
+    class DRBitReader {
+        public:
+            DRBitReader( const unsigned char * in , size_t len ) : curr(in), end(in + len), num_bits(0), overrun(false) {}
+
+            uint64_t read( unsigned int count ) {
+                uint64_t bits = 0 ;
+                while ( count > 0 ) {
+                    if ( num_bits == 0 ) {
+                        if ( curr == end ) {
+                            overrun = true ;
+                            return 0 ;
+                        }
+                        num_bits = 8 ;
+                        curr++ ;
+                    }
+                    unsigned int take = count < num_bits ? count : num_bits ;
+                    num_bits -= take ;
+                    count -= take ;
+                    bits = (bits << take) | ((curr[-1] >> num_bits) & ((1u << take) - 1)) ;
+                }
+                return bits ;
+            }
+
+            const unsigned char * curr ;
+            const unsigned char * end ;
+            unsigned int num_bits ;
+            bool overrun ;
+    } ;
+
+    inline unsigned int dr_leading_zeros( uint64_t x , unsigned int width ) {
+        unsigned int n = 0 ;
+        for ( uint64_t mask = (uint64_t)1 << (width - 1) ; mask != 0 and (x & mask) == 0 ; mask >>= 1 ) {
+            n++ ;
+        }
+        return n ;
+    }
+
+    inline unsigned int dr_trailing_zeros( uint64_t x ) {
+        unsigned int n = 0 ;
+        while ( (x & 1) == 0 ) {
+            x >>= 1 ;
+            n++ ;
+        }
+        return n ;
+    }
+
+    /**
+     Encodes @c count values of one column and appends them to @c out.
+     @param out - encoded bytes are appended here
+     @param first - address of the first value
+     @param stride - bytes between consecutive values
+     @param count - number of values
+     @param type - Trick type of the values
+     @param size - size of each value in bytes
+     @return number of bytes appended
+    */
+    inline size_t dr_encode_column( std::vector<unsigned char> & out , const char * first , size_t stride ,
+     unsigned int count , int type , int size ) {
+
+        size_t start = out.size() ;
+        uint64_t prev = 0 ;
+        unsigned int ii ;
+
+        if ( ! dr_compression_is_float(type, size) ) {
+            for ( ii = 0 ; ii < count ; ii++ ) {
+                uint64_t value = dr_compression_load(first + ii * stride, type, size) ;
+                int64_t delta = (int64_t)(value - prev) ;
+                uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63) ;
+                while ( zigzag >= 0x80 ) {
+                    out.push_back((unsigned char)(zigzag | 0x80)) ;
+                    zigzag >>= 7 ;
+                }
+                out.push_back((unsigned char)zigzag) ;
+                prev = value ;
+            }
+            return out.size() - start ;
+        }
+
+        unsigned int width = size * 8 ;
+        unsigned int prev_lead = width + 1 ;
+        unsigned int prev_trail = 0 ;
+        DRBitWriter writer(out) ;
+        for ( ii = 0 ; ii < count ; ii++ ) {
+            uint64_t value = 0 ;
+            if ( size == 4 ) {
+                uint32_t bits ;
+                memcpy(&bits, first + ii * stride, 4) ;
+                value = bits ;
+            } else {
+                memcpy(&value, first + ii * stride, 8) ;
+            }
+            uint64_t x = value ^ prev ;
+            prev = value ;
+            if ( x == 0 ) {
+                writer.write(0, 1) ;
+                continue ;
+            }
+            unsigned int lead = dr_leading_zeros(x, width) ;
+            unsigned int trail = dr_trailing_zeros(x) ;
+            if ( lead > 31 ) {
+                lead = 31 ;
+            }
+            if ( prev_lead <= width and lead >= prev_lead and trail >= prev_trail ) {
+                writer.write(2, 2) ;
+                writer.write(x >> prev_trail, width - prev_lead - prev_trail) ;
+            } else {
+                unsigned int len = width - lead - trail ;
+                writer.write(3, 2) ;
+                writer.write(lead, 5) ;
+                writer.write(len - 1, 6) ;
+                writer.write(x >> trail, len) ;
+                prev_lead = lead ;
+                prev_trail = trail ;
+            }
+        }
+        writer.flush() ;
+        return out.size() - start ;
+    }
+
+    /**
+     Decodes @c count values of one column written by dr_encode_column.
+     @param in - encoded column
+     @param len - length of the encoded column in bytes
+     @param count - number of values
+     @param type - Trick type of the values
+     @param size - size of each value in bytes
+     @param values - decoded values, see dr_compression_to_double
+     @return true if the column decoded within @c len bytes
+    */
+    inline bool dr_decode_column( const unsigned char * in , size_t len , unsigned int count , int type , int size ,
+     uint64_t * values ) {
+
+        uint64_t prev = 0 ;
+        unsigned int ii ;
+
+        if ( ! dr_compression_is_float(type, size) ) {
+            const unsigned char * end = in + len ;
+            for ( ii = 0 ; ii < count ; ii++ ) {
+                uint64_t zigzag = 0 ;
+                unsigned int shift = 0 ;
+                do {
+                    if ( in == end or shift > 63 ) {
+                        return false ;
+                    }
+                    zigzag |= (uint64_t)(*in & 0x7f) << shift ;
+                    shift += 7 ;
+                } while ( *in++ & 0x80 ) ;
+                int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1) ;
+                prev += (uint64_t)delta ;
+                values[ii] = prev ;
+            }
+            return true ;
+        }
+
+        unsigned int width = size * 8 ;
+        unsigned int lead = 0 ;
+        unsigned int sig = 0 ;
+        unsigned int trail = 0 ;
+        DRBitReader reader(in, len) ;
+        for ( ii = 0 ; ii < count ; ii++ ) {
+            if ( reader.read(1) ) {
+                if ( reader.read(1) ) {
+                    lead = reader.read(5) ;
+                    sig = reader.read(6) + 1 ;
+                    if ( lead + sig > width ) {
+                        return false ;
+                    }
+                    trail = width - lead - sig ;
+                } else if ( sig == 0 ) {
+                    return false ;
+                }
+                prev ^= reader.read(sig) << trail ;
+            }
+            values[ii] = prev ;
+        }
+        return ! reader.overrun ;
+    }
+
+} ;
+
+#endif
@@ -36,6 +36,14 @@ PROGRAMMERS:
 
 namespace Trick {
 
+    /**
+     * The DRHDF5_Layout enumeration represents the possible layouts of the recorded values in a DRHDF5 file.
+     */
+    enum DRHDF5_Layout {
+        DRHDF5_Packet_Tables = 0,   /**< one packet table per recorded parameter */
+        DRHDF5_Compound = 1         /**< one chunked dataset of records, one compound member per parameter */
+    } ;
+
 #ifdef HDF5
 #ifndef TRICK_ICG
     struct HDF5_INFO {
@@ -80,6 +88,23 @@ GROUP "/" {
     DATASET "parameter #n" {
         value1 , value2 , value3 , etc...
     }
+}
+    @endverbatim
+
+      When the layout is set to DRHDF5_Compound the per parameter packet tables are replaced by a single
+      extendible, chunked dataset named "records".  Each element of the dataset is one record, a compound
+      value with one member per parameter named after the parameter.  Whole blocks of records are appended
+      with one write, and data products read a parameter by selecting its member.
+      @verbatim
+GROUP "/" {
+    GROUP "header" {
+        ...
+    }
+    DATASET "records" {
+        { time1, param_1_value1, param_2_value1, ... },
+        { time2, param_1_value2, param_2_value2, ... },
+        ...
+    }
 }
     @endverbatim
 */
@@ -91,7 +116,8 @@ GROUP "/" {
             /**
              @brief DRHDF5 default constructor.
              */
-            DRHDF5() {}
+            DRHDF5() : layout(DRHDF5_Packet_Tables), chunk_size(1024), chunk_cache_size(0), deflate_level(-1),
+             shuffle(false), column_buff(NULL) {}
             #endif
             ~DRHDF5() {}
 
@@ -129,15 +155,89 @@ GROUP "/" {
              */
             virtual int format_specific_shutdown() ;
 
+            /**
+             @brief @userdesc Command to set the layout of the recorded values (default is DRHDF5_Packet_Tables).
+             DRHDF5_Compound writes all parameters of the group to one chunked dataset of records.
+             The setting takes effect during initialization in Trick::DRHDF5::format_specific_init.
+             @par Python Usage:
+             @code <dr_group>.set_layout(trick.DRHDF5_Compound) @endcode
+             @param in_layout - the layout
+             @return always 0
+            */
+            int set_layout(DRHDF5_Layout in_layout) ;
+
+            /**
+             @brief @userdesc Command to set the number of records (or packets of a packet table) in one HDF5
+             chunk (default is 1024).
+             @par Python Usage:
+             @code <dr_group>.set_chunk_size(<rows>) @endcode
+             @param rows - records per chunk
+             @return 0 on success, -1 if rows is 0
+            */
+            int set_chunk_size(unsigned int rows) ;
+
+            /**
+             @brief @userdesc Command to set the size of the HDF5 chunk cache of the records dataset written by the
+             DRHDF5_Compound layout (default is 0, the HDF5 default cache size).
+             @par Python Usage:
+             @code <dr_group>.set_chunk_cache_size(<bytes>) @endcode
+             @param bytes - chunk cache size in bytes
+             @return always 0
+            */
+            int set_chunk_cache_size(unsigned int bytes) ;
+
+            /**
+             @brief @userdesc Command to compress the records dataset of the DRHDF5_Compound layout with the HDF5
+             deflate filter (default is no compression).
+             @par Python Usage:
+             @code <dr_group>.set_deflate(<level>, <shuffle>) @endcode
+             @param level - deflate level 0-9, or -1 to not compress
+             @param in_shuffle - apply the HDF5 shuffle filter before deflate, which usually compresses better
+             @return 0 on success, -1 if level is out of range
+            */
+            int set_deflate(int level, bool in_shuffle = true) ;
+
+            /** Layout of the recorded values.\n */
+            DRHDF5_Layout layout ;          /**< trick_io(*io) trick_units(--) */
+
+            /** Records or packets per HDF5 chunk.\n */
+            unsigned int chunk_size ;       /**< trick_io(*io) trick_units(--) */
+
+            /** Size of the chunk cache of the records dataset in bytes, 0 = HDF5 default.\n */
+            unsigned int chunk_cache_size ; /**< trick_io(*io) trick_units(--) */
+
+            /** Deflate level of the records dataset, -1 = no compression.\n */
+            int deflate_level ;             /**< trick_io(*io) trick_units(--) */
+
+            /** Apply the shuffle filter to the records dataset before deflate.\n */
+            bool shuffle ;                  /**< trick_io(*io) trick_units(--) */
+
         protected:
 
 #ifdef HDF5
+            /**
+             @brief Appends @c count records of the recording ring starting at ring index @c first to the records
+             dataset with one write.  The records may not wrap around the end of the ring.
+             @return 0 on success, -1 on error
+            */
+            int append_records(unsigned int first, unsigned int count) ;
+
             std::vector<HDF5_INFO *> parameters;  // trick_io(**)
 
             hid_t file;  // trick_io(**)
             hid_t root_group, header_group;  // trick_io(**)
+
+            /* records dataset of the DRHDF5_Compound layout */
+            hid_t records_dataset;  // trick_io(**)
+            /* compound type of a record in the recording ring, members at the DataRecordBuffer offsets */
+            hid_t record_type;  // trick_io(**)
+            /* number of records in the records dataset */
+            hsize_t num_records;  // trick_io(**)
 #endif
 
+            /** Scratch space to gather one variable's values out of the recording ring */
+            char * column_buff ;  // trick_io(**)
+
     } ;
 
 } ;
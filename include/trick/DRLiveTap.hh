@@ -0,0 +1,83 @@
+/*
+PURPOSE:
+    (Shared memory live tap of the records of a data record group.)
+*/
+
+#ifndef DRLIVETAP_HH
+#define DRLIVETAP_HH
+
+#include <string>
+#include <vector>
+
+#include "trick/tsm.h"
+
+namespace Trick {
+
+    class DataRecordBuffer ;
+
+    /**
+      A DRLiveTap publishes every record of a data record group to a Trick shared memory (TSM) segment as it
+      is recorded, so processes on the same host can read the rows at the recording rate without the variable
+      server or the log files.  The layout of the segment is described in trick/dr_live_tap.h.
+
+      The segment is created read only for other users.  Its key and id are written to
+      log_<group_name>.tap in the output directory, for example "key 0x0100a3f2 shmid 98317 size 41040".
+      Readers attach with shmat(shmid, NULL, SHM_RDONLY) and follow rows_written.  The segment is marked for
+      removal at shutdown and goes away when the last reader detaches.
+    */
+    class DRLiveTap {
+
+        public:
+            DRLiveTap() ;
+            ~DRLiveTap() ;
+
+            /**
+             @brief Creates the shared memory segment, writes the header and variable descriptors, and writes
+             the locator file.
+             @param locator_name - path of the locator file, also the key file of the segment
+             @param vars - the recorded variables, packed in this order
+             @param record_bytes - size of a record
+             @param num_rows - number of rows kept in the segment
+             @return 0 on success, -1 if the segment could not be created
+            */
+            int init( std::string locator_name , std::vector <Trick::DataRecordBuffer *> & vars ,
+             unsigned int record_bytes , unsigned int num_rows ) ;
+
+            /**
+             @brief Copies a record to the next row of the segment.  Called by the recording thread.
+             @param record - the record
+            */
+            void publish( const char * record ) ;
+
+            /**
+             @brief Marks the segment closed and for removal, and detaches from it.
+            */
+            void shutdown() ;
+
+        protected:
+            /** The shared memory segment.  */
+            TSMDevice tsm_dev ;             /**< trick_io(**) */
+
+            /** Start of the first row slot.  */
+            char * rows ;                   /**< trick_io(**) */
+
+            /** Size of a record.  */
+            unsigned int record_bytes ;     /**< trick_io(**) */
+
+            /** Number of row slots.  */
+            unsigned int num_rows ;         /**< trick_io(**) */
+
+            /** Size of a row slot.  */
+            unsigned int slot_bytes ;       /**< trick_io(**) */
+
+            /** Rows published.  */
+            unsigned long long rows_written ; /**< trick_io(**) */
+
+        private:
+            DRLiveTap(const Trick::DRLiveTap &) ;
+            void operator =(const Trick::DRLiveTap &) ;
+    } ;
+
+} ;
+
+#endif
@@ -9,11 +9,13 @@ PROGRAMMERS:
 #define DATARECORDDISPATCHER_HH
 
 #include <iostream>
+#include <atomic>
 #include <pthread.h>
 
 #include "trick/Scheduler.hh"
 #include "trick/DataRecordGroup.hh"
 #include "trick/SysThread.hh"
+#include "trick/MessageSubscriber.hh"
 
 namespace Trick {
 
@@ -28,24 +30,60 @@ namespace Trick {
             pthread_cond_t init_complete_cv;        /**< trick_io(**) */
             /** Data writer initialized mutex. */
             pthread_mutex_t init_complete_mutex;    /**< trick_io(**) */
-            /** Flag to exit (instead of pthread_cancel) */
-            bool cancelled;
+            /** Protects the list of groups while writer threads walk it. */
+            pthread_rwlock_t groups_rwlock; /**< trick_io(**) */
+            /** Flag to exit (instead of pthread_cancel).  Read by the writers without the mutex. */
+            std::atomic<bool> cancelled;    /**< trick_io(**) */
+            /** Write pass number, incremented each time the writers are signaled.  Accessed atomically. */
+            unsigned long long pass;        /**< trick_io(**) */
+            /** Number of writer threads sharing the groups. */
+            unsigned int num_writers;       /**< trick_io(**) */
+            /** Number of writer threads sleeping on dr_go_cv.  Accessed atomically. */
+            unsigned int num_waiting;       /**< trick_io(**) */
     } ;
 
     class DRDWriterThread : public Trick::SysThread {
         public:
-            DRDWriterThread(Trick::DRDMutexes & in_mutexes, std::vector <Trick::DataRecordGroup *> & in_groups) ;
+            DRDWriterThread(Trick::DRDMutexes & in_mutexes, std::vector <Trick::DataRecordGroup *> & in_groups,
+             unsigned int in_writer_id = 0) ;
 
             virtual void * thread_body() ;
             virtual void dump( std::ostream & oss = std::cout ) ;
+
+            /** @brief Gets the id of this writer within the dispatcher's writer pool. */
+            unsigned int get_writer_id() ;
         protected:
+            /** @brief Writes every group due in @c pass that is assigned to this writer and not held by another writer. */
+            void write_groups( unsigned long long pass ) ;
+
             Trick::DRDMutexes & drd_mutexes ;  // trick_io(**)
             std::vector <Trick::DataRecordGroup *> & groups ;  // trick_io(**)
+            /** Position of this writer in the writer pool. */
+            unsigned int writer_id ;  // trick_io(**)
 
         private:
             void operator =(const Trick::DRDWriterThread &) ;
     } ;
 
+    class DataRecordDispatcher ;
+
+    /**
+     Listens to the message publisher and triggers the captures of groups set to trigger on errors.
+     */
+    class DRTriggerSubscriber : public Trick::MessageSubscriber {
+        public:
+            DRTriggerSubscriber(Trick::DataRecordDispatcher & in_drd) ;
+
+            /** @brief Triggers captures when an error message is published. */
+            virtual void update( unsigned int level , std::string header , std::string message ) ;
+
+        protected:
+            Trick::DataRecordDispatcher & drd ;  // trick_io(**)
+
+        private:
+            void operator =(const Trick::DRTriggerSubscriber &) ;
+    } ;
+
     /*
        The DataRecordDispatcher inherits from Trick::Scheduler.  It does not contain job classes
        of its own, but we do want to be notified when new sim_objects are added to the simulation.
@@ -81,6 +119,31 @@ namespace Trick {
             /** @brief Signal the write thread to execute. */
             virtual int signal_thread() ;
 
+            /**
+             @brief @userdesc Command to set the most frames sleeping writer threads are left asleep while
+             records are waiting (default is 10).  Writers are woken sooner when a group's recording buffer
+             reaches the wake fill or a triggered capture is waiting.  Writers that are still busy pick up new
+             work without being signaled.
+             @par Python Usage:
+             @code trick_data_record.drd.set_writer_wake_frames(<frames>) @endcode
+             @param frames - most frames between wake ups, at least 1
+             @return always 0
+            */
+            int set_writer_wake_frames(unsigned int frames) ;
+
+            /**
+             @brief @userdesc Command to set how full a DR_Buffer group's recording buffer gets before sleeping
+             writer threads are woken (default is 0.25).  0 wakes the writers every frame records are waiting.
+             @par Python Usage:
+             @code trick_data_record.drd.set_writer_wake_fill(<fill>) @endcode
+             @param fill - fraction of the recording buffer, 0 to 1
+             @return always 0
+            */
+            int set_writer_wake_fill(double fill) ;
+
+            /** @brief Gets the number of write passes started, the number of times the writers were signaled. */
+            unsigned long long get_write_pass() ;
+
             /** @brief Clears the tracked data record groups before a checkpoint reload. */
             int preload_checkpoint() ;
 
@@ -99,12 +162,48 @@ namespace Trick {
             /** @brief Disable a group or all groups */
             int record_now_group( const char * in_name ) ;
 
+            /**
+             @brief @userdesc Command to trigger the capture of a group or of all groups with triggered captures.
+             @par Python Usage:
+             @code trick.dr_trigger_group("<group_name>") @endcode
+             @param in_name - group name, NULL triggers every group with triggered captures
+             @return 0 on success, -1 if a named group could not be triggered
+            */
+            int trigger( const char * in_name = NULL ) ;
+
+            /** @brief Triggers every group set to trigger on error messages. */
+            void trigger_on_error() ;
+
             /** @brief set max file size for group */
             int set_group_max_file_size(const char * in_name, uint64_t bytes) ;
 
             /** @brief set max file size for all groups */
             int set_max_file_size(uint64_t bytes) ;
 
+            /**
+             @brief @userdesc Command to set the number of threads writing DR_Buffer groups to disk (default is 1).
+             Groups are shared among the writers; a group that one writer is busy with is skipped by the others,
+             so a slow group does not hold up the rest.  Must be called before initialization.
+             @par Python Usage:
+             @code trick_data_record.drd.set_num_writer_threads(<num>) @endcode
+             @param num - number of writer threads, at least 1
+             @return 0 on success, -1 if the writers are already running
+            */
+            int set_num_writer_threads(unsigned int num) ;
+
+            /** @brief Gets the number of writer threads. */
+            unsigned int get_num_writer_threads() ;
+
+            /**
+             @brief @userdesc Gets a writer thread so its cpu affinity and priority may be set.  Writer 0 is
+             drd_writer_thread.
+             @par Python Usage:
+             @code trick_data_record.drd.get_writer_thread(<id>).cpu_set(<cpu>) @endcode
+             @param id - writer id
+             @return the writer thread or NULL if id is out of range
+            */
+            Trick::DRDWriterThread * get_writer_thread(unsigned int id) ;
+
             // override the default Schduler::add_sim_object
             virtual int add_sim_object( Trick::SimObject * in_object ) ;
 
@@ -125,6 +224,27 @@ namespace Trick {
             /** mutexes shared with writer thread */
             DRDMutexes drd_mutexes ;  // trick_io(**)
 
+            /** Writer threads beyond drd_writer_thread */
+            std::vector <Trick::DRDWriterThread *> extra_writer_threads ;  // trick_io(**)
+
+            /** @brief Tests if any group has enough records waiting to wake the writers. */
+            bool writers_needed( bool interval_done ) ;
+
+            /** Most frames between waking sleeping writers while records are waiting */
+            unsigned int writer_wake_frames ;  // trick_units(--)
+
+            /** Fraction of a recording buffer filled before sleeping writers are woken */
+            double writer_wake_fill ;  // trick_units(--)
+
+            /** Frames since the writers were last signaled */
+            unsigned int frames_since_wake ;  // trick_io(**)
+
+            /** A wake up could not be delivered and is retried on the next frame */
+            bool wake_owed ;  // trick_io(**)
+
+            /** Triggers captures on error messages */
+            DRTriggerSubscriber trigger_subscriber ;  // trick_io(**)
+
 
         private:
             void operator =(const Trick::DataRecordDispatcher &) ;
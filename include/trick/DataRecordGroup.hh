@@ -14,6 +14,7 @@ PROGRAMMERS:
 #include <pthread.h>
 
 #include "trick/SimObject.hh"
+#include "trick/DRLiveTap.hh"
 #include "trick/reference.h"
 
 namespace Trick {
@@ -31,6 +32,17 @@ namespace Trick {
                                    point to point plot */
     } ;
 
+    /**
+     * The DR_Reduction enumeration represents how a variable is reduced over the cycles between records.
+     */
+    enum DR_Reduction {
+        DR_Sample = 0,          /**< record the value at the time of the record */
+        DR_Min = 1,             /**< record the minimum value since the last record */
+        DR_Max = 2,             /**< record the maximum value since the last record */
+        DR_Mean = 3,            /**< record the mean value since the last record */
+        DR_RMS = 4              /**< record the root mean square value since the last record */
+    } ;
+
     /**
      * The DR_Buffering enumeration represents the possible Trick data recording buffering options.
      */
@@ -42,19 +54,50 @@ namespace Trick {
         DR_Not_Specified = 3    /**< Unknown type */
     } ;
 
+    /**
+     * A recorded variable.  Its recorded values are in the group's recording ring, read them with
+     * DataRecordGroup::record_value().  The per variable curr_buffer and last_value buffers of older releases
+     * were removed.
+     */
     class DataRecordBuffer {
         public:
-            char *buffer;       /* ** generic holding buffer for data */
-            char *curr_buffer;  /* ** current position in the buffer */
-            char *last_value;   /* ** holding buffer for last value, used for DR_Changes_step */
+            char *buffer;       /* ** holding buffer for the last value of a change variable */
+            unsigned int offset ; /* ** byte offset of the variable's value within a record */
             REF2 * ref ;        /* ** size/address/units information of variable */
             bool ref_searched ; /* ** reference information has been searched */
             std::string name ;      /* ** actual name of the variable to record */
             std::string alias ;      /* ** alias name used in data recording files */
+            DR_Reduction reduction ; /* ** reduction recorded for the variable */
+            ATTRIBUTES reduced_attr ; /* ** attributes of a reduced value, recorded as a double */
+            int source_type ;   /* ** type of the variable a reduced value is computed from */
+            int source_size ;   /* ** size of the variable a reduced value is computed from */
             DataRecordBuffer() ;
             ~DataRecordBuffer() ;
     } ;
 
+    /**
+     * A run of recorded variables that are contiguous in simulation memory.  The run is copied
+     * into each record with a single memcpy.
+     */
+    class DataRecordCopySpan {
+        public:
+            char * address ;        /* ** start of the span in simulation memory, NULL records zeros */
+            unsigned int offset ;   /* ** byte offset of the span within a record */
+            unsigned int size ;     /* ** length of the span in bytes */
+    } ;
+
+    /**
+     * Running statistics of a reduced variable since the last record.
+     */
+    class DataRecordReduction {
+        public:
+            Trick::DataRecordBuffer * drb ; /* ** the reduced variable */
+            double min ;            /* ** smallest value sampled */
+            double max ;            /* ** largest value sampled */
+            double sum ;            /* ** sum of the values sampled */
+            double sum_sq ;         /* ** sum of the squares of the values sampled */
+    } ;
+
     class DataRecordGroup : public Trick::SimObject {
 
         public:
@@ -83,6 +126,9 @@ namespace Trick {
             /** Cycle time for data recording.\n */
             double cycle;               /**< trick_io(*io) trick_units(s) */
 
+            /** Time between records of a reducing group, 0 records every cycle.\n */
+            double reduction_cycle;     /**< trick_io(*io) trick_units(s) */
+
             /*  Fake attributes to use for data recording.\n */
             ATTRIBUTES time_value_attr; /**< trick_io(**) */
 
@@ -92,6 +138,8 @@ namespace Trick {
             char ** variable_names ;    /** trick_units(--) */
             /** List of variable aliases to save in a checkpoint.\n */
             char ** variable_alias ;    /** trick_units(--) */
+            /** List of variable reductions to save in a checkpoint.\n */
+            int * variable_reductions ; /** trick_units(--) */
 
             /** Vector of buffers - one for every variable added with Trick::DataRecordGroup::add_variable.\n */
             std::vector <Trick::DataRecordBuffer *> rec_buffer;     /**< trick_io(**) trick_units(--) */
@@ -109,12 +157,22 @@ namespace Trick {
             /** Maximum records to hold in memory before writing.\n */
             unsigned int max_num;       /**< trick_io(*io) trick_units(--) */
 
-            /** Current buffering record number.\n */
+            /** Size of one record, the packed values of every variable in rec_buffer order.\n */
+            unsigned int record_bytes;  /**< trick_io(**) trick_units(--) */
+
+            /** Recording ring of max_num records, record_bytes each.\n */
+            char * record_buffer;       /**< trick_io(**) trick_units(--) */
+
+            /** Current buffering record number.  Only advanced by data_record, with release semantics.\n */
             unsigned int buffer_num;    /**< trick_io(**) trick_units(--) */
 
-            /** Current write to file record number.\n */
+            /** Current write to file record number.  Only advanced by write_data, with release semantics.\n */
             unsigned int writer_num;    /**< trick_io(**) trick_units(--) */
 
+            /** Records data_record has started to copy into the ring.  One ahead of buffer_num while a record
+                is being copied.  Only advanced by data_record.\n */
+            unsigned int buffer_claim;  /**< trick_io(**) trick_units(--) */
+
             /** Maximum file size for data record file in bytes.\n */
             uint64_t max_file_size;    /**< trick_io(**) trick_units(--) */
            
@@ -124,6 +182,27 @@ namespace Trick {
             /** Bool to signify that the warning for reaching max filesize has been printed */
             bool max_size_warning;
 
+            /** Continue in a new numbered file segment when the max file size is reached.\n */
+            bool rollover;             /**< trick_io(*io) trick_units(--) */
+
+            /** Number of the file segment being written, 0 is the log_<group_name> file.\n */
+            unsigned int segment_num;  /**< trick_io(**) trick_units(--) */
+
+            /** DR_Ring_Buffer groups only, capture the ring to a separate file when triggered.\n */
+            bool trigger_enabled;      /**< trick_io(*io) trick_units(--) */
+
+            /** Records recorded after a trigger before the ring is captured.\n */
+            unsigned int trigger_post_records; /**< trick_io(*io) trick_units(--) */
+
+            /** Trigger a capture when a message is published at MSG_ERROR.\n */
+            bool trigger_on_error;     /**< trick_io(*io) trick_units(--) */
+
+            /** Number of captures written.\n */
+            unsigned int capture_num;  /**< trick_io(*o) trick_units(--) */
+
+            /** Rows kept in the shared memory live tap, 0 = no live tap.\n */
+            unsigned int live_tap_rows; /**< trick_io(*io) trick_units(--) */
+
             /** Buffer to hold formatted data ready for disk or other destination.\n */
             char * writer_buff ;        /**< trick_io(**) trick_units(--) */
 
@@ -145,6 +224,36 @@ namespace Trick {
             /** Pointer to the write job.  */
             Trick::JobData * write_job ; /**< trick_io(**) */
 
+            /** Writer thread assigned to this group, -1 = any writer thread.\n */
+            int writer_thread ;         /**< trick_io(*io) trick_units(--) */
+
+            /** Last dispatcher write pass completed for this group.\n */
+            unsigned long long write_pass ; /**< trick_io(**) trick_units(--) */
+
+            /** Records recorded by data_record.\n */
+            unsigned long long rows_recorded ; /**< trick_io(*io) trick_units(--) */
+
+            /** Records written to the file, including triggered captures.\n */
+            unsigned long long rows_written ; /**< trick_io(*io) trick_units(--) */
+
+            /** Records overwritten in the ring before they were written.\n */
+            unsigned long long rows_dropped ; /**< trick_io(*io) trick_units(--) */
+
+            /** Most records waiting in the ring to be written.\n */
+            unsigned int ring_high_water ; /**< trick_io(*io) trick_units(--) */
+
+            /** Bytes of records written over all file segments and captures.\n */
+            uint64_t bytes_written ;   /**< trick_io(*io) trick_units(--) */
+
+            /** Wall clock time spent in data_record.\n */
+            double record_time ;       /**< trick_io(*io) trick_units(s) */
+
+            /** Wall clock time spent formatting and writing records.\n */
+            double write_time ;        /**< trick_io(*io) trick_units(s) */
+
+            /** Writer throughput in bytes per second, bytes_written over write_time.\n */
+            double write_rate ;        /**< trick_io(*io) trick_units(--) */
+
             /**
              @brief Constructor that creates a new data recording group with the given @c in_name.
              @param in_name - the new data recording group name
@@ -229,6 +338,67 @@ namespace Trick {
             */
             virtual int set_max_file_size(uint64_t bytes) ;
 
+            /**
+             @brief @userdesc Command to continue recording in a new file segment when the max file size is reached
+             instead of stopping (default is false).  Segments after the first are named log_<group_name>.<nnnn>
+             with the format's extension, and are listed in order in log_<group_name>.segments.
+             @par Python Usage:
+             @code <dr_group>.set_rollover(<on>) @endcode
+             @param on - true to roll over to a new segment
+             @return always 0
+            */
+            virtual int set_rollover(bool on) ;
+
+            /**
+             @brief @userdesc Command to turn on triggered captures of a DR_Ring_Buffer group.  After a trigger
+             @c post_records more records are recorded, then the whole ring, the records before and after the
+             trigger, is written by the writer thread to
+             trigger_<group_name>_<nnnn>/log_<group_name> with the format's extension.
+             Must be called before the group is initialized.
+             @par Python Usage:
+             @code <dr_group>.set_trigger_window(<post_records>) @endcode
+             @param post_records - records to record after the trigger, less than the max buffer size
+             @return always 0
+            */
+            virtual int set_trigger_window(unsigned int post_records) ;
+
+            /**
+             @brief @userdesc Command to trigger a capture whenever a message is published at MSG_ERROR
+             (default is false).  Turns on triggered captures, see set_trigger_window.
+             @par Python Usage:
+             @code <dr_group>.set_trigger_on_error(<on>) @endcode
+             @param on - true to trigger on error messages
+             @return always 0
+            */
+            virtual int set_trigger_on_error(bool on) ;
+
+            /**
+             @brief @userdesc Command to trigger a capture of the recording ring.  Safe to call from any thread,
+             including input file events.  Triggers received while a capture window is open are part of that
+             capture; triggers received while a capture is being written start a new capture when it is done.
+             @par Python Usage:
+             @code <dr_group>.trigger() @endcode
+             @return 0 on success, -1 if triggered captures are not turned on for this group
+            */
+            virtual int trigger() ;
+
+            /**
+             @brief Tests if a triggered capture is waiting to be written.  Safe to call from any thread.
+             @returns true if a capture is waiting
+            */
+            bool capture_pending() ;
+
+            /**
+             @brief @userdesc Command to publish every record of the group to a shared memory segment as it is
+             recorded, so other processes on the host can read the rows without the variable server.  The
+             segment's key and id are written to log_<group_name>.tap in the output directory.  Must be called
+             before the group is initialized.
+             @par Python Usage:
+             @code <dr_group>.set_live_tap(<num_rows>) @endcode
+             @param num_rows - rows kept in the segment for readers that fall behind, 0 turns the tap off
+             @return always 0
+            */
+            virtual int set_live_tap(unsigned int num_rows) ;
 
             /**
              @brief @userdesc Command to print double variable values as single precision (float) in the log file to save space.
@@ -239,6 +409,16 @@ namespace Trick {
             */
             virtual int set_single_prec_only(bool in_single_prec_only) ;
 
+            /**
+             @brief @userdesc Command to assign this group to one of the data record dispatcher's writer threads
+             (default is -1, any writer thread).  Ids larger than the number of writers wrap around.
+             @par Python Usage:
+             @code <dr_group>.set_writer_thread(<id>) @endcode
+             @param in_writer - writer thread id, -1 for any
+             @return always 0
+            */
+            virtual int set_writer_thread(int in_writer) ;
+
             /**
              @brief @userdesc Command to set the thread of execution for this log group
              @par Python Usage:
@@ -308,6 +488,13 @@ namespace Trick {
             */
             virtual int format_specific_write_data(unsigned int writer_offset) = 0 ;
 
+            /**
+             @brief Called by write_data after a batch of records has been passed to format_specific_write_data.
+             Formats that accumulate records in memory send them to their destination here.
+             @returns always 0
+            */
+            virtual int format_specific_flush() ;
+
             /**
              @brief Shutdown loggroup. implemented in derived groups.
              @returns always 0
@@ -361,6 +548,42 @@ namespace Trick {
             */
             virtual int add_change_variable(std::string in_name) ;
 
+            /**
+             @brief @userdesc Command to add a variable recorded as its minimum, maximum, mean or root mean square
+             over the cycles since the last record.  The group samples the variable every cycle and writes a record
+             every reduction cycle, see set_reduction_cycle.  The reduced value is recorded as a double.
+             @par Python Usage:
+             @code <dr_group>.add_reduced_variable("<in_name>", trick.DR_Max [,"<alias>"]) @endcode
+             @param in_name - the name of the variable to be recorded
+             @param reduction - DR_Min, DR_Max, DR_Mean or DR_RMS.  DR_Sample records the variable like add_variable.
+             @param alias - name recorded in the log file, default is <in_name>.<min|max|mean|rms>
+             @return always 0
+            */
+            virtual int add_reduced_variable(std::string in_name , DR_Reduction reduction , std::string alias = "" ) ;
+
+            /**
+             @brief @userdesc Command to record the envelope of a variable, its minimum and maximum since the last
+             record, so peaks are kept when a fast signal is recorded at a slower rate.
+             @par Python Usage:
+             @code <dr_group>.add_envelope_variable("<in_name>") @endcode
+             @param in_name - the name of the variable to be recorded as <in_name>.min and <in_name>.max
+             @return always 0
+            */
+            virtual int add_envelope_variable(std::string in_name) ;
+
+            /**
+             @brief @userdesc Command to set the time between records of the group (default is 0, every cycle).
+             The group's cycle is the sample rate of reduced variables; a record is written every
+             reduction_cycle / cycle samples.  Variables added with add_variable are recorded at their value at
+             the time of the record.  Reductions are computed over every sample for DR_Changes groups, which
+             record when the change variables change.
+             @par Python Usage:
+             @code <dr_group>.set_reduction_cycle(<in_cycle>) @endcode
+             @param in_cycle - time between records in seconds, a multiple of the group's cycle
+             @return always 0
+            */
+            virtual int set_reduction_cycle(double in_cycle) ;
+
             /**
              @brief Copy group's variable values from memory to recording buffer.
              @param in_time - current simulation time in seconds
@@ -374,6 +597,27 @@ namespace Trick {
             */
             virtual int write_data(bool must_write = false) ;
 
+            /**
+             @brief Gets the number of records recorded but not yet written.  Safe to call from any thread.
+             @returns number of records waiting in the recording buffer
+            */
+            unsigned int pending_records() ;
+
+            /**
+             @brief Tests if a change variable changed in the last call to data_record.
+             @param index - index of the change variable in change_buffer
+             @returns true if the value changed
+            */
+            bool change_variable_changed( unsigned int index ) ;
+
+            /**
+             @brief Called by the dispatcher's writer threads.  Writes the group for write pass @c pass unless the
+             group is already current or another writer thread is writing it.
+             @param pass - dispatcher write pass number
+             @returns 0 if the group is current, 1 if another writer holds the group
+            */
+            virtual int dispatch_write(unsigned long long pass) ;
+
             /**
              @brief Clean up and close log file, implemented in derived group classes DRAscii, DRBinary, DRHDF5.
              @returns always 0
@@ -398,6 +642,18 @@ namespace Trick {
             */
             std::string type_string(int item_type, int item_size) ;
 
+            /**
+             @brief Gets the address of a recorded value in the ring being written, the recording ring or
+             a triggered capture.  The value may not be aligned for its type; copy it out before reading it
+             as anything other than bytes.
+             @param drb - the variable
+             @param writer_offset - index of the record in the ring
+             @returns address of the value
+            */
+            char * record_value( Trick::DataRecordBuffer * drb, unsigned int writer_offset ) {
+                return write_ring + (size_t)writer_offset * record_bytes + drb->offset ;
+            }
+
         protected:
             /**
              @brief This routine adds the sys.exec.out.time variable to the data record group
@@ -407,7 +663,191 @@ namespace Trick {
 
             /** Check that a variable is supported by data recording. */
             /** Variable must be a single primitive type - no STL, array, structured, string */
-            bool isSupportedType(REF2 * ref2, std::string& message);
+            /** Formats that store fewer types override this to reject the rest. */
+            virtual bool isSupportedType(REF2 * ref2, std::string& message);
+
+            /**
+             @brief Groups the recorded variables into spans that are contiguous in simulation memory
+             and in the record so each span is copied with one memcpy.  The change variables are
+             grouped the same way into spans of the change snapshot.
+            */
+            virtual void build_copy_plan() ;
+
+            /**
+             @brief Copies the current value of every recorded variable into @c record.  Addresses
+             found through pointers are checked first and the copy plan is rebuilt if any moved.
+             @param record - destination record in the recording ring
+            */
+            void copy_record_values( char * record ) ;
+
+            /**
+             @brief Sets the number of samples between records from the reduction cycle and the group's cycle.
+            */
+            void update_reduce_samples() ;
+
+            /**
+             @brief Adds the current value of every reduced variable to its statistics.
+            */
+            void sample_reductions() ;
+
+            /**
+             @brief Writes the reduced values to @c record and starts the statistics over.
+             @param record - destination record in the recording ring
+            */
+            void finish_reductions( char * record ) ;
+
+            /**
+             @brief Wall clock seconds used to time recording and writing.
+            */
+            static double wall_time() ;
+
+            /**
+             @brief Publishes the group's recording and writing counters, with a warning when the writer
+             fell behind.  Called at shutdown.
+            */
+            void report_statistics() ;
+
+            /**
+             @brief Closes the current file segment and opens the next numbered segment, writing its
+             header and adding it to the segments manifest.  Called by write_data so the segment is
+             changed by the thread writing the group, not the recording thread.
+             @returns 0 on success, -1 if the new segment could not be opened
+            */
+            int open_next_segment() ;
+
+            /**
+             @brief Closes the current file and lets the format open @c base_name with its extension and
+             write its header.
+             @param base_name - file name without the format's extension
+             @returns the format's initialization status
+            */
+            int reopen_file( std::string base_name ) ;
+
+            /**
+             @brief Called by data_record after each record.  Starts the capture window of a new trigger
+             and freezes the ring when the window is complete.
+            */
+            void check_trigger() ;
+
+            /**
+             @brief Swaps the recording ring with the spare capture ring and hands the full ring to the
+             writer.  Called by the recording thread, does not copy any records.
+            */
+            void freeze_capture() ;
+
+            /**
+             @brief Writes a frozen capture ring to its own file.  Called by the writer thread.
+             @returns 0 if nothing was written or the capture was written, -1 on error
+            */
+            int write_capture() ;
+
+            /**
+             @brief Tells the writer the record at buffer_num is being copied into the ring.  Called by data_record
+             before it writes each record.
+            */
+            void claim_record() ;
+
+            /**
+             @brief Copies records starting with record number @c first out of the recording ring into the write
+             stage and points write_ring at them.  Records data_record overwrote or may be overwriting are skipped
+             and counted as dropped.  The staged records are released back to data_record.
+             @param first - number of the first record to stage, advanced past the dropped records
+             @param last - one past the number of the last record to stage
+             @returns number of records staged, write_ring offsets 0 to the number - 1
+            */
+            unsigned int stage_records( unsigned int & first , unsigned int last ) ;
+
+            /** Ring read by the format's writer, the write stage or a frozen capture.  */
+            char * write_ring ;              /**< trick_io(**) */
+
+            /** Records copied out of the recording ring for the format's writer.  */
+            char * write_stage ;             /**< trick_io(**) */
+
+            /** Number of records the write stage holds.  */
+            unsigned int stage_num ;         /**< trick_io(**) */
+
+            /** Spare ring of a triggered group.  Swapped with the recording ring when a capture is frozen.  */
+            char * capture_ring ;            /**< trick_io(**) */
+
+            /** Number of the first record in the recording ring.  Earlier records were captured.  */
+            unsigned int ring_first ;        /**< trick_io(**) */
+
+            /** Numbers of the first and one past the last record in the frozen capture.  */
+            unsigned int capture_first ;     /**< trick_io(**) */
+            unsigned int capture_end ;       /**< trick_io(**) */
+
+            /** A frozen capture is waiting for the writer.  Accessed atomically.  */
+            bool capture_busy ;              /**< trick_io(**) */
+
+            /** Number of triggers requested.  Incremented atomically from any thread.  */
+            unsigned int triggers_requested ; /**< trick_io(**) */
+
+            /** Number of triggers requested seen by the recording thread.  */
+            unsigned int triggers_seen ;     /**< trick_io(**) */
+
+            /** A capture window is open.  */
+            bool trigger_armed ;             /**< trick_io(**) */
+
+            /** Records left in the open capture window.  */
+            unsigned int trigger_countdown ; /**< trick_io(**) */
+
+            /**
+             @brief Adds the current file to log_<group_name>.segments.  The manifest is started
+             over with the first segment.
+            */
+            void write_segment_manifest() ;
+
+            /** Spans of simulation memory copied into each record.  */
+            std::vector <Trick::DataRecordCopySpan> copy_plan ; /**< trick_io(**) */
+
+            /** Variables whose address is found through a pointer and may change.  */
+            std::vector <Trick::DataRecordBuffer *> pointer_vars ; /**< trick_io(**) */
+
+            /**
+             @brief Compares the change snapshot with the last snapshot a block at a time and sets the
+             bit in change_mask of every change variable that differs.
+             @returns number of change variables that changed
+            */
+            unsigned int detect_changes() ;
+
+            /** Spans of simulation memory copied into the change snapshot.  */
+            std::vector <Trick::DataRecordCopySpan> change_plan ; /**< trick_io(**) */
+
+            /** Change variables whose address is found through a pointer and may change.  */
+            std::vector <Trick::DataRecordBuffer *> change_pointer_vars ; /**< trick_io(**) */
+
+            /** Bytes compared at once by Trick::DataRecordGroup::detect_changes.  */
+            static const unsigned int change_block_size = 16 ; /**< trick_io(**) */
+
+            /** Size of the change snapshots, the packed change variables padded to whole blocks.  */
+            unsigned int change_bytes ;      /**< trick_io(**) */
+
+            /** Change variable values gathered this cycle.  */
+            char * change_values ;           /**< trick_io(**) */
+
+            /** Change variable values at the last change.  */
+            char * change_last ;             /**< trick_io(**) */
+
+            /** Index of the first change variable stored in each block of the snapshots.  */
+            std::vector <unsigned int> change_block_first ; /**< trick_io(**) */
+
+            /** One bit per change variable, set if the variable changed in the last data_record.  */
+            std::vector <unsigned int> change_mask ; /**< trick_io(**) */
+
+            /** Copy of the last record, used for DR_Changes_Step.  */
+            char * last_record ;             /**< trick_io(**) */
+
+            /** Statistics of the reduced variables, in rec_buffer order.  */
+            std::vector <Trick::DataRecordReduction> reductions ; /**< trick_io(**) */
+
+            /** Samples between records, from reduction_cycle.  */
+            unsigned int reduce_samples ;    /**< trick_io(**) */
+
+            /** Samples taken since the last record.  */
+            unsigned int reduce_count ;      /**< trick_io(**) */
+
+            /** Shared memory live tap, NULL if the group has none.  */
+            Trick::DRLiveTap * live_tap ;    /**< trick_io(**) */
 
             /** Max number of digits to expect per recorded value.\n */
             static const unsigned int record_size = 25; /**< trick_io(**) trick_units(--) */
@@ -415,6 +855,9 @@ namespace Trick {
             /** Data thread condition mutex.  */
             pthread_mutex_t buffer_mutex;    /**< trick_io(**) */
 
+            /** Held by the writer thread writing this group in Trick::DataRecordGroup::dispatch_write.  */
+            pthread_mutex_t dispatch_mutex;  /**< trick_io(**) */
+
             /** Current time saved in Trick::DataRecordGroup::data_record.\n */
             double curr_time ;          /**< trick_io(*i) trick_units(--) */
 
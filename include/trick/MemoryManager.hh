@@ -37,6 +37,8 @@ namespace Trick {
     typedef std::map<std::string, ALLOC_INFO*>::const_iterator VARIABLE_MAP_ITER ;
     typedef std::map<std::string, ENUM_ATTR*> ENUMERATION_MAP;
 
+    typedef std::map<std::string, REF2*> REF_CACHE_MAP;
+
 /**
   The Memory Manager provides memory-resource administration services.
   To provide these services, it tracks information about chunks of memory.
@@ -466,11 +468,19 @@ namespace Trick {
             /**
              Generate and return a REF2 reference object for the named variable.
              Caller is responsible for freeing the returned REF2 object (using free() from stdlib.h ).
+             References that do not go through a pointer are parsed once and copied from a cache after
+             that, until a named allocation is deleted or resized.
              @param name - fully qualified variable name.
              @return pointer to REF2 object, or NULL on failure.
              */
             REF2 *ref_attributes( const char* name);
 
+            /**
+             Forget the references cached by ref_attributes. Called when a named allocation is
+             deleted or moved.
+             */
+            void clear_ref_cache();
+
             /**
              @param address - Address for which a name reference is needed.
              @return a name reference for the given address.
@@ -683,6 +693,10 @@ namespace Trick {
             ENUMERATION_MAP enumeration_map; /**< ** Enumeration map. */
             pthread_mutex_t mm_mutex;        /**< ** Mutex to control access to memory manager maps */
 
+            REF_CACHE_MAP   ref_cache;       /**< ** Map of <reference, REF2*> for references parsed by ref_attributes. */
+            unsigned int    ref_cache_generation; /**< ** Counts clear_ref_cache calls, a parse that spans one is not cached. */
+            pthread_mutex_t ref_cache_mutex; /**< ** Mutex to control access to ref_cache */
+
             int alloc_info_map_counter ;     /**< ** counter to assign unique ids to allocations as they are added to map */
             int extern_alloc_info_map_counter ; /**< ** counter to assign unique ids to allocations as they are added to map */
 
@@ -793,6 +807,11 @@ namespace Trick {
              */
             ATTRIBUTES* make_reference_attr( ALLOC_INFO* alloc_info);
 
+            /**
+             Free the references cached by ref_attributes.
+             */
+            void delete_ref_cache();
+
             /**
              Delete/free the given reference attributes.
              */
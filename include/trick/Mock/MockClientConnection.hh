@@ -18,6 +18,8 @@ class MockClientConnection : public Trick::ClientConnection {
         MOCK_METHOD1(setClientTag, int(std::string tag));
         MOCK_METHOD0(getClientHostname, std::string());
         MOCK_METHOD0(getClientPort, int());
+        MOCK_METHOD0(getSocket, int());
+        MOCK_METHOD0(getConnectionType, ConnectionType());
 
 };
 
@@ -26,6 +26,7 @@ class MockVariableServerSession : public Trick::VariableServerSession {
         MOCK_METHOD0(set_exit_cmd, void());
 
         MOCK_METHOD0(copy_and_write_async, int());
+        MOCK_METHOD0(flush_send_queue, int());
 
         // Accessor for the concrete version
         int copy_and_write_async_concrete() { return Trick::VariableServerSession::copy_and_write_async(); }
@@ -21,6 +21,7 @@ namespace Trick {
             
             // Multicast specific functions
             int initialize_with_receiving(std::string local_addr, std::string mcast_addr, int port);
+            int initialize_sender(std::string mcast_addr, int port);
             virtual int initialize();
 
             virtual int broadcast (std::string message);
@@ -0,0 +1,157 @@
+#ifndef SHARED_MEMORY_CONNECTION_HH
+#define SHARED_MEMORY_CONNECTION_HH
+
+/*
+    PURPOSE: ( Exchange messages with a client on the same host through a pair of shared memory rings. )
+*/
+
+#include <string>
+#include <stdint.h>
+#include "trick/ClientConnection.hh"
+
+#define SHARED_MEMORY_CONNECTION_KEYWORD "TrickShm"
+#define SHARED_MEMORY_CONNECTION_VERSION 1
+
+// client_open of a segment with no client, with a client and after the client disconnected
+#define SHARED_MEMORY_CLIENT_NONE 0
+#define SHARED_MEMORY_CLIENT_OPEN 1
+#define SHARED_MEMORY_CLIENT_CLOSED 2
+
+namespace Trick {
+
+    /**
+      A byte stream ring with one writer and one reader.  head and tail count the bytes written and read and
+      wrap around, the data starts at head % size.  The side that moves head or tail increments signal and wakes
+      the other side if it is waiting on signal.  head, tail and signal are in their own cache lines so the two
+      sides do not slow each other down.
+     */
+    struct SharedMemoryRing {
+        uint32_t head ;             /**< -- bytes written */
+        char pad0[60] ;             /**< -- */
+        uint32_t tail ;             /**< -- bytes read */
+        char pad1[60] ;             /**< -- */
+        uint32_t signal ;           /**< -- futex word, changes every time head or tail moves */
+        uint32_t waiting ;          /**< -- number of processes waiting on signal */
+        char pad2[56] ;             /**< -- */
+    } ;
+
+    /**
+      A shared memory connection segment starts with this header.  The data of to_server follows it, then the
+      data of to_client, ring_size bytes each.
+     */
+    struct SharedMemorySegment {
+        char keyword[8] ;           /**< -- "TrickShm" */
+        uint32_t version ;          /**< -- SHARED_MEMORY_CONNECTION_VERSION */
+        uint32_t ring_size ;        /**< -- size of each ring, a power of 2 */
+        uint32_t server_pid ;       /**< -- process of the server */
+        uint32_t client_pid ;       /**< -- process of the client, 0 until a client connects and after the server releases it */
+        uint32_t server_open ;      /**< -- 1 until the server disconnects */
+        uint32_t client_open ;      /**< -- SHARED_MEMORY_CLIENT_NONE, _OPEN or _CLOSED */
+        char pad[32] ;              /**< -- */
+        SharedMemoryRing to_server ;
+        SharedMemoryRing to_client ;
+    } ;
+
+    /**
+      A connection between processes on the same host through a POSIX shared memory segment holding a ring in
+      each direction.  Messages are copied once into the ring and once out of it, without system calls unless a
+      side has to wait, so same host clients avoid the latency and copies of loopback sockets.
+
+      The server creates the segment with initialize() and removes it when it disconnects.  One client
+      connects to it by name with connect().  Both sides use write() to send and read() for newline terminated
+      text.  Clients receive binary messages with receive().  Like a socket, write() sends what fits in the ring
+      and returns without waiting unless setBlockMode(true) was called.
+
+      A segment serves one client at a time.  Once the client disconnects or its process is gone the server
+      calls release_client(), which empties the rings and lets the next client connect to the same segment.
+     */
+    class SharedMemoryConnection : public ClientConnection {
+        public:
+
+            static const unsigned int DEFAULT_RING_SIZE = 262144 ;
+
+            SharedMemoryConnection ();
+            virtual ~SharedMemoryConnection ();
+
+            int start() override;
+
+            int write (const std::string& message) override;
+            int write (char * message, int size) override;
+
+            int read  (std::string& message, int max_len = MAX_CMD_LEN) override;
+
+            int disconnect () override;
+            bool isInitialized() override;
+
+            int setBlockMode(bool blocking) override;
+            int restart() override;
+
+            virtual std::string getClientTag () override;
+            virtual int setClientTag (std::string tag) override;
+
+            virtual std::string getClientHostname() override;
+            virtual int getClientPort() override;
+
+            // Non-override functions
+
+            /**
+             @brief Creates the segment as the server.  A segment of the same name left by a server that is gone
+                    is removed first.
+             @param name - the name of the segment, like "/trick_vs_display"
+             @param ring_size - the size of each ring, rounded up to a power of 2
+             @return 0 if successful, -1 if a running server has a segment of the same name
+            */
+            int initialize(const std::string& name, unsigned int ring_size = DEFAULT_RING_SIZE);
+
+            /**
+             @brief Connects to a segment as the client.
+             @param name - the name the server gave the segment
+             @return 0 if successful, -1 if there is no such segment or the server has not released its last client
+            */
+            int connect(const std::string& name);
+
+            /**
+             @brief Lets the next client connect, as the server.  Anything left in the rings is thrown away.
+             @return 0 if successful, -1 if the client is still connected
+            */
+            int release_client();
+
+            /**
+             @brief Receives the bytes sent by the other side, waiting for some if there are none.
+             @param buffer - receives the bytes
+             @param size - the most bytes to receive
+             @param timeout - seconds to wait, negative waits until bytes arrive or the other side disconnects
+             @return the number of bytes received, 0 if none arrived in time, -1 if the other side disconnected
+            */
+            int receive(char * buffer, int size, double timeout = -1.0);
+
+            std::string getName();
+
+        protected:
+            int write_bytes(const char * message, int size);
+            bool peer_closed();
+            bool peer_open();
+            int wait(SharedMemoryRing * ring, uint32_t signal, double timeout);
+            void notify(SharedMemoryRing * ring);
+
+            bool _server;
+            bool _initialized;
+            bool _started;
+            bool _blocking;
+
+            std::string _name;
+            int _fd;
+            SharedMemorySegment * _segment;     /* ** */
+            size_t _segment_size;
+
+            // The ring this side reads and the ring it writes, with their data
+            SharedMemoryRing * _in;             /* ** */
+            SharedMemoryRing * _out;            /* ** */
+            char * _in_data;                    /* ** */
+            char * _out_data;                   /* ** */
+            uint32_t _ring_size;
+    };
+
+}
+
+#endif
@@ -38,6 +38,8 @@ namespace Trick {
             virtual std::string getClientHostname() override;
             virtual int getClientPort() override;
 
+            virtual int getSocket() override;
+
         private:
             int _socket;
             bool _connected;
@@ -14,6 +14,9 @@ namespace Trick {
     class UDPConnection : public ClientConnection {
         public:
 
+            // The largest payload of a UDP datagram over IPv4
+            static const int MAX_DATAGRAM_SIZE = 65507 ;
+
             UDPConnection ();
             UDPConnection (SystemInterface * system_interface);
 
@@ -27,7 +27,7 @@ namespace Trick {
 
         ~VariableReference();
 
-        std::string getName() const;
+        const std::string& getName() const;
         TRICK_TYPE getType() const;
 
         std::string getBaseUnits() const;
@@ -40,6 +40,12 @@ namespace Trick {
         // stageValue must be called first, and then prepare for write, and then writeValue* can be called.
         int stageValue(bool validate_address = false);
         int prepareForWrite();
+
+        // Variables read straight from a fixed address may be copied once for all sessions by the
+        // VariableServerSnapshot.  stageValueFrom stages a value copied from getAddress() elsewhere.
+        bool isShareable() const;
+        void * getAddress() const;
+        int stageValueFrom(const char * value);
         bool isStaged() const;
         bool isWriteReady() const;
 
@@ -49,11 +55,17 @@ namespace Trick {
         int getSizeBinary() const;
         int writeValueAscii( std::ostream& out ) const;
         int writeValueBinary( std::ostream& out , bool byteswap = false) const;
+        // Writes getSizeBinary() bytes straight into out
+        int writeValueBinary( char * out , bool byteswap = false) const;
         int writeNameBinary( std::ostream& out, bool byteswap = false) const;
         int writeNameLengthBinary( std::ostream& out, bool byteswap = false) const;
         int writeSizeBinary( std::ostream& out, bool byteswap = false) const;
         int writeTypeBinary( std::ostream& out, bool byteswap = false) const;
 
+        // Send on change: tests if the value ready to write differs from the value last marked as sent
+        bool writeValueChanged() const;
+        void markWriteValueSent();
+
         bool validate();
         void tagAsInvalid();
 
@@ -84,6 +96,9 @@ namespace Trick {
         void *_stage_buffer;
         void *_write_buffer;  
 
+        bool _sent;
+        std::vector<char> _sent_value;
+
         std::string _base_units;
         std::string _requested_units; 
         std::string _name;
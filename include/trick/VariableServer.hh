@@ -17,7 +17,11 @@
 #include "trick/JobData.hh"
 #include "trick/variable_server_sync_types.h"
 #include "trick/VariableServerSessionThread.hh"
+#include "trick/VariableServerChannel.hh"
 #include "trick/VariableServerListenThread.hh"
+#include "trick/VariableServerSnapshot.hh"
+#include "trick/VariableServerEventEngine.hh"
+#include "trick/VariableServerCommandParser.hh"
 #include "trick/SysThread.hh"
 
 namespace Trick {
@@ -238,6 +242,45 @@ namespace Trick {
             */
             void set_var_server_session_log_off() ;
 
+            /**
+             @brief @userdesc Command to serve TCP clients with the event engine, a few worker threads waiting on all
+             client sockets with epoll, instead of a thread per client.  Must be called before the variable server
+             is initialized.  Only available on Linux.
+             @par Python Usage:
+             @code trick.var_server_set_event_engine(<on_off>) @endcode
+             @param on_off - true to use the event engine, false (default) for a thread per client
+            */
+            void set_event_engine(bool on_off) ;
+            /**
+             @brief @userdesc Test if the event engine serves the TCP clients.
+             @par Python Usage:
+             @code <my_bool> = trick.var_server_get_event_engine() @endcode
+            */
+            bool get_event_engine() ;
+            /**
+             @brief @userdesc Command to set the number of event engine worker threads (default is 2).  Must be
+             called before the variable server is initialized.
+             @par Python Usage:
+             @code trick.var_server_set_event_workers(<num>) @endcode
+             @param num - number of worker threads, at least 1
+            */
+            void set_event_workers(unsigned int num) ;
+
+            /**
+             @brief @userdesc Command to run common variable server commands, like var_add, var_set and var_cycle
+             called with literal arguments, without the input processor (default is on).  Other commands are
+             always given to the input processor.
+             @par Python Usage:
+             @code trick.var_server_set_native_commands(<on_off>) @endcode
+             @param on_off - true to run common commands directly, false to give all commands to the input processor
+            */
+            void set_native_commands(bool on_off) ;
+            /**
+             @brief @userdesc Test if common variable server commands run without the input processor.
+             @par Python Usage:
+             @code <my_bool> = trick.var_server_get_native_commands() @endcode
+            */
+            bool get_native_commands() ;
             /**
              @brief @userdesc Command to open additional variable server listen port.
              @param source_address - the name or numeric IP of the machine to bind listen socket.  NULL or empty
@@ -273,6 +316,54 @@ namespace Trick {
             int create_multicast_socket( const char * mcast_address,
              const char * source_address, unsigned short port ) ;
 
+            /**
+             @brief @userdesc Command to open a shared memory connection for a single client on the same host.
+             @param name - the name of the shared memory segment, like "/trick_vs_display"
+             @par Python Usage:
+             @code trick.var_server_create_shared_memory(name) @endcode
+             @return 0 if successful
+            */
+            int create_shared_memory( const char * name ) ;
+
+            /**
+             @brief @userdesc Command to publish a channel, a variable list sent to a multicast group.  Any number
+             of clients receive the channel by joining the group.  Clients get the address with var_join_channel.
+             @param name - the name clients use to join the channel
+             @param mcast_address - the numeric IP of the multicast address to send to
+             @param port - the port.
+             @par Python Usage:
+             @code trick.var_server_create_channel(name, mcast_address, port) @endcode
+             @return 0 if successful
+            */
+            int create_channel( const char * name, const char * mcast_address, unsigned short port ) ;
+
+            /**
+             @brief @userdesc Command to add a variable to a channel.
+             @param name - the name of the channel
+             @param var_name - the variable
+             @param units_name - units to send the variable in.  NULL or empty string sends the variable's units.
+             @par Python Usage:
+             @code trick.var_server_channel_add(name, var_name, units_name) @endcode
+             @return 0 if successful
+            */
+            int channel_add( const char * name, const char * var_name, const char * units_name = NULL ) ;
+
+            /**
+             @brief @userdesc Command to set the period a channel is sent at.  The default is 0.1 seconds.
+             @param name - the name of the channel
+             @param period - the period in seconds
+             @par Python Usage:
+             @code trick.var_server_channel_set_cycle(name, period) @endcode
+             @return 0 if successful
+            */
+            int channel_set_cycle( const char * name, double period ) ;
+
+            /**
+             @brief Gets a channel by name.
+             @return the channel or NULL if there is no such channel
+            */
+            VariableServerChannel * get_channel( std::string name ) ;
+
             /**
              @brief @userdesc Suspend variable server processing in preparation for checkpoint reload.
              @return 0 if successful
@@ -329,6 +420,15 @@ namespace Trick {
             /** Map of additional listen threads created by create_tcp_socket.\n */
             std::map < pthread_t , VariableServerListenThread * > additional_listen_threads ; /**<  trick_io(**) */
 
+            /** Map of channels created by create_channel, by name.\n */
+            std::map < std::string , VariableServerChannel * > channels ; /**<  trick_io(**) */
+
+            /** Values copied once per copy job for all sessions copying in the main thread.\n */
+            VariableServerSnapshot snapshot ; /**<  trick_io(**) */
+
+            /** Serves TCP clients with a few worker threads when selected.\n */
+            VariableServerEventEngine event_engine ; /**<  trick_io(**) */
+
 
     } ;
 
@@ -367,6 +467,12 @@ int var_set_frame_offset(unsigned int offset) ;
 int var_set_freeze_frame_multiple(unsigned int mult) ;
 int var_set_freeze_frame_offset(unsigned int offset) ;
 int var_byteswap(bool on_off) ;
+int var_set_max_message_size(int size) ;
+int var_send_on_change(int on_off) ;
+int var_set_keyframe_interval(int cycles) ;
+int var_set_send_queue_size(int bytes) ;
+int var_set_send_queue_policy(int policy) ;
+int var_join_channel(std::string name) ;
 
 
 int var_send_list_size() ;
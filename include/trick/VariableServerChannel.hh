@@ -0,0 +1,83 @@
+/*
+    PURPOSE:
+        (A variable list published to any number of variable server clients over multicast.)
+*/
+
+#ifndef VARIABLESERVERCHANNEL_HH
+#define VARIABLESERVERCHANNEL_HH
+
+#include <string>
+#include <vector>
+#include "trick/VariableServerSession.hh"
+#include "trick/VariableServerSessionThread.hh"
+#include "trick/MulticastGroup.hh"
+
+namespace Trick {
+
+/**
+  A published channel sends one list of variables to a multicast group.  The list is copied and serialized once
+  per cycle, however many clients receive it.  Clients ask for the address of a channel with var_join_channel()
+  and join the group.
+
+  The channel is a binary VariableServerSession writing to the group, served by its own session thread like a
+  UDP session, except the thread only copies and sends.  It never reads commands from the socket.  It copies in the copy job at the channel's cycle.  Its messages are VS_CHANNEL_LIST messages
+  numbered in sequence, so receivers can tell when they missed one.
+ */
+    class VariableServerChannel {
+
+        public:
+            VariableServerChannel(std::string name) ;
+            ~VariableServerChannel() ;
+
+            /**
+             @brief Opens the multicast socket the channel publishes to and makes the session thread, to be
+                    started by the caller.  The thread owns the session and socket.
+             @return 0 if successful
+            */
+            int initialize(std::string mcast_address, unsigned short port) ;
+
+            /**
+             @brief Adds a variable to the channel.
+            */
+            int add(std::string var_name , std::string units_name = "") ;
+
+            /**
+             @brief Sets the period of the channel in seconds.
+            */
+            int set_cycle(double period) ;
+
+            /**
+             @brief Adds the variables again after a checkpoint is reloaded.  The session thread disconnected
+                    them before the reload.
+            */
+            void restart() ;
+
+            std::string get_name() const ;
+            std::string get_address() const ;
+            unsigned short get_port() const ;
+            VariableServerSessionThread * get_thread() ;
+
+        private:
+            /** Name clients use to join the channel.\n */
+            std::string name ;                          /**< trick_io(**) */
+
+            /** Multicast address and port of the channel.\n */
+            std::string address ;                       /**< trick_io(**) */
+            unsigned short port ;                       /**< trick_io(**) */
+
+            /** Names and units of the variables, to add them again after a checkpoint reload.\n */
+            std::vector < std::pair < std::string , std::string > > var_names ; /**< trick_io(**) */
+
+            /** The multicast socket.\n */
+            MulticastGroup * group ;                    /**< trick_io(**) */
+
+            /** Holds, serializes and sends the variables.\n */
+            VariableServerSession * session ;           /**< trick_io(**) */
+
+            /** Runs the session.\n */
+            VariableServerSessionThread * thread ;      /**< trick_io(**) */
+    } ;
+
+}
+
+#endif
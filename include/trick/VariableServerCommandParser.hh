@@ -0,0 +1,94 @@
+/*
+    PURPOSE:
+        (Runs common variable server commands without the input processor.)
+*/
+
+#ifndef VARIABLESERVERCOMMANDPARSER_HH
+#define VARIABLESERVERCOMMANDPARSER_HH
+
+#include <string>
+#include <vector>
+
+namespace Trick {
+
+/**
+  Runs the commands a variable server client sends.  Lines that only call variable server commands with literal
+  arguments, like
+
+  @code
+  trick.var_add("ball.obj.state.output.position[0]")
+  trick.var_set("ball.obj.state.input.mass", 10.0, "kg") ; trick.var_cycle(0.05)
+  @endcode
+
+  are run directly, without the input processor and its interpreter lock.  Every other line is given to the
+  input processor, in the order received.  Both run the same commands, so clients see no difference other than
+  speed.
+ */
+    class VariableServerCommandParser {
+
+        public:
+            /** A literal argument of a command. */
+            struct Argument {
+                enum Type { STRING , INTEGER , FLOAT , BOOLEAN } ;
+                Type type ;
+                std::string string_value ;
+                long long integer_value ;
+                double float_value ;
+            } ;
+
+            /** A command with its arguments, checked against the commands the parser runs. */
+            struct Command {
+                int command_index ;
+                std::vector < Argument > args ;
+            } ;
+
+            /**
+             @brief Runs a message from a client.  Lines the parser does not run are given to the input processor.
+             @param message - one or more lines
+             @return 0 if every line ran without a parsing error, otherwise the last input processor error
+            */
+            static int run(const std::string & message) ;
+
+            /**
+             @brief Parses one line.
+             @param line - a line without its newline
+             @param commands - filled with the commands of the line
+             @return true if the parser runs the whole line, false if the line is for the input processor
+            */
+            static bool parse_line(const std::string & line , std::vector < Command > & commands) ;
+
+            /**
+             @brief Runs a command returned by parse_line.  No native command calls into Python, so none
+             take the interpreter lock.  The send_sie_ commands, which rewrite files shared by every session,
+             run one at a time under a lock of the parser's own.
+            */
+            static void execute(const Command & command) ;
+
+            /**
+             @brief Gets the name of a command returned by parse_line, without the "trick." prefix.
+            */
+            static const char * get_name(const Command & command) ;
+
+            /**
+             @brief Tests if Python text left open brackets or a line continuation, so the next line continues it.
+            */
+            static bool continues(const std::string & python_text) ;
+
+            /**
+             @brief Turns the parser on or off.  When off, messages are given to the input processor whole.
+            */
+            static void set_enabled(bool on_off) ;
+
+            /**
+             @brief Tests if the parser is on.
+            */
+            static bool get_enabled() ;
+
+        private:
+            /** True when the parser runs the commands it knows, the default.\n */
+            static bool enabled ;           /**<  trick_io(**) */
+    } ;
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+    PURPOSE:
+        (Buffers a variable server client connection for the event engine.)
+*/
+
+#ifndef VARIABLESERVEREVENTCONNECTION_HH
+#define VARIABLESERVEREVENTCONNECTION_HH
+
+#include <string>
+
+#include "trick/ClientConnection.hh"
+
+namespace Trick {
+
+/**
+  Wraps a socket based ClientConnection for the VariableServerEventEngine.
+
+  The engine waits for the socket to be readable and hands everything on the socket to receive().  Sessions
+  read whole commands from the received bytes.  Writes go straight to the non-blocking socket and return what it
+  took.  The session's VariableServerSendQueue keeps the rest, applies its limit and policy, and is flushed by the
+  engine when the socket drains.
+ */
+    class VariableServerEventConnection : public ClientConnection {
+
+        public:
+            /**
+             @brief Constructor.
+             @param connection - the connection to wrap.  Deleted with this object.
+            */
+            VariableServerEventConnection(ClientConnection * connection) ;
+
+            virtual ~VariableServerEventConnection() ;
+
+            virtual int start() override ;
+
+            /**
+             @brief Sends what the socket takes of a message.
+             @return the number of bytes sent, or -1 with errno set.  errno is EAGAIN if the socket is full.
+            */
+            virtual int write (const std::string& message) override ;
+            virtual int write (char * message, int size) override ;
+
+            /**
+             @brief Reads the complete commands received so far.
+             @return the size of the commands, 0 if no command is complete
+            */
+            virtual int read (std::string& message, int max_len = MAX_CMD_LEN) override ;
+
+            virtual int setBlockMode (bool blocking) override ;
+            virtual int disconnect () override ;
+            virtual bool isInitialized() override ;
+
+            virtual std::string getClientTag () override ;
+            virtual int setClientTag (std::string tag) override ;
+
+            virtual int restart() override ;
+
+            virtual std::string getClientHostname() override ;
+            virtual int getClientPort() override ;
+
+            virtual int getSocket() override ;
+            virtual ConnectionType getConnectionType() override ;
+
+            /**
+             @brief Reads everything waiting on the socket.  Called by the engine when the socket is readable.
+             @return 0 if the connection is open, -1 if the client closed it or it failed
+            */
+            int receive() ;
+
+        protected:
+            /** The wrapped connection.\n */
+            ClientConnection * _connection ;    /**< trick_io(**) */
+
+            /** Bytes received but not yet read as a complete command.\n */
+            std::string _received ;             /**< trick_io(**) */
+
+        private:
+            VariableServerEventConnection(const VariableServerEventConnection &) ;
+            VariableServerEventConnection & operator=(const VariableServerEventConnection &) ;
+    } ;
+
+}
+
+#endif
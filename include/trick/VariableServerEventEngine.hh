@@ -0,0 +1,143 @@
+/*
+    PURPOSE:
+        (Event driven alternative to a thread per variable server client.)
+*/
+
+#ifndef VARIABLESERVEREVENTENGINE_HH
+#define VARIABLESERVEREVENTENGINE_HH
+
+#include <string>
+#include <vector>
+
+#include "trick/ThreadBase.hh"
+#include "trick/ClientConnection.hh"
+#include "trick/VariableServerSession.hh"
+#include "trick/VariableServerEventWorker.hh"
+
+namespace Trick {
+
+    class VariableServer ;
+
+/**
+  The event engine serves all TCP variable server clients with a small fixed number of worker threads instead
+  of one thread per client.  Each accepted client is given to the worker serving the fewest clients.  Clients
+  behave as they do with their own thread: the same commands, copy modes, update rates and checkpoint reload
+  support.  The engine is only available on Linux.  UDP and multicast sessions always run in their own thread.
+ */
+    class VariableServerEventEngine {
+
+        public:
+            VariableServerEventEngine() ;
+            ~VariableServerEventEngine() ;
+
+            /**
+             @brief Sets the variable server the sessions are added to.
+            */
+            void set_vs_ptr(VariableServer * in_vs) ;
+
+            /**
+             @brief Gets the variable server the sessions are added to.
+            */
+            VariableServer * get_vs() ;
+
+            /**
+             @brief Selects the event engine for clients connecting after initialization.
+            */
+            void set_enabled(bool on_off) ;
+
+            /**
+             @brief Tests if the event engine is selected.
+            */
+            bool get_enabled() ;
+
+            /**
+             @brief Sets the number of worker threads.  Takes effect when the engine starts.
+            */
+            void set_num_workers(unsigned int num) ;
+
+            /**
+             @brief Gets the number of worker threads.
+            */
+            unsigned int get_num_workers() ;
+
+            /**
+             @brief Starts the workers.  Does nothing if the engine is already running.
+             @param cpu_thread - thread whose cpu affinity the workers copy
+             @return 0 on success, -1 if the engine could not start
+            */
+            int start(Trick::ThreadBase & cpu_thread) ;
+
+            /**
+             @brief Tests if the workers are running.  Listen threads give new clients to the engine when it runs.
+            */
+            bool is_running() ;
+
+            /**
+             @brief Accepts a new client and gives it to a worker.  Called by listen threads.
+             @param connection - connection set up by the listener, deleted by the engine
+             @return 0 on success, -1 if the client could not be accepted
+            */
+            int add_connection(ClientConnection * connection) ;
+
+            /**
+             @brief Gets the total number of clients the workers serve.
+            */
+            unsigned int get_num_clients() ;
+
+            /**
+             @brief Writes a JSON representation of each client.
+            */
+            void get_connections(std::vector<std::string> & connections) ;
+
+            /**
+             @brief Suspends the workers before a checkpoint reload.
+            */
+            void preload_checkpoint() ;
+
+            /**
+             @brief Resumes the workers after a checkpoint reload.
+            */
+            void restart() ;
+
+            /**
+             @brief Stops the workers.  The workers close their clients as they exit.
+            */
+            void shutdown() ;
+
+            /**
+             @brief Gets the session whose commands the calling worker is running.
+             @return the session, or NULL if the calling thread is not a worker handling a client
+            */
+            static VariableServerSession * get_current_session() ;
+
+            /**
+             @brief Gets the connection of the session whose commands the calling worker is running.
+            */
+            static ClientConnection * get_current_connection() ;
+
+            /**
+             @brief Sets the client the calling worker is handling.  Called by the workers.
+            */
+            static void set_current_client(VariableServerEventClient * client) ;
+
+        protected:
+            /** The variable server.\n */
+            VariableServer * _vs ;                  /**< trick_io(**) */
+
+            /** True when the event engine is selected.\n */
+            bool _enabled ;                         /**< trick_io(**) */
+
+            /** Number of worker threads.\n */
+            unsigned int _num_workers ;             /**< trick_io(**) */
+
+            /** The worker threads, empty until the engine starts.\n */
+            std::vector < VariableServerEventWorker * > _workers ; /**< trick_io(**) */
+
+        private:
+            VariableServerEventEngine(const VariableServerEventEngine &) ;
+            VariableServerEventEngine & operator=(const VariableServerEventEngine &) ;
+    } ;
+
+}
+
+#endif
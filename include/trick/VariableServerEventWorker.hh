@@ -0,0 +1,149 @@
+/*
+    PURPOSE:
+        (Serves variable server clients for the event engine.)
+*/
+
+#ifndef VARIABLESERVEREVENTWORKER_HH
+#define VARIABLESERVEREVENTWORKER_HH
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "trick/SysThread.hh"
+#include "trick/VariableServerSession.hh"
+#include "trick/VariableServerEventConnection.hh"
+
+namespace Trick {
+
+    class VariableServerEventEngine ;
+
+    /** A client served by a VariableServerEventWorker. */
+    struct VariableServerEventClient {
+
+        /** What woke the worker, the client socket or its cycle timer. */
+        struct Source {
+            VariableServerEventClient * client ;    /**< trick_io(**) */
+            bool timer ;                            /**< trick_io(**) */
+        } ;
+
+        /** Connection to the client.\n */
+        VariableServerEventConnection * connection ; /**< trick_io(**) */
+
+        /** The client's session.\n */
+        VariableServerSession * session ;       /**< trick_io(**) */
+
+        /** Timer firing at the session's update rate.\n */
+        int timer_fd ;                          /**< trick_io(**) */
+
+        /** Period the timer is set to.\n */
+        double timer_period ;                   /**< trick_io(**) */
+
+        /** Pause state of the session before a checkpoint reload.\n */
+        bool saved_pause ;                      /**< trick_io(**) */
+
+        /** True once the client is closed.  The client is deleted after the events in hand are handled.\n */
+        bool closed ;                           /**< trick_io(**) */
+
+        Source socket_source ;                  /**< trick_io(**) */
+        Source timer_source ;                   /**< trick_io(**) */
+    } ;
+
+/**
+  A thread of the VariableServerEventEngine.  The worker waits on the sockets and cycle timers of its clients
+  with epoll and does the work the thread of each client would do.
+    - When a socket is readable, the worker reads everything on it and runs the complete commands
+    - When a socket is writable again, the worker sends the messages the socket did not take
+    - When a cycle timer fires, the worker copies and writes the session as its thread would after sleeping
+ */
+    class VariableServerEventWorker : public Trick::SysThread {
+
+        public:
+            /**
+             @brief Constructor.
+             @param engine - the engine the worker belongs to
+             @param id - number of the worker, used in the thread name
+            */
+            VariableServerEventWorker(VariableServerEventEngine * engine , unsigned int id) ;
+
+            virtual ~VariableServerEventWorker() ;
+
+            /**
+             @brief Creates the epoll instance.  Called before the thread is created.
+             @return 0 on success, -1 on error
+            */
+            int init() ;
+
+            /**
+             @brief Starts serving a client.  Called by listen threads.
+             @param connection - the accepted connection
+             @param session - the client's session, connected to the connection
+             @return 0 on success, -1 if the client could not be added.  The caller still owns the client then.
+            */
+            int add_client(VariableServerEventConnection * connection , VariableServerSession * session) ;
+
+            /**
+             @brief Gets the number of clients the worker serves.
+            */
+            unsigned int get_num_clients() ;
+
+            /**
+             @brief Writes a JSON representation of each client, as the session threads do.
+            */
+            void get_connections(std::vector<std::string> & connections) ;
+
+            /**
+             @brief Pauses the worker and disconnects its sessions from memory before a checkpoint reload.
+            */
+            void preload_checkpoint() ;
+
+            /**
+             @brief Resumes the worker after a checkpoint reload.
+            */
+            void restart() ;
+
+            /**
+             @brief Closes every client.  Called when the thread exits.
+            */
+            void close_all_clients() ;
+
+            /**
+             @brief The worker's event loop.
+            */
+            virtual void * thread_body() ;
+
+        protected:
+            /** Handles events on a client socket. */
+            void handle_socket(VariableServerEventClient * client , unsigned int events) ;
+
+            /** Copies and writes a session when its timer fires. */
+            void handle_timer(VariableServerEventClient * client) ;
+
+            /** Sets the timer to the session's update rate if it changed. */
+            int update_timer(VariableServerEventClient * client) ;
+
+            /** Stops waiting on a client and removes its session from the variable server. */
+            void close_client(VariableServerEventClient * client) ;
+
+            /** Deletes the clients closed while handling events. */
+            void delete_closed_clients() ;
+
+            /** The engine.\n */
+            VariableServerEventEngine * _engine ;   /**< trick_io(**) */
+
+            /** The epoll instance waiting on the clients.\n */
+            int _epoll_fd ;                         /**< trick_io(**) */
+
+            /** Clients of this worker.\n */
+            std::vector < VariableServerEventClient * > _clients ; /**< trick_io(**) */
+
+            /** Clients closed while handling events.\n */
+            std::vector < VariableServerEventClient * > _closed_clients ; /**< trick_io(**) */
+
+            /** Protects the client list, clients are added by the listen threads.\n */
+            pthread_mutex_t _clients_mutex ;        /**< trick_io(**) */
+    } ;
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include "trick/TCPClientListener.hh"
 #include "trick/SysThread.hh"
 #include "trick/MulticastGroup.hh"
+#include "trick/VariableServerEventEngine.hh"
 
 
 namespace Trick {
@@ -56,6 +57,9 @@ namespace Trick {
 
             void set_multicast_group (MulticastGroup * group);
 
+            /** Gives new clients to the event engine when it runs. */
+            void set_event_engine (VariableServerEventEngine * engine);
+
             virtual void dump( std::ostream & oss = std::cout ) ;
 
             void shutdownConnections();
@@ -84,6 +88,9 @@ namespace Trick {
             /* Multicast broadcaster */
             MulticastGroup * _multicast;     /**<  trick_io(**) trick_units(--)  */
 
+            /* Event engine serving clients instead of a thread per client */
+            VariableServerEventEngine * _event_engine;     /**<  trick_io(**) trick_units(--)  */
+
             bool allowConnections;                   /**<  trick_io(**) trick_units(--)  */
             unsigned int pendingConnections;         /**<  trick_io(**) trick_units(--)  */
             pthread_mutex_t connectionMutex;         /**<  trick_io(**) trick_units(--)  */
@@ -0,0 +1,127 @@
+/*
+    PURPOSE:
+        (Bounded queue of the messages a variable server session sends to a slow client.)
+*/
+
+#ifndef VARIABLESERVERSENDQUEUE_HH
+#define VARIABLESERVERSENDQUEUE_HH
+
+#include <deque>
+#include <string>
+#include <pthread.h>
+
+#include "trick/ClientConnection.hh"
+#include "trick/variable_server_sync_types.h"
+
+namespace Trick {
+
+/**
+  Sends a session's messages to its connection without ever waiting on the client.
+
+  Connections are non-blocking.  Whatever the connection does not take is queued in order and sent by flush(),
+  so a client never gets part of a message.  The messages of one cyclic update are a frame.  When the queue
+  holds more than its limit, or under VS_QUEUE_COALESCE when a newer frame is queued, whole frames not yet
+  started are dropped.  Other messages are replies to commands and are never dropped.  Under
+  VS_QUEUE_DISCONNECT the queue fails instead, and the session disconnects the client.
+ */
+    class VariableServerSendQueue {
+
+        public:
+            static const unsigned int DEFAULT_MAX_BYTES = 1048576 ;
+
+            VariableServerSendQueue() ;
+            ~VariableServerSendQueue() ;
+
+            void set_connection(ClientConnection * connection) ;
+
+            /**
+             @brief Sends a message, queueing what the connection does not take.
+             @return the size of the message, 0 if the connection discarded it, or -1 if the connection failed
+            */
+            int write(const std::string& message) ;
+            int write(char * message, int size) ;
+
+            /**
+             @brief Messages written from begin_frame() to end_frame() are one cyclic update.  end_frame() drops
+                    frames as the policy says.
+             @return 0, or -1 if the connection failed
+            */
+            void begin_frame() ;
+            int end_frame() ;
+
+            /**
+             @brief Sends queued messages.
+             @return the number of bytes still queued, or -1 if the connection failed
+            */
+            int flush() ;
+
+            /**
+             @brief Sets the most bytes queued before frames are dropped, 0 for no limit.
+            */
+            void set_max_bytes(unsigned int max_bytes) ;
+            unsigned int get_max_bytes() ;
+
+            void set_policy(VS_QUEUE_POLICY policy) ;
+            VS_QUEUE_POLICY get_policy() ;
+
+            size_t get_queued_bytes() ;
+
+            /** Frames dropped because the queue was full.\n */
+            unsigned long long get_dropped_frames() ;
+
+            /** Frames dropped because a newer frame was queued.\n */
+            unsigned long long get_coalesced_frames() ;
+
+        private:
+            struct Message {
+                std::string bytes ;     /**< trick_io(**) */
+                unsigned int frame ;    /**< trick_io(**) 0 if not part of a frame */
+                bool started ;          /**< trick_io(**) part of it was sent */
+            } ;
+
+            /** Queues what the connection did not take of a message.  Called with the queue locked. */
+            int queue_unsent(const char * message, int size, int sent) ;
+
+            void push(const char * message, int size, bool started) ;
+
+            /** Sends from the front of the queue.  Called with the queue locked. */
+            int send_queued() ;
+
+            /** Drops the oldest frame that may be dropped.  Called with the queue locked. */
+            bool drop_oldest_frame(unsigned int keep_frame = 0) ;
+
+            /** Applies the policy when the queue is over its limit.  Called with the queue locked. */
+            int check_limit() ;
+
+            bool over_limit() const ;
+
+            /** The connection to the client.\n */
+            ClientConnection * _connection ;    /**< trick_io(**) */
+
+            /** Messages the connection has not taken yet, in order.\n */
+            std::deque<Message> _queued ;       /**< trick_io(**) */
+            size_t _queued_bytes ;              /**< trick_io(**) */
+
+            /** Frame being written, 0 between frames.\n */
+            unsigned int _frame ;               /**< trick_io(**) */
+            unsigned int _last_frame ;          /**< trick_io(**) */
+
+            unsigned int _max_bytes ;           /**< trick_io(**) */
+            VS_QUEUE_POLICY _policy ;           /**< trick_io(**) */
+
+            /** Set when the connection failed or was over its limit under VS_QUEUE_DISCONNECT.\n */
+            bool _failed ;                      /**< trick_io(**) */
+
+            unsigned long long _dropped_frames ;    /**< trick_io(**) */
+            unsigned long long _coalesced_frames ;  /**< trick_io(**) */
+
+            /** Protects the queue, sessions may write from the main thread.\n */
+            pthread_mutex_t _queue_mutex ;      /**< trick_io(**) */
+
+            VariableServerSendQueue(const VariableServerSendQueue &) ;
+            VariableServerSendQueue & operator=(const VariableServerSendQueue &) ;
+    } ;
+
+}
+
+#endif
@@ -9,6 +9,8 @@ PURPOSE: (Represent the state of a variable server connection.)
 #include <string>
 
 #include "trick/VariableReference.hh"
+#include "trick/VariableServerSnapshot.hh"
+#include "trick/VariableServerSendQueue.hh"
 #include "trick/ClientConnection.hh"
 #include "trick/variable_server_sync_types.h"
 #include "trick/tc.h"
@@ -76,6 +78,20 @@ namespace Trick {
         // Called from VariableServerSessionThread
         virtual int copy_and_write_async();
 
+        /**
+         @brief Sends what the connection did not take earlier.  Called from VariableServerSessionThread.
+         @return the number of bytes still queued, or -1 if the connection failed or overflowed its queue under
+            VS_QUEUE_DISCONNECT
+        */
+        virtual int flush_send_queue();
+
+        /**
+         @brief Sets the snapshot shared with the other sessions.  Variables read straight from a fixed address
+            are registered with it, and copies made during the variable server's copy jobs take their values
+            from the snapshot's frame.
+        */
+        virtual void set_snapshot(VariableServerSnapshot * snapshot);
+
         /**
          @brief Copy given variable values from Trick memory to each variable's output buffer.
             cyclical indicated whether it is a normal cyclical copy or a send_once copy
@@ -342,6 +358,68 @@ namespace Trick {
         */
         virtual int var_byteswap(bool on_off) ;
 
+        /**
+         @brief @userdesc Command to set the largest message the variable server sends to this client
+            (default is 8192 bytes).  Returned values that do not fit in one message are split into several
+            messages.  Raise the size to receive large arrays in one message.  UDP clients may not raise it
+            past the largest datagram.
+            @par Python Usage:
+            @code trick.var_set_max_message_size(<size>) @endcode
+            @param size - largest message in bytes
+            @return 0 on success, -1 if the size is too small to hold a message header or too large for a
+                    UDP datagram
+        */
+        virtual int var_set_max_message_size(int size) ;
+
+        /**
+         @brief @userdesc Command to send only the variables whose values changed since they were last sent
+            (only has an effect in var_binary mode).  Cyclic updates are sent as VS_VAR_LIST_CHANGES messages, where
+            each variable is preceded by its index in the list of variables added.  No message is sent when
+            nothing changed.  A full VS_VAR_LIST message is sent when the mode is turned on, when the list of
+            variables changes, on var_send, and every var_set_keyframe_interval() updates.
+            @par Python Usage:
+            @code trick.var_send_on_change(<on_off>) @endcode
+            @param on_off - true to send only changes, false (default) to send every variable every cycle
+            @return always 0
+        */
+        virtual int var_send_on_change(bool on_off) ;
+
+        /**
+         @brief @userdesc Command to set how often a full message is sent in send on change mode
+            (default is every 100 updates).
+            @par Python Usage:
+            @code trick.var_set_keyframe_interval(<cycles>) @endcode
+            @param cycles - number of updates from one full message to the next, or 0 to send a full message only
+            when required
+            @return 0 on success, -1 if cycles is negative
+        */
+        virtual int var_set_keyframe_interval(int cycles) ;
+
+        /**
+         @brief @userdesc Command to set the most bytes queued for a client that does not keep up
+            (default is 1048576).  Messages the client's connection will not take are queued so the simulation
+            never waits on a slow client.  When the queue holds more than this, var_set_send_queue_policy() says
+            what happens.  Replies to commands are never dropped.
+            @par Python Usage:
+            @code trick.var_set_send_queue_size(<bytes>) @endcode
+            @param bytes - most bytes queued, or 0 for no limit
+            @return 0 on success, -1 if bytes is negative
+        */
+        virtual int var_set_send_queue_size(int bytes) ;
+
+        /**
+         @brief @userdesc Command to set what happens to cyclic updates queued for a client that does not keep up.
+            VS_QUEUE_DROP_OLDEST (0) drops the oldest updates when the queue is full.  VS_QUEUE_COALESCE (1, the
+            default) also drops every waiting update when a newer one is queued, so the client only gets the
+            latest values.  VS_QUEUE_DISCONNECT (2) disconnects the client when the queue is full.
+            In send on change mode a full message follows any dropped update.
+            @par Python Usage:
+            @code trick.var_set_send_queue_policy(<policy>) @endcode
+            @param policy - VS_QUEUE_DROP_OLDEST, VS_QUEUE_COALESCE or VS_QUEUE_DISCONNECT
+            @return 0 on success, -1 if policy is not one of these
+        */
+        virtual int var_set_send_queue_policy(int policy) ;
+
         /**
          @brief @userdesc Command to toggle variable server logged messages to a playback file.
             All messages received from all clients will be saved to file named "playback" in the RUN directory.
@@ -373,6 +451,20 @@ namespace Trick {
         */
         virtual int send_list_size();
 
+        /**
+         @brief Command to send the multicast address and port of a published channel, in reply to var_join_channel.
+            The variable server sends a message indicator of "8", followed by the address and port.
+         @param address - the multicast address, empty if there is no such channel
+         @param port - the port, 0 if there is no such channel
+        */
+        virtual int send_channel_info(std::string address, int port);
+
+        /**
+         @brief Makes the cyclic updates of this session VS_CHANNEL_LIST messages numbered in sequence, for
+            published channels.
+        */
+        void set_sequenced(bool on_off) ;
+
         /**
          @brief Special command to instruct the variable server to send the contents of the S_sie.resource file; used by TV.
             The variable server sends a message indicator of "2", followed by a tab, followed by the file contents
@@ -431,13 +523,42 @@ namespace Trick {
         virtual int transmit_file(std::string sie_file);
 
         // Helper methods to write out formatted data
-        virtual int write_binary_data(const std::vector<VariableReference *>& given_vars, VS_MESSAGE_TYPE message_type);
+        virtual int write_binary_data(const std::vector<VariableReference *>& given_vars, VS_MESSAGE_TYPE message_type,
+                                      const std::vector<int> * indices = NULL);
+        int write_binary_message(VS_MESSAGE_TYPE message_type, int message_size, int num_vars);
+        // Writes an int of a binary message, byteswapped if the client asked, and returns where the next field goes
+        static char * write_binary_int(char * out, int value, bool byteswap);
+        bool fits_in_message(int size) const;
         virtual int write_ascii_data(const std::vector<VariableReference *>& given_vars, VS_MESSAGE_TYPE message_type );
 
         virtual VariableReference * find_session_variable(std::string name) const;
 
+        // Copy the variables the snapshot does not share and hold the snapshot frame for the rest
+        int copy_snapshot_data();
+
+        // Register a new session variable with the snapshot
+        void add_snapshot_slot(VariableReference * variable);
+
+        // Release the snapshot slots and frame of the session variables
+        void clear_snapshot_slots();
+
+        // Rebuild the list of variables the snapshot does not share
+        void update_unshared_variables();
+
         std::vector<VariableReference *> _session_variables; /**<  trick_io(**) */
 
+        /** Shared snapshot, NULL when the session copies all of its variables.\n */
+        VariableServerSnapshot * _snapshot;  /**<  trick_io(**) */
+
+        /** Snapshot slot of each session variable, in _session_variables order.\n */
+        std::vector<VariableServerSnapshot::Slot> _snapshot_slots; /**<  trick_io(**) */
+
+        /** Session variables copied by the session itself.\n */
+        std::vector<VariableReference *> _unshared_variables; /**<  trick_io(**) */
+
+        /** Snapshot frame holding the values of the shared variables not yet written.\n */
+        VariableServerSnapshot::Frame * _frame; /**<  trick_io(**) */
+
         // Getters and setters for internal variables
         virtual long long get_cycle_tics() const; 
 
@@ -502,6 +623,37 @@ namespace Trick {
         /** Toggle to tell variable server return data in binary format without the variable names.\n */
         bool _binary_data_nonames ;       /**<  trick_io(**) */
 
+        /** Largest message sent to the client in bytes, 0 for no limit.\n */
+        int _max_message_size ;           /**<  trick_io(**) */
+
+        /** Toggle to send only the variables that changed since they were last sent.\n */
+        bool _send_on_change ;            /**<  trick_io(**) */
+
+        /** Number of updates from one full message to the next in send on change mode, 0 for none.\n */
+        int _keyframe_interval ;          /**<  trick_io(**) */
+
+        /** Updates left before the next full message, 0 to send a full message next.  Protected by _copy_mutex.\n */
+        int _cycles_to_keyframe ;         /**<  trick_io(**) */
+
+        /** Toggle to send cyclic updates as VS_CHANNEL_LIST messages numbered in sequence.\n */
+        bool _sequenced ;                 /**<  trick_io(**) */
+
+        /** Sequence number of the next VS_CHANNEL_LIST message.\n */
+        unsigned int _sequence ;          /**<  trick_io(**) */
+
+        /** Changed session variables and their indexes, kept to avoid allocating on every update.\n */
+        std::vector<VariableReference *> _changed_variables ; /**<  trick_io(**) */
+        std::vector<int> _changed_indices ; /**<  trick_io(**) */
+
+        /** Queues what the connection does not take, and drops cyclic updates a slow client cannot keep up with.\n */
+        VariableServerSendQueue _send_queue ; /**<  trick_io(**) */
+
+        /** Cyclic updates the send queue had dropped when the last update was written.  Protected by _copy_mutex.\n */
+        unsigned long long _lost_frames ; /**<  trick_io(**) */
+
+        /** Binary messages are built here.  Kept between messages so it is only allocated as it grows.\n */
+        std::vector<char> _message_buffer ; /**<  trick_io(**) */
+
         /** Value (1,2,or 3) that causes the variable server to output increasing amounts of debug information.\n */
         int _debug ;                      /**<  trick_io(**) */
 
@@ -59,6 +59,12 @@ namespace Trick {
             */
             void set_connection(ClientConnection * in_connection);
 
+            /**
+             @brief Sets whether the thread reads and executes commands from the connection (default true).  A
+                    thread that only publishes, like a channel's, never reads what arrives on its socket.
+            */
+            void set_read_commands(bool on_off);
+
             /**
              @brief Block until thread has accepted connection
             */
@@ -79,6 +85,17 @@ namespace Trick {
             void cleanup();
 
         protected:
+            /**
+             @brief Sets up the session with the variable server's log settings and gives it the connection.
+            */
+            void start_session() ;
+
+            /**
+             @brief Starts a new session for the next client of a shared memory connection once its client is gone.
+             @return false if the connection ends with its session
+            */
+            bool next_client() ;
+
             /** The Master variable server object. */
             static VariableServer * _vs ;
 
@@ -96,6 +113,9 @@ namespace Trick {
             pthread_cond_t _connection_status_cv;         /**<  trick_io(**) */
 
             bool _saved_pause_cmd;
+
+            /** Toggle to read and execute commands from the connection.\n */
+            bool _read_commands ;               /**<  trick_io(**) */
     } ;
 
     std::ostream& operator<< (std::ostream& s, VariableServerSessionThread& vst);
@@ -0,0 +1,180 @@
+/*
+    PURPOSE:
+        (Values shared by all variable server sessions copying in the main thread.)
+*/
+
+#ifndef VARIABLESERVERSNAPSHOT_HH
+#define VARIABLESERVERSNAPSHOT_HH
+
+#include <atomic>
+#include <map>
+#include <vector>
+#include <pthread.h>
+
+namespace Trick {
+
+/**
+  The VariableServerSnapshot copies the values requested by variable server sessions from the simulation once per
+  copy job, however many sessions requested them.
+
+  Sessions register each variable that is read straight from a fixed address.  Variables registered by several
+  sessions share one value.  When a copy job finds a session due, the first session asks for a frame, a free
+  frame becomes the next version of the snapshot.  Each session due in the job copies its values into that frame,
+  skipping the values an earlier session of the job already copied, so a job copies the union of the values of the
+  sessions due and nothing else.  A session holds the frame until it writes, copying its values out of the frame on
+  its own thread.  Values are only added to a frame, never changed, while it is held.  Frames are reused once no
+  session holds them, so the main thread never waits on a session.
+ */
+    class VariableServerSnapshot {
+
+        public:
+
+            /** A version of the snapshot.  Values are only added to it while it is held. */
+            struct Frame {
+                /** The values, at the offsets of their slots.\n */
+                char * values ;                 /**< trick_io(**) */
+
+                /** Size of values.\n */
+                size_t capacity ;               /**< trick_io(**) */
+
+                /** Snapshot version copied into the frame.\n */
+                unsigned long long version ;    /**< trick_io(**) */
+
+                /** Number of holders.  The frame is free at 0.\n */
+                unsigned int refs ;             /**< trick_io(**) */
+            } ;
+
+            /** A registered value, as seen by a session. */
+            struct Slot {
+                /** Slot id, -1 if the variable is not shared.\n */
+                int id ;                        /**< trick_io(**) */
+
+                /** Offset of the value in a frame.\n */
+                size_t offset ;                 /**< trick_io(**) */
+
+                /** Snapshot version when the value was registered.  Later frames hold it.\n */
+                unsigned long long version ;    /**< trick_io(**) */
+            } ;
+
+            VariableServerSnapshot() ;
+            ~VariableServerSnapshot() ;
+
+            /**
+             @brief Registers a value to copy.  A value already registered at the same address and size is shared.
+             @param address - address of the value
+             @param size - size of the value
+             @return the slot of the value
+            */
+            Slot add_value( void * address , int size ) ;
+
+            /**
+             @brief Releases a value registered with add_value.  The value is no longer copied once no session
+             has it registered.
+             @param slot - the slot returned by add_value
+            */
+            void remove_value( const Slot & slot ) ;
+
+            /**
+             @brief Starts a copy job.  Called by the main thread before it visits the sessions.
+            */
+            void begin_copy() ;
+
+            /**
+             @brief Tests if the calling thread is running a copy job, so sessions may use get_frame.
+            */
+            bool in_copy() ;
+
+            /**
+             @brief Gets the frame of the current copy job, taking a free frame on the first call of the job, and
+             copies the values of @c slots not yet copied into it.  Called by the main thread.
+             @param slots - the caller's slots.  Slots with id -1 are skipped.
+             @return the frame, held for the caller, or NULL if a session is registering values.  Sessions copy
+             their own values when no frame is available.
+            */
+            Frame * get_frame( const std::vector < Slot > & slots ) ;
+
+            /**
+             @brief Ends a copy job and releases the copy job's hold of its frame.
+            */
+            void end_copy() ;
+
+            /**
+             @brief Releases a frame returned by get_frame.  May be called from any thread.
+             @param frame - the frame
+            */
+            static void release( Frame * frame ) ;
+
+            /**
+             @brief Gets the address of a slot's value in a frame.
+             @param frame - a held frame
+             @param slot - the slot
+             @return the address of the value, or NULL if the frame was copied before the value was registered
+            */
+            static const char * value( const Frame * frame , const Slot & slot ) ;
+
+            /**
+             @brief Gets the number of distinct values copied into each frame.
+            */
+            unsigned int get_num_values() ;
+
+            /**
+             @brief Gets the version of the last frame.
+            */
+            unsigned long long get_version() ;
+
+        protected:
+
+            /** A registered value. */
+            struct Value {
+                void * address ;                /**< trick_io(**) */
+                int size ;                      /**< trick_io(**) */
+                size_t offset ;                 /**< trick_io(**) */
+                unsigned int refs ;             /**< trick_io(**) */
+                /** Version of the last frame the value was copied into.\n */
+                unsigned long long copied ;     /**< trick_io(**) */
+            } ;
+
+            /** Finds a free frame and makes it the next version.  Called with the values locked. */
+            Frame * take() ;
+
+            /** Registered values by slot id.  A slot with no references may be reused for a value of its size.\n */
+            std::vector < Value > values ;      /**< trick_io(**) */
+
+            /** Slot ids by address and size.\n */
+            std::map < std::pair < void * , int > , int > slot_ids ; /**< trick_io(**) */
+
+            /** Values registered by at least one session.\n */
+            unsigned int num_values ;           /**< trick_io(**) */
+
+            /** Bytes needed by a frame.\n */
+            size_t frame_bytes ;                /**< trick_io(**) */
+
+            /** Frames ever allocated, free or held.\n */
+            std::vector < Frame * > frames ;    /**< trick_io(**) */
+
+            /** Frame of the current copy job.\n */
+            Frame * current ;                   /**< trick_io(**) */
+
+            /** True when the current copy job already tried to take a frame.\n */
+            bool current_taken ;                /**< trick_io(**) */
+
+            /** True during a copy job.  Read by sessions on their own threads.\n */
+            std::atomic<bool> copying ;         /**< trick_io(**) */
+
+            /** Thread running the copy job.\n */
+            std::atomic<pthread_t> copy_thread ; /**< trick_io(**) */
+
+            /** Version of the last frame.\n */
+            unsigned long long version ;        /**< trick_io(**) */
+
+            /** Protects the registered values.  The main thread only tries the lock.\n */
+            pthread_mutex_t values_mutex ;      /**< trick_io(**) */
+
+        private:
+            VariableServerSnapshot(const VariableServerSnapshot &) ;
+            VariableServerSnapshot & operator=(const VariableServerSnapshot &) ;
+    } ;
+
+}
+
+#endif
@@ -14,6 +14,8 @@ int dr_disable(void) ;
 int dr_enable_group( const char * in_name ) ;
 int dr_disable_group( const char * in_name ) ;
 int dr_record_now_group( const char * in_name ) ;
+int dr_trigger(void) ;
+int dr_trigger_group( const char * in_name ) ;
 int dr_set_max_file_size ( uint64_t bytes ) ;
 void remove_all_data_record_groups(void) ;
 int set_max_size_record_group (const char * in_name, uint64_t bytes ) ;
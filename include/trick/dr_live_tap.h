@@ -0,0 +1,72 @@
+/*
+PURPOSE:
+    (Layout of the shared memory live tap of a data record group, shared with external readers.)
+ICG: (No)
+*/
+
+#ifndef DR_LIVE_TAP_H
+#define DR_LIVE_TAP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define DR_LIVE_TAP_KEYWORD "TrickTap"
+#define DR_LIVE_TAP_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A live tap segment starts with this header.  The variable descriptors follow it, in the format of a
+ * DRBinary header entry: the name length and name, the units length and units, the Trick type and the
+ * size of each variable.  Rows hold the variables packed in descriptor order, time first.
+ *
+ * The rows are a ring of num_rows slots of slot_bytes each starting at rows_offset.  A slot starts with a
+ * 64 bit sequence number followed by the row.  Row n is written to slot n % num_rows.  The sequence number
+ * is odd while the row is written and 2 * (n + 1) when row n is complete.  All values are in the byte order
+ * of the simulation.
+ */
+typedef struct {
+    char keyword[8] ;           /* -- "TrickTap" */
+    uint32_t version ;          /* -- DR_LIVE_TAP_VERSION */
+    uint32_t num_vars ;         /* -- number of variable descriptors */
+    uint32_t record_bytes ;     /* -- size of a row */
+    uint32_t num_rows ;         /* -- number of row slots */
+    uint32_t slot_bytes ;       /* -- size of a slot, the sequence number and the row padded to 8 bytes */
+    uint32_t rows_offset ;      /* -- offset of the first slot from the start of the segment */
+    uint64_t rows_written ;     /* -- rows published, stored after each row with release semantics */
+    uint64_t open ;             /* -- 1 while the simulation is recording, 0 after it shut down */
+} DRLiveTapHeader ;
+
+/*
+ * Copies row @c row of a live tap segment into @c dest, record_bytes bytes.
+ * Returns 0 if the row was copied, 1 if the row has not been written yet, or -1 if the row was
+ * overwritten before or while it was copied.  A reader that gets -1 has fallen a full ring behind.
+ */
+static inline int dr_live_tap_read_row( const void * segment , uint64_t row , void * dest ) {
+
+    const DRLiveTapHeader * header = (const DRLiveTapHeader *)segment ;
+    const char * slot = (const char *)segment + header->rows_offset + (row % header->num_rows) * header->slot_bytes ;
+    uint64_t expected = 2 * (row + 1) ;
+    uint64_t seq = __atomic_load_n((const uint64_t *)slot, __ATOMIC_ACQUIRE) ;
+
+    if ( seq < expected ) {
+        return 1 ;
+    }
+    if ( seq != expected ) {
+        return -1 ;
+    }
+    memcpy(dest, slot + sizeof(uint64_t), header->record_bytes) ;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE) ;
+    if ( __atomic_load_n((const uint64_t *)slot, __ATOMIC_RELAXED) != expected ) {
+        return -1 ;
+    }
+    return 0 ;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -66,6 +66,7 @@ int   get_size(void *addr) ;
 void* add_var( TRICK_TYPE type, const char* stype, VAR_DECLARE* var_declare, char* units);
 int   add_vars( TRICK_TYPE type, const char* stype, VAR_LIST* var_list, char* units);
 void* follow_address_path(REF2 *R) ;
+void  compile_address_path(REF2 *R) ;
 int   ref_allocate(REF2 *R, int num) ;
 int   ref_assignment(REF2* R, V_TREE* V);
 int   get_truncated_size(void *addr) ;
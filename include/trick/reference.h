@@ -62,6 +62,8 @@ typedef struct {
     ATTRIBUTES* ref_attr;   /**< -- Dynamically allocated reference attribute. */
     int create_add_path ;   /**< ** bool to shortcut to resolve address */
     DLLIST * address_path ; /**< ** shortcut to resolve address */
+    ADDRESS_NODE * compiled_path ; /**< ** address_path as an array with adjacent offsets folded */
+    int compiled_path_size ; /**< ** number of nodes in compiled_path */
 } REF2;
 
 /**
@@ -74,9 +74,10 @@ const static std::map<TRICK_TYPE, unsigned int> type_size_map = {{TRICK_CHARACTE
     
 class Var {
     public:
-        Var () : _has_name(false) {};
+        Var () : _has_name(false), _index(-1) {};
         void setValue(const std::vector<unsigned char>& bytes, size_t size, TRICK_TYPE type, bool byteswap = false);
         void setName(size_t name_size, const std::vector<unsigned char>& name_data);
+        void setIndex(int index);
 
         // The closest to runtime return type polymorphism that I can think of
         // There won't be a general case
@@ -87,6 +88,8 @@ class Var {
         int getArraySize() const;
         std::string getName() const;
         TRICK_TYPE getType() const;
+        // Index of the variable in the var_add list, -1 if the message does not carry indexes
+        int getIndex() const;
 
 
     private:
@@ -96,6 +99,7 @@ class Var {
         bool _has_name;
         unsigned int _name_length;
         std::string _name;
+        int _index;
 
         bool _byteswap;
 
@@ -107,7 +111,7 @@ class Var {
 class ParsedBinaryMessage {
     public:
         ParsedBinaryMessage() : ParsedBinaryMessage(false, false)  {}
-        ParsedBinaryMessage (bool byteswap, bool nonames) : _message_type(0), _message_size(0), _num_vars(0), _byteswap(byteswap), _nonames(nonames) {}
+        ParsedBinaryMessage (bool byteswap, bool nonames) : _message_type(0), _message_size(0), _num_vars(0), _sequence(0), _byteswap(byteswap), _nonames(nonames) {}
 
         void combine (const ParsedBinaryMessage& message);
         
@@ -116,6 +120,8 @@ class ParsedBinaryMessage {
         int getMessageType() const;
         unsigned int getMessageSize() const;
         unsigned int getNumVars() const;
+        // Sequence number of a VS_CHANNEL_LIST message, 0 for other messages
+        unsigned int getSequence() const;
         Var getVariable(const std::string& name);
         Var getVariable(unsigned int index);
 
@@ -127,6 +133,7 @@ class ParsedBinaryMessage {
         int _message_type;
         unsigned int _message_size;
         unsigned int _num_vars;
+        unsigned int _sequence;
 
         bool _byteswap;
         bool _nonames;
@@ -134,8 +141,10 @@ class ParsedBinaryMessage {
         const static size_t header_size;
         const static size_t message_indicator_size;
         const static size_t variable_num_size;
+        const static size_t sequence_size;
         const static size_t message_size_size;
         const static size_t variable_name_length_size;
         const static size_t variable_type_size;
         const static size_t variable_size_size;
+        const static size_t variable_index_size;
 };
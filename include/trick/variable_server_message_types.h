@@ -14,8 +14,11 @@ typedef enum {
     VS_LIST_SIZE = 3 ,
     VS_STDIO = 4,
     VS_SEND_ONCE = 5,
+    VS_VAR_LIST_CHANGES = 6,
+    VS_CHANNEL_LIST = 7,
+    VS_CHANNEL_INFO = 8,
     VS_MIN_CODE = VS_IP_ERROR,
-    VS_MAX_CODE = VS_SEND_ONCE
+    VS_MAX_CODE = VS_CHANNEL_INFO
 } VS_MESSAGE_TYPE ;
 
 #endif
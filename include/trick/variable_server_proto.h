@@ -19,9 +19,19 @@ void var_server_set_user_tag(const char * tag) ;
 int var_server_get_enabled(void) ;
 void var_server_set_enabled(int on_off) ;
 
+int var_server_get_event_engine(void) ;
+void var_server_set_event_engine(int on_off) ;
+void var_server_set_event_workers(unsigned int num) ;
+int var_server_get_native_commands(void) ;
+void var_server_set_native_commands(int on_off) ;
+
 int var_server_create_tcp_socket(const char * address, unsigned short port) ;
 int var_server_create_udp_socket(const char * address, unsigned short port) ;
 int var_server_create_multicast_socket(const char * mcast_address, const char * address, unsigned short port) ;
+int var_server_create_shared_memory(const char * name) ;
+int var_server_create_channel(const char * name, const char * mcast_address, unsigned short port) ;
+int var_server_channel_add(const char * name, const char * var_name, const char * units_name) ;
+int var_server_channel_set_cycle(const char * name, double period) ;
 
 #ifdef __cplusplus
 }
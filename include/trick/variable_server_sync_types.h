@@ -17,5 +17,11 @@ typedef enum {
     VS_WRITE_WHEN_COPIED = 1
 } VS_WRITE_MODE ;
 
+typedef enum {
+    VS_QUEUE_DROP_OLDEST = 0,
+    VS_QUEUE_COALESCE = 1,
+    VS_QUEUE_DISCONNECT = 2
+} VS_QUEUE_POLICY ;
+
 #endif
 
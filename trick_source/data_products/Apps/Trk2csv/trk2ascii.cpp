@@ -2,6 +2,7 @@
 #include <vector>
 #include <iostream>
 #include "Log/TrickBinary.hh"
+#include "Log/TrickCompressed.hh"
 #include <string.h>
 #include <stdlib.h>
 
@@ -10,6 +11,7 @@ static const char *usage_doc[] = {
 " trk2ascii -                                                                ",
 "                                                                            ",
 " USAGE:  trk2ascii <ascii_format [output_file_name]> <trk_file_name> [args] ",
+"         <trk_file_name> may be a .trk or a compressed .trkz file            ",
 " Options:                                                                   ",
 "     -help                Print this message and exit.                      ",
 "     -csv, -ascii         Generates a comma-separated value (CSV) file from ",
@@ -40,6 +42,19 @@ void usage() {
     print_doc((char **)usage_doc,N_USAGE_LINES);
 }
 
+/* Compressed .trkz files are read by TrickCompressed */
+bool is_compressed(char *file_name) {
+    string name(file_name);
+    return ( name.size() > 5 && name.compare(name.size() - 5, 5, ".trkz") == 0 );
+}
+
+DataStream * open_data_stream(char *file_name, char *param_name) {
+    if ( is_compressed(file_name) ) {
+        return new TrickCompressed(file_name, param_name);
+    }
+    return new TrickBinary(file_name, param_name);
+}
+
 int main(int argc, char* argv[])
 {
     double t, y ;
@@ -126,7 +141,10 @@ int main(int argc, char* argv[])
         fp = stdout;
     }
 
-    number_of_parameters = TrickBinaryGetNumVariables(trk_file_name);
+    bool compressed = is_compressed(trk_file_name);
+
+    number_of_parameters = compressed ? TrickCompressedGetNumVariables(trk_file_name) :
+                                        TrickBinaryGetNumVariables(trk_file_name);
 
     if (number_of_parameters == 0) {
         cerr << "No parameters found in the Trk data log file.\n";
@@ -134,13 +152,17 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
 
-    if (( param_names = TrickBinaryGetVariableNames(trk_file_name)) == NULL ) {
+    param_names = compressed ? TrickCompressedGetVariableNames(trk_file_name) :
+                               TrickBinaryGetVariableNames(trk_file_name);
+    if ( param_names == NULL ) {
         cerr << "Unable get parameter names from the Trk data log file.\n";
         cerr.flush();
         exit(EXIT_FAILURE);
     }
 
-    if (( param_units = TrickBinaryGetVariableUnits(trk_file_name)) == NULL ) {
+    param_units = compressed ? TrickCompressedGetVariableUnits(trk_file_name) :
+                               TrickBinaryGetVariableUnits(trk_file_name);
+    if ( param_units == NULL ) {
         cerr << "Unable get parameter units from the Trk data log file.\n";
         cerr.flush();
         exit(EXIT_FAILURE);
@@ -165,7 +187,7 @@ int main(int argc, char* argv[])
             fprintf(fp,"%4s<Columns>\n", "");
             for ( i=0; i<number_of_parameters; i++ ) {
                 fprintf(fp, "%8s<Column name=\"%s\" units=\"%s\" />\n", "", param_names[i], param_units[i]);
-                if (( each_ds = new TrickBinary(trk_file_name, param_names[i] )) == NULL) {
+                if (( each_ds = open_data_stream(trk_file_name, param_names[i] )) == NULL) {
                     cerr << ".\n";
                     cerr.flush();
                     exit(EXIT_FAILURE);
@@ -208,7 +230,7 @@ int main(int argc, char* argv[])
                     fprintf(fp,"%s%s {%s}", delimiter.c_str(), param_names[i], param_units[i]);
                 }
 
-                if (( each_ds = new TrickBinary(trk_file_name, param_names[i] )) == NULL) {
+                if (( each_ds = open_data_stream(trk_file_name, param_names[i] )) == NULL) {
                     cerr << ".\n";
                     cerr.flush();
                     exit(EXIT_FAILURE);
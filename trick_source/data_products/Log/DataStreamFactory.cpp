@@ -56,8 +56,33 @@ DataStream* DataStreamFactory::create( const char* iRunDir,
     	return(NULL) ;
     }
 
+    // Groups that rolled over into several file segments.  The segments are
+    // chained together in the order listed in the log_<group>.segments manifest.
+    while ((dp = readdir(dirp)) != NULL) {
+        len = strlen(dp->d_name);
+        if ( len > 9 && !strcmp( &(dp->d_name[len - 9]) , ".segments")) {
+            string manifest = runDir + "/" + dp->d_name ;
+            vector<string> paths = TrickSegmentsReadManifest(manifest.c_str()) ;
+            vector<DataStream*> segments ;
+            for ( unsigned int ii = 0 ; ii < paths.size() ; ii++ ) {
+                DataStream* segment = createSegment(paths[ii].c_str(), paramName.c_str(), timeName) ;
+                if ( segment == NULL ) {
+                    // The parameter is not in this group, or a segment is missing
+                    break ;
+                }
+                segments.push_back(segment) ;
+            }
+            if ( ! segments.empty() ) {
+                closedir(dirp) ;
+                stream = new TrickSegments(manifest.c_str(), segments) ;
+                return(stream) ;
+            }
+        }
+    }
+
     // HDF5 (Hierarchical Data Format - h5, hdf5) log files
 #ifdef HDF5
+    rewinddir(dirp) ;
     while ((dp = readdir(dirp)) != NULL) {
         len = strlen(dp->d_name);
         if ( !strcmp( &(dp->d_name[len - 3]) , ".h5")) {
@@ -93,6 +118,42 @@ DataStream* DataStreamFactory::create( const char* iRunDir,
         }
     }
 
+    // Trick binary, compressed
+    rewinddir(dirp) ;
+    while ((dp = readdir(dirp)) != NULL) {
+        len = strlen(dp->d_name);
+        if ( len > 5 && !strcmp( &(dp->d_name[len - 5]) , ".trkz")) {
+            size_t full_path_len = runDir.length() + strlen(dp->d_name) + 2;
+            full_path = (char*) malloc( full_path_len) ;
+            snprintf(full_path, full_path_len, "%s/%s", runDir.c_str(), dp->d_name);
+            if ( TrickCompressedLocateParam((const char*)full_path , paramName.c_str()) ) {
+            	closedir(dirp) ;
+                stream = new TrickCompressed(full_path , (char *)paramName.c_str()) ;
+                free( full_path ) ;
+                return(stream) ;
+            }
+            free( full_path ) ;
+        }
+    }
+
+    // Trick columnar, a directory of column files
+    rewinddir(dirp) ;
+    while ((dp = readdir(dirp)) != NULL) {
+        len = strlen(dp->d_name);
+        if ( len > 4 && !strcmp( &(dp->d_name[len - 4]) , ".col")) {
+            size_t full_path_len = runDir.length() + strlen(dp->d_name) + 2;
+            full_path = (char*) malloc( full_path_len) ;
+            snprintf(full_path, full_path_len, "%s/%s", runDir.c_str(), dp->d_name);
+            if ( TrickColumnarLocateParam((const char*)full_path , paramName.c_str()) ) {
+            	closedir(dirp) ;
+                stream = new TrickColumnar(full_path , (char *)paramName.c_str()) ;
+                free( full_path ) ;
+                return(stream) ;
+            }
+            free( full_path ) ;
+        }
+    }
+
     // CSV Files
     rewinddir(dirp) ;
     while ((dp = readdir(dirp)) != NULL) {
@@ -148,6 +209,39 @@ DataStream* DataStreamFactory::create( const char* iRunDir,
     return stream ;
 }
 
+// Create the data stream of one file segment of a group, chosen by the
+// segment's extension.  Returns NULL if the segment does not hold the parameter.
+DataStream* DataStreamFactory::createSegment( const char* path,
+                                              const char* paramName ,
+                                              const char* timeName )
+{
+    string segment = path ;
+    string::size_type idx = segment.rfind('.') ;
+    string ext = ( idx == string::npos ) ? string("") : segment.substr(idx) ;
+    char* full_path = (char*)segment.c_str() ;
+
+#ifdef HDF5
+    if ( ext == ".h5" && HDF5LocateParam(full_path , paramName) ) {
+        return new TrickHDF5(full_path , (char *)paramName , (char *)timeName ) ;
+    }
+#endif
+    if ( ext == ".trk" && TrickBinaryLocateParam(full_path , paramName) ) {
+        return new TrickBinary(full_path , (char *)paramName) ;
+    }
+    if ( ext == ".trkz" && TrickCompressedLocateParam(full_path , paramName) ) {
+        return new TrickCompressed(full_path , (char *)paramName) ;
+    }
+    if ( ext == ".col" && TrickColumnarLocateParam(full_path , paramName) ) {
+        return new TrickColumnar(full_path , (char *)paramName) ;
+    }
+    if ( ext == ".csv" && CsvLocateParam(full_path , (char *)paramName) ) {
+        return new Csv(full_path , (char *)paramName) ;
+    }
+    (void)timeName ;
+
+    return NULL ;
+}
+
 DataStream* DataStreamFactory::create( const char* Machine,
                                        const unsigned short Port ,
                                        const char* VarName )
@@ -189,5 +283,23 @@ int getVariableNames( const char* pathToData,
         return 1 ;
 }
 
+    if ( len > 5 && !strcmp( &pathToData[len - 5] , ".trkz" )) {
+    	*numVariables  = TrickCompressedGetNumVariables(pathToData) ;
+        if ( *numVariables == 0 ) {
+        	return 0 ;
+        }
+        *variableNames = TrickCompressedGetVariableNames(pathToData) ;
+        return 1 ;
+    }
+
+    if ( !strcmp( &pathToData[len - 4] , ".col" )) {
+    	*numVariables  = TrickColumnarGetNumVariables(pathToData) ;
+        if ( *numVariables == 0 ) {
+        	return 0 ;
+        }
+        *variableNames = TrickColumnarGetVariableNames(pathToData) ;
+        return 1 ;
+    }
+
     return(0);
 }
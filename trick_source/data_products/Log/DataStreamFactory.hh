@@ -15,6 +15,9 @@
 //#include "OctaveAscii.hh"
 //#include "OctaveBinary.hh"
 #include "TrickBinary.hh"
+#include "TrickColumnar.hh"
+#include "TrickCompressed.hh"
+#include "TrickSegments.hh"
 //#include "TrickBinary04.hh"
 #include "MatLab.hh"
 #include "MatLab4.hh"
@@ -40,6 +43,10 @@ class DataStreamFactory {
         DataStream* create(const char* machine, const unsigned short port ,
                            const char* paramName );
 
+   private:
+        DataStream* createSegment(const char* path, const char* paramName ,
+                                  const char* timeName );
+
 } ;
 
 #endif
@@ -380,6 +380,7 @@ int TrickBinaryReadByteOrder( FILE* fp ) {
         fread(file_type , file_type_len , 1 , fp ) ;
         file_type[file_type_len] = '\0' ;
 
+        // Compressed files (Trick-Z1) are read by TrickCompressed
         if ( !strncmp( file_type , "Trick-05" , 8 ) ||
              !strncmp( file_type , "Trick-07" , 8 ) ||
              !strncmp( file_type , "Trick-10" , 8) ) {
@@ -407,7 +408,10 @@ int TrickBinaryGetNumVariables(const char* file_name) {
         int swap ;
 
         if ((fp = fopen(file_name , "r")) != 0 ) {
-                swap = TrickBinaryReadByteOrder( fp ) ;
+                if ((swap = TrickBinaryReadByteOrder( fp )) < 0 ) {
+                        fclose(fp) ;
+                        return(0) ;
+                }
                 fread(&num_params , 4 , 1 , fp ) ;
                 if ( swap ) { num_params = trick_byteswap_int(num_params) ; }
         } else {
@@ -435,7 +439,10 @@ char** TrickBinaryGetVariableNames(const char* file_name) {
 
         if ((fp = fopen(file_name , "r")) != 0 ) {
 
-                 swap = TrickBinaryReadByteOrder( fp ) ;
+                 if ((swap = TrickBinaryReadByteOrder( fp )) < 0 ) {
+                         fclose(fp) ;
+                         return(0) ;
+                 }
 
                  // num_params
                  fread(&num_params , 4 , 1 , fp ) ;
@@ -502,7 +509,10 @@ char** TrickBinaryGetVariableUnits(const char* file_name) {
 
         if ((fp = fopen(file_name , "r")) != 0 ) {
 
-                 swap = TrickBinaryReadByteOrder( fp ) ;
+                 if ((swap = TrickBinaryReadByteOrder( fp )) < 0 ) {
+                         fclose(fp) ;
+                         return(0) ;
+                 }
 
                  // num_params
                  fread(&num_params , 4 , 1 , fp ) ;
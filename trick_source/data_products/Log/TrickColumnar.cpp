@@ -0,0 +1,278 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "TrickColumnar.hh"
+#include "TrickBinary.hh"
+#include "trick/parameter_types.h"
+#include "trick_byte_order.h"
+#include "trick_byteswap.h"
+#include "trick/map_trick_units_to_udunits.hh"
+
+// Each column file starts with the "TrickCol" keyword and the number of values
+static const long column_header_size = 16 ;
+
+/*
+ * The index of a column directory is a Trick-10 binary log header.  Find the time and
+ * the requested parameter in it, then open only their two column files.
+ */
+TrickColumnar::TrickColumnar(char * dir_name , char * param_name ) {
+
+        const int file_type_len = 10 ;
+        char file_type[file_type_len + 1] ;
+        int my_byte_order ;
+        int num_params ;
+        int len ;
+        int ii ;
+        int type ;
+        int size ;
+        int param_index = -1 ;
+        long long num_time_values = 0 ;
+        long long num_param_values = 0 ;
+        FILE *fp ;
+
+        fileName_ = dir_name ;
+        time_fp_ = value_fp_ = 0 ;
+        swap_ = 0 ;
+        time_type_ = TRICK_DOUBLE ;
+        time_size_ = 8 ;
+        type_ = TRICK_DOUBLE ;
+        size_ = 8 ;
+        num_values_ = index_ = 0 ;
+
+        std::string index_name = std::string(dir_name) + "/index" ;
+        if ((fp = fopen(index_name.c_str() , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << index_name << "\": " << std::strerror(errno) << std::endl;
+                return ;
+        }
+
+        memset(file_type, 0 , file_type_len + 1 ) ;
+        fread(file_type , file_type_len , 1 , fp ) ;
+        if ( strncmp( file_type , "Trick-10" , 8 ) ) {
+                std::cerr << "ERROR:  \"" << index_name << "\" is not a Trick column index" << std::endl;
+                fclose(fp) ;
+                return ;
+        }
+        TRICK_GET_BYTE_ORDER(my_byte_order) ;
+        switch ( file_type[file_type_len - 1] ) {
+            case 'L':
+                    swap_ = ( my_byte_order == TRICK_LITTLE_ENDIAN ) ? 0 : 1 ;
+                    break ;
+            case 'B':
+                    swap_ = ( my_byte_order == TRICK_BIG_ENDIAN ) ? 0 : 1 ;
+                    break ;
+        }
+
+        fread(&num_params , 4 , 1 , fp ) ;
+        if ( swap_ ) { num_params = trick_byteswap_int(num_params) ; }
+
+        for ( ii = 0  ; ii < num_params ; ii++ ) {
+
+                // name
+                fread(&len , 4 , 1 , fp ) ;
+                if ( swap_ ) { len = trick_byteswap_int(len) ; }
+                std::string name(len, '\0') ;
+                fread(&name[0] , len , 1 , fp ) ;
+
+                // units
+                fread(&len , 4 , 1 , fp ) ;
+                if ( swap_ ) { len = trick_byteswap_int(len) ; }
+                std::string units(len, '\0') ;
+                fread(&units[0] , len , 1 , fp ) ;
+
+                // type and size
+                fread(&type , 4 , 1 , fp ) ;
+                if ( swap_ ) { type = trick_byteswap_int(type) ; }
+                fread(&size , 4 , 1 , fp ) ;
+                if ( swap_ ) { size = trick_byteswap_int(size) ; }
+
+                if ( ii == 0 ) {
+                        time_type_ = type ;
+                        time_size_ = size ;
+                        unitTimeStr_ = units ;
+                }
+                if ( param_index == -1 and name == param_name ) {
+                        if ( units == "--" ) {
+                                unitStr_ = units ;
+                        } else {
+                                unitStr_ = map_trick_units_to_udunits(units) ;
+                        }
+                        type_ = type ;
+                        size_ = size ;
+                        param_index = ii ;
+                }
+        }
+        fclose(fp) ;
+
+        if ( param_index == -1 or size_ > (int)sizeof(value_) or time_size_ > (int)sizeof(value_) ) {
+                std::cerr << "ERROR:  Couldn't find \"" << param_name << "\" in \"" << dir_name << "\"" << std::endl;
+                return ;
+        }
+
+        time_fp_ = openColumn( dir_name , 0 , &num_time_values ) ;
+        value_fp_ = openColumn( dir_name , param_index , &num_param_values ) ;
+
+        // The columns of a running simulation may be one write cycle apart
+        num_values_ = ( num_time_values < num_param_values ) ? num_time_values : num_param_values ;
+}
+
+TrickColumnar::~TrickColumnar()
+{
+        if ( time_fp_ ) {
+                fclose(time_fp_);
+        }
+        if ( value_fp_ ) {
+                fclose(value_fp_);
+        }
+}
+
+/*
+ * Open column file col_<column> and read the number of values it holds.  The file is
+ * left positioned at the first value.
+ */
+FILE * TrickColumnar::openColumn( const char * dir_name , int column , long long * num_values ) {
+
+        char key[8] ;
+        char full_path[4096] ;
+        FILE * fp ;
+
+        *num_values = 0 ;
+        snprintf(full_path, sizeof(full_path), "%s/col_%d", dir_name, column) ;
+        if ((fp = fopen(full_path , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << full_path << "\": " << std::strerror(errno) << std::endl;
+                return 0 ;
+        }
+        if ( fread(key, sizeof(key), 1, fp) != 1 or strncmp(key, "TrickCol", sizeof(key)) or
+             fread(num_values, sizeof(*num_values), 1, fp) != 1 ) {
+                std::cerr << "ERROR:  \"" << full_path << "\" is not a Trick column file" << std::endl;
+                fclose(fp) ;
+                *num_values = 0 ;
+                return 0 ;
+        }
+        if ( swap_ ) { *num_values = trick_byteswap_long_long(*num_values) ; }
+
+        return fp ;
+}
+
+double TrickColumnar::toDouble( char * value , int type , int size ) {
+
+        switch ( type ) {
+                case TRICK_FLOAT:
+                        {
+                                float f ;
+                                memcpy(&f, value, sizeof(f)) ;
+                                return swap_ ? trick_byteswap_float(f) : f ;
+                        }
+                case TRICK_DOUBLE:
+                        {
+                                double d ;
+                                memcpy(&d, value, sizeof(d)) ;
+                                return swap_ ? trick_byteswap_double(d) : d ;
+                        }
+                case TRICK_UNSIGNED_CHARACTER:
+                case TRICK_UNSIGNED_SHORT:
+                case TRICK_UNSIGNED_INTEGER:
+                case TRICK_UNSIGNED_LONG:
+                case TRICK_UNSIGNED_LONG_LONG:
+                case TRICK_UNSIGNED_BITFIELD:
+                case TRICK_BOOLEAN:
+                        switch ( size ) {
+                                case 1 : { unsigned char v ; memcpy(&v, value, 1) ; return (double)v ; }
+                                case 2 : { short v ; memcpy(&v, value, 2) ; return (double)(unsigned short)(swap_ ? trick_byteswap_short(v) : v) ; }
+                                case 4 : { int v ; memcpy(&v, value, 4) ; return (double)(unsigned int)(swap_ ? trick_byteswap_int(v) : v) ; }
+                                case 8 : { long long v ; memcpy(&v, value, 8) ; return (double)(unsigned long long)(swap_ ? trick_byteswap_long_long(v) : v) ; }
+                        }
+                        break ;
+                default:
+                        switch ( size ) {
+                                case 1 : { signed char v ; memcpy(&v, value, 1) ; return (double)v ; }
+                                case 2 : { short v ; memcpy(&v, value, 2) ; return (double)(swap_ ? trick_byteswap_short(v) : v) ; }
+                                case 4 : { int v ; memcpy(&v, value, 4) ; return (double)(swap_ ? trick_byteswap_int(v) : v) ; }
+                                case 8 : { long long v ; memcpy(&v, value, 8) ; return (double)(swap_ ? trick_byteswap_long_long(v) : v) ; }
+                        }
+                        break ;
+        }
+        return 0.0 ;
+}
+
+int TrickColumnar::get( double * time , double * value ) {
+
+        char time_value[16] ;
+
+        if ( time_fp_ == 0 or value_fp_ == 0 or index_ >= num_values_ ) {
+                return(0) ;
+        }
+        if ( fread(time_value , time_size_ , 1 , time_fp_ ) != 1 or
+             fread(value_ , size_ , 1 , value_fp_ ) != 1 ) {
+                return(0) ;
+        }
+        index_++ ;
+
+        *time = toDouble( time_value , time_type_ , time_size_ ) ;
+        *value = toDouble( value_ , type_ , size_ ) ;
+
+        return(1) ;
+}
+
+int TrickColumnar::peek( double * time , double * value ) {
+
+        int ret ;
+
+        ret = get( time , value ) ;
+        if ( ret ) {
+                index_-- ;
+                fseek(time_fp_ , -(long)time_size_ , SEEK_CUR ) ;
+                fseek(value_fp_ , -(long)size_ , SEEK_CUR ) ;
+        }
+
+        return(ret) ;
+}
+
+void TrickColumnar::begin() {
+        index_ = 0 ;
+        if ( time_fp_ ) {
+                fseek(time_fp_, column_header_size , SEEK_SET) ;
+        }
+        if ( value_fp_ ) {
+                fseek(value_fp_, column_header_size , SEEK_SET) ;
+        }
+        return ;
+}
+
+int TrickColumnar::end() {
+        return ( index_ >= num_values_ ) ;
+}
+
+int TrickColumnar::step() {
+
+        if ( index_ >= num_values_ ) {
+                return(0) ;
+        }
+        index_++ ;
+        fseek(time_fp_ , time_size_ , SEEK_CUR ) ;
+        fseek(value_fp_ , size_ , SEEK_CUR ) ;
+
+        return(1) ;
+}
+
+int TrickColumnarGetNumVariables(const char* dir_name) {
+        std::string index_name = std::string(dir_name) + "/index" ;
+        return TrickBinaryGetNumVariables(index_name.c_str()) ;
+}
+
+char** TrickColumnarGetVariableNames(const char* dir_name) {
+        std::string index_name = std::string(dir_name) + "/index" ;
+        return TrickBinaryGetVariableNames(index_name.c_str()) ;
+}
+
+int TrickColumnarLocateParam( const char * dir_name , const char * param_name ) {
+        std::string index_name = std::string(dir_name) + "/index" ;
+        if ( access(index_name.c_str(), R_OK) ) {
+                return 0 ;
+        }
+        return TrickBinaryLocateParam(index_name.c_str() , param_name) ;
+}
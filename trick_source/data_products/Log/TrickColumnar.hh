@@ -0,0 +1,45 @@
+
+#ifndef TRICKCOLUMNAR_HH
+#define TRICKCOLUMNAR_HH
+
+#include <stdio.h>
+#include "DataStream.hh"
+
+/*
+ * Reads one parameter from a log_<group>.col directory written by a DRColumnar recording group.
+ * Only the time column and the parameter's column are read.
+ */
+class TrickColumnar : public DataStream {
+
+       public:
+               TrickColumnar(char * dir, char * param ) ;
+               ~TrickColumnar() ;
+
+               int get(double * time , double * value ) ;
+               int peek(double * time , double * value ) ;
+
+               void begin() ;
+               int end() ;
+               int step() ;
+
+       private:
+               FILE *time_fp_ ;
+               FILE *value_fp_ ;
+               int swap_ ;
+               int time_type_ ;
+               int time_size_ ;
+               int type_ ;
+               int size_ ;
+               long long num_values_ ;
+               long long index_ ;
+               char value_[16] ;
+
+               FILE * openColumn( const char * dir , int column , long long * num_values ) ;
+               double toDouble( char * value , int type , int size ) ;
+} ;
+
+int TrickColumnarLocateParam( const char * dir_name , const char * param_name ) ;
+char** TrickColumnarGetVariableNames(const char* dir_name) ;
+int    TrickColumnarGetNumVariables(const char* dir_name) ;
+
+#endif
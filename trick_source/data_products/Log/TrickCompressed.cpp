@@ -0,0 +1,349 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <stdlib.h>
+#include <string.h>
+#include "TrickCompressed.hh"
+#include "trick/parameter_types.h"
+#include "trick/DRCompression.hh"
+#include "trick_byte_order.h"
+#include "trick_byteswap.h"
+#include "trick/map_trick_units_to_udunits.hh"
+
+/*
+ * The header of a compressed file is a Trick-10 binary log header with the keyword Trick-Z1.
+ * Remember where the time and the requested parameter are in each block.
+ */
+TrickCompressed::TrickCompressed(char * file_name , char * param_name ) {
+
+        int len ;
+        int ii ;
+        int type ;
+        int size ;
+
+        fileName_ = file_name ;
+        swap_ = 0 ;
+        num_params_ = 0 ;
+        param_index_ = -1 ;
+        time_type_ = TRICK_DOUBLE ;
+        time_size_ = 8 ;
+        type_ = TRICK_DOUBLE ;
+        size_ = 8 ;
+        data_offset_ = 0 ;
+        block_records_ = block_index_ = 0 ;
+
+        if ((fp_ = fopen(file_name , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << file_name << "\": " << std::strerror(errno) << std::endl;
+                return ;
+        }
+
+        if ((swap_ = TrickCompressedReadByteOrder( fp_ )) < 0 ) {
+                std::cerr << "ERROR:  \"" << file_name << "\" is not a compressed Trick log file" << std::endl;
+                fclose(fp_) ;
+                fp_ = 0 ;
+                swap_ = 0 ;
+                return ;
+        }
+
+        fread(&num_params_ , 4 , 1 , fp_ ) ;
+        if ( swap_ ) { num_params_ = trick_byteswap_int(num_params_) ; }
+
+        for ( ii = 0  ; ii < num_params_ ; ii++ ) {
+
+                // name
+                fread(&len , 4 , 1 , fp_ ) ;
+                if ( swap_ ) { len = trick_byteswap_int(len) ; }
+                std::string name(len, '\0') ;
+                fread(&name[0] , len , 1 , fp_ ) ;
+
+                // units
+                fread(&len , 4 , 1 , fp_ ) ;
+                if ( swap_ ) { len = trick_byteswap_int(len) ; }
+                std::string units(len, '\0') ;
+                fread(&units[0] , len , 1 , fp_ ) ;
+
+                // type and size
+                fread(&type , 4 , 1 , fp_ ) ;
+                if ( swap_ ) { type = trick_byteswap_int(type) ; }
+                fread(&size , 4 , 1 , fp_ ) ;
+                if ( swap_ ) { size = trick_byteswap_int(size) ; }
+
+                if ( ii == 0 ) {
+                        time_type_ = type ;
+                        time_size_ = size ;
+                        unitTimeStr_ = units ;
+                }
+                if ( param_index_ == -1 and name == param_name ) {
+                        if ( units == "--" ) {
+                                unitStr_ = units ;
+                        } else {
+                                unitStr_ = map_trick_units_to_udunits(units) ;
+                        }
+                        type_ = type ;
+                        size_ = size ;
+                        param_index_ = ii ;
+                }
+        }
+        data_offset_ = ftell(fp_) ;
+
+        if ( param_index_ == -1 ) {
+                std::cerr << "ERROR:  Couldn't find \"" << param_name << "\" in \"" << file_name << "\"" << std::endl;
+        }
+}
+
+TrickCompressed::~TrickCompressed()
+{
+        if ( fp_ ) {
+                fclose(fp_);
+        }
+}
+
+/*
+ * Read and decode one column of the current block into out.
+ */
+int TrickCompressed::decodeColumn( long offset , unsigned int len , int type , int size , std::vector<uint64_t> & out ) {
+
+        column_.resize(len + 1) ;
+        out.resize(block_records_) ;
+        if ( fseek(fp_ , offset , SEEK_SET) or ( len > 0 and fread(&column_[0] , len , 1 , fp_) != 1 )) {
+                return 0 ;
+        }
+        if ( ! Trick::dr_decode_column(&column_[0] , len , block_records_ , type , size , &out[0]) ) {
+                std::cerr << "ERROR:  Corrupt block in \"" << fileName_ << "\"" << std::endl;
+                return 0 ;
+        }
+        return 1 ;
+}
+
+/*
+ * Read the next block's record count and column lengths, decode the time and parameter
+ * columns, and leave the file at the start of the following block.
+ */
+int TrickCompressed::readBlock() {
+
+        unsigned int num_records ;
+        long columns_offset ;
+        long time_offset = 0 ;
+        long param_offset = 0 ;
+        long next_block ;
+        int ii ;
+
+        block_records_ = block_index_ = 0 ;
+        if ( fp_ == 0 or param_index_ == -1 ) {
+                return 0 ;
+        }
+
+        column_lens_.resize(num_params_) ;
+        if ( fread(&num_records , 4 , 1 , fp_) != 1 or
+             fread(&column_lens_[0] , 4 , num_params_ , fp_) != (size_t)num_params_ ) {
+                return 0 ;
+        }
+        if ( swap_ ) {
+                num_records = trick_byteswap_int(num_records) ;
+                for ( ii = 0 ; ii < num_params_ ; ii++ ) {
+                        column_lens_[ii] = trick_byteswap_int(column_lens_[ii]) ;
+                }
+        }
+
+        columns_offset = ftell(fp_) ;
+        next_block = columns_offset ;
+        for ( ii = 0 ; ii < num_params_ ; ii++ ) {
+                if ( ii == 0 ) {
+                        time_offset = next_block ;
+                }
+                if ( ii == param_index_ ) {
+                        param_offset = next_block ;
+                }
+                next_block += column_lens_[ii] ;
+        }
+
+        block_records_ = num_records ;
+        if ( ! decodeColumn( time_offset , column_lens_[0] , time_type_ , time_size_ , times_ ) or
+             ! decodeColumn( param_offset , column_lens_[param_index_] , type_ , size_ , values_ ) ) {
+                block_records_ = 0 ;
+                return 0 ;
+        }
+        fseek(fp_ , next_block , SEEK_SET) ;
+
+        return 1 ;
+}
+
+int TrickCompressed::get( double * time , double * value ) {
+
+        while ( block_index_ >= block_records_ ) {
+                if ( ! readBlock() ) {
+                        return(0) ;
+                }
+        }
+
+        *time = Trick::dr_compression_to_double( times_[block_index_] , time_type_ , time_size_ ) ;
+        *value = Trick::dr_compression_to_double( values_[block_index_] , type_ , size_ ) ;
+        block_index_++ ;
+
+        return(1) ;
+}
+
+int TrickCompressed::peek( double * time , double * value ) {
+
+        int ret ;
+
+        ret = get( time , value ) ;
+        if ( ret ) {
+                block_index_-- ;
+        }
+
+        return(ret) ;
+}
+
+void TrickCompressed::begin() {
+        block_records_ = block_index_ = 0 ;
+        if ( fp_ ) {
+                fseek(fp_, data_offset_ , SEEK_SET) ;
+        }
+        return ;
+}
+
+int TrickCompressed::end() {
+
+        long offset ;
+        long endOffset ;
+
+        if ( block_index_ < block_records_ ) {
+                return(0) ;
+        }
+        if ( fp_ == 0 ) {
+                return(1) ;
+        }
+
+        offset = ftell(fp_) ;
+        fseek(fp_, 0, SEEK_END) ;
+        endOffset = ftell(fp_) ;
+        fseek(fp_ , offset , SEEK_SET ) ;
+
+        return ( endOffset - offset == 0 ) ;
+}
+
+int TrickCompressed::step() {
+
+        double time ;
+        double value ;
+
+        return get( &time , &value ) ;
+}
+
+int TrickCompressedReadByteOrder( FILE* fp ) {
+
+        const int file_type_len = 10 ;
+        char file_type[file_type_len + 1] ;
+        int my_byte_order ;
+        int swap = 0 ;
+
+        memset(file_type, 0 , file_type_len + 1 ) ;
+        fread(file_type , file_type_len , 1 , fp ) ;
+
+        if ( strncmp( file_type , "Trick-Z1" , 8 ) ) {
+                return -1 ;
+        }
+
+        TRICK_GET_BYTE_ORDER(my_byte_order) ;
+        switch ( file_type[file_type_len - 1] ) {
+            case 'L':
+                    swap = ( my_byte_order == TRICK_LITTLE_ENDIAN ) ? 0 : 1 ;
+                    break ;
+            case 'B':
+                    swap = ( my_byte_order == TRICK_BIG_ENDIAN ) ? 0 : 1 ;
+                    break ;
+        }
+
+        return swap ;
+}
+
+/*
+ * Read the names and units in the header of a compressed file.  Returns 0 if the file is not a compressed log.
+ */
+static int TrickCompressedReadHeader( const char* file_name , std::vector<std::string> & names ,
+ std::vector<std::string> & units ) {
+
+        FILE *fp ;
+        int swap ;
+        int num_params = 0 ;
+        int len ;
+        int type_size[2] ;
+        int ii ;
+
+        if ((fp = fopen(file_name , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << file_name << "\": " << std::strerror(errno) << std::endl;
+                return(0) ;
+        }
+
+        if ((swap = TrickCompressedReadByteOrder( fp )) < 0 ) {
+                fclose(fp) ;
+                return(0) ;
+        }
+
+        fread(&num_params , 4 , 1 , fp ) ;
+        if ( swap ) { num_params = trick_byteswap_int(num_params) ; }
+
+        for ( ii = 0 ; ii < num_params ; ii++ ) {
+                fread(&len , 4 , 1 , fp ) ;
+                if ( swap ) { len = trick_byteswap_int(len) ; }
+                names.push_back(std::string(len, '\0')) ;
+                fread(&names.back()[0] , len , 1 , fp ) ;
+
+                fread(&len , 4 , 1 , fp ) ;
+                if ( swap ) { len = trick_byteswap_int(len) ; }
+                units.push_back(std::string(len, '\0')) ;
+                fread(&units.back()[0] , len , 1 , fp ) ;
+
+                // type and size
+                fread(type_size , 4 , 2 , fp ) ;
+        }
+
+        fclose(fp) ;
+        return num_params ;
+}
+
+static char** TrickCompressedCopyStrings( const std::vector<std::string> & strings ) {
+
+        char ** copy = new char*[strings.size()] ;
+        for ( unsigned int ii = 0 ; ii < strings.size() ; ii++ ) {
+                copy[ii] = new char[strings[ii].size() + 1] ;
+                strcpy(copy[ii], strings[ii].c_str()) ;
+        }
+        return copy ;
+}
+
+int TrickCompressedGetNumVariables(const char* file_name) {
+        std::vector<std::string> names , units ;
+        return TrickCompressedReadHeader( file_name , names , units ) ;
+}
+
+char** TrickCompressedGetVariableNames(const char* file_name) {
+        std::vector<std::string> names , units ;
+        if ( TrickCompressedReadHeader( file_name , names , units ) == 0 ) {
+                return(0) ;
+        }
+        return TrickCompressedCopyStrings(names) ;
+}
+
+char** TrickCompressedGetVariableUnits(const char* file_name) {
+        std::vector<std::string> names , units ;
+        if ( TrickCompressedReadHeader( file_name , names , units ) == 0 ) {
+                return(0) ;
+        }
+        return TrickCompressedCopyStrings(units) ;
+}
+
+int TrickCompressedLocateParam( const char * file_name , const char * param_name ) {
+
+        std::vector<std::string> names , units ;
+        TrickCompressedReadHeader( file_name , names , units ) ;
+        for ( unsigned int ii = 0 ; ii < names.size() ; ii++ ) {
+                if ( names[ii] == param_name ) {
+                        return(1) ;
+                }
+        }
+        return(0) ;
+}
@@ -0,0 +1,55 @@
+
+#ifndef TRICKCOMPRESSED_HH
+#define TRICKCOMPRESSED_HH
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include "DataStream.hh"
+
+/*
+ * Reads one parameter from a compressed log_<group>.trkz file written by a DRBinary group
+ * with compression on.  Only the time column and the parameter's column of each block are decoded.
+ */
+class TrickCompressed : public DataStream {
+
+       public:
+               TrickCompressed(char * file, char * param ) ;
+               ~TrickCompressed() ;
+
+               int get(double * time , double * value ) ;
+               int peek(double * time , double * value ) ;
+
+               void begin() ;
+               int end() ;
+               int step() ;
+
+       private:
+               FILE *fp_ ;
+               int swap_ ;
+               int num_params_ ;
+               int param_index_ ;
+               int time_type_ ;
+               int time_size_ ;
+               int type_ ;
+               int size_ ;
+               long data_offset_ ;
+
+               unsigned int block_records_ ;
+               unsigned int block_index_ ;
+               std::vector<uint64_t> times_ ;
+               std::vector<uint64_t> values_ ;
+               std::vector<unsigned int> column_lens_ ;
+               std::vector<unsigned char> column_ ;
+
+               int readBlock() ;
+               int decodeColumn( long offset , unsigned int len , int type , int size , std::vector<uint64_t> & out ) ;
+} ;
+
+int    TrickCompressedLocateParam( const char * file_name , const char * param_name ) ;
+char** TrickCompressedGetVariableNames(const char* file_name) ;
+int    TrickCompressedGetNumVariables(const char* file_name) ;
+int    TrickCompressedReadByteOrder( FILE* fp ) ;
+char** TrickCompressedGetVariableUnits(const char* file_name) ;
+
+#endif
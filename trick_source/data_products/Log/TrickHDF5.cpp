@@ -9,6 +9,8 @@
 TrickHDF5::TrickHDF5(char *file_name , char *parameter_name , char *time_name) {
 
     packet_index = 0;
+    num_packets = 0;
+    records_layout = false;
 
     hid_t header_group, parameter_names, parameter_units;
     hsize_t header_packet_index;
@@ -70,6 +72,24 @@ TrickHDF5::TrickHDF5(char *file_name , char *parameter_name , char *time_name) {
         H5Gclose(header_group);
     }
 
+    /*!
+     * Files recorded with the compound layout have a single "records" dataset.
+     * Read the time and parameter members of every record as doubles.
+     */
+    if ( H5Lexists( root_group, "records", H5P_DEFAULT ) > 0 ) {
+        hid_t records = H5Dopen2( root_group, "records", H5P_DEFAULT );
+        records_layout = true;
+        if ( records < 0 ||
+             ! HDF5ReadRecordsMember( records, time_name, time_column ) ||
+             ! HDF5ReadRecordsMember( records, parameter_name, parameter_column ) ) {
+            cerr << "ERROR:  Couldn't read \"" << parameter_name
+                 << "\" from the records dataset" << endl;
+            exit(-1);
+        }
+        H5Dclose(records);
+        return;
+    }
+
     /*!
      * Open datasets(D)/packet-tables(PT).
      * "parameter_dataset" is the recorded data for the specified parameter.
@@ -91,6 +111,11 @@ TrickHDF5::TrickHDF5(char *file_name , char *parameter_name , char *time_name) {
 }
 
 TrickHDF5::~TrickHDF5() {
+    if ( records_layout ) {
+        H5Gclose(root_group);
+        H5Fclose(file);
+        return;
+    }
     //! End access to all open packet tables.
     H5PTclose(time_dataset);
     H5PTclose(parameter_dataset);
@@ -104,6 +129,15 @@ int TrickHDF5::get(double *time, double *value) {
 
     int ret;
 
+    if ( records_layout ) {
+        if ( packet_index < num_packets ) {
+            *time = time_column[packet_index];
+            *value = parameter_column[packet_index];
+            return (this->step());
+        }
+        return (0);
+    }
+
     if ( packet_index < num_packets ) {
         /*! Retrieve a param value (plus corresponding time)
          *  from the current packet index position. */
@@ -136,6 +170,11 @@ void TrickHDF5::begin() {
     //! Reset the dataset if another data pass is needed.
     packet_index = 0;
 
+    if ( records_layout ) {
+        num_packets = parameter_column.size();
+        return ;
+    }
+
     /*! See how many packets were logged for this parameter.
      *  Each recorded value is represented by one packet. */
     H5PTget_num_packets( parameter_dataset, &num_packets );
@@ -152,6 +191,11 @@ void TrickHDF5::begin() {
 
 int TrickHDF5::end() {
 
+    if ( records_layout ) {
+        packet_index = num_packets;
+        return (1);
+    }
+
     //! Move packet index to the end of the packet table.
     H5PTset_index( time_dataset, num_packets );
     H5PTset_index( parameter_dataset, num_packets );
@@ -165,6 +209,9 @@ int TrickHDF5::step() {
     if ( packet_index < num_packets ) {
         //! Increment the packet table's index.
         packet_index++;
+        if ( records_layout ) {
+            return (1);
+        }
         /*! Set the packet table's index.  Each packet table keeps an index
          *  of its "current" packet so that get_next can iterate through
          *  the packets in order. */
@@ -179,6 +226,36 @@ int TrickHDF5::step() {
     }
 }
 
+/*!
+ * Reads one member of every record in a "records" dataset into column,
+ * converting the values to doubles.  Returns 1 on success, 0 if the member
+ * does not exist or could not be read.
+ */
+int HDF5ReadRecordsMember( hid_t dataset , const char * member_name , std::vector<double> & column ) {
+
+    hid_t file_type = H5Dget_type(dataset);
+    int found = ( H5Tget_member_index(file_type, member_name) >= 0 );
+    H5Tclose(file_type);
+    if ( ! found ) {
+        return 0;
+    }
+
+    hid_t space = H5Dget_space(dataset);
+    hssize_t num_records = H5Sget_simple_extent_npoints(space);
+    H5Sclose(space);
+    column.resize(num_records);
+    if ( num_records == 0 ) {
+        return 1;
+    }
+
+    //! A compound memory type with only the requested member selects it out of each record.
+    hid_t mem_type = H5Tcreate(H5T_COMPOUND, sizeof(double));
+    H5Tinsert(mem_type, member_name, 0, H5T_NATIVE_DOUBLE);
+    herr_t ret = H5Dread(dataset, mem_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &column[0]);
+    H5Tclose(mem_type);
+
+    return ( ret >= 0 );
+}
 
 int HDF5LocateParam( const char * file_name, const char * parameter_name ) {
 
@@ -196,6 +273,21 @@ int HDF5LocateParam( const char * file_name, const char * parameter_name ) {
         return 0;
     }
 
+    //! Parameters recorded with the compound layout are members of the "records" dataset.
+    if ( H5Lexists(group, "records", H5P_DEFAULT) > 0 ) {
+        hid_t records = H5Dopen2(group, "records", H5P_DEFAULT);
+        int found = 0;
+        if ( records >= 0 ) {
+            hid_t file_type = H5Dget_type(records);
+            found = ( H5Tget_member_index(file_type, parameter_name) >= 0 );
+            H5Tclose(file_type);
+            H5Dclose(records);
+        }
+        H5Gclose(group);
+        H5Fclose(file);
+        return found;
+    }
+
     /*! Open an existing HDF5 packet table.
      * PARAMETERS:
      *     IN: Identifier of the file/group which the packet table can be found.
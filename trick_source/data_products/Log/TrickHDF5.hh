@@ -32,8 +32,14 @@ class TrickHDF5 : public DataStream {
         hsize_t         num_packets;
         hsize_t         packet_index;
 
+        // Files recorded with the DRHDF5_Compound layout store every parameter in the "records" dataset.
+        // The time and parameter members are read into these columns when the stream is opened.
+        bool                records_layout;
+        std::vector<double> time_column, parameter_column;
+
 } ;
 
+int HDF5ReadRecordsMember( hid_t dataset , const char * member_name , std::vector<double> & column ) ;
 int HDF5LocateParam( const char * file_name , const char * param_name ) ;
 int HDF5LocateParam( string file_name , string param_name ) ;
 
@@ -0,0 +1,121 @@
+
+#include <fstream>
+#include "TrickSegments.hh"
+
+TrickSegments::TrickSegments(const char * manifest, std::vector<DataStream *> & segments) :
+ segments_(segments) ,
+ curr_(0) {
+
+        fileName_ = manifest ;
+        if ( ! segments_.empty() ) {
+                unitStr_ = segments_[0]->getUnit() ;
+                unitTimeStr_ = segments_[0]->getTimeUnit() ;
+        }
+        begin() ;
+}
+
+TrickSegments::~TrickSegments() {
+
+        unsigned int ii ;
+
+        for ( ii = 0 ; ii < segments_.size() ; ii++ ) {
+                delete segments_[ii] ;
+        }
+}
+
+/*
+ * Moves to the beginning of the next segment.  Returns 0 if there are no more segments.
+ */
+int TrickSegments::nextSegment() {
+
+        if ( curr_ + 1 >= segments_.size() ) {
+                return(0) ;
+        }
+        curr_++ ;
+        segments_[curr_]->begin() ;
+        return(1) ;
+}
+
+int TrickSegments::get( double * time , double * value ) {
+
+        if ( segments_.empty() ) {
+                return(0) ;
+        }
+        do {
+                if ( segments_[curr_]->get(time, value) ) {
+                        return(1) ;
+                }
+        } while ( nextSegment() ) ;
+
+        return(0) ;
+}
+
+int TrickSegments::peek( double * time , double * value ) {
+
+        if ( segments_.empty() ) {
+                return(0) ;
+        }
+        do {
+                if ( segments_[curr_]->peek(time, value) ) {
+                        return(1) ;
+                }
+        } while ( nextSegment() ) ;
+
+        return(0) ;
+}
+
+void TrickSegments::begin() {
+
+        curr_ = 0 ;
+        if ( ! segments_.empty() ) {
+                segments_[0]->begin() ;
+        }
+}
+
+int TrickSegments::end() {
+
+        if ( segments_.empty() ) {
+                return(1) ;
+        }
+        if ( curr_ + 1 < segments_.size() ) {
+                return(0) ;
+        }
+        return(segments_[curr_]->end()) ;
+}
+
+int TrickSegments::step() {
+
+        if ( segments_.empty() ) {
+                return(0) ;
+        }
+        do {
+                if ( segments_[curr_]->step() ) {
+                        return(1) ;
+                }
+        } while ( nextSegment() ) ;
+
+        return(0) ;
+}
+
+/*
+ * Returns the paths of the segments listed in a manifest.  Segments are listed
+ * one per line relative to the directory holding the manifest.
+ */
+std::vector<std::string> TrickSegmentsReadManifest( const char * manifest ) {
+
+        std::vector<std::string> paths ;
+        std::string dir = manifest ;
+        std::string line ;
+        std::string::size_type idx ;
+
+        idx = dir.rfind('/') ;
+        dir = ( idx == std::string::npos ) ? std::string("") : dir.substr(0, idx + 1) ;
+
+        std::ifstream in(manifest) ;
+        while ( std::getline(in, line) ) {
+                if ( ! line.empty() ) {
+                        paths.push_back(dir + line) ;
+                }
+        }
+        return(paths) ;
+}
@@ -0,0 +1,36 @@
+
+#ifndef TRICKSEGMENTS_HH
+#define TRICKSEGMENTS_HH
+
+#include <string>
+#include <vector>
+#include "DataStream.hh"
+
+/*
+ * Reads one parameter from a recording group that rolled over into several file segments.
+ * The segments are listed in order in a log_<group>.segments manifest and are read one after
+ * the other, each through the data stream of its own format.
+ */
+class TrickSegments : public DataStream {
+
+       public:
+               TrickSegments(const char * manifest, std::vector<DataStream *> & segments) ;
+               ~TrickSegments() ;
+
+               int get(double * time , double * value ) ;
+               int peek(double * time , double * value ) ;
+
+               void begin() ;
+               int end() ;
+               int step() ;
+
+       private:
+               std::vector<DataStream *> segments_ ;
+               unsigned int curr_ ;
+
+               int nextSegment() ;
+} ;
+
+std::vector<std::string> TrickSegmentsReadManifest( const char * manifest ) ;
+
+#endif
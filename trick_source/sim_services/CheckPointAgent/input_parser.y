@@ -402,6 +402,8 @@ param: NAME {
            $$.attr = NULL;
            $$.create_add_path = 0 ;
            $$.address_path = NULL ;
+           $$.compiled_path = NULL ;
+           $$.compiled_path_size = 0 ;
 
            // Get the address and attrs of the variable.
            if ((ret = IP->mem_mgr->ref_var( &$$, $1)) == MM_OK) {
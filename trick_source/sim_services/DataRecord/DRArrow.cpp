@@ -0,0 +1,544 @@
+/*
+PURPOSE:
+    (Data record to disk in the Apache Arrow IPC streaming format.)
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "trick/DRArrow.hh"
+#include "trick/bitfield_proto.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+/*
+ * Arrow messages are FlatBuffers.  These helpers lay a buffer out front to back: a table is written before
+ * the strings, vectors and tables it refers to, and its offset fields are filled in once they are written.
+ * Every offset then points forward as FlatBuffers requires.  Only the parts of Message.fbs and Schema.fbs
+ * written by DRArrow are defined here.
+ */
+
+enum {
+    arrow_metadata_v5 = 4 ,
+    arrow_header_schema = 1 ,
+    arrow_header_record_batch = 3 ,
+    arrow_type_int = 2 ,
+    arrow_type_floating_point = 3 ,
+    arrow_type_bool = 6 ,
+    arrow_precision_single = 1 ,
+    arrow_precision_double = 2
+} ;
+
+static const uint32_t arrow_continuation = 0xFFFFFFFF ;
+
+/* Appends @c value to @c buf, returns its position. */
+template <class T> static size_t fb_put( std::vector <unsigned char> & buf , T value ) {
+    size_t at = buf.size() ;
+    buf.resize(at + sizeof(T)) ;
+    memcpy(&buf[at], &value, sizeof(T)) ;
+    return at ;
+}
+
+/* Pads @c buf with zeros until its size plus @c extra is a multiple of @c align. */
+static void fb_pad( std::vector <unsigned char> & buf , size_t align , size_t extra = 0 ) {
+    while ( (buf.size() + extra) % align ) {
+        buf.push_back(0) ;
+    }
+}
+
+/* Points the offset field at @c at to the object at @c target. */
+static void fb_set_offset( std::vector <unsigned char> & buf , size_t at , size_t target ) {
+    uint32_t offset = target - at ;
+    memcpy(&buf[at], &offset, sizeof(offset)) ;
+}
+
+/* Appends a string, returns its position. */
+static size_t fb_string( std::vector <unsigned char> & buf , const std::string & str ) {
+    fb_pad(buf, 4) ;
+    size_t at = fb_put<uint32_t>(buf, str.size()) ;
+    buf.insert(buf.end(), str.begin(), str.end()) ;
+    buf.push_back(0) ;
+    return at ;
+}
+
+/* Appends a vector of @c num offsets to be filled in, returns its position.  Element i is at position + 4 + 4i. */
+static size_t fb_offset_vector( std::vector <unsigned char> & buf , unsigned int num ) {
+    fb_pad(buf, 4) ;
+    size_t at = fb_put<uint32_t>(buf, num) ;
+    buf.resize(buf.size() + num * sizeof(uint32_t), 0) ;
+    return at ;
+}
+
+/* Appends the length of a vector of 16 byte structs.  The elements that follow are 8 byte aligned. */
+static size_t fb_struct_vector( std::vector <unsigned char> & buf , unsigned int num ) {
+    fb_pad(buf, 8, 4) ;
+    return fb_put<uint32_t>(buf, num) ;
+}
+
+/* A table being built.  Fields are added by id and written largest first so each is aligned. */
+class FBTable {
+    public:
+        /* Adds a scalar field of @c size bytes. */
+        void add( unsigned int id , unsigned int size , uint64_t value ) {
+            FBField field = { id , size , value , 0 } ;
+            fields.push_back(field) ;
+        }
+
+        /* Adds an offset field, filled in with fb_set_offset at the position returned by field_pos. */
+        void add_offset( unsigned int id ) {
+            add(id, sizeof(uint32_t), 0) ;
+        }
+
+        /* Writes the vtable and the table, returns the position of the table. */
+        size_t write( std::vector <unsigned char> & buf ) {
+            unsigned int ii ;
+            unsigned int num_ids = 0 ;
+            unsigned int table_size = sizeof(int32_t) ;
+            bool has_long = false ;
+
+            std::stable_sort(fields.begin(), fields.end(), larger) ;
+            for ( ii = 0 ; ii < fields.size() ; ii++ ) {
+                num_ids = std::max(num_ids, fields[ii].id + 1) ;
+                has_long = has_long or fields[ii].size == 8 ;
+            }
+            // With the table 4 bytes past an 8 byte boundary, fields sorted largest first are aligned
+            for ( ii = 0 ; ii < fields.size() ; ii++ ) {
+                fields[ii].offset = table_size ;
+                table_size += fields[ii].size ;
+            }
+            table_size = (table_size + 3) / 4 * 4 ;
+
+            fb_pad(buf, 2) ;
+            size_t vtable = buf.size() ;
+            fb_put<uint16_t>(buf, 4 + 2 * num_ids) ;
+            fb_put<uint16_t>(buf, table_size) ;
+            for ( ii = 0 ; ii < num_ids ; ii++ ) {
+                fb_put<uint16_t>(buf, 0) ;
+            }
+            for ( ii = 0 ; ii < fields.size() ; ii++ ) {
+                uint16_t field_offset = fields[ii].offset ;
+                memcpy(&buf[vtable + 4 + 2 * fields[ii].id], &field_offset, sizeof(field_offset)) ;
+            }
+
+            if ( has_long ) {
+                fb_pad(buf, 8, 4) ;
+            } else {
+                fb_pad(buf, 4) ;
+            }
+            table = buf.size() ;
+            fb_put<int32_t>(buf, table - vtable) ;
+            buf.resize(table + table_size, 0) ;
+            for ( ii = 0 ; ii < fields.size() ; ii++ ) {
+                unsigned char * dest = &buf[table + fields[ii].offset] ;
+                uint8_t value8 = fields[ii].value ;
+                uint16_t value16 = fields[ii].value ;
+                uint32_t value32 = fields[ii].value ;
+                switch ( fields[ii].size ) {
+                    case 1: memcpy(dest, &value8, 1) ; break ;
+                    case 2: memcpy(dest, &value16, 2) ; break ;
+                    case 4: memcpy(dest, &value32, 4) ; break ;
+                    default: memcpy(dest, &fields[ii].value, 8) ; break ;
+                }
+            }
+            return table ;
+        }
+
+        /* Position of field @c id after the table is written. */
+        size_t field_pos( unsigned int id ) const {
+            for ( unsigned int ii = 0 ; ii < fields.size() ; ii++ ) {
+                if ( fields[ii].id == id ) {
+                    return table + fields[ii].offset ;
+                }
+            }
+            return 0 ;
+        }
+
+    private:
+        struct FBField {
+            unsigned int id ;
+            unsigned int size ;
+            uint64_t value ;
+            unsigned int offset ;
+        } ;
+
+        static bool larger( const FBField & a , const FBField & b ) {
+            return a.size > b.size ;
+        }
+
+        std::vector <FBField> fields ;
+        size_t table ;
+} ;
+
+/* Starts a Message with the given header type.  Returns the position of its header offset field. */
+static size_t arrow_message( std::vector <unsigned char> & buf , unsigned int header_type , uint64_t body_length ) {
+    buf.clear() ;
+    fb_put<uint32_t>(buf, 0) ;
+    FBTable message ;
+    message.add(0, 2, arrow_metadata_v5) ;
+    message.add(1, 1, header_type) ;
+    message.add_offset(2) ;
+    message.add(3, 8, body_length) ;
+    fb_set_offset(buf, 0, message.write(buf)) ;
+    return message.field_pos(2) ;
+}
+
+Trick::DRArrow::DRArrow( std::string in_name ) :
+ Trick::DataRecordGroup(in_name) ,
+ max_batch_rows(65536) ,
+ fd(-1) ,
+ batch_buff(NULL) ,
+ batch_capacity(0) ,
+ batch_rows(0) {
+    register_group_with_mm(this, "Trick::DRArrow") ;
+}
+
+int Trick::DRArrow::set_max_batch_rows( unsigned int rows ) {
+    max_batch_rows = (rows < 1) ? 1 : rows ;
+    return(0) ;
+}
+
+int Trick::DRArrow::format_specific_header( std::fstream & out_stream ) {
+    out_stream << " byte_order is " << byte_order << std::endl ;
+    return(0) ;
+}
+
+/**
+@details
+-# Set the file extension to ".arrows"
+-# Allocate the batch to hold the smaller of #max_batch_rows and #max_num records
+-# Open the log file
+   -# Return an error if the open failed
+-# Write the schema message
+*/
+int Trick::DRArrow::format_specific_init() {
+
+    file_name.append(".arrows") ;
+
+    batch_capacity = std::min(max_batch_rows, max_num) ;
+    if ( batch_capacity < 1 ) {
+        batch_capacity = 1 ;
+    }
+    batch_rows = 0 ;
+    if ( batch_buff ) {
+        free(batch_buff) ;
+    }
+    batch_buff = (char *)calloc(batch_capacity, record_bytes) ;
+
+    if ((fd = creat(file_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == -1) {
+        message_publish(MSG_ERROR, "Can't open Data Record file %s.\n", file_name.c_str()) ;
+        record = false ;
+        return (-1) ;
+    }
+
+    if ( write_schema() != 0 ) {
+        record = false ;
+        return (-1) ;
+    }
+
+    return(0) ;
+}
+
+/**
+@details
+-# Encode a Message holding a Schema with one field per recorded parameter.  Each field has its name,
+   its Arrow type, an empty children list and its units in the "units" metadata.
+-# Write the message, it has no body
+*/
+bool Trick::DRArrow::isSupportedType(REF2 * ref2, std::string& message) {
+
+    if ( ! Trick::DataRecordGroup::isSupportedType(ref2, message) ) {
+        return false ;
+    }
+
+    switch ( ref2->attr->type ) {
+        case TRICK_CHARACTER:
+        case TRICK_UNSIGNED_CHARACTER:
+        case TRICK_SHORT:
+        case TRICK_UNSIGNED_SHORT:
+        case TRICK_INTEGER:
+        case TRICK_UNSIGNED_INTEGER:
+        case TRICK_LONG:
+        case TRICK_UNSIGNED_LONG:
+        case TRICK_LONG_LONG:
+        case TRICK_UNSIGNED_LONG_LONG:
+        case TRICK_ENUMERATED:
+        case TRICK_BITFIELD:
+        case TRICK_UNSIGNED_BITFIELD:
+        case TRICK_FLOAT:
+        case TRICK_DOUBLE:
+        case TRICK_BOOLEAN:
+            return true ;
+        default:
+            message = "Cannot Data Record variable " + std::string(ref2->reference) +
+             " of type " + std::to_string(ref2->attr->type) + " in an Arrow file" ;
+            return false ;
+    }
+}
+
+int Trick::DRArrow::write_schema() {
+
+    unsigned int ii ;
+    size_t header_offset = arrow_message(metadata, arrow_header_schema, 0) ;
+
+    FBTable schema ;
+    schema.add(0, 2, byte_order.compare("little_endian") ? 1 : 0) ;
+    schema.add_offset(1) ;
+    fb_set_offset(metadata, header_offset, schema.write(metadata)) ;
+
+    size_t fields = fb_offset_vector(metadata, rec_buffer.size()) ;
+    fb_set_offset(metadata, schema.field_pos(1), fields) ;
+
+    for ( ii = 0 ; ii < rec_buffer.size() ; ii++ ) {
+        ATTRIBUTES * attr = rec_buffer[ii]->ref->attr ;
+        unsigned int type_type ;
+        FBTable type ;
+
+        switch ( attr->type ) {
+            case TRICK_FLOAT:
+                type_type = arrow_type_floating_point ;
+                type.add(0, 2, arrow_precision_single) ;
+                break ;
+            case TRICK_DOUBLE:
+                type_type = arrow_type_floating_point ;
+                type.add(0, 2, arrow_precision_double) ;
+                break ;
+            case TRICK_BOOLEAN:
+                if ( attr->size == 1 ) {
+                    type_type = arrow_type_bool ;
+                    break ;
+                }
+                type_type = arrow_type_int ;
+                type.add(0, 4, attr->size * 8) ;
+                type.add(1, 1, 0) ;
+                break ;
+            case TRICK_UNSIGNED_CHARACTER:
+            case TRICK_UNSIGNED_SHORT:
+            case TRICK_UNSIGNED_INTEGER:
+            case TRICK_UNSIGNED_LONG:
+            case TRICK_UNSIGNED_LONG_LONG:
+            case TRICK_UNSIGNED_BITFIELD:
+                type_type = arrow_type_int ;
+                type.add(0, 4, attr->size * 8) ;
+                type.add(1, 1, 0) ;
+                break ;
+            default:
+                // signed integers, isSupportedType kept out every other type
+                type_type = arrow_type_int ;
+                type.add(0, 4, attr->size * 8) ;
+                type.add(1, 1, 1) ;
+                break ;
+        }
+
+        FBTable field ;
+        field.add_offset(0) ;
+        field.add(1, 1, 0) ;
+        field.add(2, 1, type_type) ;
+        field.add_offset(3) ;
+        field.add_offset(5) ;
+        field.add_offset(6) ;
+        fb_set_offset(metadata, fields + 4 + 4 * ii, field.write(metadata)) ;
+
+        fb_set_offset(metadata, field.field_pos(0), fb_string(metadata, rec_buffer[ii]->ref->reference)) ;
+        fb_set_offset(metadata, field.field_pos(3), type.write(metadata)) ;
+        fb_set_offset(metadata, field.field_pos(5), fb_offset_vector(metadata, 0)) ;
+
+        size_t custom = fb_offset_vector(metadata, 1) ;
+        fb_set_offset(metadata, field.field_pos(6), custom) ;
+        FBTable units ;
+        units.add_offset(0) ;
+        units.add_offset(1) ;
+        fb_set_offset(metadata, custom + 4, units.write(metadata)) ;
+        fb_set_offset(metadata, units.field_pos(0), fb_string(metadata, "units")) ;
+        fb_set_offset(metadata, units.field_pos(1),
+         fb_string(metadata, (attr->mods & TRICK_MODS_UNITSDASHDASH) ? "--" : attr->units)) ;
+    }
+    fb_pad(metadata, 8) ;
+
+    body.clear() ;
+    return write_message(metadata, body) ;
+}
+
+/**
+@details
+-# Lay out the body, a data buffer for each column padded to 8 bytes.  One byte booleans are packed into
+   bits.  No column has nulls, so every validity buffer is empty.
+-# Encode a Message holding a RecordBatch with a node and two buffers per column
+-# Write the message and empty the batch
+*/
+int Trick::DRArrow::write_batch() {
+
+    unsigned int ii , jj ;
+    int ret ;
+
+    body.clear() ;
+    std::vector <uint64_t> buffer_offsets(rec_buffer.size()) ;
+    std::vector <uint64_t> buffer_lengths(rec_buffer.size()) ;
+    for ( ii = 0 ; ii < rec_buffer.size() ; ii++ ) {
+        ATTRIBUTES * attr = rec_buffer[ii]->ref->attr ;
+        const char * column = batch_buff + (size_t)batch_capacity * rec_buffer[ii]->offset ;
+        buffer_offsets[ii] = body.size() ;
+        if ( attr->type == TRICK_BOOLEAN and attr->size == 1 ) {
+            size_t start = body.size() ;
+            body.resize(start + (batch_rows + 7) / 8, 0) ;
+            for ( jj = 0 ; jj < batch_rows ; jj++ ) {
+                if ( column[jj] ) {
+                    body[start + jj / 8] |= 1 << (jj % 8) ;
+                }
+            }
+        } else {
+            body.insert(body.end(), column, column + (size_t)batch_rows * attr->size) ;
+        }
+        buffer_lengths[ii] = body.size() - buffer_offsets[ii] ;
+        fb_pad(body, 8) ;
+    }
+
+    size_t header_offset = arrow_message(metadata, arrow_header_record_batch, body.size()) ;
+
+    FBTable batch ;
+    batch.add(0, 8, batch_rows) ;
+    batch.add_offset(1) ;
+    batch.add_offset(2) ;
+    fb_set_offset(metadata, header_offset, batch.write(metadata)) ;
+
+    fb_set_offset(metadata, batch.field_pos(1), fb_struct_vector(metadata, rec_buffer.size())) ;
+    for ( ii = 0 ; ii < rec_buffer.size() ; ii++ ) {
+        fb_put<int64_t>(metadata, batch_rows) ;
+        fb_put<int64_t>(metadata, 0) ;
+    }
+    fb_set_offset(metadata, batch.field_pos(2), fb_struct_vector(metadata, 2 * rec_buffer.size())) ;
+    for ( ii = 0 ; ii < rec_buffer.size() ; ii++ ) {
+        fb_put<int64_t>(metadata, buffer_offsets[ii]) ;
+        fb_put<int64_t>(metadata, 0) ;
+        fb_put<int64_t>(metadata, buffer_offsets[ii]) ;
+        fb_put<int64_t>(metadata, buffer_lengths[ii]) ;
+    }
+    fb_pad(metadata, 8) ;
+
+    ret = write_message(metadata, body) ;
+    batch_rows = 0 ;
+
+    return ret ;
+}
+
+/**
+@details
+-# Write the continuation marker and the metadata length, then the metadata and the body
+-# Count the bytes written
+*/
+int Trick::DRArrow::write_message( const std::vector <unsigned char> & in_metadata ,
+ const std::vector <unsigned char> & in_body ) {
+
+    uint32_t prefix[2] = { arrow_continuation , (uint32_t)in_metadata.size() } ;
+    const char * parts[3] = { (const char *)prefix , (const char *)&in_metadata[0] ,
+     in_body.empty() ? NULL : (const char *)&in_body[0] } ;
+    size_t lengths[3] = { sizeof(prefix) , in_metadata.size() , in_body.size() } ;
+
+    for ( unsigned int ii = 0 ; ii < 3 ; ii++ ) {
+        size_t written = 0 ;
+        while ( written < lengths[ii] ) {
+            ssize_t ret = write( fd , parts[ii] + written , lengths[ii] - written ) ;
+            if ( ret < 0 ) {
+                if ( errno == EINTR ) {
+                    continue ;
+                }
+                message_publish(MSG_ERROR, "Data Record group %s failed writing to %s: %s\n",
+                 group_name.c_str(), file_name.c_str(), strerror(errno)) ;
+                return -1 ;
+            }
+            written += ret ;
+        }
+        total_bytes_written += written ;
+    }
+    return 0 ;
+}
+
+/**
+@details
+-# If the batch is full, write it
+-# Copy each parameter value of the record at @c writer_offset to the end of its column in the batch,
+   extracting bitfield values from their containing words
+-# return 0, the bytes are counted when the batch is written
+*/
+int Trick::DRArrow::format_specific_write_data(unsigned int writer_offset) {
+
+    unsigned int ii ;
+    int sbf ;
+    unsigned int bf ;
+    unsigned int word ;
+
+    if ( batch_rows == batch_capacity ) {
+        write_batch() ;
+    }
+
+    for (ii = 0; ii < rec_buffer.size() ; ii++) {
+        ATTRIBUTES * attr = rec_buffer[ii]->ref->attr ;
+        char * address = record_value(rec_buffer[ii], writer_offset) ;
+        char * dest = batch_buff + (size_t)batch_capacity * rec_buffer[ii]->offset + (size_t)batch_rows * attr->size ;
+
+        switch (attr->type) {
+            case TRICK_BITFIELD:
+                memcpy(&word, address, (size_t)attr->size) ;
+                sbf = GET_BITFIELD(&word, attr->size, attr->index[0].start, attr->index[0].size);
+                memcpy(dest, &sbf, (size_t)attr->size);
+                break;
+
+            case TRICK_UNSIGNED_BITFIELD:
+                memcpy(&word, address, (size_t)attr->size) ;
+                bf = GET_UNSIGNED_BITFIELD(&word, attr->size, attr->index[0].start, attr->index[0].size);
+                memcpy(dest, &bf, (size_t)attr->size);
+                break;
+
+            default:
+                memcpy(dest, address, (size_t)attr->size);
+                break;
+        }
+    }
+    batch_rows++ ;
+
+    return 0 ;
+}
+
+/**
+@details
+-# Write the records gathered this write cycle as one record batch
+*/
+int Trick::DRArrow::format_specific_flush() {
+    if ( batch_rows > 0 and fd != -1 ) {
+        write_batch() ;
+    }
+    return(0) ;
+}
+
+/**
+@details
+-# Write any records left in the batch
+-# Write the end of stream marker and close the file
+-# Free the batch
+*/
+int Trick::DRArrow::format_specific_shutdown() {
+
+    if ( fd != -1 ) {
+        if ( inited ) {
+            uint32_t end_of_stream[2] = { arrow_continuation , 0 } ;
+            format_specific_flush() ;
+            if ( write( fd , end_of_stream , sizeof(end_of_stream) ) == (ssize_t)sizeof(end_of_stream) ) {
+                total_bytes_written += sizeof(end_of_stream) ;
+            }
+        }
+        close(fd) ;
+        fd = -1 ;
+    }
+    if ( batch_buff ) {
+        free(batch_buff) ;
+        batch_buff = NULL ;
+    }
+    batch_rows = 0 ;
+    return(0) ;
+}
@@ -18,7 +18,9 @@ PROGRAMMERS:
 #include "trick/message_type.h"
 #include "trick/bitfield_proto.h"
 
-Trick::DRAscii::DRAscii( std::string in_name ) : Trick::DataRecordGroup( in_name ) {
+Trick::DRAscii::DRAscii( std::string in_name ) : Trick::DataRecordGroup( in_name ) ,
+ block_size(1 << 20) ,
+ block_buff(NULL) {
 
     ascii_float_format = "%20.8g" ;
     ascii_double_format = "%20.16g" ;
@@ -26,6 +28,49 @@ Trick::DRAscii::DRAscii( std::string in_name ) : Trick::DataRecordGroup( in_name
     register_group_with_mm(this, "Trick::DRAscii") ;
 }
 
+/*
+   Integer values are converted by hand, it is considerably faster than parsing a printf format for every value.
+   The digits are built backwards in a scratch buffer and copied to the destination.  Returns the number of
+   characters written to buf, or 0 if there is not enough room.
+*/
+static int ascii_unsigned( char * buf, size_t spare, unsigned long long value, bool negative = false ) {
+    char digits[24] ;
+    char * end = digits + sizeof(digits) ;
+    char * ptr = end ;
+    do {
+        *--ptr = (char)('0' + (value % 10)) ;
+        value /= 10 ;
+    } while ( value != 0 ) ;
+    if ( negative ) {
+        *--ptr = '-' ;
+    }
+    size_t len = end - ptr ;
+    if ( len >= spare ) {
+        return 0 ;
+    }
+    memcpy(buf, ptr, len) ;
+    return (int)len ;
+}
+
+static int ascii_signed( char * buf, size_t spare, long long value ) {
+    if ( value < 0 ) {
+        // negate in unsigned arithmetic so LLONG_MIN does not overflow
+        return ascii_unsigned(buf, spare, 0ULL - (unsigned long long)value, true) ;
+    }
+    return ascii_unsigned(buf, spare, (unsigned long long)value) ;
+}
+
+/* snprintf returns the length it wanted to write, limit it to what actually fit in the buffer */
+static int ascii_fit( int len, size_t spare ) {
+    if ( len < 0 ) {
+        return 0 ;
+    }
+    if ( (size_t)len >= spare ) {
+        return spare > 0 ? (int)spare - 1 : 0 ;
+    }
+    return len ;
+}
+
 int Trick::DRAscii::format_specific_header( std::fstream & out_st ) {
     out_st << " is in ASCII" << std::endl ;
     return(0) ;
@@ -36,6 +81,8 @@ int Trick::DRAscii::format_specific_header( std::fstream & out_st ) {
 -# If the #delimiter is not empty and not a comma then set the file extension to ".txt"
 -# Else set the file extension to ".csv"
 -# Allocate enough memory to hold #record_size of records in memory
+-# If block writes are enabled, give the output stream a #block_size buffer so many records are
+   written to the file at once
 -# Open the log file
    -# Return an error if the open failed.
 -# Write out the title line of the log file.  The title line includes the names of
@@ -55,16 +102,26 @@ int Trick::DRAscii::format_specific_init() {
         file_name.append(".csv");
     }
 
-    /* Calculate a "worst case" for space used for 1 record. */
-    writer_buff_size = record_size * rec_buffer.size();
+    /* Calculate a "worst case" for space used for 1 record, including the delimiters and newline. */
+    writer_buff_size = (record_size + delimiter.length()) * rec_buffer.size() + 1 ;
     writer_buff = (char *)calloc(1 , writer_buff_size) ;
 
     /* This loop touches all of the memory locations in the allocation forcing the
        system to actually do the allocation */
-    for ( jj= 0 ; jj < record_size * rec_buffer.size() ; jj += 1024 ) {
+    for ( jj= 0 ; jj < writer_buff_size ; jj += 1024 ) {
         writer_buff[jj] = 1 ;
     }
-    writer_buff[record_size * rec_buffer.size() - 1] = 1 ;
+    writer_buff[writer_buff_size - 1] = 1 ;
+
+    /* The stream buffer must be set before the file is opened to take effect. */
+    if ( block_buff ) {
+        free(block_buff) ;
+        block_buff = NULL ;
+    }
+    if ( block_size > 0 ) {
+        block_buff = (char *)calloc(1 , block_size) ;
+        out_stream.rdbuf()->pubsetbuf(block_buff, block_size) ;
+    }
 
     out_stream.open(file_name.c_str(), std::fstream::out | std::fstream::app ) ;
     if ( !out_stream || !out_stream.good() ) {
@@ -103,48 +160,68 @@ int Trick::DRAscii::format_specific_init() {
 
 /**
 @details
--# While there is data in memory that has not been written to disk
-   -# Write out the time to a temporary #writer_buff
-   -# Write out each of the other parameter values preceded by the delimiter to the temporary #writer_buff
-   -# Write #writer_buff to the output file
--# Flush the output file stream
+-# Write out the time to a temporary #writer_buff
+-# Write out each of the other parameter values preceded by the delimiter to the temporary #writer_buff
+-# Terminate the record with a newline
+-# Write #writer_buff to the output stream.  The stream is flushed once per write cycle in
+   Trick::DRAscii::format_specific_flush, not per record.
 -# Return the number of bytes written
 */
 int Trick::DRAscii::format_specific_write_data(unsigned int writer_offset) {
     unsigned int ii ;
-    char *buf;
-
-    buf = writer_buff ;
+    size_t len ;
+    const char * delim = delimiter.c_str() ;
+    size_t delim_len = delimiter.length() ;
 
     /* Write out the first parameters (time) */
-    copy_data_ascii_item(rec_buffer[0], writer_offset, buf );
-    buf += strlen(buf);
+    len = copy_data_ascii_item(rec_buffer[0], writer_offset, writer_buff );
 
     /* Write out all other parameters */
     for (ii = 1; ii < rec_buffer.size() ; ii++) {
-        strcat(buf, delimiter.c_str() );
-        buf += delimiter.length() ;
-        copy_data_ascii_item(rec_buffer[ii], writer_offset, buf );
-        buf += strlen(buf);
+        if ( len + delim_len < writer_buff_size - 1 ) {
+            memcpy(writer_buff + len, delim, delim_len) ;
+            len += delim_len ;
+        }
+        len += copy_data_ascii_item(rec_buffer[ii], writer_offset, writer_buff + len );
     }
 
-    out_stream << writer_buff << std::endl ;
+    writer_buff[len++] = '\n' ;
+    out_stream.write(writer_buff, len) ;
 
-    /*! Flush the output */
-    out_stream.flush() ;
-    /*! +1 for endl */
-    return(strlen(writer_buff) + 1) ;
+    return(len) ;
+}
+
+/**
+@details
+-# Flush the output file stream
+*/
+int Trick::DRAscii::format_specific_flush() {
+
+    if ( inited ) {
+        out_stream.flush() ;
+    }
+    return(0) ;
 }
 
 /**
 @details
 -# Close the output file stream
+-# Free the stream block buffer
 */
 int Trick::DRAscii::format_specific_shutdown() {
 
     if ( inited ) {
         out_stream.close() ;
     }
+    if ( block_buff ) {
+        free(block_buff) ;
+        block_buff = NULL ;
+    }
+    return(0) ;
+}
+
+int Trick::DRAscii::set_block_size( unsigned int bytes ) {
+    block_size = bytes ;
     return(0) ;
 }
 
@@ -174,39 +251,61 @@ int Trick::DRAscii::set_single_prec_only( bool in_single_prec_only ) {
     return(0) ;
 }
 
+/**
+@details
+-# Format the value of item @c item_num of the buffer @c DI into @c buf
+-# Return the number of characters written, not including a null terminator
+*/
 int Trick::DRAscii::copy_data_ascii_item( Trick::DataRecordBuffer * DI, int item_num, char *buf ) {
 
     char *address = 0;
+    int len = 0 ;
 
     unsigned long bf;
     int sbf;
 
-    address = DI->buffer + (item_num * DI->ref->attr->size) ;
+    /* Values are packed in the record and may not be aligned, copy the value out before reading it. */
+    union {
+        long long ll ;
+        long double ld ;
+        char c[sizeof(long double)] ;
+    } value ;
+    size_t value_size = DI->ref->attr->size ;
+    if ( value_size > sizeof(value) ) {
+        value_size = sizeof(value) ;
+    }
+    memcpy(value.c, record_value(DI, item_num), value_size) ;
+    address = value.c ;
 
-    size_t writer_buf_spare = writer_buff + writer_buff_size - buf;
+    /* leave room for the newline that ends the record */
+    size_t writer_buf_spare = writer_buff + writer_buff_size - 1 - buf;
 
     switch (DI->ref->attr->type) {
         case TRICK_CHARACTER:
-            snprintf(buf, writer_buf_spare, "%c", *((char *) address));
+            // A NUL character is written as nothing, as the string formatting did
+            if ( writer_buf_spare > 1 and *((char *) address) != '\0' ) {
+                buf[0] = *((char *) address) ;
+                len = 1 ;
+            }
             break;
 
         case TRICK_UNSIGNED_CHARACTER:
 #if ( __linux | __sgi )
         case TRICK_BOOLEAN:
 #endif
-            snprintf(buf, writer_buf_spare, "%u", *((unsigned char *) address));
+            len = ascii_unsigned(buf, writer_buf_spare, *((unsigned char *) address));
             break;
 
         case TRICK_STRING:
-            snprintf(buf, writer_buf_spare, "%s", *((char **) address));
+            len = ascii_fit(snprintf(buf, writer_buf_spare, "%s", *((char **) address)), writer_buf_spare);
             break;
 
         case TRICK_SHORT:
-            snprintf(buf, writer_buf_spare, "%d", *((short *) address));
+            len = ascii_signed(buf, writer_buf_spare, *((short *) address));
             break;
 
         case TRICK_UNSIGNED_SHORT:
-            snprintf(buf, writer_buf_spare, "%u", *((unsigned short *) address));
+            len = ascii_unsigned(buf, writer_buf_spare, *((unsigned short *) address));
             break;
 
         case TRICK_ENUMERATED:
@@ -214,49 +313,49 @@ int Trick::DRAscii::copy_data_ascii_item( Trick::DataRecordBuffer * DI, int item
 #if ( __sun | __APPLE__ )
         case TRICK_BOOLEAN:
 #endif
-            snprintf(buf, writer_buf_spare, "%d", *((int *) address));
+            len = ascii_signed(buf, writer_buf_spare, *((int *) address));
             break;
 
         case TRICK_UNSIGNED_INTEGER:
-            snprintf(buf, writer_buf_spare, "%u", *((unsigned int *) address));
+            len = ascii_unsigned(buf, writer_buf_spare, *((unsigned int *) address));
             break;
 
         case TRICK_LONG:
-            snprintf(buf, writer_buf_spare, "%ld", *((long *) address));
+            len = ascii_signed(buf, writer_buf_spare, *((long *) address));
             break;
 
         case TRICK_UNSIGNED_LONG:
-            snprintf(buf, writer_buf_spare, "%lu", *((unsigned long *) address));
+            len = ascii_unsigned(buf, writer_buf_spare, *((unsigned long *) address));
             break;
 
         case TRICK_FLOAT:
-            snprintf(buf, writer_buf_spare, ascii_float_format.c_str() , *((float *) address));
+            len = ascii_fit(snprintf(buf, writer_buf_spare, ascii_float_format.c_str() , *((float *) address)), writer_buf_spare);
             break;
 
         case TRICK_DOUBLE:
-            snprintf(buf, writer_buf_spare, ascii_double_format.c_str() , *((double *) address));
+            len = ascii_fit(snprintf(buf, writer_buf_spare, ascii_double_format.c_str() , *((double *) address)), writer_buf_spare);
             break;
 
         case TRICK_BITFIELD:
             sbf = GET_BITFIELD(address, DI->ref->attr->size, DI->ref->attr->index[0].start, DI->ref->attr->index[0].size);
-            snprintf(buf, writer_buf_spare, "%d", sbf);
+            len = ascii_signed(buf, writer_buf_spare, sbf);
             break;
 
         case TRICK_UNSIGNED_BITFIELD:
             bf = GET_UNSIGNED_BITFIELD(address, DI->ref->attr->size, DI->ref->attr->index[0].start, DI->ref->attr->index[0].size);
-            snprintf(buf, writer_buf_spare, "%lu", bf);
+            len = ascii_unsigned(buf, writer_buf_spare, bf);
             break;
 
         case TRICK_LONG_LONG:
-            snprintf(buf, writer_buf_spare, "%lld", *((long long *) address));
+            len = ascii_signed(buf, writer_buf_spare, *((long long *) address));
             break;
 
         case TRICK_UNSIGNED_LONG_LONG:
-            snprintf(buf, writer_buf_spare, "%llu", *((unsigned long long *) address));
+            len = ascii_unsigned(buf, writer_buf_spare, *((unsigned long long *) address));
             break;
         default:
             break;
     }
 
-    return(0) ;
+    return(len) ;
 }
@@ -12,17 +12,30 @@ PROGRAMMERS:
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <errno.h>
 
 #include "trick/DRBinary.hh"
+#include "trick/DRCompression.hh"
 #include "trick/command_line_protos.h"
 #include "trick/memorymanager_c_intf.h"
 #include "trick/bitfield_proto.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
 
 /*
    Other classes inherit from DRBinary. In these cases, we don't want to register the memory as DRBinary,
    so register_group will be set to false.
 */
-Trick::DRBinary::DRBinary( std::string in_name , bool register_group ) : Trick::DataRecordGroup(in_name) {
+Trick::DRBinary::DRBinary( std::string in_name , bool register_group ) :
+ Trick::DataRecordGroup(in_name) ,
+ block_size(1 << 20) ,
+ compress(false) ,
+ min_block_size(1 << 16) ,
+ fd(-1) ,
+ has_bitfields(false) ,
+ block_buff(NULL) ,
+ block_buff_size(0) ,
+ block_len(0) {
     if ( register_group ) {
         register_group_with_mm(this, "Trick::DRBinary") ;
     }
@@ -35,11 +48,13 @@ int Trick::DRBinary::format_specific_header( std::fstream & out_stream ) {
 
 /**
 @details
--# Set the file extension to ".trk"
+-# Set the file extension to ".trk", or ".trkz" if compression is on
 -# Allocate enough memory to hold #record_size of records in memory
+-# If block writes are enabled, allocate the block buffer rounded down to a whole number of records
 -# Open the log file
    -# Return an error if the open failed
--# Write out the magic Trick-07-[LB] keyword, L for little endian, B for big.
+-# Write out the magic Trick-10-[LB] keyword, L for little endian, B for big.  Compressed files use
+   Trick-Z1-[LB].
 -# Write out the number of variables recorded
 -# For each variable to be recorded
    -# Write out the name
@@ -61,7 +76,11 @@ int Trick::DRBinary::format_specific_init() {
         char c[sizeof(long)];
     } byte_order_union;
 
-    file_name.append(".trk");
+    if ( compress ) {
+        file_name.append(".trkz");
+    } else {
+        file_name.append(".trk");
+    }
 
     /* Calculate a "worst case" for space used for 1 record. */
     writer_buff = (char *)calloc(1 , record_size * rec_buffer.size()) ;
@@ -73,6 +92,32 @@ int Trick::DRBinary::format_specific_init() {
     }
     writer_buff[record_size * rec_buffer.size() - 1] = 1 ;
 
+    has_bitfields = false ;
+    for ( jj = 0 ; jj < rec_buffer.size() ; jj++ ) {
+        if ( rec_buffer[jj]->ref->attr->type == TRICK_BITFIELD or rec_buffer[jj]->ref->attr->type == TRICK_UNSIGNED_BITFIELD ) {
+            has_bitfields = true ;
+        }
+    }
+
+    /* A block must hold at least one record.  Blocks are sized to a whole number of records
+       so a full block is written with a single call. */
+    if ( block_buff ) {
+        free(block_buff) ;
+        block_buff = NULL ;
+    }
+    block_len = block_buff_size = 0 ;
+    if ( compress and block_size == 0 ) {
+        message_publish(MSG_WARNING, "Data Record group %s is compressed and must use blocks, using a block size of 1048576.\n",
+         group_name.c_str()) ;
+        block_size = 1 << 20 ;
+    }
+    if ( block_size > 0 ) {
+        block_buff_size = (block_size < record_bytes) ? record_bytes : block_size - ( block_size % record_bytes ) ;
+        block_buff = (char *)malloc(block_buff_size) ;
+        /* touch the block so the allocation does not fault pages in while recording */
+        memset(block_buff, 0, block_buff_size) ;
+    }
+
     /* start header information in trk file */
     if ((fd = creat(file_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == -1) {
         record = false ;
@@ -85,10 +130,10 @@ int Trick::DRBinary::format_specific_init() {
      */
     byte_order_union.l = 1 ;
     if (byte_order_union.c[sizeof(long)-1] != 1) {
-        bytes += write( fd , "Trick-10-L", (size_t)10 ) ;
+        bytes += write( fd , compress ? "Trick-Z1-L" : "Trick-10-L", (size_t)10 ) ;
         
     } else {
-        bytes += write( fd , "Trick-10-B", (size_t)10 ) ;
+        bytes += write( fd , compress ? "Trick-Z1-B" : "Trick-10-B", (size_t)10 ) ;
     }
     write_value = rec_buffer.size() ;
     bytes += write( fd , &write_value , sizeof(int) ) ;
@@ -121,73 +166,192 @@ int Trick::DRBinary::format_specific_init() {
 
 /**
 @details
--# While there is data in memory that has not been written to disk
-   -# Write out each of the other parameter values to the temporary #writer_buff
-   -# Write #writer_buff to the output file
--# return the number of bytes written
+-# If the group has no bitfields the record in the recording ring is already laid out as a
+   record in the file.  Copy it whole.
+-# Else copy each of the parameter values of the record at @c writer_offset to @c dest,
+   extracting bitfield values from their containing words
+-# return the number of bytes copied
 */
-int Trick::DRBinary::format_specific_write_data(unsigned int writer_offset) {
+unsigned int Trick::DRBinary::copy_record(char * dest, unsigned int writer_offset) {
 
 	unsigned long bf;
 	int sbf;
     unsigned int ii ;
     unsigned int len = 0 ;
     char *address = 0 ;
+    /* bitfield containing words may not be aligned in the record */
+    unsigned int word ;
+
+    if ( ! has_bitfields ) {
+        memcpy(dest, write_ring + (size_t)writer_offset * record_bytes, record_bytes) ;
+        return record_bytes ;
+    }
 
     /* Write out all parameters */
     for (ii = 0; ii < rec_buffer.size() ; ii++) {
 
-        address = rec_buffer[ii]->buffer + ( writer_offset * rec_buffer[ii]->ref->attr->size ) ;
+        address = record_value(rec_buffer[ii], writer_offset) ;
 
         switch (rec_buffer[ii]->ref->attr->type) {
-            case TRICK_CHARACTER:
-            case TRICK_UNSIGNED_CHARACTER:
-            case TRICK_SHORT:
-            case TRICK_UNSIGNED_SHORT:
-            case TRICK_BOOLEAN:
-            case TRICK_ENUMERATED:
-            case TRICK_INTEGER:
-            case TRICK_UNSIGNED_INTEGER:
-            case TRICK_FLOAT:
-            case TRICK_LONG:
-            case TRICK_UNSIGNED_LONG:
-            case TRICK_LONG_LONG:
-            case TRICK_UNSIGNED_LONG_LONG:
-            case TRICK_STRUCTURED:
-            case TRICK_DOUBLE:
-                memcpy(writer_buff + len, address, (size_t)rec_buffer[ii]->ref->attr->size);
-                break;
-
             case TRICK_BITFIELD:
-                sbf = GET_BITFIELD(address, rec_buffer[ii]->ref->attr->size,
+                memcpy(&word, address, (size_t)rec_buffer[ii]->ref->attr->size) ;
+                sbf = GET_BITFIELD(&word, rec_buffer[ii]->ref->attr->size,
                  rec_buffer[ii]->ref->attr->index[0].start, rec_buffer[ii]->ref->attr->index[0].size);
-                memcpy(writer_buff + len, &sbf, (size_t)rec_buffer[ii]->ref->attr->size);
+                memcpy(dest + len, &sbf, (size_t)rec_buffer[ii]->ref->attr->size);
                 break;
 
             case TRICK_UNSIGNED_BITFIELD:
-                bf = GET_UNSIGNED_BITFIELD(address, rec_buffer[ii]->ref->attr->size,
+                memcpy(&word, address, (size_t)rec_buffer[ii]->ref->attr->size) ;
+                bf = GET_UNSIGNED_BITFIELD(&word, rec_buffer[ii]->ref->attr->size,
                  rec_buffer[ii]->ref->attr->index[0].start, rec_buffer[ii]->ref->attr->index[0].size);
-                memcpy(writer_buff + len, &bf, (size_t)rec_buffer[ii]->ref->attr->size);
+                memcpy(dest + len, &bf, (size_t)rec_buffer[ii]->ref->attr->size);
                 break;
 
             default:
+                memcpy(dest + len, address, (size_t)rec_buffer[ii]->ref->attr->size);
                 break;
         }
         len += rec_buffer[ii]->ref->attr->size ;
 
     }
 
-    return write( fd , writer_buff , len) ;
+    return len ;
+}
+
+/**
+@details
+-# If block writes are disabled
+   -# Copy the record to the temporary #writer_buff
+   -# Write #writer_buff to the output file
+-# Else
+   -# If the record does not fit in the block, write the block to the output file
+   -# Copy the record to the end of the block
+-# return the number of bytes written or gathered
+*/
+int Trick::DRBinary::format_specific_write_data(unsigned int writer_offset) {
+
+    if ( block_buff == NULL ) {
+        return write( fd , writer_buff , copy_record(writer_buff, writer_offset)) ;
+    }
+
+    if ( block_len + record_bytes > block_buff_size ) {
+        write_block() ;
+    }
+    block_len += copy_record(block_buff + block_len, writer_offset) ;
+
+    // compressed blocks count their bytes when they are written
+    return compress ? 0 : record_bytes ;
+}
+
+/**
+@details
+-# Write the number of records in the block followed by a placeholder length for each column
+-# Encode each column of the block, a parameter's values are at the same offset in every record
+-# Fill in the encoded length of each column
+*/
+void Trick::DRBinary::compress_block() {
+
+    unsigned int ii ;
+    unsigned int num_records = block_len / record_bytes ;
+    unsigned int column_len ;
+
+    compressed_block.assign((rec_buffer.size() + 1) * sizeof(unsigned int), 0) ;
+    memcpy(&compressed_block[0], &num_records, sizeof(unsigned int)) ;
+
+    for (ii = 0; ii < rec_buffer.size() ; ii++) {
+        ATTRIBUTES * attr = rec_buffer[ii]->ref->attr ;
+        column_len = Trick::dr_encode_column(compressed_block, block_buff + rec_buffer[ii]->offset, record_bytes,
+         num_records, attr->type, attr->size) ;
+        memcpy(&compressed_block[(ii + 1) * sizeof(unsigned int)], &column_len, sizeof(unsigned int)) ;
+    }
+}
+
+/**
+@details
+-# If compression is on, encode the block
+-# Write the block to the output file, continuing after partial writes
+-# Empty the block
+-# return the number of bytes written
+*/
+int Trick::DRBinary::write_block() {
+
+    unsigned int written = 0 ;
+    ssize_t ret ;
+    const char * out = block_buff ;
+    unsigned int out_len = block_len ;
+
+    if ( compress ) {
+        compress_block() ;
+        out = (const char *)&compressed_block[0] ;
+        out_len = compressed_block.size() ;
+    }
+
+    while ( written < out_len ) {
+        ret = write( fd , out + written , out_len - written ) ;
+        if ( ret < 0 ) {
+            if ( errno == EINTR ) {
+                continue ;
+            }
+            message_publish(MSG_ERROR, "Data Record group %s failed writing to %s: %s\n",
+             group_name.c_str(), file_name.c_str(), strerror(errno)) ;
+            break ;
+        }
+        written += ret ;
+    }
+    block_len = 0 ;
+    if ( compress ) {
+        total_bytes_written += written ;
+    }
+
+    return written ;
+}
+
+/**
+@details
+-# Write out any records waiting in the block.  A compressed block waits until it holds at least
+   #min_block_size bytes of records.
+*/
+int Trick::DRBinary::format_specific_flush() {
+
+    if ( block_len > 0 and ( ! compress or block_len >= min_block_size )) {
+        write_block() ;
+    }
+    return(0) ;
 }
 
 /**
 @details
+-# Write out all records waiting in the block
 -# Close the output file stream
+-# Free the block buffer
 */
 int Trick::DRBinary::format_specific_shutdown() {
 
     if ( inited ) {
+        if ( block_len > 0 ) {
+            write_block() ;
+        }
         close(fd) ;
     }
+    if ( block_buff ) {
+        free(block_buff) ;
+        block_buff = NULL ;
+    }
+    block_len = block_buff_size = 0 ;
+    return(0) ;
+}
+
+int Trick::DRBinary::set_block_size( unsigned int bytes ) {
+    block_size = bytes ;
+    return(0) ;
+}
+
+int Trick::DRBinary::set_compression( bool on ) {
+    compress = on ;
+    return(0) ;
+}
+
+int Trick::DRBinary::set_min_block_size( unsigned int bytes ) {
+    min_block_size = bytes ;
     return(0) ;
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+/*
+PURPOSE:
+    (Data record to disk in one memory mapped file per parameter.)
+*/
+
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "trick/DRColumnar.hh"
+#include "trick/bitfield_proto.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+Trick::DRColumnar::DRColumnar( std::string in_name ) :
+ Trick::DataRecordGroup(in_name) ,
+ num_rows(0) ,
+ capacity_rows(0) {
+    register_group_with_mm(this, "Trick::DRColumnar") ;
+}
+
+int Trick::DRColumnar::format_specific_header( std::fstream & out_stream ) {
+    out_stream << " byte_order is " << byte_order << std::endl ;
+    return(0) ;
+}
+
+/**
+@details
+-# Set the file name to the log_<group_name>.col directory and create it
+   -# Return an error if the directory could not be created
+-# Write the index, the same header written at the top of a DRBinary log file
+-# Create a column file for each variable and grow the columns to hold the recording buffer
+   -# Return an error if a column file could not be created
+*/
+int Trick::DRColumnar::format_specific_init() {
+
+    unsigned int jj ;
+    int fd ;
+    int write_value ;
+    int bytes = 0 ;
+
+    file_name.append(".col");
+
+    if ( mkdir(file_name.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1 and errno != EEXIST ) {
+        message_publish(MSG_ERROR, "Can't create Data Record directory %s: %s\n", file_name.c_str(), strerror(errno)) ;
+        record = false ;
+        return (-1) ;
+    }
+
+    std::string index_name = file_name + "/index" ;
+    if ((fd = creat(index_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == -1) {
+        message_publish(MSG_ERROR, "Can't open Data Record file %s.\n", index_name.c_str()) ;
+        record = false ;
+        return (-1) ;
+    }
+
+    if ( ! byte_order.compare("little_endian") ) {
+        bytes += write( fd , "Trick-10-L", (size_t)10 ) ;
+    } else {
+        bytes += write( fd , "Trick-10-B", (size_t)10 ) ;
+    }
+    write_value = rec_buffer.size() ;
+    bytes += write( fd , &write_value , sizeof(int) ) ;
+
+    for (jj = 0; jj < rec_buffer.size(); jj++) {
+        /* name */
+        write_value = strlen(rec_buffer[jj]->ref->reference) ;
+        bytes += write( fd , &write_value , sizeof(int)) ;
+        bytes += write( fd , rec_buffer[jj]->ref->reference , write_value ) ;
+
+        /* units */
+        if ( rec_buffer[jj]->ref->attr->mods & TRICK_MODS_UNITSDASHDASH ) {
+            write_value = strlen("--") ;
+            bytes += write( fd , &write_value , sizeof(int)) ;
+            bytes += write( fd , "--" , write_value ) ;
+        } else {
+            write_value = strlen(rec_buffer[jj]->ref->attr->units) ;
+            bytes += write( fd , &write_value , sizeof(int)) ;
+            bytes += write( fd , rec_buffer[jj]->ref->attr->units , write_value ) ;
+        }
+
+        write_value = rec_buffer[jj]->ref->attr->type ;
+        bytes += write( fd , &write_value , sizeof(int)) ;
+
+        bytes += write( fd , &rec_buffer[jj]->ref->attr->size , sizeof(int)) ;
+    }
+    close(fd) ;
+    total_bytes_written += bytes;
+
+    num_rows = capacity_rows = 0 ;
+    columns.assign(rec_buffer.size(), Trick::DRColumnarColumn()) ;
+    for (jj = 0; jj < columns.size(); jj++) {
+        std::ostringstream column_name ;
+        column_name << file_name << "/col_" << jj ;
+        columns[jj].fd = open(column_name.str().c_str(), O_RDWR | O_CREAT | O_TRUNC,
+         S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH) ;
+        if ( columns[jj].fd == -1 ) {
+            message_publish(MSG_ERROR, "Can't open Data Record file %s.\n", column_name.str().c_str()) ;
+            record = false ;
+            return (-1) ;
+        }
+    }
+
+    if ( grow_columns(max_num) != 0 ) {
+        record = false ;
+        return (-1) ;
+    }
+    write_row_counts() ;
+
+    return(0) ;
+}
+
+/**
+@details
+-# For each column
+   -# Unmap the column file
+   -# Extend the column file to hold @c rows values.  Unwritten pages are not allocated on disk.
+   -# Map the column file and write the keyword
+-# return 0 on success, -1 on failure
+*/
+int Trick::DRColumnar::grow_columns( unsigned long long rows ) {
+
+    unsigned int jj ;
+
+    for (jj = 0; jj < columns.size(); jj++) {
+        Trick::DRColumnarColumn & column = columns[jj] ;
+        size_t new_size = column_header_size + rows * rec_buffer[jj]->ref->attr->size ;
+
+        if ( column.map != NULL ) {
+            munmap(column.map, column.map_size) ;
+            column.map = NULL ;
+            column.map_size = 0 ;
+        }
+        if ( ftruncate(column.fd, new_size) == -1 ) {
+            message_publish(MSG_ERROR, "Data Record group %s failed to grow column %s: %s\n",
+             group_name.c_str(), rec_buffer[jj]->ref->reference, strerror(errno)) ;
+            return -1 ;
+        }
+        void * map = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, column.fd, 0) ;
+        if ( map == MAP_FAILED ) {
+            message_publish(MSG_ERROR, "Data Record group %s failed to map column %s: %s\n",
+             group_name.c_str(), rec_buffer[jj]->ref->reference, strerror(errno)) ;
+            return -1 ;
+        }
+        column.map = (char *)map ;
+        column.map_size = new_size ;
+        memcpy(column.map, "TrickCol", 8) ;
+    }
+    capacity_rows = rows ;
+
+    return 0 ;
+}
+
+void Trick::DRColumnar::write_row_counts() {
+
+    unsigned int jj ;
+
+    for (jj = 0; jj < columns.size(); jj++) {
+        if ( columns[jj].map != NULL ) {
+            memcpy(columns[jj].map + 8, &num_rows, sizeof(num_rows)) ;
+        }
+    }
+}
+
+/**
+@details
+-# If the columns are full, double their size
+-# Copy each parameter value of the record at @c writer_offset to the end of its column,
+   extracting bitfield values from their containing words
+-# return the number of bytes copied
+*/
+int Trick::DRColumnar::format_specific_write_data(unsigned int writer_offset) {
+
+    unsigned int ii ;
+    int sbf ;
+    unsigned int bf ;
+    unsigned int word ;
+
+    if ( num_rows == capacity_rows ) {
+        if ( grow_columns(capacity_rows * 2) != 0 ) {
+            record = false ;
+            return 0 ;
+        }
+    }
+
+    for (ii = 0; ii < rec_buffer.size() ; ii++) {
+        ATTRIBUTES * attr = rec_buffer[ii]->ref->attr ;
+        char * address = record_value(rec_buffer[ii], writer_offset) ;
+        char * dest = columns[ii].map + column_header_size + num_rows * attr->size ;
+
+        switch (attr->type) {
+            case TRICK_BITFIELD:
+                memcpy(&word, address, (size_t)attr->size) ;
+                sbf = GET_BITFIELD(&word, attr->size, attr->index[0].start, attr->index[0].size);
+                memcpy(dest, &sbf, (size_t)attr->size);
+                break;
+
+            case TRICK_UNSIGNED_BITFIELD:
+                memcpy(&word, address, (size_t)attr->size) ;
+                bf = GET_UNSIGNED_BITFIELD(&word, attr->size, attr->index[0].start, attr->index[0].size);
+                memcpy(dest, &bf, (size_t)attr->size);
+                break;
+
+            default:
+                memcpy(dest, address, (size_t)attr->size);
+                break;
+        }
+    }
+    num_rows++ ;
+
+    return record_bytes ;
+}
+
+/**
+@details
+-# Publish the values written this cycle by updating the value count of each column
+*/
+int Trick::DRColumnar::format_specific_flush() {
+    write_row_counts() ;
+    return(0) ;
+}
+
+/**
+@details
+-# Write the final value count of each column
+-# Unmap and truncate each column file to the values written and close it
+*/
+int Trick::DRColumnar::format_specific_shutdown() {
+
+    unsigned int jj ;
+
+    if ( inited ) {
+        write_row_counts() ;
+    }
+    for (jj = 0; jj < columns.size(); jj++) {
+        Trick::DRColumnarColumn & column = columns[jj] ;
+        if ( column.map != NULL ) {
+            munmap(column.map, column.map_size) ;
+            column.map = NULL ;
+        }
+        if ( column.fd != -1 ) {
+            if ( ftruncate(column.fd, column_header_size + num_rows * rec_buffer[jj]->ref->attr->size) == -1 ) {
+                message_publish(MSG_WARNING, "Data Record group %s failed to truncate column %s: %s\n",
+                 group_name.c_str(), rec_buffer[jj]->ref->reference, strerror(errno)) ;
+            }
+            close(column.fd) ;
+            column.fd = -1 ;
+        }
+    }
+    columns.clear() ;
+    return(0) ;
+}
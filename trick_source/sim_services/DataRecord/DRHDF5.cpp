@@ -7,6 +7,7 @@ PROGRAMMERS:
 
 #include <iostream>
 #include <stdlib.h>
+#include <string.h>
 
 #include "trick/DRHDF5.hh"
 #include "trick/parameter_types.h"
@@ -14,7 +15,13 @@ PROGRAMMERS:
 #include "trick/memorymanager_c_intf.h"
 #include "trick/message_proto.h"
 
-Trick::DRHDF5::DRHDF5( std::string in_name ) : Trick::DataRecordGroup(in_name) {
+Trick::DRHDF5::DRHDF5( std::string in_name ) : Trick::DataRecordGroup(in_name) ,
+ layout(DRHDF5_Packet_Tables) ,
+ chunk_size(1024) ,
+ chunk_cache_size(0) ,
+ deflate_level(-1) ,
+ shuffle(false) ,
+ column_buff(NULL) {
     register_group_with_mm(this, "Trick::DRHDF5") ;
 }
 
@@ -23,14 +30,47 @@ int Trick::DRHDF5::format_specific_header( std::fstream & out_stream ) {
     return(0) ;
 }
 
+int Trick::DRHDF5::set_layout( DRHDF5_Layout in_layout ) {
+    layout = in_layout ;
+    return(0) ;
+}
+
+int Trick::DRHDF5::set_chunk_size( unsigned int rows ) {
+    if ( rows == 0 ) {
+        message_publish(MSG_WARNING, "Data Record group %s chunk size must be greater than 0.\n", group_name.c_str()) ;
+        return(-1) ;
+    }
+    chunk_size = rows ;
+    return(0) ;
+}
+
+int Trick::DRHDF5::set_chunk_cache_size( unsigned int bytes ) {
+    chunk_cache_size = bytes ;
+    return(0) ;
+}
+
+int Trick::DRHDF5::set_deflate( int level , bool in_shuffle ) {
+    if ( level < -1 or level > 9 ) {
+        message_publish(MSG_WARNING, "Data Record group %s deflate level %d is not -1 through 9.\n",
+         group_name.c_str(), level) ;
+        return(-1) ;
+    }
+    deflate_level = level ;
+    shuffle = in_shuffle ;
+    return(0) ;
+}
+
 /**
 @details
 -# Set the file extension to ".h5"
 -# Open the log file
 -# Create the root directory in the HDF5 file
 -# For each variable to be recorded
-   -# Create a fixed length packet table
-   -# Associate the packet table with the temporary memory buffer storing the simulation data
+   -# If the layout is DRHDF5_Packet_Tables create a fixed length packet table
+   -# If the layout is DRHDF5_Compound add a member to the record type at the variable's offset in the
+      recording ring
+-# If the layout is DRHDF5_Compound create the extendible records dataset with the configured chunk size,
+   chunk cache and filters.  The file type is the record type packed.
 -# Declare the recording group to the memory manager so that the group can be checkpointed
    and restored.
 */
@@ -39,7 +79,6 @@ int Trick::DRHDF5::format_specific_init() {
 #ifdef HDF5
     unsigned int ii ;
     HDF5_INFO *hdf5_info ;
-    hsize_t chunk_size = 1024;
     hid_t byte_id ;
     hid_t file_names_id, param_types_id, param_units_id, param_names_id ;
     hid_t datatype ;
@@ -48,6 +87,10 @@ int Trick::DRHDF5::format_specific_init() {
 
     file_name.append(".h5") ;
 
+    records_dataset = -1 ;
+    record_type = -1 ;
+    num_records = 0 ;
+
     s256 = H5Tcopy(H5T_C_S1);
     H5Tset_size(s256, 256);
 
@@ -76,7 +119,11 @@ int Trick::DRHDF5::format_specific_init() {
     // Create a packet table (PT) that stores each parameter's name.
     param_names_id =  H5PTcreate_fl(header_group, "param_names", s256, chunk_size, 1) ;
 
-    // Create a table for each requested parameter.
+    if ( layout == DRHDF5_Compound ) {
+        record_type = H5Tcreate(H5T_COMPOUND, record_bytes) ;
+    }
+
+    // Create a table, or a member of the record type, for each requested parameter.
     for (ii = 0; ii < rec_buffer.size(); ii++) {
 
         hdf5_info = (HDF5_INFO *)malloc(sizeof(HDF5_INFO));
@@ -170,11 +217,21 @@ int Trick::DRHDF5::format_specific_init() {
          * RETURN:
          *     Returns an identifier for the new packet table, or H5I_BADID on error.
          */
-        hdf5_info->dataset = H5PTcreate_fl(root_group, rec_buffer[ii]->ref->reference, datatype, chunk_size, 1) ;
+        if ( layout == DRHDF5_Compound ) {
+            hdf5_info->dataset = H5I_BADID ;
+            if ( H5Tinsert(record_type, rec_buffer[ii]->ref->reference, rec_buffer[ii]->offset, datatype) < 0 ) {
+                message_publish(MSG_ERROR, "An error occured in data record group \"%s\" when adding \"%s\".\n",
+                 group_name.c_str() , rec_buffer[ii]->ref->reference) ;
+                free(hdf5_info);
+                continue;
+            }
+        } else {
+            hdf5_info->dataset = H5PTcreate_fl(root_group, rec_buffer[ii]->ref->reference, datatype, chunk_size, 1) ;
 
-        if ( hdf5_info->dataset == H5I_BADID ) {
-            message_publish(MSG_ERROR, "An error occured in data record group \"%s\" when adding \"%s\".\n",
-             group_name.c_str() , rec_buffer[ii]->ref->reference) ;
+            if ( hdf5_info->dataset == H5I_BADID ) {
+                message_publish(MSG_ERROR, "An error occured in data record group \"%s\" when adding \"%s\".\n",
+                 group_name.c_str() , rec_buffer[ii]->ref->reference) ;
+            }
         }
 
         hdf5_info->drb = rec_buffer[ii] ;
@@ -205,67 +262,178 @@ int Trick::DRHDF5::format_specific_init() {
     H5PTclose( param_units_id );
     H5PTclose( param_names_id );
     H5Gclose( header_group );
+
+    if ( layout == DRHDF5_Compound ) {
+        hsize_t dims = 0 ;
+        hsize_t max_dims = H5S_UNLIMITED ;
+        hsize_t chunk_dims = chunk_size ;
+        hid_t file_type = H5Tcopy(record_type) ;
+        hid_t space = H5Screate_simple(1, &dims, &max_dims) ;
+        hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE) ;
+        hid_t dapl = H5Pcreate(H5P_DATASET_ACCESS) ;
+
+        // Store the records without the alignment padding of the recording ring.
+        H5Tpack(file_type) ;
+        H5Pset_chunk(dcpl, 1, &chunk_dims) ;
+        if ( deflate_level >= 0 ) {
+            if ( H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0 ) {
+                if ( shuffle ) {
+                    H5Pset_shuffle(dcpl) ;
+                }
+                H5Pset_deflate(dcpl, deflate_level) ;
+            } else {
+                message_publish(MSG_WARNING, "Data Record group %s: the HDF5 deflate filter is not available, "
+                 "recording uncompressed.\n", group_name.c_str()) ;
+            }
+        }
+        if ( chunk_cache_size > 0 ) {
+            H5Pset_chunk_cache(dapl, H5D_CHUNK_CACHE_NSLOTS_DEFAULT, chunk_cache_size, H5D_CHUNK_CACHE_W0_DEFAULT) ;
+        }
+
+        records_dataset = H5Dcreate2(root_group, "records", file_type, space, H5P_DEFAULT, dcpl, dapl) ;
+
+        H5Pclose(dapl) ;
+        H5Pclose(dcpl) ;
+        H5Sclose(space) ;
+        H5Tclose(file_type) ;
+
+        if ( records_dataset < 0 ) {
+            message_publish(MSG_ERROR, "Can't create the records dataset in Data Record file %s.\n", file_name.c_str()) ;
+            record = false ;
+            return -1 ;
+        }
+    }
+
+    /* Scratch space to gather one variable's values out of the recording ring. */
+    unsigned int max_size = 0 ;
+    for (ii = 0; ii < rec_buffer.size(); ii++) {
+        if ( (unsigned int)rec_buffer[ii]->ref->attr->size > max_size ) {
+            max_size = rec_buffer[ii]->ref->attr->size ;
+        }
+    }
+    if ( column_buff ) {
+        free(column_buff) ;
+    }
+    column_buff = (char *)calloc(max_num , max_size) ;
 #endif
 
     return(0);
 }
 
+#ifdef HDF5
+/**
+@details
+-# Extend the records dataset by @c count records
+-# Select the new records in the file and write them from the recording ring in one call.  HDF5 converts
+   the records from the record type to the packed file type.
+*/
+int Trick::DRHDF5::append_records( unsigned int first , unsigned int count ) {
+
+    hsize_t start = num_records ;
+    hsize_t rows = count ;
+    hsize_t new_size = num_records + count ;
+    hid_t file_space ;
+    hid_t mem_space ;
+    herr_t ret ;
+
+    if ( H5Dset_extent(records_dataset, &new_size) < 0 ) {
+        message_publish(MSG_ERROR, "Data Record group %s failed to extend the records dataset.\n", group_name.c_str()) ;
+        return -1 ;
+    }
+    file_space = H5Dget_space(records_dataset) ;
+    H5Sselect_hyperslab(file_space, H5S_SELECT_SET, &start, NULL, &rows, NULL) ;
+    mem_space = H5Screate_simple(1, &rows, NULL) ;
+
+    ret = H5Dwrite(records_dataset, record_type, mem_space, file_space, H5P_DEFAULT,
+     write_ring + (size_t)first * record_bytes) ;
+
+    H5Sclose(mem_space) ;
+    H5Sclose(file_space) ;
+
+    if ( ret < 0 ) {
+        message_publish(MSG_ERROR, "Data Record group %s failed to write to the records dataset.\n", group_name.c_str()) ;
+        return -1 ;
+    }
+    num_records = new_size ;
+    return 0 ;
+}
+#endif
+
 /*
    HDF5 logging is done on a per variable basis instead of per time step like the
    other recording methods.  This write_data routine overrides the default in
    DataRecordGroup.  This routine writes out all of the buffered data of a variable
-   in one or two HDF5 calls.
+   in one HDF5 call per stage of records.  With the DRHDF5_Compound layout each stage of records is
+   appended to the records dataset in one call.  The records are taken from the ring and counted as in
+   DataRecordGroup::write_data.  The bytes counted are the bytes of values handed to HDF5, they do not
+   count against the max file size.
 */
 int Trick::DRHDF5::write_data(bool must_write) {
 
 #ifdef HDF5
     unsigned int local_buffer_num ;
+    unsigned int local_writer_num ;
     unsigned int num_to_write ;
+    unsigned int num_staged ;
+    unsigned int value_bytes = 0 ;
     unsigned int ii;
     char *buf = 0;
+    double write_start ;
 
     if ( record and inited and (buffer_type == DR_No_Buffer or must_write)) {
 
+        for (ii = 0; ii < parameters.size(); ii++) {
+            value_bytes += parameters[ii]->drb->ref->attr->size ;
+        }
+
         // buffer_mutex is used in this one place to prevent forced calls of write_data
         // to not overwrite data being written by the asynchronous thread.
         pthread_mutex_lock(&buffer_mutex) ;
-        local_buffer_num = buffer_num ;
-        if ( (local_buffer_num - writer_num) > max_num ) {
-            num_to_write = max_num ;
-        } else {
-            num_to_write = (local_buffer_num - writer_num) ;
+        write_start = wall_time() ;
+        // acquire pairs with the release of buffer_num in data_record, see DataRecordGroup::write_data
+        local_buffer_num = __atomic_load_n(&buffer_num, __ATOMIC_ACQUIRE) ;
+        local_writer_num = writer_num ;
+        num_to_write = local_buffer_num - local_writer_num ;
+        // Records before ring_first went out with a triggered capture and are no longer in the ring
+        if ( capture_ring != NULL and (local_buffer_num - ring_first) < num_to_write ) {
+            local_writer_num = ring_first ;
         }
-        writer_num = local_buffer_num - num_to_write ;
-
-        if ( writer_num != local_buffer_num ) {
-            // Test if the writer pointer to the right of the buffer pointer in the ring
-            if ( (writer_num % max_num) > (local_buffer_num % max_num) ) {
-               // we have 2 segments to write per variable
-               for (ii = 0; ii < parameters.size(); ii++) {
-                   HDF5_INFO * hi = parameters[ii] ;
-                   unsigned int writer_offset = writer_num % max_num ;
-                   buf = hi->drb->buffer + (writer_offset * hi->drb->ref->attr->size) ;
-
-                   /* Append all of the data on the end of the buffer to the packet table. */
-                   H5PTappend( hi->dataset, max_num - writer_offset , buf );
-
-                   buf = hi->drb->buffer ;
-                   /* Append all of the data at the beginning of the buffer to the packet table. */
-                   H5PTappend( hi->dataset, local_buffer_num % max_num , buf );
-               }
-            }  else {
-               // we have 1 continous segment to write per variable
-               for (ii = 0; ii < parameters.size(); ii++) {
-                   HDF5_INFO * hi = parameters[ii] ;
-                   unsigned int writer_offset = writer_num % max_num ;
-                   buf = hi->drb->buffer + (writer_offset * hi->drb->ref->attr->size) ;
-
-                   /* Append all of the data to the packet table. */
-                   H5PTappend( hi->dataset, local_buffer_num - writer_num , buf );
-
-               }
+
+        while ( record and local_writer_num != local_buffer_num ) {
+            // Records are copied out of the ring a stage at a time, see DataRecordGroup::stage_records
+            num_staged = stage_records(local_writer_num, local_buffer_num) ;
+            if ( num_staged == 0 ) {
+                continue ;
             }
-            writer_num = local_buffer_num ;
+            if ( layout == DRHDF5_Compound ) {
+                if ( append_records(0, num_staged) != 0 ) {
+                    record = false ;
+                    break ;
+                }
+            } else {
+                // Records are stored whole.  Gather each variable's values into a column
+                // and append the column to the variable's packet table in one call.
+                for (ii = 0; ii < parameters.size(); ii++) {
+                    HDF5_INFO * hi = parameters[ii] ;
+                    unsigned int size = hi->drb->ref->attr->size ;
+                    buf = column_buff ;
+                    for ( unsigned int rec = 0 ; rec < num_staged ; rec++ ) {
+                        memcpy( buf , record_value(hi->drb, rec) , size ) ;
+                        buf += size ;
+                    }
+
+                    /* Append all of the data to the packet table. */
+                    H5PTappend( hi->dataset, num_staged , column_buff );
+                }
+            }
+            local_writer_num += num_staged ;
+            rows_written += num_staged ;
+            bytes_written += (uint64_t)value_bytes * num_staged ;
+        }
+        write_ring = record_buffer ;
+        write_time += wall_time() - write_start ;
+        if ( write_time > 0.0 ) {
+            write_rate = bytes_written / write_time ;
         }
         pthread_mutex_unlock(&buffer_mutex) ;
 
@@ -279,7 +447,8 @@ int Trick::DRHDF5::write_data(bool must_write) {
 /**
 @details
 -# Snapshot the index of the most recent temporary memory buffer to write to disk to curr_buffer_num
--# For each parameter to be recorded
+-# If the layout is DRHDF5_Compound append the record to the records dataset
+-# Else for each parameter to be recorded
    -# Point a pointer to the beginning of the data in the memory buffer to be written to disk
    -# Append one packet to the packet table.
 */
@@ -287,7 +456,13 @@ int Trick::DRHDF5::format_specific_write_data(unsigned int writer_offset __attri
 
 #ifdef HDF5
     unsigned int ii;
-    char *buf = 0;
+
+    if ( layout == DRHDF5_Compound ) {
+        if ( append_records(writer_offset, 1) != 0 ) {
+            record = false ;
+        }
+        return(0);
+    }
 
     /* Loop through each parameter. */
     for (ii = 0; ii < parameters.size(); ii++) {
@@ -296,10 +471,10 @@ int Trick::DRHDF5::format_specific_write_data(unsigned int writer_offset __attri
          * So there is a seperate DataRecordBuffer per variable.
          * Point to the value to be recorded. */
         HDF5_INFO * hi = parameters[ii] ;
-        buf = hi->drb->buffer + (writer_offset * hi->drb->ref->attr->size) ;
+        memcpy( column_buff , record_value(hi->drb, writer_offset) , hi->drb->ref->attr->size ) ;
 
         /* Append 1 value to the packet table. */
-        H5PTappend( hi->dataset, 1, buf );
+        H5PTappend( hi->dataset, 1, column_buff );
 
     }
 #endif
@@ -311,6 +486,8 @@ int Trick::DRHDF5::format_specific_write_data(unsigned int writer_offset __attri
 @details
 -# For each parameter being recorded
    -# Close the HDF5 packet table
+   -# Free the parameter so opening another file starts a new list
+-# Close the records dataset and the record type
 -# Close the HDF5 root
 -# Close the HDF5 file
 */
@@ -322,12 +499,28 @@ int Trick::DRHDF5::format_specific_shutdown() {
     if ( inited ) {
         for (ii = 0; ii < parameters.size(); ii++) {
             HDF5_INFO * hi = parameters[ii] ;
-            H5PTclose( hi->dataset );
+            if ( hi->dataset != H5I_BADID ) {
+                H5PTclose( hi->dataset );
+            }
+            free(hi) ;
+        }
+        parameters.clear() ;
+        if ( records_dataset >= 0 ) {
+            H5Dclose(records_dataset);
+            records_dataset = -1 ;
+        }
+        if ( record_type >= 0 ) {
+            H5Tclose(record_type);
+            record_type = -1 ;
         }
         H5Gclose(root_group);
         H5Fclose(file);
 
     }
+    if ( column_buff ) {
+        free(column_buff) ;
+        column_buff = NULL ;
+    }
 #endif
     return(0);
 }
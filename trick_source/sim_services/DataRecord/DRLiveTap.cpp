@@ -0,0 +1,158 @@
+/*
+PURPOSE:
+    (Shared memory live tap of the records of a data record group.)
+*/
+
+#include <fstream>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "trick/DRLiveTap.hh"
+#include "trick/DataRecordGroup.hh"
+#include "trick/dr_live_tap.h"
+#include "trick/tsm_proto.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+Trick::DRLiveTap::DRLiveTap() :
+ tsm_dev() ,
+ rows(NULL) ,
+ record_bytes(0) ,
+ num_rows(0) ,
+ slot_bytes(0) ,
+ rows_written(0) {}
+
+Trick::DRLiveTap::~DRLiveTap() {
+    shutdown() ;
+}
+
+/* Appends a length prefixed string to a descriptor list. */
+static void append_string( std::vector <char> & desc , const char * str ) {
+    int len = strlen(str) ;
+    desc.insert(desc.end(), (char *)&len, (char *)&len + sizeof(len)) ;
+    desc.insert(desc.end(), str, str + len) ;
+}
+
+/**
+@details
+-# Build the variable descriptors.  Each is the name, units, type and size of a variable like a DRBinary header.
+-# Size the segment for the header, the descriptors and @c in_num_rows row slots
+-# Create the locator file, it is the key file of the segment
+-# Create the segment with tsm_init and make it read only for everyone but its creator
+-# Clear the segment and write the header and descriptors
+-# Write the key and id of the segment to the locator file
+*/
+int Trick::DRLiveTap::init( std::string locator_name , std::vector <Trick::DataRecordBuffer *> & vars ,
+ unsigned int in_record_bytes , unsigned int in_num_rows ) {
+
+    std::vector <char> desc ;
+    unsigned int ii ;
+    int fd ;
+
+    shutdown() ;
+
+    for ( ii = 0 ; ii < vars.size() ; ii++ ) {
+        ATTRIBUTES * attr = vars[ii]->ref->attr ;
+        append_string(desc, vars[ii]->ref->reference) ;
+        append_string(desc, (attr->mods & TRICK_MODS_UNITSDASHDASH) ? "--" : attr->units) ;
+        int type = attr->type ;
+        desc.insert(desc.end(), (char *)&type, (char *)&type + sizeof(type)) ;
+        desc.insert(desc.end(), (char *)&attr->size, (char *)&attr->size + sizeof(attr->size)) ;
+    }
+
+    record_bytes = in_record_bytes ;
+    num_rows = in_num_rows ;
+    slot_bytes = (sizeof(uint64_t) + record_bytes + 7) / 8 * 8 ;
+    unsigned long long rows_offset = (sizeof(DRLiveTapHeader) + desc.size() + 63) / 64 * 64 ;
+    unsigned long long size = rows_offset + (unsigned long long)num_rows * slot_bytes ;
+    if ( size > 0x7fffffff ) {
+        message_publish(MSG_ERROR, "Data Record live tap %s of %u rows is too large.\n", locator_name.c_str(), num_rows) ;
+        return -1 ;
+    }
+
+    if ((fd = creat(locator_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) == -1) {
+        message_publish(MSG_ERROR, "Can't open Data Record live tap file %s.\n", locator_name.c_str()) ;
+        return -1 ;
+    }
+    close(fd) ;
+
+    strncpy(tsm_dev.key_file, locator_name.c_str(), sizeof(tsm_dev.key_file) - 1) ;
+    tsm_dev.size = (int)size ;
+    if ( tsm_init(&tsm_dev) != TSM_SUCCESS ) {
+        message_publish(MSG_ERROR, "Data Record live tap %s could not create its shared memory.\n", locator_name.c_str()) ;
+        tsm_dev.addr = NULL ;
+        return -1 ;
+    }
+
+    struct shmid_ds ds ;
+    if ( shmctl(tsm_dev.shmid, IPC_STAT, &ds) == 0 ) {
+        ds.shm_perm.mode = 0644 ;
+        shmctl(tsm_dev.shmid, IPC_SET, &ds) ;
+    }
+
+    char * segment = (char *)tsm_dev.addr ;
+    memset(segment, 0, size) ;
+    DRLiveTapHeader * header = (DRLiveTapHeader *)segment ;
+    memcpy(header->keyword, DR_LIVE_TAP_KEYWORD, sizeof(header->keyword)) ;
+    header->version = DR_LIVE_TAP_VERSION ;
+    header->num_vars = vars.size() ;
+    header->record_bytes = record_bytes ;
+    header->num_rows = num_rows ;
+    header->slot_bytes = slot_bytes ;
+    header->rows_offset = rows_offset ;
+    header->open = 1 ;
+    if ( ! desc.empty() ) {
+        memcpy(segment + sizeof(DRLiveTapHeader), &desc[0], desc.size()) ;
+    }
+    rows = segment + rows_offset ;
+    rows_written = 0 ;
+
+    std::ofstream locator(locator_name.c_str()) ;
+    locator << "key 0x" << std::hex << tsm_dev.key << std::dec << " shmid " << tsm_dev.shmid
+     << " size " << tsm_dev.size << std::endl ;
+
+    return 0 ;
+}
+
+/**
+@details
+-# Mark the slot of the next row as being written
+-# Copy the record
+-# Mark the row complete, then publish the new row count.  Readers that see the count see the row.
+*/
+void Trick::DRLiveTap::publish( const char * record ) {
+
+    if ( rows == NULL ) {
+        return ;
+    }
+
+    char * slot = rows + (size_t)(rows_written % num_rows) * slot_bytes ;
+    uint64_t * seq = (uint64_t *)slot ;
+
+    __atomic_store_n(seq, 2 * rows_written + 1, __ATOMIC_RELAXED) ;
+    __atomic_thread_fence(__ATOMIC_RELEASE) ;
+    memcpy(slot + sizeof(uint64_t), record, record_bytes) ;
+    __atomic_store_n(seq, 2 * (rows_written + 1), __ATOMIC_RELEASE) ;
+
+    rows_written++ ;
+    __atomic_store_n(&((DRLiveTapHeader *)tsm_dev.addr)->rows_written, (uint64_t)rows_written, __ATOMIC_RELEASE) ;
+}
+
+/**
+@details
+-# Mark the segment closed so readers know no more rows are coming
+-# Mark the segment for removal and detach from it.  Attached readers keep it until they detach.
+*/
+void Trick::DRLiveTap::shutdown() {
+
+    if ( tsm_dev.addr == NULL ) {
+        return ;
+    }
+    __atomic_store_n(&((DRLiveTapHeader *)tsm_dev.addr)->open, (uint64_t)0, __ATOMIC_RELEASE) ;
+    shmctl(tsm_dev.shmid, IPC_RMID, NULL) ;
+    tsm_disconnect(&tsm_dev) ;
+    tsm_dev.addr = NULL ;
+    rows = NULL ;
+}
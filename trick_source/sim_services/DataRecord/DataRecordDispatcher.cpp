@@ -29,51 +29,136 @@ Trick::DRDMutexes::DRDMutexes() {
     pthread_mutex_init(&dr_go_mutex, NULL);
     pthread_cond_init(&init_complete_cv, NULL);
     pthread_mutex_init(&init_complete_mutex, NULL);
+    pthread_rwlock_init(&groups_rwlock, NULL);
     cancelled = false;
+    pass = 0 ;
+    num_writers = 1 ;
+    num_waiting = 0 ;
 }
 
-Trick::DRDWriterThread::DRDWriterThread(DRDMutexes & in_mutexes, std::vector <Trick::DataRecordGroup *> & in_groups) :
- SysThread("DR_Writer"),
+static std::string writer_thread_name( unsigned int writer_id ) {
+    if ( writer_id == 0 ) {
+        return "DR_Writer" ;
+    }
+    std::ostringstream oss ;
+    oss << "DR_Writer_" << writer_id ;
+    return oss.str() ;
+}
+
+Trick::DRDWriterThread::DRDWriterThread(DRDMutexes & in_mutexes, std::vector <Trick::DataRecordGroup *> & in_groups,
+ unsigned int in_writer_id) :
+ SysThread(writer_thread_name(in_writer_id)),
  drd_mutexes(in_mutexes) ,
- groups(in_groups) {}
+ groups(in_groups) ,
+ writer_id(in_writer_id) {}
 
+/**
+@details
+-# Signal the main thread that this writer is ready
+-# Until cancelled
+   -# If the write pass number has not changed, announce that this writer is sleeping and wait
+      for the condition variable.  The pass is checked again after announcing so a pass started
+      in between is not missed.
+   -# Write the groups due in the current pass.  The dispatcher mutex is not held while writing so
+      the other writers in the pool run at the same time.  A writer that finds a new pass when it
+      finishes goes straight to it without sleeping.
+*/
 void * Trick::DRDWriterThread::thread_body() {
+    unsigned long long my_pass ;
+
     pthread_mutex_lock(&(drd_mutexes.dr_go_mutex));
+    my_pass = __atomic_load_n(&drd_mutexes.pass, __ATOMIC_SEQ_CST) ;
 
     /* tell the main thread that the writer is ready to go */
     pthread_mutex_lock(&(drd_mutexes.init_complete_mutex));
     pthread_cond_signal(&(drd_mutexes.init_complete_cv));
     pthread_mutex_unlock(&(drd_mutexes.init_complete_mutex));
+    pthread_mutex_unlock(&(drd_mutexes.dr_go_mutex));
 
-    /* from now until death, wait for the condition variable,
+    /* from now until death, wait for a new write pass,
        then call the write_data method for all of the groups */
     while(1) {
-        pthread_cond_wait(&(drd_mutexes.dr_go_cv), &(drd_mutexes.dr_go_mutex));
-        if (drd_mutexes.cancelled) {
+        if ( my_pass == __atomic_load_n(&drd_mutexes.pass, __ATOMIC_SEQ_CST) ) {
+            pthread_mutex_lock(&(drd_mutexes.dr_go_mutex));
+            __atomic_add_fetch(&drd_mutexes.num_waiting, 1, __ATOMIC_SEQ_CST) ;
+            while ( my_pass == __atomic_load_n(&drd_mutexes.pass, __ATOMIC_SEQ_CST) and ! drd_mutexes.cancelled ) {
+                pthread_cond_wait(&(drd_mutexes.dr_go_cv), &(drd_mutexes.dr_go_mutex));
+            }
+            __atomic_sub_fetch(&drd_mutexes.num_waiting, 1, __ATOMIC_SEQ_CST) ;
             pthread_mutex_unlock(&(drd_mutexes.dr_go_mutex));
-            pthread_exit(0);
         }
-        for ( unsigned int ii = 0 ; ii < groups.size() ; ii++ ) {
-            if ( groups[ii]->buffer_type == Trick::DR_Buffer ) {
-                groups[ii]->write_data(true) ;
-            }
+        if (drd_mutexes.cancelled) {
+            pthread_exit(0);
         }
+        my_pass = __atomic_load_n(&drd_mutexes.pass, __ATOMIC_SEQ_CST) ;
+
+        write_groups(my_pass) ;
     }
-    pthread_mutex_unlock(&(drd_mutexes.dr_go_mutex));
     return NULL ;
 }
 
+/**
+@details
+-# Walk the groups starting at an offset based on the writer id so the writers start on different groups.
+-# Skip groups that are not DR_Buffer groups and have no triggered capture waiting, or are assigned to a
+   different writer.
+-# Write the rest.  A group held by another writer is left to that writer.
+*/
+void Trick::DRDWriterThread::write_groups( unsigned long long pass ) {
+    unsigned int num_writers = drd_mutexes.num_writers ;
+
+    pthread_rwlock_rdlock(&(drd_mutexes.groups_rwlock));
+    unsigned int num_groups = groups.size() ;
+    for ( unsigned int ii = 0 ; ii < num_groups ; ii++ ) {
+        Trick::DataRecordGroup * drg = groups[(ii + writer_id) % num_groups] ;
+        if ( drg->buffer_type != Trick::DR_Buffer and ! drg->capture_pending() ) {
+            continue ;
+        }
+        if ( drg->writer_thread >= 0 and ((unsigned int)drg->writer_thread % num_writers) != writer_id ) {
+            continue ;
+        }
+        drg->dispatch_write(pass) ;
+    }
+    pthread_rwlock_unlock(&(drd_mutexes.groups_rwlock));
+}
+
+unsigned int Trick::DRDWriterThread::get_writer_id() {
+    return writer_id ;
+}
+
 void Trick::DRDWriterThread::dump( std::ostream & oss ) {
     oss << "Trick::DRDWriterThread (" << name << ")" << std::endl ;
+    oss << "    writer id = " << writer_id << " of " << drd_mutexes.num_writers << std::endl ;
     oss << "    number of data record groups = " << groups.size() << std::endl ;
     Trick::ThreadBase::dump(oss) ;
 }
 
-Trick::DataRecordDispatcher::DataRecordDispatcher() : drd_writer_thread(drd_mutexes, groups) {
+Trick::DRTriggerSubscriber::DRTriggerSubscriber(Trick::DataRecordDispatcher & in_drd) :
+ drd(in_drd) {
+    name = "data_record_trigger" ;
+}
+
+void Trick::DRTriggerSubscriber::update( unsigned int level , std::string header __attribute__((unused)) ,
+ std::string message __attribute__((unused)) ) {
+    if ( enabled and level == MSG_ERROR ) {
+        drd.trigger_on_error() ;
+    }
+}
+
+Trick::DataRecordDispatcher::DataRecordDispatcher() :
+ drd_writer_thread(drd_mutexes, groups) ,
+ writer_wake_frames(10) ,
+ writer_wake_fill(0.25) ,
+ frames_since_wake(0) ,
+ wake_owed(false) ,
+ trigger_subscriber(*this) {
     the_drd = this ;
 }
 
 Trick::DataRecordDispatcher::~DataRecordDispatcher() {
+    for ( unsigned int ii = 0 ; ii < extra_writer_threads.size() ; ii++ ) {
+        delete extra_writer_threads[ii] ;
+    }
 }
 
 int Trick::DataRecordDispatcher::remove_files() {
@@ -81,25 +166,73 @@ int Trick::DataRecordDispatcher::remove_files() {
     std::string command;
     command = std::string("/bin/rm -rf ") + command_line_args_get_output_dir() + std::string("/log_*") ;
     system(command.c_str());
+    command = std::string("/bin/rm -rf ") + command_line_args_get_output_dir() + std::string("/trigger_*") ;
+    system(command.c_str());
     return 0 ;
 }
 
 /**
 @details
 -# Initialize thread mutex and condition variable
--# Create a new thread calling the DataRecordThreaded Writer routine.
--# Wait for the data record thread to initialize before continuing.
+-# For each writer in the pool
+   -# Create a new thread calling the DataRecordThreaded Writer routine.
+   -# Wait for the data record thread to initialize before continuing.
+-# Subscribe to messages so error messages trigger captures
 */
 int Trick::DataRecordDispatcher::init() {
 
-    pthread_mutex_lock(&drd_mutexes.init_complete_mutex);
-    drd_writer_thread.create_thread() ;
-    pthread_cond_wait(&drd_mutexes.init_complete_cv, &drd_mutexes.init_complete_mutex);
-    pthread_mutex_unlock(&drd_mutexes.init_complete_mutex);
+    for ( unsigned int ii = 0 ; ii < drd_mutexes.num_writers ; ii++ ) {
+        pthread_mutex_lock(&drd_mutexes.init_complete_mutex);
+        get_writer_thread(ii)->create_thread() ;
+        pthread_cond_wait(&drd_mutexes.init_complete_cv, &drd_mutexes.init_complete_mutex);
+        pthread_mutex_unlock(&drd_mutexes.init_complete_mutex);
+    }
+    message_add_subscriber(&trigger_subscriber) ;
 
     return(0) ;
 }
 
+/**
+@details
+-# Return an error if the writers have already been started.
+-# Create writer thread objects for the writers beyond drd_writer_thread.  The threads are
+   created now so that their cpu affinity and priority can be set before initialization.
+*/
+int Trick::DataRecordDispatcher::set_num_writer_threads( unsigned int num ) {
+
+    if ( drd_writer_thread.get_pthread_id() != 0 ) {
+        message_publish(MSG_ERROR, "Data Record writer threads must be set before initialization.\n") ;
+        return -1 ;
+    }
+    if ( num < 1 ) {
+        num = 1 ;
+    }
+    while ( extra_writer_threads.size() + 1 > num ) {
+        delete extra_writer_threads.back() ;
+        extra_writer_threads.pop_back() ;
+    }
+    while ( extra_writer_threads.size() + 1 < num ) {
+        extra_writer_threads.push_back(new Trick::DRDWriterThread(drd_mutexes, groups, extra_writer_threads.size() + 1)) ;
+    }
+    drd_mutexes.num_writers = num ;
+
+    return 0 ;
+}
+
+unsigned int Trick::DataRecordDispatcher::get_num_writer_threads() {
+    return drd_mutexes.num_writers ;
+}
+
+Trick::DRDWriterThread * Trick::DataRecordDispatcher::get_writer_thread( unsigned int id ) {
+    if ( id == 0 ) {
+        return &drd_writer_thread ;
+    }
+    if ( id <= extra_writer_threads.size() ) {
+        return extra_writer_threads[id - 1] ;
+    }
+    return NULL ;
+}
+
 /**
 add_sim_object is called by the executive when a new sim_object is added to the sim.
 @details
@@ -109,7 +242,9 @@ add_sim_object is called by the executive when a new sim_object is added to the
 int Trick::DataRecordDispatcher::add_sim_object(Trick::SimObject * in_object ) {
     Trick::DataRecordGroup * drg = dynamic_cast< Trick::DataRecordGroup * >(in_object) ;
     if ( drg != NULL ) {
+        pthread_rwlock_wrlock(&drd_mutexes.groups_rwlock) ;
         groups.push_back(drg) ;
+        pthread_rwlock_unlock(&drd_mutexes.groups_rwlock) ;
     }
     return 0 ;
 }
@@ -153,11 +288,11 @@ int Trick::DataRecordDispatcher::remove_group(Trick::DataRecordGroup * in_group)
     // remove the group from the dispatcher vector of jobs.
     for ( drg_it = groups.begin() ; drg_it != groups.end() ; ) {
         if ( (*drg_it) == in_group ) {
-            // erase the group from the dispatcher. Lock the mutex so we aren't in the
-            // middle of writing data as we delete the group.
-            pthread_mutex_lock(&drd_mutexes.dr_go_mutex) ;
+            // erase the group from the dispatcher. Lock the group list so no writer is
+            // in the middle of writing data as we delete the group.
+            pthread_rwlock_wrlock(&drd_mutexes.groups_rwlock) ;
             drg_it = groups.erase(drg_it) ;
-            pthread_mutex_unlock(&drd_mutexes.dr_go_mutex) ;
+            pthread_rwlock_unlock(&drd_mutexes.groups_rwlock) ;
 
             // call exec_remove_sim_object to remove the data recording jobs from the sim.
             exec_remove_sim_object(in_group) ;
@@ -191,19 +326,79 @@ Trick::DataRecordGroup * Trick::DataRecordDispatcher::get_group(std::string in_n
 
 /**
 @details
--# If the writer thread condition variable is unlocked
-   -# Signal the thread to go
+Tests if any group has enough records waiting to be worth waking the writers.  The groups are not tested if
+the group list is being changed.
+-# Return true if any group has a triggered capture waiting
+-# Return true if any DR_Buffer group's recording buffer is #writer_wake_fill full, or holds any records at
+   all when @c interval_done is set
+*/
+bool Trick::DataRecordDispatcher::writers_needed( bool interval_done ) {
+    bool needed = false ;
+    if ( pthread_rwlock_tryrdlock(&drd_mutexes.groups_rwlock) ) {
+        return interval_done ;
+    }
+    for ( unsigned int ii = 0 ; ii < groups.size() and ! needed ; ii++ ) {
+        Trick::DataRecordGroup * drg = groups[ii] ;
+        if ( drg->capture_pending() ) {
+            needed = true ;
+        } else if ( drg->buffer_type == Trick::DR_Buffer ) {
+            unsigned int pending = drg->pending_records() ;
+            needed = pending > 0 and ( interval_done or pending >= drg->max_num * writer_wake_fill ) ;
+        }
+    }
+    pthread_rwlock_unlock(&drd_mutexes.groups_rwlock) ;
+    return needed ;
+}
+
+/**
+@details
+Called at the end of every frame from the main thread.  The writers are woken when there is enough to write,
+not every frame.  No lock is taken unless a writer is asleep and needs to be woken.
+-# Return unless a wake up is owed or writers_needed finds work.  After #writer_wake_frames frames without a
+   wake up any record waiting is enough.
+-# Start a new write pass.  Busy writers pick the pass up when they finish their current one.
+-# If any writer is sleeping and the writer thread condition variable is unlocked
+   -# Signal the threads to go
+-# If the condition variable was locked, a writer is on its way to sleep.  Retry on the next frame.
 */
 int Trick::DataRecordDispatcher::signal_thread() {
 
-    if (!pthread_mutex_trylock(&drd_mutexes.dr_go_mutex)) {
-        pthread_cond_signal(&drd_mutexes.dr_go_cv);
-        pthread_mutex_unlock(&drd_mutexes.dr_go_mutex);
+    bool interval_done = ++frames_since_wake >= writer_wake_frames ;
+    if ( ! wake_owed and ! writers_needed(interval_done) ) {
+        return(0) ;
     }
+    frames_since_wake = 0 ;
 
+    if ( ! wake_owed ) {
+        __atomic_add_fetch(&drd_mutexes.pass, 1, __ATOMIC_SEQ_CST) ;
+    }
+    wake_owed = false ;
+    if ( __atomic_load_n(&drd_mutexes.num_waiting, __ATOMIC_SEQ_CST) > 0 ) {
+        if (!pthread_mutex_trylock(&drd_mutexes.dr_go_mutex)) {
+            pthread_cond_broadcast(&drd_mutexes.dr_go_cv);
+            pthread_mutex_unlock(&drd_mutexes.dr_go_mutex);
+        } else {
+            wake_owed = true ;
+        }
+    }
+
+    return(0) ;
+}
+
+int Trick::DataRecordDispatcher::set_writer_wake_frames( unsigned int frames ) {
+    writer_wake_frames = (frames < 1) ? 1 : frames ;
+    return(0) ;
+}
+
+int Trick::DataRecordDispatcher::set_writer_wake_fill( double fill ) {
+    writer_wake_fill = (fill < 0.0) ? 0.0 : (fill > 1.0) ? 1.0 : fill ;
     return(0) ;
 }
 
+unsigned long long Trick::DataRecordDispatcher::get_write_pass() {
+    return __atomic_load_n(&drd_mutexes.pass, __ATOMIC_SEQ_CST) ;
+}
+
 /**
 @details
 -# Close out current data record groups
@@ -213,10 +408,12 @@ int Trick::DataRecordDispatcher::signal_thread() {
 int Trick::DataRecordDispatcher::preload_checkpoint() {
     unsigned int ii ;
     // close out current data record groups
+    pthread_rwlock_wrlock(&drd_mutexes.groups_rwlock) ;
     for ( ii = 0 ; ii < groups.size() ; ii++ ) {
         groups[ii]->shutdown() ;
     }
     groups.clear() ;
+    pthread_rwlock_unlock(&drd_mutexes.groups_rwlock) ;
     return 0 ;
 }
 
@@ -237,18 +434,26 @@ int Trick::DataRecordDispatcher::restart() {
 
 /**
 @details
--# If the thread was started,
-   -# Wait for the thread to be available
-   -# Cancel the thread
+-# Stop listening for error messages
+-# If the threads were started,
+   -# Wait for the threads to be available
+   -# Cancel the threads
+   -# Join the threads, so a writer in the middle of a pass finishes it before the groups close their files
 */
 int Trick::DataRecordDispatcher::shutdown() {
 
+    message_remove_subscriber(&trigger_subscriber) ;
+
     if ( drd_writer_thread.get_pthread_id() != 0 ) {
         pthread_mutex_lock( &drd_mutexes.dr_go_mutex);
         // pthread_cancel( drd_writer_thread.get_pthread_id()) ;
         drd_mutexes.cancelled = true;
-        pthread_cond_signal(&drd_mutexes.dr_go_cv);
+        pthread_cond_broadcast(&drd_mutexes.dr_go_cv);
         pthread_mutex_unlock( &drd_mutexes.dr_go_mutex);
+
+        for ( unsigned int ii = 0 ; ii < drd_mutexes.num_writers ; ii++ ) {
+            get_writer_thread(ii)->join_thread() ;
+        }
     }
 
     return(0) ;
@@ -283,6 +488,51 @@ int Trick::DataRecordDispatcher::record_now_group( const char * in_name ) {
     return 0 ;
 }
 
+/**
+@details
+-# If a group is named, trigger it and return its result
+-# Otherwise trigger every group with triggered captures turned on
+*/
+int Trick::DataRecordDispatcher::trigger( const char * in_name ) {
+    unsigned int ii ;
+    int ret = 0 ;
+    bool found = false ;
+    for ( ii = 0 ; ii < groups.size() ; ii++ ) {
+        if ( in_name == NULL ) {
+            if ( groups[ii]->trigger_enabled ) {
+                groups[ii]->trigger() ;
+            }
+        } else if ( !groups[ii]->get_group_name().compare(in_name) ) {
+            found = true ;
+            ret = groups[ii]->trigger() ;
+        }
+    }
+    if ( in_name != NULL and ! found ) {
+        message_publish(MSG_WARNING, "Data Record group %s not found, capture not triggered.\n", in_name) ;
+        ret = -1 ;
+    }
+    return ret ;
+}
+
+/**
+@details
+Called by the trigger subscriber from the thread publishing the error.  The group list is skipped
+if it is being changed.
+-# Trigger every DR_Ring_Buffer group set to trigger on errors
+*/
+void Trick::DataRecordDispatcher::trigger_on_error() {
+    unsigned int ii ;
+    if ( ! pthread_rwlock_tryrdlock(&drd_mutexes.groups_rwlock) ) {
+        for ( ii = 0 ; ii < groups.size() ; ii++ ) {
+            if ( groups[ii]->trigger_on_error and groups[ii]->trigger_enabled and
+                 groups[ii]->buffer_type == Trick::DR_Ring_Buffer ) {
+                groups[ii]->trigger() ;
+            }
+        }
+        pthread_rwlock_unlock(&drd_mutexes.groups_rwlock) ;
+    }
+}
+
 int Trick::DataRecordDispatcher::set_group_max_file_size(const char * in_name, uint64_t bytes){
     unsigned int ii ;
     for ( ii = 0 ; ii < groups.size() ; ii++ ) {
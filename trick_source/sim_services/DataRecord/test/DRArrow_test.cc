@@ -0,0 +1,227 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DRArrow recording format )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRArrow.hh"
+
+/*
+ One message of an Arrow IPC stream, the flatbuffer metadata and the body that follows it.
+ */
+struct ArrowMessage {
+    std::vector <unsigned char> metadata;
+    std::vector <unsigned char> body;
+};
+
+/*
+ Test Fixture.  Groups record to DRArrow_test_output.  The stream is read back by walking its messages and the
+ few flatbuffer fields the tests need, there is no Arrow library to read it with.
+ */
+class DRArrow_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+        double value;
+        int count;
+        bool flag;
+
+		DRArrow_test() : value(0.0), count(0), flag(false) {
+            (void) system("rm -rf DRArrow_test_output");
+            mkdir("DRArrow_test_output", 0755);
+            cmd_args.set_output_dir("DRArrow_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+            (void) memmgr.declare_extern_var(&count, "int count");
+            (void) memmgr.declare_extern_var(&flag, "bool flag");
+        }
+		~DRArrow_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+
+        template <class T> static T get(const std::vector <unsigned char> & buf, size_t pos) {
+            T t;
+            memcpy(&t, &buf[pos], sizeof(T));
+            return t;
+        }
+
+        // The position of field id of the table at table_pos, 0 if the field is not set
+        static size_t field(const std::vector <unsigned char> & buf, size_t table_pos, unsigned int id) {
+            size_t vtable_pos = table_pos - get<int32_t>(buf, table_pos);
+            uint16_t vtable_size = get<uint16_t>(buf, vtable_pos);
+            if (4 + 2 * id >= vtable_size) {
+                return 0;
+            }
+            uint16_t offset = get<uint16_t>(buf, vtable_pos + 4 + 2 * id);
+            return offset ? table_pos + offset : 0;
+        }
+
+        static size_t follow(const std::vector <unsigned char> & buf, size_t pos) {
+            return pos + get<uint32_t>(buf, pos);
+        }
+
+        // Splits the stream into its messages.  Returns false if the stream does not end with the end of stream marker.
+        bool read_stream(std::string file_name, std::vector <ArrowMessage> & messages) {
+            std::ifstream in(file_name.c_str(), std::ios::binary);
+            std::vector <unsigned char> stream((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            size_t pos = 0;
+            while (pos + 8 <= stream.size()) {
+                EXPECT_EQ(get<uint32_t>(stream, pos), 0xFFFFFFFF);
+                uint32_t metadata_size = get<uint32_t>(stream, pos + 4);
+                pos += 8;
+                if (metadata_size == 0) {
+                    return pos == stream.size();
+                }
+                // The body starts on an 8 byte boundary
+                EXPECT_EQ((pos + metadata_size) % 8, 0);
+                ArrowMessage message;
+                message.metadata.assign(stream.begin() + pos, stream.begin() + pos + metadata_size);
+                pos += metadata_size;
+                int64_t body_length = get<int64_t>(message.metadata, field(message.metadata, follow(message.metadata, 0), 3));
+                if (pos + body_length > stream.size()) {
+                    return false;
+                }
+                message.body.assign(stream.begin() + pos, stream.begin() + pos + body_length);
+                pos += body_length;
+                messages.push_back(message);
+            }
+            return false;
+        }
+
+        static uint8_t header_type(const ArrowMessage & message) {
+            return get<uint8_t>(message.metadata, field(message.metadata, follow(message.metadata, 0), 1));
+        }
+
+        static size_t header(const ArrowMessage & message) {
+            return follow(message.metadata, field(message.metadata, follow(message.metadata, 0), 2));
+        }
+
+        // The number of rows in a record batch
+        static int64_t batch_length(const ArrowMessage & message) {
+            return get<int64_t>(message.metadata, field(message.metadata, header(message), 0));
+        }
+
+        // The values of a column of a record batch, the data buffer follows the validity buffer of each column
+        template <class T> static std::vector <T> batch_column(const ArrowMessage & message, unsigned int column) {
+            size_t buffers = follow(message.metadata, field(message.metadata, header(message), 2));
+            size_t data_buffer = buffers + 4 + 16 * (2 * column + 1);
+            int64_t offset = get<int64_t>(message.metadata, data_buffer);
+            int64_t length = get<int64_t>(message.metadata, data_buffer + 8);
+            std::vector <T> values(length / sizeof(T));
+            if (length > 0) {
+                memcpy(&values[0], &message.body[offset], values.size() * sizeof(T));
+            }
+            return values;
+        }
+};
+
+TEST_F(DRArrow_test, round_trip) {
+    // ARRANGE
+    Trick::DRArrow group("arrow");
+    group.add_variable("value");
+    group.add_variable("count");
+    group.set_max_batch_rows(100);
+    group.init();
+
+    // ACT
+    const int num_records = 250;
+    for (int ii = 0; ii < num_records; ii++) {
+        value = ii * 0.5;
+        count = -ii;
+        group.data_record(ii * 0.1);
+    }
+    group.shutdown();
+
+    // ASSERT
+    // A schema, then full batches and the rest in a last batch
+    std::vector <ArrowMessage> messages;
+    ASSERT_TRUE(read_stream("DRArrow_test_output/log_arrow.arrows", messages));
+    ASSERT_EQ(messages.size(), 4);
+    EXPECT_EQ(header_type(messages[0]), 1);
+    EXPECT_TRUE(messages[0].body.empty());
+
+    int row = 0;
+    for (unsigned int ii = 1; ii < messages.size(); ii++) {
+        EXPECT_EQ(header_type(messages[ii]), 3);
+        int64_t length = batch_length(messages[ii]);
+        EXPECT_EQ(length, ii < 3 ? 100 : 50);
+        std::vector <double> times = batch_column<double>(messages[ii], 0);
+        std::vector <double> values = batch_column<double>(messages[ii], 1);
+        std::vector <int32_t> counts = batch_column<int32_t>(messages[ii], 2);
+        ASSERT_EQ(times.size(), length);
+        ASSERT_EQ(values.size(), length);
+        ASSERT_EQ(counts.size(), length);
+        for (int jj = 0; jj < length; jj++, row++) {
+            EXPECT_EQ(times[jj], row * 0.1);
+            EXPECT_EQ(values[jj], row * 0.5);
+            EXPECT_EQ(counts[jj], -row);
+        }
+    }
+    EXPECT_EQ(row, num_records);
+}
+
+TEST_F(DRArrow_test, booleans_packed) {
+    // ARRANGE
+    Trick::DRArrow group("packed");
+    group.add_variable("flag");
+    group.init();
+
+    // ACT
+    for (int ii = 0; ii < 10; ii++) {
+        flag = (ii % 3 == 0);
+        group.data_record(ii * 0.1);
+    }
+    group.shutdown();
+
+    // ASSERT
+    // Rows 0, 3, 6 and 9 are set, one bit a row
+    std::vector <ArrowMessage> messages;
+    ASSERT_TRUE(read_stream("DRArrow_test_output/log_packed.arrows", messages));
+    ASSERT_EQ(messages.size(), 2);
+    EXPECT_EQ(batch_length(messages[1]), 10);
+    std::vector <uint8_t> bits = batch_column<uint8_t>(messages[1], 1);
+    ASSERT_EQ(bits.size(), 2);
+    EXPECT_EQ(bits[0], 0x49);
+    EXPECT_EQ(bits[1], 0x02);
+}
+
+TEST_F(DRArrow_test, batch_each_write) {
+    // ARRANGE
+    Trick::DRArrow group("cycles");
+    group.add_variable("value");
+    group.init();
+
+    // ACT
+    // Records gathered in a write cycle go out as one batch, readers of a running sim see them
+    for (int ii = 0; ii < 30; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+        if (ii % 10 == 9) {
+            group.write_data(true);
+        }
+    }
+    group.shutdown();
+
+    // ASSERT
+    std::vector <ArrowMessage> messages;
+    ASSERT_TRUE(read_stream("DRArrow_test_output/log_cycles.arrows", messages));
+    ASSERT_EQ(messages.size(), 4);
+    for (unsigned int ii = 1; ii < messages.size(); ii++) {
+        EXPECT_EQ(batch_length(messages[ii]), 10);
+        std::vector <double> values = batch_column<double>(messages[ii], 1);
+        ASSERT_EQ(values.size(), 10);
+        EXPECT_EQ(values.front(), (ii - 1) * 10);
+    }
+}
@@ -0,0 +1,167 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DRAscii recording format )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRAscii.hh"
+
+/*
+ Test Fixture.  Groups record to DRAscii_test_output.
+ */
+class DRAscii_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+		DRAscii_test() {
+            (void) system("rm -rf DRAscii_test_output");
+            mkdir("DRAscii_test_output", 0755);
+            cmd_args.set_output_dir("DRAscii_test_output");
+        }
+		~DRAscii_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+
+        // The fields of each record of a DRAscii log, without the header
+        static std::vector< std::vector<std::string> > read_rows(std::string file_name) {
+            std::vector< std::vector<std::string> > rows;
+            std::ifstream in(file_name.c_str());
+            std::string line;
+            std::getline(in, line);
+            while (std::getline(in, line)) {
+                std::vector<std::string> fields;
+                std::stringstream ss(line);
+                std::string field;
+                while (std::getline(ss, field, ',')) {
+                    fields.push_back(field);
+                }
+                // getline drops an empty last field
+                if (!line.empty() and line[line.size() - 1] == ',') {
+                    fields.push_back("");
+                }
+                rows.push_back(fields);
+            }
+            return rows;
+        }
+
+        template <class T> static std::string printed(const char * format, T value) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), format, value);
+            return buf;
+        }
+};
+
+TEST_F(DRAscii_test, integers_match_printf) {
+    // ARRANGE
+    short s;
+    unsigned short us;
+    int i;
+    unsigned int ui;
+    long l;
+    unsigned long ul;
+    long long ll;
+    unsigned long long ull;
+    unsigned char uc;
+    (void) memmgr.declare_extern_var(&s, "short s");
+    (void) memmgr.declare_extern_var(&us, "unsigned short us");
+    (void) memmgr.declare_extern_var(&i, "int i");
+    (void) memmgr.declare_extern_var(&ui, "unsigned int ui");
+    (void) memmgr.declare_extern_var(&l, "long l");
+    (void) memmgr.declare_extern_var(&ul, "unsigned long ul");
+    (void) memmgr.declare_extern_var(&ll, "long long ll");
+    (void) memmgr.declare_extern_var(&ull, "unsigned long long ull");
+    (void) memmgr.declare_extern_var(&uc, "unsigned char uc");
+    Trick::DRAscii group("integers");
+    const char * names[] = {"s", "us", "i", "ui", "l", "ul", "ll", "ull", "uc"};
+    for (int jj = 0; jj < 9; jj++) {
+        group.add_variable(names[jj]);
+    }
+    group.init();
+
+    // ACT
+    // The least value, -1, 0, 1 and the greatest value of each type
+    std::vector< std::vector<std::string> > expected;
+    for (int ii = 0; ii < 5; ii++) {
+        switch (ii) {
+            case 0:
+                s = std::numeric_limits<short>::min(); i = std::numeric_limits<int>::min();
+                l = std::numeric_limits<long>::min(); ll = std::numeric_limits<long long>::min();
+                us = 0; ui = 0; ul = 0; ull = 0; uc = 0;
+                break;
+            case 4:
+                s = std::numeric_limits<short>::max(); i = std::numeric_limits<int>::max();
+                l = std::numeric_limits<long>::max(); ll = std::numeric_limits<long long>::max();
+                us = std::numeric_limits<unsigned short>::max(); ui = std::numeric_limits<unsigned int>::max();
+                ul = std::numeric_limits<unsigned long>::max(); ull = std::numeric_limits<unsigned long long>::max();
+                uc = std::numeric_limits<unsigned char>::max();
+                break;
+            default:
+                s = i = l = ll = ii - 2;
+                us = ui = ul = ull = uc = ii - 1;
+                break;
+        }
+        std::vector<std::string> fields;
+        fields.push_back(printed("%d", s));
+        fields.push_back(printed("%u", us));
+        fields.push_back(printed("%d", i));
+        fields.push_back(printed("%u", ui));
+        fields.push_back(printed("%ld", l));
+        fields.push_back(printed("%lu", ul));
+        fields.push_back(printed("%lld", ll));
+        fields.push_back(printed("%llu", ull));
+        fields.push_back(printed("%u", uc));
+        expected.push_back(fields);
+        group.data_record(ii * 0.1);
+    }
+    group.shutdown();
+
+    // ASSERT
+    std::vector< std::vector<std::string> > rows = read_rows("DRAscii_test_output/log_integers.csv");
+    ASSERT_EQ(rows.size(), 5);
+    EXPECT_EQ(rows[0][3], "-2147483648");
+    EXPECT_EQ(rows[2][3], "0");
+    EXPECT_EQ(rows[4][8], "18446744073709551615");
+    for (unsigned int ii = 0; ii < rows.size(); ii++) {
+        ASSERT_EQ(rows[ii].size(), 10);
+        for (unsigned int jj = 0; jj < 9; jj++) {
+            EXPECT_EQ(rows[ii][jj + 1], expected[ii][jj]) << "record " << ii << " " << names[jj];
+        }
+    }
+}
+
+TEST_F(DRAscii_test, characters) {
+    // ARRANGE
+    char c = 'A';
+    (void) memmgr.declare_extern_var(&c, "char c");
+    Trick::DRAscii group("characters");
+    group.add_variable("c");
+    group.init();
+
+    // ACT
+    // A NUL character is written as nothing
+    group.data_record(0.0);
+    c = '\0';
+    group.data_record(0.1);
+    group.shutdown();
+
+    // ASSERT
+    std::vector< std::vector<std::string> > rows = read_rows("DRAscii_test_output/log_characters.csv");
+    ASSERT_EQ(rows.size(), 2);
+    ASSERT_EQ(rows[0].size(), 2);
+    EXPECT_EQ(rows[0][1], "A");
+    ASSERT_EQ(rows[1].size(), 2);
+    EXPECT_EQ(rows[1][1], "");
+}
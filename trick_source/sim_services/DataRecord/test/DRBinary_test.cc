@@ -0,0 +1,255 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DRBinary recording format )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRBinary.hh"
+#include "TrickBinary.hh"
+#include "TrickCompressed.hh"
+#include "TrickSegments.hh"
+
+/*
+ Test Fixture.  Groups record to DRBinary_test_output and are read back with the data products readers.
+ */
+class DRBinary_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+        double value;
+        int count;
+
+		DRBinary_test() : value(0.0), count(0) {
+            (void) system("rm -rf DRBinary_test_output");
+            mkdir("DRBinary_test_output", 0755);
+            cmd_args.set_output_dir("DRBinary_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+            (void) memmgr.declare_extern_var(&count, "int count");
+        }
+		~DRBinary_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+
+        // Records the same smooth signal and wandering counter into each group
+        void record(Trick::DRBinary & group, int num_records) {
+            for (int ii = 0; ii < num_records; ii++) {
+                value = sin(ii * 0.01) * 100.0;
+                count = (ii % 7 == 0) ? -ii : ii / 3;
+                group.data_record(ii * 0.01);
+                if (ii % 100 == 99) {
+                    group.write_data(true);
+                }
+            }
+        }
+
+        static off_t file_size(const char * file_name) {
+            struct stat st;
+            return stat(file_name, &st) == 0 ? st.st_size : -1;
+        }
+
+        static std::string file_contents(const char * file_name) {
+            std::ifstream in(file_name, std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        }
+};
+
+TEST_F(DRBinary_test, uncompressed_round_trip) {
+    // ARRANGE
+    Trick::DRBinary group("plain");
+    group.add_variable("value");
+    group.init();
+
+    // ACT
+    record(group, 1000);
+    group.shutdown();
+
+    // ASSERT
+    char file_name[] = "DRBinary_test_output/log_plain.trk";
+    char param[] = "value";
+    TrickBinary reader(file_name, param);
+    reader.begin();
+    double time, read_value;
+    for (int ii = 0; ii < 1000; ii++) {
+        ASSERT_EQ(reader.get(&time, &read_value), 1);
+        EXPECT_EQ(time, ii * 0.01);
+        EXPECT_EQ(read_value, sin(ii * 0.01) * 100.0);
+    }
+}
+
+TEST_F(DRBinary_test, blocks_match_record_writes) {
+    // ARRANGE
+    // Records are 20 bytes, the small block holds 2 of them
+    Trick::DRBinary rows("rows");
+    rows.set_block_size(0);
+    Trick::DRBinary small("small");
+    small.set_block_size(50);
+    Trick::DRBinary large("large");
+    Trick::DRBinary * groups[] = {&rows, &small, &large};
+    for (int ii = 0; ii < 3; ii++) {
+        groups[ii]->add_variable("value");
+        groups[ii]->add_variable("count");
+        groups[ii]->init();
+    }
+
+    // ACT
+    for (int ii = 0; ii < 3; ii++) {
+        record(*groups[ii], 1001);
+        groups[ii]->shutdown();
+    }
+
+    // ASSERT
+    std::string rows_file = file_contents("DRBinary_test_output/log_rows.trk");
+    ASSERT_GT(rows_file.size(), 1001 * 20);
+    EXPECT_EQ(file_contents("DRBinary_test_output/log_small.trk"), rows_file);
+    EXPECT_EQ(file_contents("DRBinary_test_output/log_large.trk"), rows_file);
+}
+
+TEST_F(DRBinary_test, block_written_each_cycle) {
+    // ARRANGE
+    Trick::DRBinary group("cycle");
+    group.add_variable("value");
+    group.init();
+    off_t header_size = file_size("DRBinary_test_output/log_cycle.trk");
+
+    // ACT
+    // The records wait in the block until the end of the write cycle
+    for (int ii = 0; ii < 10; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    off_t size_recorded = file_size("DRBinary_test_output/log_cycle.trk");
+    group.write_data(true);
+    off_t size_written = file_size("DRBinary_test_output/log_cycle.trk");
+    for (int ii = 10; ii < 15; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    group.shutdown();
+
+    // ASSERT
+    ASSERT_GT(header_size, 0);
+    EXPECT_EQ(size_recorded, header_size);
+    EXPECT_EQ(size_written, header_size + 10 * 16);
+    EXPECT_EQ(file_size("DRBinary_test_output/log_cycle.trk"), header_size + 15 * 16);
+}
+
+TEST_F(DRBinary_test, compressed_round_trip) {
+    // ARRANGE
+    // Small blocks so the log holds many of them
+    Trick::DRBinary group("packed");
+    group.add_variable("value");
+    group.add_variable("count");
+    group.set_compression(true);
+    group.set_block_size(4096);
+    group.set_min_block_size(1024);
+    group.init();
+
+    // ACT
+    const int num_records = 10000;
+    record(group, num_records);
+    group.shutdown();
+
+    // ASSERT
+    // Lossless, every value reads back bit for bit
+    char file_name[] = "DRBinary_test_output/log_packed.trkz";
+    EXPECT_TRUE(TrickCompressedLocateParam(file_name, "value"));
+    EXPECT_TRUE(TrickCompressedLocateParam(file_name, "count"));
+    char value_name[] = "value";
+    TrickCompressed value_reader(file_name, value_name);
+    char count_name[] = "count";
+    TrickCompressed count_reader(file_name, count_name);
+    value_reader.begin();
+    count_reader.begin();
+    double time, read_value;
+    for (int ii = 0; ii < num_records; ii++) {
+        ASSERT_EQ(value_reader.get(&time, &read_value), 1);
+        EXPECT_EQ(time, ii * 0.01);
+        EXPECT_EQ(read_value, sin(ii * 0.01) * 100.0);
+        ASSERT_EQ(count_reader.get(&time, &read_value), 1);
+        EXPECT_EQ(read_value, (ii % 7 == 0) ? -ii : ii / 3);
+    }
+    EXPECT_TRUE(value_reader.end());
+    EXPECT_EQ(value_reader.get(&time, &read_value), 0);
+}
+
+TEST_F(DRBinary_test, compressed_smaller) {
+    // ARRANGE
+    Trick::DRBinary plain("same_plain");
+    plain.add_variable("value");
+    plain.add_variable("count");
+    plain.init();
+    Trick::DRBinary packed("same_packed");
+    packed.add_variable("value");
+    packed.add_variable("count");
+    packed.set_compression(true);
+    packed.init();
+
+    // ACT
+    record(plain, 10000);
+    record(packed, 10000);
+    plain.shutdown();
+    packed.shutdown();
+
+    // ASSERT
+    // The time and counter columns are regular, their deltas take a byte or two a record
+    off_t plain_size = file_size("DRBinary_test_output/log_same_plain.trk");
+    off_t packed_size = file_size("DRBinary_test_output/log_same_packed.trkz");
+    ASSERT_GT(plain_size, 0);
+    ASSERT_GT(packed_size, 0);
+    EXPECT_LT(packed_size, plain_size);
+}
+
+TEST_F(DRBinary_test, rollover_segments) {
+    // ARRANGE
+    // Each segment holds about 60 records
+    Trick::DRBinary group("seg");
+    group.add_variable("value");
+    group.set_rollover(true);
+    group.set_max_file_size(1000);
+    group.init();
+
+    // ACT
+    // Only the writer turns the segments over, recording alone leaves the first file
+    const int num_records = 500;
+    for (int ii = 0; ii < num_records; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    unsigned int segments_recorded = group.segment_num;
+    group.write_data(true);
+    group.shutdown();
+
+    // ASSERT
+    EXPECT_EQ(segments_recorded, 0);
+    std::vector<std::string> paths = TrickSegmentsReadManifest("DRBinary_test_output/log_seg.segments");
+    ASSERT_GT(paths.size(), 5);
+    EXPECT_EQ(paths[0], "DRBinary_test_output/log_seg.trk");
+    EXPECT_EQ(paths[1], "DRBinary_test_output/log_seg.0001.trk");
+    EXPECT_EQ(paths[2], "DRBinary_test_output/log_seg.0002.trk");
+    std::vector<DataStream *> segments;
+    char param[] = "value";
+    for (unsigned int ii = 0; ii < paths.size(); ii++) {
+        // Every segment starts with its own header
+        segments.push_back(new TrickBinary((char *)paths[ii].c_str(), param));
+    }
+    TrickSegments reader("DRBinary_test_output/log_seg.segments", segments);
+    reader.begin();
+    double time, read_value;
+    for (int ii = 0; ii < num_records; ii++) {
+        ASSERT_EQ(reader.get(&time, &read_value), 1);
+        EXPECT_EQ(read_value, ii);
+    }
+    EXPECT_EQ(reader.get(&time, &read_value), 0);
+}
@@ -0,0 +1,113 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DRColumnar recording format )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRColumnar.hh"
+#include "TrickColumnar.hh"
+
+/*
+ Test Fixture.  Groups record to DRColumnar_test_output and are read back with the data products reader.
+ */
+class DRColumnar_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+        double value;
+        int count;
+
+		DRColumnar_test() : value(0.0), count(0) {
+            (void) system("rm -rf DRColumnar_test_output");
+            mkdir("DRColumnar_test_output", 0755);
+            cmd_args.set_output_dir("DRColumnar_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+            (void) memmgr.declare_extern_var(&count, "int count");
+        }
+		~DRColumnar_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+};
+
+TEST_F(DRColumnar_test, round_trip) {
+    // ARRANGE
+    Trick::DRColumnar group("columns");
+    group.add_variable("value");
+    group.add_variable("count");
+    group.set_max_buffer_size(100);
+    group.init();
+
+    // ACT
+    // More records than the first mapping of the columns holds, written in many passes
+    const int num_records = 5000;
+    for (int ii = 0; ii < num_records; ii++) {
+        value = ii * 0.5;
+        count = -ii;
+        group.data_record(ii * 0.1);
+        if (ii % 50 == 49) {
+            group.write_data(true);
+        }
+    }
+    group.shutdown();
+
+    // ASSERT
+    char dir_name[] = "DRColumnar_test_output/log_columns.col";
+    EXPECT_EQ(TrickColumnarGetNumVariables(dir_name), 3);
+    EXPECT_TRUE(TrickColumnarLocateParam(dir_name, "value"));
+    EXPECT_TRUE(TrickColumnarLocateParam(dir_name, "count"));
+
+    char value_name[] = "value";
+    TrickColumnar value_reader(dir_name, value_name);
+    char count_name[] = "count";
+    TrickColumnar count_reader(dir_name, count_name);
+    value_reader.begin();
+    count_reader.begin();
+    double time, read_value;
+    for (int ii = 0; ii < num_records; ii++) {
+        ASSERT_EQ(value_reader.get(&time, &read_value), 1);
+        EXPECT_EQ(time, ii * 0.1);
+        EXPECT_EQ(read_value, ii * 0.5);
+        ASSERT_EQ(count_reader.get(&time, &read_value), 1);
+        EXPECT_EQ(read_value, -ii);
+    }
+    EXPECT_TRUE(value_reader.end());
+    EXPECT_EQ(value_reader.get(&time, &read_value), 0);
+}
+
+TEST_F(DRColumnar_test, flush_makes_rows_readable) {
+    // ARRANGE
+    Trick::DRColumnar group("flushed");
+    group.add_variable("value");
+    group.init();
+
+    // ACT
+    // A reader of a running sim sees the rows written up to the last flush
+    for (int ii = 0; ii < 10; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    group.write_data(true);
+    group.format_specific_flush();
+    char dir_name[] = "DRColumnar_test_output/log_flushed.col";
+    char value_name[] = "value";
+    TrickColumnar reader(dir_name, value_name);
+    reader.begin();
+    int num_read = 0;
+    double time, read_value;
+    while (reader.get(&time, &read_value)) {
+        EXPECT_EQ(read_value, num_read);
+        num_read++;
+    }
+    group.shutdown();
+
+    // ASSERT
+    EXPECT_EQ(num_read, 10);
+}
@@ -0,0 +1,131 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DRHDF5 compound records layout )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "hdf5.h"
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRHDF5.hh"
+
+/*
+ A record as the test reads it back, HDF5 converts the packed records of the file to this layout.
+ */
+struct ReadRecord {
+    double time;
+    double value;
+    int count;
+    short step;
+};
+
+/*
+ Test Fixture.  Groups record to DRHDF5_test_output and are read back with the HDF5 library.
+ */
+class DRHDF5_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+        double value;
+        int count;
+        short step;
+
+		DRHDF5_test() : value(0.0), count(0), step(0) {
+            (void) system("rm -rf DRHDF5_test_output");
+            mkdir("DRHDF5_test_output", 0755);
+            cmd_args.set_output_dir("DRHDF5_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+            (void) memmgr.declare_extern_var(&count, "int count");
+            (void) memmgr.declare_extern_var(&step, "short step");
+        }
+		~DRHDF5_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+};
+
+TEST_F(DRHDF5_test, compound_layout) {
+    // ARRANGE
+    Trick::DRHDF5 group("compound");
+    group.add_variable("value");
+    group.add_variable("count");
+    group.add_variable("step");
+    group.set_layout(Trick::DRHDF5_Compound);
+    group.set_chunk_size(64);
+    group.init();
+
+    // ACT
+    // Several appends to the records dataset, each spanning chunks
+    const int num_records = 250;
+    for (int ii = 0; ii < num_records; ii++) {
+        value = ii * 0.5;
+        count = -ii;
+        step = ii % 3;
+        group.data_record(ii * 0.1);
+        if (ii % 100 == 99) {
+            group.write_data(true);
+        }
+    }
+    group.shutdown();
+
+    // ASSERT
+    hid_t file = H5Fopen("DRHDF5_test_output/log_compound.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+    ASSERT_GE(file, 0);
+    hid_t dataset = H5Dopen2(file, "/records", H5P_DEFAULT);
+    ASSERT_GE(dataset, 0);
+
+    // The file stores one packed compound member per parameter, time first
+    hid_t file_type = H5Dget_type(dataset);
+    ASSERT_EQ(H5Tget_class(file_type), H5T_COMPOUND);
+    ASSERT_EQ(H5Tget_nmembers(file_type), 4);
+    EXPECT_EQ(H5Tget_size(file_type), 8 + 8 + 4 + 2);
+    const char * names[] = {"sys.exec.out.time", "value", "count", "step"};
+    const size_t offsets[] = {0, 8, 16, 20};
+    for (unsigned int ii = 0; ii < 4; ii++) {
+        char * name = H5Tget_member_name(file_type, ii);
+        EXPECT_EQ(std::string(name), names[ii]);
+        H5free_memory(name);
+        EXPECT_EQ(H5Tget_member_offset(file_type, ii), offsets[ii]);
+    }
+    H5Tclose(file_type);
+
+    hid_t dcpl = H5Dget_create_plist(dataset);
+    hsize_t chunk_dims = 0;
+    ASSERT_EQ(H5Pget_layout(dcpl), H5D_CHUNKED);
+    EXPECT_EQ(H5Pget_chunk(dcpl, 1, &chunk_dims), 1);
+    EXPECT_EQ(chunk_dims, 64);
+    H5Pclose(dcpl);
+
+    hid_t space = H5Dget_space(dataset);
+    hsize_t dims = 0;
+    H5Sget_simple_extent_dims(space, &dims, NULL);
+    H5Sclose(space);
+    ASSERT_EQ(dims, num_records);
+
+    // Read the members back by name
+    hid_t mem_type = H5Tcreate(H5T_COMPOUND, sizeof(ReadRecord));
+    H5Tinsert(mem_type, "sys.exec.out.time", offsetof(ReadRecord, time), H5T_NATIVE_DOUBLE);
+    H5Tinsert(mem_type, "value", offsetof(ReadRecord, value), H5T_NATIVE_DOUBLE);
+    H5Tinsert(mem_type, "count", offsetof(ReadRecord, count), H5T_NATIVE_INT);
+    H5Tinsert(mem_type, "step", offsetof(ReadRecord, step), H5T_NATIVE_SHORT);
+    std::vector<ReadRecord> records(num_records);
+    ASSERT_GE(H5Dread(dataset, mem_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &records[0]), 0);
+    H5Tclose(mem_type);
+    H5Dclose(dataset);
+    H5Fclose(file);
+
+    for (int ii = 0; ii < num_records; ii++) {
+        EXPECT_EQ(records[ii].time, ii * 0.1);
+        EXPECT_EQ(records[ii].value, ii * 0.5);
+        EXPECT_EQ(records[ii].count, -ii);
+        EXPECT_EQ(records[ii].step, ii % 3);
+    }
+}
@@ -0,0 +1,186 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the shared memory live tap of data record groups )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRAscii.hh"
+#include "trick/DRLiveTap.hh"
+#include "trick/dr_live_tap.h"
+
+/*
+ Test Fixture.  Taps are created in DRLiveTap_test_output and read back the way an external reader would,
+ through the id in the locator file.
+ */
+class DRLiveTap_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+        double value;
+
+		DRLiveTap_test() : value(0.0) {
+            (void) system("rm -rf DRLiveTap_test_output");
+            mkdir("DRLiveTap_test_output", 0755);
+            cmd_args.set_output_dir("DRLiveTap_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+        }
+		~DRLiveTap_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+
+        // Attaches read only to the segment named in a locator file, NULL if it can't
+        static void * attach(std::string locator_name) {
+            std::ifstream locator(locator_name.c_str());
+            std::string key_label, key, id_label;
+            int shmid = -1;
+            locator >> key_label >> key >> id_label >> shmid;
+            if (id_label != "shmid") {
+                return NULL;
+            }
+            void * segment = shmat(shmid, NULL, SHM_RDONLY);
+            return segment == (void *)-1 ? NULL : segment;
+        }
+
+        // A name or units string of the variable descriptors
+        static std::string read_string(const char *& pos) {
+            int len;
+            memcpy(&len, pos, sizeof(len));
+            std::string str(pos + sizeof(len), len);
+            pos += sizeof(len) + len;
+            return str;
+        }
+};
+
+TEST_F(DRLiveTap_test, read_back) {
+    // ARRANGE
+    Trick::DRAscii group("tap");
+    group.add_variable("value");
+    group.set_live_tap(8);
+    group.init();
+    void * segment = attach("DRLiveTap_test_output/log_tap.tap");
+    ASSERT_TRUE(segment != NULL);
+    const DRLiveTapHeader * header = (const DRLiveTapHeader *)segment;
+    double row[2];
+    int before_recording = dr_live_tap_read_row(segment, 0, row);
+
+    // ACT
+    for (int ii = 0; ii < 5; ii++) {
+        value = ii * 0.5;
+        group.data_record(ii * 0.1);
+    }
+    std::vector<double> values;
+    for (int ii = 0; ii < 5; ii++) {
+        EXPECT_EQ(dr_live_tap_read_row(segment, ii, row), 0);
+        EXPECT_EQ(row[0], ii * 0.1);
+        values.push_back(row[1]);
+    }
+    // 25 rows in a ring of 8, rows 0 through 16 are overwritten
+    for (int ii = 5; ii < 25; ii++) {
+        value = ii * 0.5;
+        group.data_record(ii * 0.1);
+    }
+    int overwritten = dr_live_tap_read_row(segment, 16, row);
+    int newest = dr_live_tap_read_row(segment, 24, row);
+    double newest_value = row[1];
+    int not_written = dr_live_tap_read_row(segment, 25, row);
+    uint64_t rows_written = __atomic_load_n(&header->rows_written, __ATOMIC_ACQUIRE);
+    uint64_t open_recording = header->open;
+    group.shutdown();
+    uint64_t open_after = header->open;
+
+    // ASSERT
+    EXPECT_EQ(std::string(header->keyword, 8), DR_LIVE_TAP_KEYWORD);
+    EXPECT_EQ(header->version, DR_LIVE_TAP_VERSION);
+    EXPECT_EQ(header->num_vars, 2);
+    EXPECT_EQ(header->record_bytes, 2 * sizeof(double));
+    EXPECT_EQ(header->num_rows, 8);
+    const char * desc = (const char *)segment + sizeof(DRLiveTapHeader);
+    EXPECT_EQ(read_string(desc), "sys.exec.out.time");
+    read_string(desc);
+    desc += 2 * sizeof(int);
+    EXPECT_EQ(read_string(desc), "value");
+
+    EXPECT_EQ(before_recording, 1);
+    for (int ii = 0; ii < 5; ii++) {
+        EXPECT_EQ(values[ii], ii * 0.5);
+    }
+    EXPECT_EQ(overwritten, -1);
+    EXPECT_EQ(newest, 0);
+    EXPECT_EQ(newest_value, 24 * 0.5);
+    EXPECT_EQ(not_written, 1);
+    EXPECT_EQ(rows_written, 25);
+    EXPECT_EQ(open_recording, 1);
+    EXPECT_EQ(open_after, 0);
+    shmdt(segment);
+}
+
+TEST_F(DRLiveTap_test, no_torn_rows) {
+    // ARRANGE
+    // Every word of row n holds n, a row read while it is written would mix two rows
+    const unsigned int num_words = 16;
+    const uint64_t num_published = 200000;
+    std::vector <Trick::DataRecordBuffer *> no_vars;
+    Trick::DRLiveTap tap;
+    ASSERT_EQ(tap.init("DRLiveTap_test_output/log_direct.tap", no_vars, num_words * sizeof(uint64_t), 4), 0);
+    void * segment = attach("DRLiveTap_test_output/log_direct.tap");
+    ASSERT_TRUE(segment != NULL);
+    const DRLiveTapHeader * header = (const DRLiveTapHeader *)segment;
+
+    // ACT
+    // The reader follows rows_written on a small ring, so it is often overwritten under it
+    uint64_t rows_read = 0;
+    uint64_t rows_missed = 0;
+    uint64_t torn = 0;
+    std::thread reader([&]() {
+        uint64_t record[num_words];
+        uint64_t next = 0;
+        while (next < num_published) {
+            uint64_t written = __atomic_load_n(&header->rows_written, __ATOMIC_ACQUIRE);
+            if (next >= written) {
+                continue;
+            }
+            int ret = dr_live_tap_read_row(segment, next, record);
+            if (ret == 0) {
+                for (unsigned int jj = 0; jj < num_words; jj++) {
+                    torn += (record[jj] != next);
+                }
+                rows_read++;
+                next++;
+            } else {
+                // Fallen behind, skip to the newest row
+                EXPECT_EQ(ret, -1);
+                rows_missed++;
+                next = __atomic_load_n(&header->rows_written, __ATOMIC_ACQUIRE) - 1;
+            }
+        }
+    });
+    uint64_t record[num_words];
+    for (uint64_t ii = 0; ii < num_published; ii++) {
+        for (unsigned int jj = 0; jj < num_words; jj++) {
+            record[jj] = ii;
+        }
+        tap.publish((const char *)record);
+    }
+    reader.join();
+    tap.shutdown();
+
+    // ASSERT
+    EXPECT_EQ(torn, 0);
+    EXPECT_GT(rows_read, 0);
+    EXPECT_EQ(header->rows_written, num_published);
+    shmdt(segment);
+}
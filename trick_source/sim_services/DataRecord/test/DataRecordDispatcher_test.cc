@@ -0,0 +1,229 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DataRecordDispatcher writer pool and writer wake ups )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DataRecordDispatcher.hh"
+#include "trick/DRAscii.hh"
+
+/*
+ Test Fixture.  Groups are handed to the dispatcher directly, there is no executive to add them to.
+ */
+class DataRecordDispatcher_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+        Trick::DataRecordDispatcher drd;
+
+        double value;
+
+		DataRecordDispatcher_test() : value(0.0) {
+            (void) system("rm -rf DataRecordDispatcher_test_output");
+            mkdir("DataRecordDispatcher_test_output", 0755);
+            cmd_args.set_output_dir("DataRecordDispatcher_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+        }
+		~DataRecordDispatcher_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+
+        // Records num_records records into the group
+        void record(Trick::DataRecordGroup & group, int num_records) {
+            for (int ii = 0; ii < num_records; ii++) {
+                value = ii;
+                group.data_record(ii * 0.1);
+            }
+        }
+
+        // The number of records in a DRAscii log, without the header
+        static int count_rows(std::string file_name) {
+            std::ifstream in(file_name.c_str());
+            std::string line;
+            int rows = -1;
+            while (std::getline(in, line)) {
+                rows++;
+            }
+            return rows;
+        }
+};
+
+TEST_F(DataRecordDispatcher_test, no_wake_without_records) {
+    // ARRANGE
+    Trick::DRAscii group("idle");
+    group.add_variable("value");
+    group.init();
+    drd.add_sim_object(&group);
+
+    // ACT
+    for (int ii = 0; ii < 50; ii++) {
+        drd.signal_thread();
+    }
+
+    // ASSERT
+    EXPECT_EQ(drd.get_write_pass(), 0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordDispatcher_test, wake_after_max_frames) {
+    // ARRANGE
+    Trick::DRAscii group("interval");
+    group.add_variable("value");
+    group.set_max_buffer_size(100);
+    group.init();
+    drd.add_sim_object(&group);
+    drd.set_writer_wake_frames(5);
+
+    // ACT
+    // A few records are left for the writers until the wake up interval is done
+    record(group, 10);
+    for (int ii = 0; ii < 4; ii++) {
+        drd.signal_thread();
+    }
+    unsigned long long pass_before = drd.get_write_pass();
+    drd.signal_thread();
+
+    // ASSERT
+    EXPECT_EQ(pass_before, 0);
+    EXPECT_EQ(drd.get_write_pass(), 1);
+    group.shutdown();
+}
+
+TEST_F(DataRecordDispatcher_test, wake_when_buffer_fills) {
+    // ARRANGE
+    Trick::DRAscii group("fill");
+    group.add_variable("value");
+    group.set_max_buffer_size(100);
+    group.init();
+    drd.add_sim_object(&group);
+    drd.set_writer_wake_frames(1000);
+
+    // ACT
+    // The default wake fill is a quarter of the buffer
+    record(group, 24);
+    drd.signal_thread();
+    unsigned long long pass_before = drd.get_write_pass();
+    record(group, 1);
+    drd.signal_thread();
+
+    // ASSERT
+    EXPECT_EQ(pass_before, 0);
+    EXPECT_EQ(drd.get_write_pass(), 1);
+    group.shutdown();
+}
+
+TEST_F(DataRecordDispatcher_test, wake_every_frame_with_zero_fill) {
+    // ARRANGE
+    Trick::DRAscii group("zero_fill");
+    group.add_variable("value");
+    group.init();
+    drd.add_sim_object(&group);
+    drd.set_writer_wake_fill(0.0);
+
+    // ACT
+    drd.signal_thread();
+    unsigned long long pass_before = drd.get_write_pass();
+    record(group, 1);
+    drd.signal_thread();
+
+    // ASSERT
+    EXPECT_EQ(pass_before, 0);
+    EXPECT_EQ(drd.get_write_pass(), 1);
+    group.shutdown();
+}
+
+TEST_F(DataRecordDispatcher_test, wake_for_capture) {
+    // ARRANGE
+    // Ring buffer groups are only written by the writers when a triggered capture is waiting
+    Trick::DRAscii group("capture");
+    group.add_variable("value");
+    group.set_buffer_type(Trick::DR_Ring_Buffer);
+    group.set_max_buffer_size(100);
+    group.set_trigger_window(1);
+    group.init();
+    drd.add_sim_object(&group);
+    drd.set_writer_wake_frames(1000);
+
+    // ACT
+    record(group, 50);
+    drd.signal_thread();
+    unsigned long long pass_before = drd.get_write_pass();
+    group.trigger();
+    record(group, 2);
+    drd.signal_thread();
+
+    // ASSERT
+    EXPECT_EQ(pass_before, 0);
+    EXPECT_TRUE(group.capture_pending());
+    EXPECT_EQ(drd.get_write_pass(), 1);
+    group.shutdown();
+}
+
+TEST_F(DataRecordDispatcher_test, writer_pool_writes_every_group) {
+    // ARRANGE
+    const unsigned int num_groups = 6;
+    const int num_frames = 200;
+    std::vector<Trick::DRAscii *> groups;
+    for (unsigned int ii = 0; ii < num_groups; ii++) {
+        std::ostringstream name;
+        name << "pool" << ii;
+        groups.push_back(new Trick::DRAscii(name.str()));
+        groups.back()->add_variable("value");
+        groups.back()->init();
+        drd.add_sim_object(groups.back());
+    }
+    ASSERT_EQ(drd.set_num_writer_threads(3), 0);
+    drd.init();
+
+    // ACT
+    // Every frame each group records a record, the writers are woken when there is enough to write
+    for (int frame = 0; frame < num_frames; frame++) {
+        value = frame;
+        for (unsigned int ii = 0; ii < num_groups; ii++) {
+            groups[ii]->data_record(frame * 0.1);
+        }
+        drd.signal_thread();
+    }
+    unsigned long long passes = drd.get_write_pass();
+    // Wake the writers for the last records until they are written
+    drd.set_writer_wake_fill(0.0);
+    for (int wait = 0; wait < 5000; wait++) {
+        drd.signal_thread();
+        bool done = true;
+        for (unsigned int ii = 0; ii < num_groups; ii++) {
+            done = done and groups[ii]->pending_records() == 0;
+        }
+        if (done) {
+            break;
+        }
+        usleep(1000);
+    }
+    drd.shutdown();
+
+    // ASSERT
+    // A wake up at most every 10 frames, not one a frame, and every group written by the writers
+    EXPECT_GT(passes, 0);
+    EXPECT_LE(passes, num_frames / 10);
+    for (unsigned int ii = 0; ii < num_groups; ii++) {
+        EXPECT_EQ(groups[ii]->pending_records(), 0);
+        EXPECT_EQ(groups[ii]->rows_written, num_frames);
+        groups[ii]->shutdown();
+        EXPECT_EQ(groups[ii]->rows_written, num_frames);
+        EXPECT_EQ(groups[ii]->rows_dropped, 0);
+        std::ostringstream file_name;
+        file_name << "DataRecordDispatcher_test_output/log_pool" << ii << ".csv";
+        EXPECT_EQ(count_rows(file_name.str()), num_frames);
+        delete groups[ii];
+    }
+}
@@ -0,0 +1,648 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the DataRecordGroup ring and writer threads )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/DRAscii.hh"
+
+/*
+ A DRAscii group that shows the tests how its copy plan is built and what is in its ring.
+ */
+class CopyPlanGroup : public Trick::DRAscii {
+    public:
+        CopyPlanGroup(std::string in_name) : Trick::DRAscii(in_name) {}
+
+        size_t num_spans() {
+            return copy_plan.size();
+        }
+
+        // Record num of the ring
+        const char * ring_record(unsigned int num) {
+            return record_buffer + (size_t)(num % max_num) * record_bytes;
+        }
+
+        // Where variable index, 0 being time, is in the newest record
+        const char * recorded(unsigned int index) {
+            return ring_record(buffer_num - 1) + rec_buffer[index]->offset;
+        }
+
+        // The value of a double variable index in record num
+        double recorded_double(unsigned int num, unsigned int index) {
+            double d;
+            memcpy(&d, ring_record(num) + rec_buffer[index]->offset, sizeof(d));
+            return d;
+        }
+};
+
+/*
+ Test Fixture.  Groups record to DataRecordGroup_test_output.
+ */
+class DataRecordGroup_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::CommandLineArguments cmd_args;
+
+        double value;
+
+		DataRecordGroup_test() : value(0.0) {
+            // DRAscii appends to its file, start every test with an empty directory
+            (void) system("rm -rf DataRecordGroup_test_output");
+            mkdir("DataRecordGroup_test_output", 0755);
+            cmd_args.set_output_dir("DataRecordGroup_test_output");
+            (void) memmgr.declare_extern_var(&value, "double value");
+        }
+		~DataRecordGroup_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+
+        // The values of a column of a DRAscii log, without the header
+        std::vector<double> read_column(std::string file_name, unsigned int column) {
+            std::vector<double> values;
+            std::ifstream in(file_name.c_str());
+            std::string line;
+            std::getline(in, line);
+            while (std::getline(in, line)) {
+                std::stringstream ss(line);
+                std::string field;
+                for (unsigned int ii = 0; ii <= column; ii++) {
+                    std::getline(ss, field, ',');
+                }
+                values.push_back(std::stod(field));
+            }
+            return values;
+        }
+};
+
+TEST_F(DataRecordGroup_test, writer_pool_writes_each_record_once) {
+    // ARRANGE
+    Trick::DRAscii group("pool");
+    group.add_variable("value");
+    group.set_max_buffer_size(1000);
+    group.init();
+
+    // ACT
+    // Like the dispatcher's writer pool, several threads try to write the group on every pass
+    unsigned long long pass = 0;
+    for (int ii = 0; ii < 500; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+        if (ii % 10 == 9) {
+            pass++;
+            std::vector<std::thread> writers;
+            for (int jj = 0; jj < 4; jj++) {
+                writers.push_back(std::thread([&group, pass] { group.dispatch_write(pass); }));
+            }
+            for (auto & writer : writers) {
+                writer.join();
+            }
+        }
+    }
+    group.shutdown();
+
+    // ASSERT
+    std::vector<double> values = read_column("DataRecordGroup_test_output/log_pool.csv", 1);
+    ASSERT_EQ(values.size(), 500);
+    for (int ii = 0; ii < 500; ii++) {
+        EXPECT_EQ(values[ii], ii);
+    }
+    EXPECT_EQ(group.write_pass, pass);
+    EXPECT_EQ(group.rows_written, 500);
+}
+
+TEST_F(DataRecordGroup_test, dispatch_write_skips_current_group) {
+    // ARRANGE
+    Trick::DRAscii group("current");
+    group.add_variable("value");
+    group.init();
+    group.data_record(0.0);
+    group.dispatch_write(1);
+    group.data_record(0.1);
+
+    // ACT
+    // The group already finished pass 1, the second record waits for the next pass
+    int ret = group.dispatch_write(1);
+    unsigned int pending = group.pending_records();
+    group.shutdown();
+
+    // ASSERT
+    EXPECT_EQ(ret, 0);
+    EXPECT_EQ(pending, 1);
+}
+
+TEST_F(DataRecordGroup_test, ring_records_while_writer_writes) {
+    // ARRANGE
+    // A small ring makes the recording side wrap it many times while the writer is copying out of it
+    Trick::DRAscii group("ring");
+    group.add_variable("value");
+    group.set_max_buffer_size(64);
+    group.init();
+    const int num_records = 20000;
+    bool recording = true;
+
+    // ACT
+    std::thread writer([&] {
+        while (__atomic_load_n(&recording, __ATOMIC_ACQUIRE)) {
+            group.write_data(true);
+        }
+    });
+    for (int ii = 0; ii < num_records; ii++) {
+        value = ii;
+        group.data_record(ii * 0.01);
+    }
+    __atomic_store_n(&recording, false, __ATOMIC_RELEASE);
+    writer.join();
+    group.shutdown();
+
+    // ASSERT
+    // The recording side never waits.  Records the writer fell behind on are dropped whole, no record is torn
+    // or written twice and the newest record is written at shutdown.
+    std::vector<double> times = read_column("DataRecordGroup_test_output/log_ring.csv", 0);
+    std::vector<double> values = read_column("DataRecordGroup_test_output/log_ring.csv", 1);
+    ASSERT_EQ(values.size(), group.rows_written);
+    for (unsigned int ii = 0; ii < values.size(); ii++) {
+        ASSERT_NEAR(times[ii], values[ii] * 0.01, 1e-9);
+        if (ii > 0) {
+            ASSERT_GT(values[ii], values[ii - 1]);
+        }
+    }
+    EXPECT_EQ(values.back(), num_records - 1);
+    EXPECT_EQ(group.rows_recorded, num_records);
+    EXPECT_EQ(group.rows_written + group.rows_dropped, num_records);
+    EXPECT_LE(group.ring_high_water, 64);
+}
+
+TEST_F(DataRecordGroup_test, ring_buffer_keeps_newest_records) {
+    // ARRANGE
+    Trick::DRAscii group("newest");
+    group.add_variable("value");
+    group.set_buffer_type(Trick::DR_Ring_Buffer);
+    group.set_max_buffer_size(10);
+    group.init();
+
+    // ACT
+    for (int ii = 0; ii < 25; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    group.shutdown();
+
+    // ASSERT
+    std::vector<double> values = read_column("DataRecordGroup_test_output/log_newest.csv", 1);
+    ASSERT_EQ(values.size(), 10);
+    for (int ii = 0; ii < 10; ii++) {
+        EXPECT_EQ(values[ii], ii + 15);
+    }
+    EXPECT_EQ(group.rows_dropped, 15);
+}
+
+TEST_F(DataRecordGroup_test, trigger_captures_window) {
+    // ARRANGE
+    Trick::DRAscii group("capture");
+    group.add_variable("value");
+    group.set_buffer_type(Trick::DR_Ring_Buffer);
+    group.set_max_buffer_size(10);
+    group.set_trigger_window(3);
+    group.init();
+
+    // ACT
+    for (int ii = 0; ii < 30; ii++) {
+        if (ii == 12) {
+            EXPECT_EQ(group.trigger(), 0);
+        }
+        value = ii;
+        group.data_record(ii * 0.1);
+        if (ii == 20) {
+            EXPECT_TRUE(group.capture_pending());
+            group.dispatch_write(1);
+            EXPECT_FALSE(group.capture_pending());
+        }
+    }
+    group.shutdown();
+
+    // ASSERT
+    // The capture holds the ring when the window closed, the trigger record and the 3 after it
+    std::vector<double> captured = read_column("DataRecordGroup_test_output/trigger_capture_0001/log_capture.csv", 1);
+    ASSERT_EQ(captured.size(), 10);
+    for (int ii = 0; ii < 10; ii++) {
+        EXPECT_EQ(captured[ii], ii + 6);
+    }
+    // Recording went on in the spare ring
+    std::vector<double> values = read_column("DataRecordGroup_test_output/log_capture.csv", 1);
+    ASSERT_EQ(values.size(), 10);
+    EXPECT_EQ(values.front(), 20);
+    EXPECT_EQ(values.back(), 29);
+}
+
+TEST_F(DataRecordGroup_test, trigger_not_turned_on) {
+    // ARRANGE
+    Trick::DRAscii group("no_capture");
+    group.add_variable("value");
+    group.init();
+
+    // ACT
+    int ret = group.trigger();
+    group.shutdown();
+
+    // ASSERT
+    EXPECT_EQ(ret, -1);
+}
+
+TEST_F(DataRecordGroup_test, counters_after_writer_falls_behind) {
+    // ARRANGE
+    Trick::DRAscii group("behind");
+    group.add_variable("value");
+    group.set_max_buffer_size(10);
+    group.init();
+
+    // ACT
+    // The writer does not run until the ring has been overwritten
+    for (int ii = 0; ii < 25; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    group.write_data(true);
+
+    // ASSERT
+    EXPECT_EQ(group.rows_recorded, 25);
+    EXPECT_EQ(group.rows_written, 10);
+    EXPECT_EQ(group.rows_dropped, 15);
+    EXPECT_EQ(group.ring_high_water, 10);
+    EXPECT_GT(group.bytes_written, 0);
+    group.shutdown();
+    std::vector<double> values = read_column("DataRecordGroup_test_output/log_behind.csv", 1);
+    ASSERT_EQ(values.size(), 10);
+    EXPECT_EQ(values.front(), 15);
+    EXPECT_EQ(values.back(), 24);
+}
+
+TEST_F(DataRecordGroup_test, counters_kept_across_init) {
+    // ARRANGE
+    // Counters restored by a checkpoint before the group is initialized again
+    Trick::DRAscii group("restored");
+    group.add_variable("value");
+    group.rows_recorded = 100;
+    group.rows_written = 90;
+    group.rows_dropped = 10;
+    group.ring_high_water = 7;
+
+    // ACT
+    group.init();
+    for (int ii = 0; ii < 5; ii++) {
+        value = ii;
+        group.data_record(ii * 0.1);
+    }
+    group.write_data(true);
+
+    // ASSERT
+    EXPECT_EQ(group.rows_recorded, 105);
+    EXPECT_EQ(group.rows_written, 95);
+    EXPECT_EQ(group.rows_dropped, 10);
+    EXPECT_EQ(group.ring_high_water, 7);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, copy_plan_merges_array_elements) {
+    // ARRANGE
+    double array[4] = {1.0, 2.0, 3.0, 4.0};
+    (void) memmgr.declare_extern_var(array, "double array[4]");
+    CopyPlanGroup group("array");
+    for (int ii = 0; ii < 4; ii++) {
+        group.add_variable("array[" + std::to_string(ii) + "]");
+    }
+    group.init();
+
+    // ACT
+    group.data_record(0.0);
+    size_t spans = group.num_spans();
+    bool first_matches = memcmp(group.recorded(1), array, sizeof(array)) == 0;
+    array[0] = -1.0;
+    array[3] = -4.0;
+    group.data_record(0.1);
+
+    // ASSERT
+    // Time, then the whole array in one copy
+    EXPECT_EQ(spans, 2);
+    EXPECT_TRUE(first_matches);
+    EXPECT_EQ(memcmp(group.recorded(1), array, sizeof(array)), 0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, copy_plan_keeps_order) {
+    // ARRANGE
+    // Elements recorded out of memory order are copied one at a time
+    double array[3] = {1.0, 2.0, 3.0};
+    (void) memmgr.declare_extern_var(array, "double array[3]");
+    CopyPlanGroup group("order");
+    group.add_variable("array[2]");
+    group.add_variable("array[0]");
+    group.add_variable("array[1]");
+    group.init();
+
+    // ACT
+    group.data_record(0.0);
+
+    // ASSERT
+    EXPECT_EQ(group.num_spans(), 3);
+    EXPECT_EQ(memcmp(group.recorded(1), &array[2], sizeof(double)), 0);
+    EXPECT_EQ(memcmp(group.recorded(2), &array[0], sizeof(double) * 2), 0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, copy_plan_merges_struct_members) {
+    // ARRANGE
+    // Members of different types next to each other in memory
+    struct {
+        int count;
+        float gain;
+        double level;
+        short flags[4];
+    } members = {7, 0.5f, 2.25, {1, 2, 3, 4}};
+    (void) memmgr.declare_extern_var(&members.count, "int members_count");
+    (void) memmgr.declare_extern_var(&members.gain, "float members_gain");
+    (void) memmgr.declare_extern_var(&members.level, "double members_level");
+    (void) memmgr.declare_extern_var(members.flags, "short members_flags[4]");
+    CopyPlanGroup group("members");
+    group.add_variable("members_count");
+    group.add_variable("members_gain");
+    group.add_variable("members_level");
+    for (int ii = 0; ii < 4; ii++) {
+        group.add_variable("members_flags[" + std::to_string(ii) + "]");
+    }
+    group.init();
+
+    // ACT
+    group.data_record(0.0);
+    members.count = -7;
+    members.flags[3] = -4;
+    group.data_record(0.1);
+
+    // ASSERT
+    EXPECT_EQ(group.num_spans(), 2);
+    EXPECT_EQ(memcmp(group.recorded(1), &members, sizeof(members)), 0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, copy_plan_follows_retargeted_pointer) {
+    // ARRANGE
+    double first[2] = {1.0, 2.0};
+    double second[2] = {10.0, 20.0};
+    double * pointer = &first[0];
+    (void) memmgr.declare_extern_var(first, "double first[2]");
+    (void) memmgr.declare_extern_var(second, "double second[2]");
+    (void) memmgr.declare_extern_var(&pointer, "double * pointer");
+    CopyPlanGroup group("pointer");
+    group.add_variable("first[0]");
+    group.add_variable("pointer[1]");
+    group.init();
+
+    // ACT
+    // At first pointer[1] is next to first[0] and both are copied together
+    group.data_record(0.0);
+    size_t spans_before = group.num_spans();
+    double recorded_before;
+    memcpy(&recorded_before, group.recorded(2), sizeof(double));
+    pointer = &second[0];
+    group.data_record(0.1);
+    size_t spans_after = group.num_spans();
+    double recorded_after;
+    memcpy(&recorded_after, group.recorded(2), sizeof(double));
+    pointer = NULL;
+    group.data_record(0.2);
+    double recorded_null;
+    memcpy(&recorded_null, group.recorded(2), sizeof(double));
+
+    // ASSERT
+    EXPECT_EQ(spans_before, 2);
+    EXPECT_EQ(recorded_before, 2.0);
+    EXPECT_EQ(spans_after, 3);
+    EXPECT_EQ(recorded_after, 20.0);
+    EXPECT_EQ(recorded_null, 0.0);
+    EXPECT_EQ(memcmp(group.recorded(1), &first[0], sizeof(double)), 0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, changes_at_block_edges) {
+    // ARRANGE
+    // 40 one byte change variables fill two 16 byte blocks and half of a third
+    char bytes[40];
+    memset(bytes, 0, sizeof(bytes));
+    (void) memmgr.declare_extern_var(bytes, "char bytes[40]");
+    CopyPlanGroup group("edges");
+    group.set_freq(Trick::DR_Changes);
+    group.add_variable("value");
+    for (int ii = 0; ii < 40; ii++) {
+        group.add_change_variable("bytes[" + std::to_string(ii) + "]");
+    }
+    group.init();
+    group.data_record(0.0);
+    unsigned int records_before = group.buffer_num;
+
+    // ACT
+    // Flip every byte on its own, the first and last bytes of each block and those of the
+    // partial block among them.  Each flip is compared with a plain compare of the variable, which
+    // checks the vector block compare.  Building DataRecordGroup.cpp with -U__SSE2__ (or -U__ARM_NEON)
+    // checks the scalar compare the same way.
+    std::vector<std::string> mismatches;
+    for (int ii = 0; ii < 40; ii++) {
+        char last[40];
+        memcpy(last, bytes, sizeof(bytes));
+        bytes[ii] ^= 0x80;
+        group.data_record(0.1 * (ii + 1));
+        for (int jj = 0; jj < 40; jj++) {
+            if (group.change_variable_changed(jj) != (bytes[jj] != last[jj])) {
+                mismatches.push_back("flip " + std::to_string(ii) + " variable " + std::to_string(jj));
+            }
+        }
+    }
+    unsigned int records_after = group.buffer_num;
+    group.data_record(5.0);
+
+    // ASSERT
+    EXPECT_EQ(records_before, 0);
+    EXPECT_EQ(mismatches, std::vector<std::string>());
+    EXPECT_EQ(records_after, 40);
+    EXPECT_EQ(group.buffer_num, 40);
+    for (int jj = 0; jj < 40; jj++) {
+        EXPECT_FALSE(group.change_variable_changed(jj));
+    }
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, change_across_block_edge) {
+    // ARRANGE
+    // The double is stored at bytes 12 to 19 of the snapshot, in the first two blocks.
+    // The short after it is in a partial block.
+    int lead[3] = {1, 2, 3};
+    double across = 1.0;
+    short tail = 5;
+    (void) memmgr.declare_extern_var(lead, "int lead[3]");
+    (void) memmgr.declare_extern_var(&across, "double across");
+    (void) memmgr.declare_extern_var(&tail, "short tail");
+    CopyPlanGroup group("across");
+    group.set_freq(Trick::DR_Changes);
+    group.add_variable("value");
+    for (int ii = 0; ii < 3; ii++) {
+        group.add_change_variable("lead[" + std::to_string(ii) + "]");
+    }
+    group.add_change_variable("across");
+    group.add_change_variable("tail");
+    group.init();
+    group.data_record(0.0);
+
+    // ACT
+    unsigned char * across_bytes = (unsigned char *)&across;
+    across_bytes[3] ^= 0x01;
+    group.data_record(0.1);
+    bool low_half[5];
+    for (int jj = 0; jj < 5; jj++) {
+        low_half[jj] = group.change_variable_changed(jj);
+    }
+    across_bytes[4] ^= 0x01;
+    group.data_record(0.2);
+    bool high_half[5];
+    for (int jj = 0; jj < 5; jj++) {
+        high_half[jj] = group.change_variable_changed(jj);
+    }
+    tail = -5;
+    group.data_record(0.3);
+    bool tail_changed[5];
+    for (int jj = 0; jj < 5; jj++) {
+        tail_changed[jj] = group.change_variable_changed(jj);
+    }
+
+    // ASSERT
+    // The values at init are the first last snapshot, only the three flips are recorded
+    EXPECT_EQ(group.buffer_num, 3);
+    for (int jj = 0; jj < 5; jj++) {
+        EXPECT_EQ(low_half[jj], jj == 3);
+        EXPECT_EQ(high_half[jj], jj == 3);
+        EXPECT_EQ(tail_changed[jj], jj == 4);
+    }
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, changes_recorded) {
+    // ARRANGE
+    int count = 0;
+    (void) memmgr.declare_extern_var(&count, "int count");
+    CopyPlanGroup group("changes");
+    group.set_freq(Trick::DR_Changes);
+    group.add_variable("value");
+    group.add_change_variable("count");
+    group.init();
+
+    // ACT
+    // count changes at cycles 3 and 7, value changes every cycle
+    for (int ii = 0; ii < 10; ii++) {
+        value = ii * 10.0;
+        count = (ii >= 3) + (ii >= 7);
+        group.data_record(ii * 0.1);
+    }
+
+    // ASSERT
+    ASSERT_EQ(group.buffer_num, 2);
+    EXPECT_EQ(group.recorded_double(0, 0), 3 * 0.1);
+    EXPECT_EQ(group.recorded_double(0, 1), 30.0);
+    EXPECT_EQ(group.recorded_double(1, 0), 7 * 0.1);
+    EXPECT_EQ(group.recorded_double(1, 1), 70.0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, changes_step_recorded) {
+    // ARRANGE
+    int count = 0;
+    (void) memmgr.declare_extern_var(&count, "int count");
+    CopyPlanGroup group("changes_step");
+    group.set_freq(Trick::DR_Changes_Step);
+    group.add_variable("value");
+    group.add_change_variable("count");
+    group.init();
+
+    // ACT
+    for (int ii = 0; ii < 10; ii++) {
+        value = ii * 10.0;
+        count = (ii >= 3) + (ii >= 7);
+        group.data_record(ii * 0.1);
+    }
+
+    // ASSERT
+    // Each change records the last recorded values at the new time, then the new values
+    ASSERT_EQ(group.buffer_num, 4);
+    EXPECT_EQ(group.recorded_double(1, 0), 3 * 0.1);
+    EXPECT_EQ(group.recorded_double(1, 1), 30.0);
+    EXPECT_EQ(group.recorded_double(2, 0), 7 * 0.1);
+    EXPECT_EQ(group.recorded_double(2, 1), 30.0);
+    EXPECT_EQ(group.recorded_double(3, 0), 7 * 0.1);
+    EXPECT_EQ(group.recorded_double(3, 1), 70.0);
+    group.shutdown();
+}
+
+TEST_F(DataRecordGroup_test, reductions_over_interval) {
+    // ARRANGE
+    // Sampled every 0.1 s and recorded every second, 10 samples a record
+    int count = 0;
+    (void) memmgr.declare_extern_var(&count, "int count");
+    CopyPlanGroup group("reduced");
+    group.add_reduced_variable("value", Trick::DR_Min);
+    group.add_reduced_variable("value", Trick::DR_Max);
+    group.add_reduced_variable("value", Trick::DR_Mean);
+    group.add_reduced_variable("value", Trick::DR_RMS);
+    group.add_envelope_variable("count");
+    group.add_variable("value");
+    group.set_cycle(0.1);
+    group.set_reduction_cycle(1.0);
+    group.init();
+
+    // ACT
+    // The second interval holds a constant
+    const double samples[10] = {3.0, -1.0, 4.0, 1.0, -5.0, 9.0, 2.0, 6.0, -5.0, 3.5};
+    unsigned int records_after_9_samples = 0;
+    for (int ii = 0; ii < 20; ii++) {
+        value = ii < 10 ? samples[ii] : 10.0;
+        count = -ii;
+        group.data_record(ii * 0.1);
+        if (ii == 8) {
+            records_after_9_samples = group.buffer_num;
+        }
+    }
+
+    // ASSERT
+    double sum = 0.0, sum_sq = 0.0;
+    for (int ii = 0; ii < 10; ii++) {
+        sum += samples[ii];
+        sum_sq += samples[ii] * samples[ii];
+    }
+    EXPECT_EQ(records_after_9_samples, 0);
+    ASSERT_EQ(group.buffer_num, 2);
+    EXPECT_EQ(group.recorded_double(0, 0), 9 * 0.1);
+    EXPECT_EQ(group.recorded_double(0, 1), -5.0);
+    EXPECT_EQ(group.recorded_double(0, 2), 9.0);
+    EXPECT_DOUBLE_EQ(group.recorded_double(0, 3), sum / 10);
+    EXPECT_DOUBLE_EQ(group.recorded_double(0, 4), sqrt(sum_sq / 10));
+    EXPECT_EQ(group.recorded_double(0, 5), -9.0);
+    EXPECT_EQ(group.recorded_double(0, 6), 0.0);
+    EXPECT_EQ(group.recorded_double(0, 7), 3.5);
+
+    EXPECT_EQ(group.recorded_double(1, 0), 19 * 0.1);
+    for (int jj = 1; jj <= 4; jj++) {
+        EXPECT_DOUBLE_EQ(group.recorded_double(1, jj), 10.0);
+    }
+    EXPECT_EQ(group.recorded_double(1, 5), -19.0);
+    EXPECT_EQ(group.recorded_double(1, 6), -10.0);
+    EXPECT_EQ(group.recorded_double(1, 7), 10.0);
+    group.shutdown();
+}
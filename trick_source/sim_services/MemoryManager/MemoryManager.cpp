@@ -30,6 +30,8 @@ Trick::MemoryManager::MemoryManager()
     // start counter at 0.  This forces extern vars to appear in front of actual allocations in checkpoint.
     extern_alloc_info_map_counter = 0 ;
     pthread_mutex_init(&mm_mutex, NULL);
+    ref_cache_generation = 0 ;
+    pthread_mutex_init(&ref_cache_mutex, NULL);
 
     defaultCheckPointAgent = new ClassicCheckPointAgent( this);
     defaultCheckPointAgent->set_reduced_checkpoint( reduced_checkpoint);
@@ -94,6 +96,9 @@ Trick::MemoryManager::~MemoryManager() {
         free(ai_ptr) ;
     }
     alloc_info_map.clear() ;
+
+    delete_ref_cache() ;
+    pthread_mutex_destroy(&ref_cache_mutex);
 }
 
 #include <sstream>
@@ -65,6 +65,8 @@ int Trick::MemoryManager::delete_var(void* address ) {
             pthread_mutex_lock(&mm_mutex);
             variable_map.erase( alloc_info->name);
             pthread_mutex_unlock(&mm_mutex);
+            // References to the variable are no longer valid.
+            clear_ref_cache();
             free(alloc_info->name);
         }
 
@@ -179,6 +179,11 @@ void* Trick::MemoryManager::resize_array( void *address, int n_cdims, int *cdims
     alloc_info_map[alloc_info->start] = alloc_info;
     pthread_mutex_unlock(&mm_mutex);
 
+    /** @li References to a named allocation now point to the old array.*/
+    if (alloc_info->name) {
+        clear_ref_cache();
+    }
+
     /** @li If debug is enabled, show what happened.*/
     if (debug_level) {
         int i;
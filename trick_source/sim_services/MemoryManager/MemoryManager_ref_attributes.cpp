@@ -5,16 +5,103 @@
 #include <sstream>
 #include "trick/MemoryManager.hh"
 #include "trick/RefParseContext.hh"
+#include "trick/memorymanager_c_intf.h"
 
 extern int REF_debug;
 
+/*
+ Make a copy of R that owns its own reference string, reference attributes and address paths.
+ */
+static REF2 * ref_copy( REF2 * R ) {
+
+    REF2 * copy = (REF2*)malloc( sizeof(REF2));
+    memcpy( copy, R, sizeof(REF2));
+
+    copy->reference = R->reference ? strdup(R->reference) : NULL ;
+    copy->units = R->units ? strdup(R->units) : NULL ;
+
+    // The attributes of the top level of a reference are made for it and freed with it.
+    if ( R->ref_attr ) {
+        copy->ref_attr = (ATTRIBUTES*)malloc( sizeof(ATTRIBUTES));
+        memcpy( copy->ref_attr, R->ref_attr, sizeof(ATTRIBUTES));
+        if ( R->attr == R->ref_attr ) {
+            copy->attr = copy->ref_attr ;
+        }
+    }
+
+    if ( R->address_path ) {
+        copy->address_path = DLL_Create() ;
+        DLLPOS list_pos = DLL_GetHeadPosition(R->address_path) ;
+        while ( list_pos != NULL ) {
+            ADDRESS_NODE * address_node = (ADDRESS_NODE *)DLL_GetNext(&list_pos, R->address_path) ;
+            DLL_AddTail(new ADDRESS_NODE(*address_node), copy->address_path) ;
+        }
+    }
+
+    if ( R->compiled_path ) {
+        copy->compiled_path = (ADDRESS_NODE*)malloc( R->compiled_path_size * sizeof(ADDRESS_NODE));
+        memcpy( copy->compiled_path, R->compiled_path, R->compiled_path_size * sizeof(ADDRESS_NODE));
+    }
+
+    return copy ;
+}
+
+/*
+ Free a copy made by ref_copy.
+ */
+static void ref_copy_free( REF2 * R ) {
+    if ( R->ref_attr ) {
+        free(R->ref_attr) ;
+    }
+    if ( R->units ) {
+        free(R->units) ;
+    }
+    ref_free(R) ;
+    free(R) ;
+}
+
+/*
+ A reference can be cached if its address is fixed as long as its allocation exists, that is if it
+ is not reached through a pointer.  A pointer may change or become NULL at any time.
+ */
+static bool ref_cacheable( REF2 * R ) {
+
+    if ( R->address_path == NULL || R->pointer_present ) {
+        return false ;
+    }
+
+    DLLPOS list_pos = DLL_GetHeadPosition(R->address_path) ;
+    while ( list_pos != NULL ) {
+        ADDRESS_NODE * address_node = (ADDRESS_NODE *)DLL_GetNext(&list_pos, R->address_path) ;
+        if ( address_node->operator_ == AO_DEREFERENCE ) {
+            return false ;
+        }
+    }
+    return true ;
+}
+
 REF2 *Trick::MemoryManager::ref_attributes(const char* name) {
 
     std::stringstream reference_sstream;
     REF2 * result = NULL;
     RefParseContext* context = NULL;
+    unsigned int generation ;
 
     /** @par Design Details: */
+
+    /** @li Return a copy of the cached reference if this name was parsed before and its allocation has not
+            been deleted or moved since. */
+    pthread_mutex_lock(&ref_cache_mutex);
+    generation = ref_cache_generation ;
+    REF_CACHE_MAP::iterator pos = ref_cache.find(name) ;
+    if ( pos != ref_cache.end() ) {
+        result = ref_copy( pos->second ) ;
+    }
+    pthread_mutex_unlock(&ref_cache_mutex);
+    if ( result != NULL ) {
+        return result ;
+    }
+
     reference_sstream << name;
 
     REF_debug = 0;
@@ -37,7 +124,37 @@ REF2 *Trick::MemoryManager::ref_attributes(const char* name) {
         delete( context);
     }
 
+    /** @li Cache a copy of the result if it is not reached through a pointer, unless an allocation was
+            deleted or moved while parsing. */
+    if ( result != NULL and ref_cacheable(result) ) {
+        pthread_mutex_lock(&ref_cache_mutex);
+        if ( generation == ref_cache_generation ) {
+            REF2 *& entry = ref_cache[name] ;
+            if ( entry != NULL ) {
+                ref_copy_free( entry ) ;
+            }
+            entry = ref_copy( result ) ;
+        }
+        pthread_mutex_unlock(&ref_cache_mutex);
+    }
+
     /** @li Return the the REF2 object.*/
     return ( result);
 }
 
+void Trick::MemoryManager::clear_ref_cache() {
+    // Bumping the generation keeps a parse that started before now out of the cache
+    pthread_mutex_lock(&ref_cache_mutex);
+    ref_cache_generation++ ;
+    pthread_mutex_unlock(&ref_cache_mutex);
+    delete_ref_cache() ;
+}
+
+void Trick::MemoryManager::delete_ref_cache() {
+    pthread_mutex_lock(&ref_cache_mutex);
+    for ( REF_CACHE_MAP::iterator pos = ref_cache.begin() ; pos != ref_cache.end() ; ++pos ) {
+        ref_copy_free( pos->second ) ;
+    }
+    ref_cache.clear() ;
+    pthread_mutex_unlock(&ref_cache_mutex);
+}
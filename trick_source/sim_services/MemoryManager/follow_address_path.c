@@ -1,15 +1,90 @@
 
+#include <stdlib.h>
 #include "trick/reference.h"
 #include "trick/memorymanager_c_intf.h"
 
+/*
+ Copy the address path of R into R->compiled_path, an array walked without following list links.  Offsets
+ are added to the address or offset before them.
+ */
+void compile_address_path(REF2 * R) {
+
+    DLLPOS list_pos ;
+    ADDRESS_NODE * address_node ;
+    ADDRESS_NODE * nodes ;
+    int num_nodes ;
+
+    free(R->compiled_path) ;
+    R->compiled_path = NULL ;
+    R->compiled_path_size = 0 ;
+
+    if ( R->address_path == NULL ) {
+        return ;
+    }
+
+    nodes = (ADDRESS_NODE *)malloc(DLL_GetCount(R->address_path) * sizeof(ADDRESS_NODE)) ;
+    num_nodes = 0 ;
+
+    list_pos = DLL_GetHeadPosition(R->address_path) ;
+    while ( list_pos != NULL ) {
+        address_node = (ADDRESS_NODE *)DLL_GetNext(&list_pos, R->address_path) ;
+        switch ( address_node->operator_ ) {
+            case AO_ADDRESS:
+            case AO_DEREFERENCE:
+                nodes[num_nodes++] = *address_node ;
+                break ;
+            case AO_OFFSET:
+                if ( address_node->operand.offset == 0 ) {
+                    break ;
+                }
+                if ( num_nodes > 0 && nodes[num_nodes - 1].operator_ == AO_OFFSET ) {
+                    nodes[num_nodes - 1].operand.offset += address_node->operand.offset ;
+                } else if ( num_nodes > 0 && nodes[num_nodes - 1].operator_ == AO_ADDRESS &&
+                            nodes[num_nodes - 1].operand.address != NULL ) {
+                    nodes[num_nodes - 1].operand.address =
+                     (void *)((char *)nodes[num_nodes - 1].operand.address + address_node->operand.offset) ;
+                } else {
+                    nodes[num_nodes++] = *address_node ;
+                }
+                break ;
+        }
+    }
+
+    R->compiled_path = nodes ;
+    R->compiled_path_size = num_nodes ;
+}
+
 void * follow_address_path(REF2 * R) {
 
     DLLPOS list_pos ;
     ADDRESS_NODE * address_node ;
     void * address ;
+    int ii ;
 
     address = NULL ;
 
+    if ( R->compiled_path != NULL ) {
+        for ( ii = 0 ; ii < R->compiled_path_size ; ii++ ) {
+            address_node = &R->compiled_path[ii] ;
+            switch ( address_node->operator_ ) {
+                case AO_ADDRESS:
+                    address = address_node->operand.address  ;
+                    break ;
+                case AO_DEREFERENCE:
+                    address = *(char **)address ;
+                    break ;
+                case AO_OFFSET:
+                    address = (void *)((char *)address + address_node->operand.offset) ;
+                    break ;
+            }
+            // If we resolve a pointer to NULL this variable is now bad.
+            if (address == NULL) {
+                break ;
+            }
+        }
+        return(address) ;
+    }
+
     list_pos = DLL_GetHeadPosition(R->address_path) ;
     while ( list_pos != NULL ) {
         address_node = (ADDRESS_NODE *)DLL_GetNext(&list_pos, R->address_path) ;
@@ -32,6 +107,3 @@ void * follow_address_path(REF2 * R) {
 
     return(address) ;
 }
-
-
-
@@ -22,6 +22,12 @@ extern "C" void ref_free(REF2 * ref) {
             DLL_Delete(ref->address_path) ;
         }
 
+        // The compiled address path was allocated with malloc.
+        if ( ref->compiled_path ) {
+            free(ref->compiled_path) ;
+            ref->compiled_path = NULL ;
+        }
+
         // The reference string was allocated with strdup.
         if ( ref->reference ) {
             free(ref->reference) ;
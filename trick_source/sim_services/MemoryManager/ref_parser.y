@@ -16,6 +16,7 @@
 #include <string.h>
 
 #include "trick/RefParseContext.hh"
+#include "trick/memorymanager_c_intf.h"
 #include "trick/vval.h"
 #include "trick/value.h"
 #include "trick/var.h"
@@ -73,6 +74,10 @@ reference: param {
           $$ = $1 ;
           context->result = (REF2*)malloc( sizeof(REF2));
           memcpy( context->result, &$1, sizeof(REF2));
+
+          /* The address path is complete, make the array follow_address_path walks */
+          context->result->compiled_path = NULL ;
+          compile_address_path(context->result) ;
 }
 ;
 
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include "MM_test.hh"
 #include "MM_user_defined_types.hh"
+#include "trick/memorymanager_c_intf.h"
 
 
 /*
@@ -147,6 +148,98 @@ TEST_F(MM_ref_attributes, NormalCases) {
 
 }
 
+TEST_F(MM_ref_attributes, CachedReferences) {
+    REF2 *ref1;
+    REF2 *ref2;
+    UDT1  udt1;
+    UDT1  other_udt1;
+    UDT3  udt3;
+
+    udt3.udt1_p = &udt1;
+
+    UDT3* udt3_p = (UDT3*)memmgr->declare_extern_var(&udt3, "UDT3 udt3");
+    ASSERT_TRUE(udt3_p != NULL);
+
+    // The second reference is a copy of the first.
+    ref1 = memmgr->ref_attributes("udt3.M2[2][3]");
+    ref2 = memmgr->ref_attributes("udt3.M2[2][3]");
+    ASSERT_TRUE(ref1 != NULL);
+    ASSERT_TRUE(ref2 != NULL);
+    EXPECT_NE( ref1, ref2);
+    EXPECT_NE( ref1->reference, ref2->reference);
+    EXPECT_STREQ( "udt3.M2[2][3]", ref2->reference);
+    EXPECT_EQ( &udt3.M2[2][3], ref2->address);
+    EXPECT_EQ( ref1->attr, ref2->attr);
+    free( ref1);
+    free( ref2);
+
+    // References through a pointer follow the pointer.
+    ref1 = memmgr->ref_attributes("udt3.udt1_p->x");
+    udt3.udt1_p = &other_udt1;
+    ref2 = memmgr->ref_attributes("udt3.udt1_p->x");
+    ASSERT_TRUE(ref1 != NULL);
+    ASSERT_TRUE(ref2 != NULL);
+    EXPECT_EQ( &udt1.x, ref1->address);
+    EXPECT_EQ( &other_udt1.x, ref2->address);
+    free( ref1);
+    free( ref2);
+}
+
+TEST_F(MM_ref_attributes, CachedReferencesDeleteVar) {
+    REF2 *ref;
+
+    double *d1 = (double*)memmgr->declare_var("double cached_d[3]");
+    ASSERT_TRUE(d1 != NULL);
+    ref = memmgr->ref_attributes("cached_d[1]");
+    ASSERT_TRUE(ref != NULL);
+    EXPECT_EQ( &d1[1], ref->address);
+    free( ref);
+
+    // The reference is parsed again for the new allocation.
+    memmgr->delete_var("cached_d");
+    double *d2 = (double*)memmgr->declare_var("double cached_d[4]");
+    ASSERT_TRUE(d2 != NULL);
+
+    ref = memmgr->ref_attributes("cached_d[3]");
+    ASSERT_TRUE(ref != NULL);
+    EXPECT_EQ( &d2[3], ref->address);
+    free( ref);
+
+    ref = memmgr->ref_attributes("cached_d[1]");
+    ASSERT_TRUE(ref != NULL);
+    EXPECT_EQ( &d2[1], ref->address);
+    free( ref);
+}
+
+TEST_F(MM_ref_attributes, CompiledAddressPath) {
+    REF2 *ref;
+    UDT1  udt1;
+    UDT1  other_udt1;
+    UDT2  udt2;
+    UDT3  udt3;
+
+    udt3.udt2_p = &udt2;
+    udt2.udt1_p = &udt1;
+
+    UDT3* udt3_p = (UDT3*)memmgr->declare_extern_var(&udt3, "UDT3 udt3");
+    ASSERT_TRUE(udt3_p != NULL);
+
+    ref = memmgr->ref_attributes("udt3.udt2_p->udt1_p->y");
+    ASSERT_TRUE(ref != NULL);
+    ASSERT_TRUE(ref->compiled_path != NULL);
+    EXPECT_LE( ref->compiled_path_size, DLL_GetCount(ref->address_path));
+    EXPECT_EQ( &udt1.y, follow_address_path(ref));
+
+    // The compiled path follows the pointers as they change.
+    udt2.udt1_p = &other_udt1;
+    EXPECT_EQ( &other_udt1.y, follow_address_path(ref));
+    udt3.udt2_p = NULL;
+    EXPECT_EQ( NULL, follow_address_path(ref));
+
+    ref_free( ref);
+    free( ref);
+}
+
 TEST_F(MM_ref_attributes, FailureCases) {
     REF2 *ref;
     UDT1  udt1;
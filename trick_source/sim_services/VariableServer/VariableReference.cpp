@@ -61,7 +61,7 @@ REF2* make_time_ref(double * time) {
     return new_ref;
 }
 
-Trick::VariableReference::VariableReference(std::string var_name, double* time) : _staged(false), _write_ready(false) {
+Trick::VariableReference::VariableReference(std::string var_name, double* time) : _staged(false), _write_ready(false), _sent(false) {
     if (var_name != "time") {
         ASSERT(0);
     }
@@ -86,7 +86,7 @@ Trick::VariableReference::VariableReference(std::string var_name, double* time)
     _name = _var_info->reference;
 }
 
-Trick::VariableReference::VariableReference(std::string var_name) : _staged(false), _write_ready(false) {
+Trick::VariableReference::VariableReference(std::string var_name) : _staged(false), _write_ready(false), _sent(false) {
 
     if (var_name == "time") {
         ASSERT(0);
@@ -192,7 +192,7 @@ Trick::VariableReference::~VariableReference() {
     }
 }
 
-std::string Trick::VariableReference::getName() const {
+const std::string& Trick::VariableReference::getName() const {
     return _name;
 }
 
@@ -343,6 +343,29 @@ int Trick::VariableReference::stageValue(bool validate_address) {
     return 0;
 }
 
+bool Trick::VariableReference::isShareable() const {
+    // Pointers are followed and strings are sized on every copy, the time variable belongs to its session,
+    // and error refs are looked up again on every copy.
+    return ( _var_info->pointer_present == 0 and
+             !_deref and
+             _trick_type != TRICK_STRING and
+             _trick_type != TRICK_WSTRING and
+             _var_info->address != &_bad_ref_int and
+             _var_info->address != &_do_not_resolve_bad_ref_int and
+             _name != "time" ) ;
+}
+
+void * Trick::VariableReference::getAddress() const {
+    return _address;
+}
+
+int Trick::VariableReference::stageValueFrom(const char * value) {
+    _write_ready = false;
+    memcpy( _stage_buffer , value , _size ) ;
+    _staged = true;
+    return 0;
+}
+
 bool Trick::VariableReference::validate() {
     // The address is not NULL.
     // Should be called by VariableServer Session if validateAddress is on.
@@ -731,6 +754,55 @@ int Trick::VariableReference::writeValueBinary( std::ostream& out, bool byteswap
     
 }  
 
+bool Trick::VariableReference::writeValueChanged() const {
+    if (!_sent or _sent_value.size() != (size_t)_size) {
+        return true;
+    }
+    return _size > 0 and memcmp(&_sent_value[0], _write_buffer, _size) != 0;
+}
+
+void Trick::VariableReference::markWriteValueSent() {
+    _sent_value.resize(_size);
+    if (_size > 0) {
+        memcpy(&_sent_value[0], _write_buffer, _size);
+    }
+    _sent = true;
+}
+
+int Trick::VariableReference::writeValueBinary( char * out, bool byteswap ) const {
+
+    if ( _trick_type == TRICK_BITFIELD ) {
+        int temp_i = GET_BITFIELD(_write_buffer , _var_info->attr->size ,
+            _var_info->attr->index[0].start, _var_info->attr->index[0].size) ;
+        memcpy(out, &temp_i, _size);
+        return _size;
+    }
+
+    if ( _trick_type == TRICK_UNSIGNED_BITFIELD ) {
+        int temp_unsigned = GET_UNSIGNED_BITFIELD(_write_buffer , _var_info->attr->size ,
+                _var_info->attr->index[0].start, _var_info->attr->index[0].size) ;
+        memcpy(out, &temp_unsigned, _size);
+        return _size;
+    }
+
+    if (_trick_type ==  TRICK_NUMBER_OF_TYPES) {
+        // TRICK_NUMBER_OF_TYPES is an error case
+        memset(out, 0, _size);
+        return _size;
+    }
+
+    if (byteswap) {
+        // byteswap_var only writes elements of 1, 2, 4 and 8 bytes, zero what it leaves
+        memset(out, 0, _size);
+        byteswap_var(out, (char *) _write_buffer);
+    }
+    else {
+        memcpy(out, _write_buffer, _size);
+    }
+
+    return _size;
+}
+
 std::ostream& Trick::operator<< (std::ostream& s, const Trick::VariableReference& ref) {
     s << "      \"" << ref.getName() << "\"";
     return s;
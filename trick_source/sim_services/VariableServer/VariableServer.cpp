@@ -1,6 +1,7 @@
 
 #include <netdb.h>
 #include <iostream>
+#include <sstream>
 #include "trick/VariableServer.hh"
 #include "trick/tc_proto.h"
 
@@ -13,6 +14,8 @@ Trick::VariableServer::VariableServer() :
 {
     the_vs = this ;
     pthread_mutex_init(&map_mutex, NULL);
+    event_engine.set_vs_ptr(this) ;
+    listen_thread.set_event_engine(&event_engine) ;
 }
 
 Trick::VariableServer::~VariableServer() {
@@ -25,19 +28,25 @@ void Trick::VariableServer::shutdownConnections() {
 
 std::ostream& Trick::operator<< (std::ostream& s, Trick::VariableServer& vs) {
     std::map < pthread_t , VariableServerSessionThread * >::iterator it ;
+    std::vector < std::string > connections ;
 
-    s << "{\"variable_server_connections\":[\n";
-    int count = 0;
-    int n_connections = (int)vs.var_server_threads.size();
     for ( it = vs.var_server_threads.begin() ; it != vs.var_server_threads.end() ; ++it ) {
+        std::stringstream connection ;
+        connection << *(*it).second;
+        connections.push_back(connection.str()) ;
+    }
+    vs.event_engine.get_connections(connections) ;
+
+    s << "{\"variable_server_connections\":[\n";
+    int n_connections = (int)connections.size();
+    for ( int count = 0 ; count < n_connections ; count++ ) {
         s << "{\n";
-        s << *(*it).second;
+        s << connections[count];
         s << "}";
         if ((n_connections-count)>1) {
             s << "," ;
         }
         s << "\n";
-        count ++;
     }
     s << "]}" << std::endl;
     return s;
@@ -109,6 +118,26 @@ void Trick::VariableServer::set_var_server_session_log_off() {
     }
 }
 
+void Trick::VariableServer::set_event_engine(bool on_off) {
+    event_engine.set_enabled(on_off) ;
+}
+
+bool Trick::VariableServer::get_event_engine() {
+    return event_engine.get_enabled() ;
+}
+
+void Trick::VariableServer::set_event_workers(unsigned int num) {
+    event_engine.set_num_workers(num) ;
+}
+
+void Trick::VariableServer::set_native_commands(bool on_off) {
+    VariableServerCommandParser::set_enabled(on_off) ;
+}
+
+bool Trick::VariableServer::get_native_commands() {
+    return VariableServerCommandParser::get_enabled() ;
+}
+
 const char * Trick::VariableServer::get_hostname() {
     return listen_thread.get_hostname();
 }
@@ -124,6 +153,7 @@ void Trick::VariableServer::add_vst(pthread_t in_thread_id, VariableServerSessio
 }
 
 void Trick::VariableServer::add_session(pthread_t in_thread_id, VariableServerSession * in_session) {
+    in_session->set_snapshot(&snapshot) ;
     pthread_mutex_lock(&map_mutex) ;
     var_server_sessions[in_thread_id] = in_session ;
     pthread_mutex_unlock(&map_mutex) ;
@@ -0,0 +1,108 @@
+
+#include "trick/VariableServerChannel.hh"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+Trick::VariableServerChannel::VariableServerChannel(std::string in_name) :
+ name(in_name) ,
+ address("") ,
+ port(0) ,
+ group(NULL) ,
+ session(NULL) ,
+ thread(NULL) {}
+
+// The session thread deletes the session and disconnects the socket when it shuts down
+Trick::VariableServerChannel::~VariableServerChannel() {}
+
+/**
+@details
+-# Open a socket that sends to the multicast group
+-# Make a binary session that numbers its messages, copied by the copy job and written as soon as it is copied.
+   The default cycle is the session's 0.1 seconds.
+-# Make the session thread.  It writes the messages copied while the simulation is not running in real time, and
+   never reads the socket.
+*/
+int Trick::VariableServerChannel::initialize(std::string mcast_address, unsigned short in_port) {
+
+    group = new MulticastGroup() ;
+    if ( group->initialize_sender(mcast_address, in_port) != 0 ) {
+        delete group ;
+        group = NULL ;
+        return -1 ;
+    }
+    group->setClientTag(std::string("channel ") + name) ;
+
+    address = mcast_address ;
+    port = in_port ;
+
+    session = new VariableServerSession() ;
+    session->set_connection(group) ;
+    session->var_binary() ;
+    session->set_sequenced(true) ;
+    session->var_set_write_mode(VS_WRITE_WHEN_COPIED) ;
+    session->var_set_copy_mode(VS_COPY_SCHEDULED) ;
+
+    thread = new VariableServerSessionThread(session) ;
+    thread->set_connection(group) ;
+    // Anyone can send to the socket, the channel takes no commands
+    thread->set_read_commands(false) ;
+
+    return 0 ;
+}
+
+int Trick::VariableServerChannel::add(std::string var_name , std::string units_name) {
+    if ( session == NULL ) {
+        return -1 ;
+    }
+    if ( units_name.empty() ) {
+        session->var_add(var_name) ;
+    } else {
+        session->var_add(var_name, units_name) ;
+    }
+    var_names.push_back(std::make_pair(var_name, units_name)) ;
+    return 0 ;
+}
+
+int Trick::VariableServerChannel::set_cycle(double period) {
+    if ( session == NULL ) {
+        return -1 ;
+    }
+    if ( period <= 0.0 ) {
+        message_publish(MSG_ERROR, "Variable server channel %s cycle must be greater than 0, was %g.\n", name.c_str(), period) ;
+        return -1 ;
+    }
+    session->var_cycle(period) ;
+    // Schedules the next copy at the new cycle
+    session->var_set_copy_mode(VS_COPY_SCHEDULED) ;
+    return 0 ;
+}
+
+void Trick::VariableServerChannel::restart() {
+    if ( session == NULL ) {
+        return ;
+    }
+    session->var_clear() ;
+    for ( const auto & var : var_names ) {
+        if ( var.second.empty() ) {
+            session->var_add(var.first) ;
+        } else {
+            session->var_add(var.first, var.second) ;
+        }
+    }
+}
+
+std::string Trick::VariableServerChannel::get_name() const {
+    return name ;
+}
+
+std::string Trick::VariableServerChannel::get_address() const {
+    return address ;
+}
+
+unsigned short Trick::VariableServerChannel::get_port() const {
+    return port ;
+}
+
+Trick::VariableServerSessionThread * Trick::VariableServerChannel::get_thread() {
+    return thread ;
+}
@@ -0,0 +1,462 @@
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <ctype.h>
+#include <pthread.h>
+
+#include "trick/VariableServerCommandParser.hh"
+#include "trick/VariableServer.hh"
+#include "trick/input_processor_proto.h"
+
+bool Trick::VariableServerCommandParser::enabled = true ;
+
+typedef std::vector < Trick::VariableServerCommandParser::Argument > Arguments ;
+
+static int int_arg(const Arguments & args , unsigned int ii) {
+    return (int)args[ii].integer_value ;
+}
+
+static unsigned int unsigned_arg(const Arguments & args , unsigned int ii) {
+    return (unsigned int)args[ii].integer_value ;
+}
+
+static double double_arg(const Arguments & args , unsigned int ii) {
+    if ( args[ii].type == Trick::VariableServerCommandParser::Argument::FLOAT ) {
+        return args[ii].float_value ;
+    }
+    return (double)args[ii].integer_value ;
+}
+
+static const char * string_arg(const Arguments & args , unsigned int ii) {
+    return args[ii].string_value.c_str() ;
+}
+
+// var_set takes the overload the input processor would pick for the value
+static void run_var_set(const Arguments & args) {
+    const char * units = NULL ;
+    if ( args.size() > 2 ) {
+        units = string_arg(args, 2) ;
+    }
+    switch ( args[1].type ) {
+        case Trick::VariableServerCommandParser::Argument::STRING:
+            var_set(string_arg(args, 0), string_arg(args, 1), units) ;
+            break ;
+        case Trick::VariableServerCommandParser::Argument::FLOAT:
+            var_set(string_arg(args, 0), args[1].float_value, units) ;
+            break ;
+        default:
+            var_set(string_arg(args, 0), args[1].integer_value, units) ;
+            break ;
+    }
+}
+
+/*
+ The send_sie_ commands rewrite the S_sie files shared by every session before sending them.  Python ran
+ them one at a time, these run them one at a time without it.
+ */
+static pthread_mutex_t sie_mutex = PTHREAD_MUTEX_INITIALIZER ;
+
+static void run_send_sie(int (*send_sie)()) {
+    pthread_mutex_lock(&sie_mutex) ;
+    send_sie() ;
+    pthread_mutex_unlock(&sie_mutex) ;
+}
+
+/*
+ The commands the parser runs.  The signature has a letter for each argument the command accepts:
+   s - string
+   i - int, or a boolean
+   u - unsigned int, or a boolean
+   d - float, or an integer
+   b - boolean
+   v - string, integer, float or boolean
+ */
+struct NativeCommand {
+    const char * name ;
+    const char * signature ;
+    void (*run)(const Arguments & args) ;
+} ;
+
+static const NativeCommand native_commands[] = {
+    { "var_add" , "s" , [](const Arguments & a) { var_add(a[0].string_value) ; } } ,
+    { "var_add" , "ss" , [](const Arguments & a) { var_add(a[0].string_value, a[1].string_value) ; } } ,
+    { "var_remove" , "s" , [](const Arguments & a) { var_remove(a[0].string_value) ; } } ,
+    { "var_units" , "ss" , [](const Arguments & a) { var_units(a[0].string_value, a[1].string_value) ; } } ,
+    { "var_exists" , "s" , [](const Arguments & a) { var_exists(a[0].string_value) ; } } ,
+    { "var_send_once" , "s" , [](const Arguments & a) { var_send_once(a[0].string_value) ; } } ,
+    { "var_send_once" , "si" , [](const Arguments & a) { var_send_once(a[0].string_value, int_arg(a, 1)) ; } } ,
+    { "var_send" , "" , [](const Arguments &) { var_send() ; } } ,
+    { "var_clear" , "" , [](const Arguments &) { var_clear() ; } } ,
+    { "var_cycle" , "d" , [](const Arguments & a) { var_cycle(double_arg(a, 0)) ; } } ,
+    { "var_pause" , "" , [](const Arguments &) { var_pause() ; } } ,
+    { "var_unpause" , "" , [](const Arguments &) { var_unpause() ; } } ,
+    { "var_exit" , "" , [](const Arguments &) { var_exit() ; } } ,
+    { "var_write_stdio" , "is" , [](const Arguments & a) { var_write_stdio(int_arg(a, 0), a[1].string_value) ; } } ,
+    { "var_set_client_tag" , "s" , [](const Arguments & a) { var_set_client_tag(a[0].string_value) ; } } ,
+    { "var_debug" , "i" , [](const Arguments & a) { var_debug(int_arg(a, 0)) ; } } ,
+    { "var_ascii" , "" , [](const Arguments &) { var_ascii() ; } } ,
+    { "var_binary" , "" , [](const Arguments &) { var_binary() ; } } ,
+    { "var_binary_nonames" , "" , [](const Arguments &) { var_binary_nonames() ; } } ,
+    { "var_validate_address" , "i" , [](const Arguments & a) { var_validate_address(int_arg(a, 0)) ; } } ,
+    { "var_set_copy_mode" , "i" , [](const Arguments & a) { var_set_copy_mode(int_arg(a, 0)) ; } } ,
+    { "var_set_write_mode" , "i" , [](const Arguments & a) { var_set_write_mode(int_arg(a, 0)) ; } } ,
+    { "var_set_send_stdio" , "i" , [](const Arguments & a) { var_set_send_stdio(int_arg(a, 0)) ; } } ,
+    { "var_sync" , "i" , [](const Arguments & a) { var_sync(int_arg(a, 0)) ; } } ,
+    { "var_set_frame_multiple" , "u" , [](const Arguments & a) { var_set_frame_multiple(unsigned_arg(a, 0)) ; } } ,
+    { "var_set_frame_offset" , "u" , [](const Arguments & a) { var_set_frame_offset(unsigned_arg(a, 0)) ; } } ,
+    { "var_set_freeze_frame_multiple" , "u" , [](const Arguments & a) { var_set_freeze_frame_multiple(unsigned_arg(a, 0)) ; } } ,
+    { "var_set_freeze_frame_offset" , "u" , [](const Arguments & a) { var_set_freeze_frame_offset(unsigned_arg(a, 0)) ; } } ,
+    { "var_byteswap" , "b" , [](const Arguments & a) { var_byteswap(a[0].integer_value != 0) ; } } ,
+    { "var_set_max_message_size" , "i" , [](const Arguments & a) { var_set_max_message_size(int_arg(a, 0)) ; } } ,
+    { "var_send_on_change" , "i" , [](const Arguments & a) { var_send_on_change(int_arg(a, 0)) ; } } ,
+    { "var_set_keyframe_interval" , "i" , [](const Arguments & a) { var_set_keyframe_interval(int_arg(a, 0)) ; } } ,
+    { "var_set_send_queue_size" , "i" , [](const Arguments & a) { var_set_send_queue_size(int_arg(a, 0)) ; } } ,
+    { "var_set_send_queue_policy" , "i" , [](const Arguments & a) { var_set_send_queue_policy(int_arg(a, 0)) ; } } ,
+    { "var_join_channel" , "s" , [](const Arguments & a) { var_join_channel(a[0].string_value) ; } } ,
+    { "var_send_list_size" , "" , [](const Arguments &) { var_send_list_size() ; } } ,
+    { "var_set" , "sv" , run_var_set } ,
+    { "var_set" , "svs" , run_var_set } ,
+    { "var_server_log_on" , "" , [](const Arguments &) { var_server_log_on() ; } } ,
+    { "var_server_log_off" , "" , [](const Arguments &) { var_server_log_off() ; } } ,
+    { "send_sie_resource" , "" , [](const Arguments &) { run_send_sie(send_sie_resource) ; } } ,
+    { "send_sie_class" , "" , [](const Arguments &) { run_send_sie(send_sie_class) ; } } ,
+    { "send_sie_enum" , "" , [](const Arguments &) { run_send_sie(send_sie_enum) ; } } ,
+    { "send_sie_top_level_objects" , "" , [](const Arguments &) { run_send_sie(send_sie_top_level_objects) ; } } ,
+    { "send_file" , "s" , [](const Arguments & a) { send_file(a[0].string_value) ; } }
+} ;
+
+static const int num_native_commands = sizeof(native_commands) / sizeof(native_commands[0]) ;
+
+static bool argument_matches(char letter , const Trick::VariableServerCommandParser::Argument & arg) {
+    typedef Trick::VariableServerCommandParser::Argument Arg ;
+    switch ( letter ) {
+        case 's':
+            return arg.type == Arg::STRING ;
+        case 'i':
+            return (arg.type == Arg::INTEGER or arg.type == Arg::BOOLEAN) and
+             arg.integer_value >= INT_MIN and arg.integer_value <= INT_MAX ;
+        case 'u':
+            return (arg.type == Arg::INTEGER or arg.type == Arg::BOOLEAN) and
+             arg.integer_value >= 0 and arg.integer_value <= UINT_MAX ;
+        case 'd':
+            return arg.type != Arg::STRING ;
+        case 'b':
+            return arg.type == Arg::BOOLEAN ;
+        case 'v':
+            return true ;
+    }
+    return false ;
+}
+
+// Returns the index of the command taking these arguments, or -1
+static int find_command(const std::string & name , const Arguments & args) {
+    for ( int ii = 0 ; ii < num_native_commands ; ii++ ) {
+        const NativeCommand & command = native_commands[ii] ;
+        if ( name.compare(command.name) != 0 or strlen(command.signature) != args.size() ) {
+            continue ;
+        }
+        unsigned int jj ;
+        for ( jj = 0 ; jj < args.size() ; jj++ ) {
+            if ( ! argument_matches(command.signature[jj], args[jj]) ) {
+                break ;
+            }
+        }
+        if ( jj == args.size() ) {
+            return ii ;
+        }
+    }
+    return -1 ;
+}
+
+static bool is_identifier_char(char c) {
+    return isalnum((unsigned char)c) or c == '_' ;
+}
+
+static void skip_spaces(const std::string & line , size_t & pos) {
+    while ( pos < line.size() and (line[pos] == ' ' or line[pos] == '\t') ) {
+        pos++ ;
+    }
+}
+
+// A string literal without prefixes.  Unusual escapes are left to the input processor.
+static bool parse_string(const std::string & line , size_t & pos , std::string & value) {
+    char quote = line[pos++] ;
+    value.clear() ;
+    while ( pos < line.size() ) {
+        char c = line[pos++] ;
+        if ( c == quote ) {
+            return true ;
+        }
+        if ( c == '\\' ) {
+            if ( pos >= line.size() ) {
+                return false ;
+            }
+            switch ( line[pos++] ) {
+                case '\\': value += '\\' ; break ;
+                case '\'': value += '\'' ; break ;
+                case '"': value += '"' ; break ;
+                case 'n': value += '\n' ; break ;
+                case 't': value += '\t' ; break ;
+                case 'r': value += '\r' ; break ;
+                default: return false ;
+            }
+        } else {
+            value += c ;
+        }
+    }
+    return false ;
+}
+
+// A decimal integer or float literal, True or False
+static bool parse_value(const std::string & line , size_t & pos , Trick::VariableServerCommandParser::Argument & arg) {
+    typedef Trick::VariableServerCommandParser::Argument Arg ;
+
+    size_t start = pos ;
+    while ( pos < line.size() and (is_identifier_char(line[pos]) or line[pos] == '.' or
+             ((line[pos] == '-' or line[pos] == '+') and
+              (pos == start or line[pos-1] == 'e' or line[pos-1] == 'E'))) ) {
+        pos++ ;
+    }
+    std::string token = line.substr(start, pos - start) ;
+    if ( token.empty() ) {
+        return false ;
+    }
+
+    if ( token == "True" or token == "False" ) {
+        arg.type = Arg::BOOLEAN ;
+        arg.integer_value = (token == "True") ;
+        return true ;
+    }
+
+    // Only digits, a point and an exponent.  Python rejects leading zeros on integers.
+    size_t digits_start = (token[0] == '-' or token[0] == '+') ? 1 : 0 ;
+    bool is_integer = true ;
+    bool has_digit = false ;
+    for ( size_t ii = digits_start ; ii < token.size() ; ii++ ) {
+        char c = token[ii] ;
+        if ( isdigit((unsigned char)c) ) {
+            has_digit = true ;
+        } else if ( c == '.' or c == 'e' or c == 'E' or c == '-' or c == '+' ) {
+            is_integer = false ;
+        } else {
+            return false ;
+        }
+    }
+    if ( ! has_digit ) {
+        return false ;
+    }
+    if ( ! isdigit((unsigned char)token[digits_start]) and token[digits_start] != '.' ) {
+        return false ;
+    }
+
+    char * end ;
+    errno = 0 ;
+    if ( is_integer ) {
+        if ( token.size() > digits_start + 1 and token[digits_start] == '0' ) {
+            return false ;
+        }
+        arg.type = Arg::INTEGER ;
+        arg.integer_value = strtoll(token.c_str(), &end, 10) ;
+    } else {
+        arg.type = Arg::FLOAT ;
+        arg.float_value = strtod(token.c_str(), &end) ;
+    }
+    return errno == 0 and *end == '\0' ;
+}
+
+/**
+@details
+-# A line is run by the parser when it is made of calls of "trick." commands the parser runs, separated by
+   semicolons and optionally followed by a comment.  The arguments must be literals the parser reads exactly as
+   the input processor would: strings, decimal numbers, True and False.
+-# Anything else, keyword arguments, expressions or indented lines for instance, is left to the input processor.
+*/
+bool Trick::VariableServerCommandParser::parse_line(const std::string & line , std::vector < Command > & commands) {
+
+    commands.clear() ;
+
+    size_t end = line.size() ;
+    while ( end > 0 and isspace((unsigned char)line[end - 1]) ) {
+        end-- ;
+    }
+    std::string text = line.substr(0, end) ;
+    size_t pos = 0 ;
+
+    while ( true ) {
+        if ( text.compare(pos, 6, "trick.") != 0 ) {
+            return false ;
+        }
+        pos += 6 ;
+        size_t name_start = pos ;
+        while ( pos < text.size() and is_identifier_char(text[pos]) ) {
+            pos++ ;
+        }
+        std::string name = text.substr(name_start, pos - name_start) ;
+        skip_spaces(text, pos) ;
+        if ( pos >= text.size() or text[pos] != '(' ) {
+            return false ;
+        }
+        pos++ ;
+
+        Command command ;
+        skip_spaces(text, pos) ;
+        while ( pos < text.size() and text[pos] != ')' ) {
+            Argument arg ;
+            arg.integer_value = 0 ;
+            arg.float_value = 0.0 ;
+            if ( text[pos] == '"' or text[pos] == '\'' ) {
+                arg.type = Argument::STRING ;
+                if ( ! parse_string(text, pos, arg.string_value) ) {
+                    return false ;
+                }
+            } else if ( ! parse_value(text, pos, arg) ) {
+                return false ;
+            }
+            command.args.push_back(arg) ;
+
+            skip_spaces(text, pos) ;
+            if ( pos < text.size() and text[pos] == ',' ) {
+                pos++ ;
+                skip_spaces(text, pos) ;
+            } else if ( pos >= text.size() or text[pos] != ')' ) {
+                return false ;
+            }
+        }
+        if ( pos >= text.size() ) {
+            return false ;
+        }
+        pos++ ;
+
+        command.command_index = find_command(name, command.args) ;
+        if ( command.command_index < 0 ) {
+            return false ;
+        }
+        commands.push_back(command) ;
+
+        skip_spaces(text, pos) ;
+        if ( pos < text.size() and text[pos] == ';' ) {
+            pos++ ;
+            skip_spaces(text, pos) ;
+        } else if ( pos < text.size() and text[pos] != '#' ) {
+            return false ;
+        }
+        if ( pos >= text.size() or text[pos] == '#' ) {
+            return true ;
+        }
+    }
+}
+
+void Trick::VariableServerCommandParser::execute(const Command & command) {
+    native_commands[command.command_index].run(command.args) ;
+}
+
+const char * Trick::VariableServerCommandParser::get_name(const Command & command) {
+    return native_commands[command.command_index].name ;
+}
+
+bool Trick::VariableServerCommandParser::continues(const std::string & python_text) {
+    int depth = 0 ;
+    char quote = '\0' ;
+    bool continued = false ;
+    for ( size_t ii = 0 ; ii < python_text.size() ; ii++ ) {
+        char c = python_text[ii] ;
+        continued = false ;
+        if ( c == '\n' ) {
+            quote = '\0' ;
+        } else if ( c == '\\' ) {
+            if ( ii + 1 < python_text.size() and python_text[ii + 1] == '\n' ) {
+                continued = true ;
+            }
+            ii++ ;
+        } else if ( quote != '\0' ) {
+            if ( c == quote ) {
+                quote = '\0' ;
+            }
+        } else if ( c == '"' or c == '\'' ) {
+            quote = c ;
+        } else if ( c == '#' ) {
+            while ( ii + 1 < python_text.size() and python_text[ii + 1] != '\n' ) {
+                ii++ ;
+            }
+        } else if ( c == '(' or c == '[' or c == '{' ) {
+            depth++ ;
+        } else if ( c == ')' or c == ']' or c == '}' ) {
+            depth-- ;
+        }
+    }
+    return depth > 0 or continued ;
+}
+
+void Trick::VariableServerCommandParser::set_enabled(bool on_off) {
+    enabled = on_off ;
+}
+
+bool Trick::VariableServerCommandParser::get_enabled() {
+    return enabled ;
+}
+
+/**
+@details
+-# Give messages to the input processor whole if the parser is off
+-# Give messages with triple quoted strings to the input processor whole, their lines cannot be told apart
+-# Run each line the parser can run.  Lines for the input processor are collected and parsed together just
+   before the next line the parser runs, so the commands run in the order received and Python blocks stay
+   whole.  A line continuing the collected Python text is always collected.
+-# Give the message to the input processor unchanged if the parser ran none of it
+*/
+int Trick::VariableServerCommandParser::run(const std::string & message) {
+
+    if ( ! enabled or message.find("\"\"\"") != std::string::npos or message.find("'''") != std::string::npos ) {
+        return ip_parse(message.c_str()) ;
+    }
+
+    int ret = 0 ;
+    bool ran_command = false ;
+    std::string python_text ;
+    std::vector < Command > commands ;
+    size_t start = 0 ;
+
+    while ( start < message.size() ) {
+        size_t newline = message.find('\n', start) ;
+        size_t next = (newline == std::string::npos) ? message.size() : newline + 1 ;
+        std::string line = message.substr(start, next - start) ;
+        start = next ;
+
+        bool blank = (line.find_first_not_of(" \t\r\n") == std::string::npos) ;
+        if ( blank ) {
+            if ( ! python_text.empty() ) {
+                python_text += line ;
+            }
+            continue ;
+        }
+
+        if ( (python_text.empty() or ! continues(python_text)) and parse_line(line, commands) ) {
+            if ( ! python_text.empty() ) {
+                int status = ip_parse(python_text.c_str()) ;
+                if ( status != 0 ) {
+                    ret = status ;
+                }
+                python_text.clear() ;
+            }
+            for ( const Command & command : commands ) {
+                execute(command) ;
+            }
+            ran_command = true ;
+        } else {
+            python_text += line ;
+        }
+    }
+
+    if ( ! ran_command ) {
+        return ip_parse(message.c_str()) ;
+    }
+    if ( ! python_text.empty() ) {
+        int status = ip_parse(python_text.c_str()) ;
+        if ( status != 0 ) {
+            ret = status ;
+        }
+    }
+    return ret ;
+}
@@ -0,0 +1,125 @@
+
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "trick/VariableServerEventConnection.hh"
+
+Trick::VariableServerEventConnection::VariableServerEventConnection(ClientConnection * connection) :
+ _connection(connection) {}
+
+Trick::VariableServerEventConnection::~VariableServerEventConnection() {
+    delete _connection ;
+}
+
+int Trick::VariableServerEventConnection::start() {
+    return _connection->start() ;
+}
+
+int Trick::VariableServerEventConnection::write(const std::string& message) {
+    return write((char *)message.data(), message.size()) ;
+}
+
+int Trick::VariableServerEventConnection::write(char * message, int size) {
+    return _connection->write(message, size) ;
+}
+
+/**
+@details
+-# Read the socket until it would block.  The engine is told of new bytes only once, so everything on the
+   socket is taken now.
+-# A read of 0 bytes means the client closed the connection
+*/
+int Trick::VariableServerEventConnection::receive() {
+
+    int socket = _connection->getSocket() ;
+    if ( socket < 0 ) {
+        return -1 ;
+    }
+
+    char buffer[4096] ;
+    while (1) {
+        ssize_t nbytes = recv(socket, buffer, sizeof(buffer), 0) ;
+        if ( nbytes > 0 ) {
+            _received.append(buffer, nbytes) ;
+        } else if ( nbytes == 0 ) {
+            return -1 ;
+        } else if ( errno == EINTR ) {
+            continue ;
+        } else if ( errno == EAGAIN or errno == EWOULDBLOCK ) {
+            return 0 ;
+        } else {
+            return -1 ;
+        }
+    }
+}
+
+/**
+@details
+-# Find the last newline received, within max_len bytes.  Everything up to it is complete commands.
+-# Return the commands without any \r characters, leaving a partial command for the next read
+*/
+int Trick::VariableServerEventConnection::read(std::string& message, int max_len) {
+
+    message.clear() ;
+
+    size_t limit = _received.size() < (size_t)max_len ? _received.size() : (size_t)max_len ;
+    if ( limit == 0 ) {
+        return 0 ;
+    }
+
+    size_t last_newline = _received.rfind('\n', limit - 1) ;
+    if ( last_newline == std::string::npos ) {
+        return 0 ;
+    }
+
+    message.reserve(last_newline + 1) ;
+    for ( size_t ii = 0 ; ii <= last_newline ; ii++ ) {
+        if ( _received[ii] != '\r' ) {
+            message += _received[ii] ;
+        }
+    }
+    _received.erase(0, last_newline + 1) ;
+
+    return message.size() ;
+}
+
+int Trick::VariableServerEventConnection::setBlockMode(bool blocking) {
+    return _connection->setBlockMode(blocking) ;
+}
+
+int Trick::VariableServerEventConnection::disconnect() {
+    return _connection->disconnect() ;
+}
+
+bool Trick::VariableServerEventConnection::isInitialized() {
+    return _connection->isInitialized() ;
+}
+
+std::string Trick::VariableServerEventConnection::getClientTag() {
+    return _connection->getClientTag() ;
+}
+
+int Trick::VariableServerEventConnection::setClientTag(std::string tag) {
+    return _connection->setClientTag(tag) ;
+}
+
+int Trick::VariableServerEventConnection::restart() {
+    return _connection->restart() ;
+}
+
+std::string Trick::VariableServerEventConnection::getClientHostname() {
+    return _connection->getClientHostname() ;
+}
+
+int Trick::VariableServerEventConnection::getClientPort() {
+    return _connection->getClientPort() ;
+}
+
+int Trick::VariableServerEventConnection::getSocket() {
+    return _connection->getSocket() ;
+}
+
+Trick::ClientConnection::ConnectionType Trick::VariableServerEventConnection::getConnectionType() {
+    return _connection->getConnectionType() ;
+}
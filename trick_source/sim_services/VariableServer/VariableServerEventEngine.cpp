@@ -0,0 +1,185 @@
+
+#include <sstream>
+
+#include "trick/VariableServer.hh"
+#include "trick/VariableServerEventEngine.hh"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+// The client the calling worker thread is handling
+static __thread Trick::VariableServerEventClient * current_client = NULL ;
+
+Trick::VariableServerEventEngine::VariableServerEventEngine() :
+ _vs(NULL) ,
+ _enabled(false) ,
+ _num_workers(2) {}
+
+Trick::VariableServerEventEngine::~VariableServerEventEngine() {}
+
+void Trick::VariableServerEventEngine::set_vs_ptr(Trick::VariableServer * in_vs) {
+    _vs = in_vs ;
+}
+
+Trick::VariableServer * Trick::VariableServerEventEngine::get_vs() {
+    return _vs ;
+}
+
+void Trick::VariableServerEventEngine::set_enabled(bool on_off) {
+    _enabled = on_off ;
+}
+
+bool Trick::VariableServerEventEngine::get_enabled() {
+    return _enabled ;
+}
+
+void Trick::VariableServerEventEngine::set_num_workers(unsigned int num) {
+    if ( num == 0 ) {
+        num = 1 ;
+    }
+    _num_workers = num ;
+}
+
+unsigned int Trick::VariableServerEventEngine::get_num_workers() {
+    return _num_workers ;
+}
+
+/**
+@details
+-# Return if the workers are already running
+-# Create the workers with the cpu affinity of the given thread.  On error, or if epoll is not available, stop
+   and let the listen threads keep creating a thread per client.
+*/
+int Trick::VariableServerEventEngine::start(Trick::ThreadBase & cpu_thread) {
+
+    if ( ! _workers.empty() ) {
+        return 0 ;
+    }
+
+#if __linux
+    std::vector < VariableServerEventWorker * > workers ;
+    for ( unsigned int ii = 0 ; ii < _num_workers ; ii++ ) {
+        VariableServerEventWorker * worker = new VariableServerEventWorker(this, ii) ;
+        workers.push_back(worker) ;
+        if ( worker->init() != 0 ) {
+            message_publish(MSG_ERROR, "Variable server event engine could not start, using a thread per client.\n") ;
+            for ( VariableServerEventWorker * created : workers ) {
+                delete created ;
+            }
+            return -1 ;
+        }
+    }
+    for ( VariableServerEventWorker * worker : workers ) {
+        worker->copy_cpus(cpu_thread.get_cpus()) ;
+        worker->create_thread() ;
+    }
+    _workers = workers ;
+    message_publish(MSG_INFO, "Variable server event engine serving clients with %u threads\n", _num_workers) ;
+    return 0 ;
+#else
+    (void)cpu_thread ;
+    message_publish(MSG_WARNING, "Variable server event engine requires epoll, using a thread per client.\n") ;
+    return -1 ;
+#endif
+}
+
+bool Trick::VariableServerEventEngine::is_running() {
+    return ! _workers.empty() ;
+}
+
+/**
+@details
+-# Accept the client on the listen thread, as a session thread would on its own thread
+-# Create the session with the logging selected for the variable server
+-# Give the client to the worker serving the fewest clients
+*/
+int Trick::VariableServerEventEngine::add_connection(ClientConnection * in_connection) {
+
+    VariableServerEventConnection * connection = new VariableServerEventConnection(in_connection) ;
+    if ( _workers.empty() or connection->start() != 0 ) {
+        delete connection ;
+        return -1 ;
+    }
+    if ( connection->getSocket() < 0 ) {
+        message_publish(MSG_ERROR, "Variable server event engine cannot serve a connection without a socket.\n") ;
+        connection->disconnect() ;
+        delete connection ;
+        return -1 ;
+    }
+
+    VariableServerSession * session = new VariableServerSession() ;
+    if (_vs->get_log()) {
+        session->set_log(true);
+    }
+    if (_vs->get_session_log()) {
+        session->set_session_log(true);
+    }
+    if (_vs->get_info_msg()) {
+        session->set_info_message(true);
+    }
+    session->set_connection(connection) ;
+
+    VariableServerEventWorker * worker = _workers[0] ;
+    for ( VariableServerEventWorker * candidate : _workers ) {
+        if ( candidate->get_num_clients() < worker->get_num_clients() ) {
+            worker = candidate ;
+        }
+    }
+
+    if ( worker->add_client(connection, session) != 0 ) {
+        connection->disconnect() ;
+        delete session ;
+        delete connection ;
+        return -1 ;
+    }
+    return 0 ;
+}
+
+unsigned int Trick::VariableServerEventEngine::get_num_clients() {
+    unsigned int num = 0 ;
+    for ( VariableServerEventWorker * worker : _workers ) {
+        num += worker->get_num_clients() ;
+    }
+    return num ;
+}
+
+void Trick::VariableServerEventEngine::get_connections(std::vector<std::string> & connections) {
+    for ( VariableServerEventWorker * worker : _workers ) {
+        worker->get_connections(connections) ;
+    }
+}
+
+void Trick::VariableServerEventEngine::preload_checkpoint() {
+    for ( VariableServerEventWorker * worker : _workers ) {
+        worker->preload_checkpoint() ;
+    }
+}
+
+void Trick::VariableServerEventEngine::restart() {
+    for ( VariableServerEventWorker * worker : _workers ) {
+        worker->restart() ;
+    }
+}
+
+void Trick::VariableServerEventEngine::shutdown() {
+    for ( VariableServerEventWorker * worker : _workers ) {
+        worker->cancel_thread() ;
+    }
+}
+
+Trick::VariableServerSession * Trick::VariableServerEventEngine::get_current_session() {
+    if ( current_client == NULL ) {
+        return NULL ;
+    }
+    return current_client->session ;
+}
+
+Trick::ClientConnection * Trick::VariableServerEventEngine::get_current_connection() {
+    if ( current_client == NULL ) {
+        return NULL ;
+    }
+    return current_client->connection ;
+}
+
+void Trick::VariableServerEventEngine::set_current_client(VariableServerEventClient * client) {
+    current_client = client ;
+}
@@ -0,0 +1,356 @@
+
+#if __linux
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <cxxabi.h>
+
+#include "trick/VariableServer.hh"
+#include "trick/VariableServerEventWorker.hh"
+#include "trick/VariableServerEventEngine.hh"
+#include "trick/ExecutiveException.hh"
+#include "trick/exec_proto.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+// Sessions served by the workers have no thread of their own, the variable server knows them by address
+static pthread_t session_key(Trick::VariableServerSession * session) {
+    return (pthread_t)session ;
+}
+
+static void exit_event_worker(void * in_worker) {
+    ((Trick::VariableServerEventWorker *)in_worker)->close_all_clients() ;
+}
+
+Trick::VariableServerEventWorker::VariableServerEventWorker(VariableServerEventEngine * engine , unsigned int id) :
+ Trick::SysThread(std::string("VarServEvent") + std::to_string(id)) ,
+ _engine(engine) ,
+ _epoll_fd(-1) {
+    pthread_mutex_init(&_clients_mutex, NULL) ;
+    cancellable = false ;
+}
+
+Trick::VariableServerEventWorker::~VariableServerEventWorker() {
+    if ( _epoll_fd >= 0 ) {
+        close(_epoll_fd) ;
+    }
+    pthread_mutex_destroy(&_clients_mutex) ;
+}
+
+int Trick::VariableServerEventWorker::init() {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC) ;
+    if ( _epoll_fd < 0 ) {
+        perror("Unable to create variable server event worker epoll instance") ;
+        return -1 ;
+    }
+    return 0 ;
+}
+
+/**
+@details
+-# Create the client's cycle timer
+-# Add the session to the variable server so the copy jobs see it
+-# Wait on the socket edge triggered: the worker reads all there is when told of new bytes, and is told when a
+   full socket drains
+-# Wait on the timer
+*/
+int Trick::VariableServerEventWorker::add_client(VariableServerEventConnection * connection , VariableServerSession * session) {
+
+    VariableServerEventClient * client = new VariableServerEventClient() ;
+    client->connection = connection ;
+    client->session = session ;
+    client->timer_period = 0.0 ;
+    client->saved_pause = false ;
+    client->closed = false ;
+    client->socket_source.client = client ;
+    client->socket_source.timer = false ;
+    client->timer_source.client = client ;
+    client->timer_source.timer = true ;
+
+    client->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC) ;
+    if ( client->timer_fd < 0 or update_timer(client) != 0 ) {
+        perror("Unable to create variable server client timer") ;
+        if ( client->timer_fd >= 0 ) {
+            close(client->timer_fd) ;
+        }
+        delete client ;
+        return -1 ;
+    }
+
+    pthread_mutex_lock(&_clients_mutex) ;
+    _clients.push_back(client) ;
+    pthread_mutex_unlock(&_clients_mutex) ;
+
+    _engine->get_vs()->add_session(session_key(session), session) ;
+
+    struct epoll_event socket_event ;
+    socket_event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET ;
+    socket_event.data.ptr = &client->socket_source ;
+    struct epoll_event timer_event ;
+    timer_event.events = EPOLLIN ;
+    timer_event.data.ptr = &client->timer_source ;
+
+    if ( epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, connection->getSocket(), &socket_event) != 0 or
+         epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, client->timer_fd, &timer_event) != 0 ) {
+        perror("Unable to wait on variable server client") ;
+        epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, connection->getSocket(), NULL) ;
+        _engine->get_vs()->delete_session(session_key(session)) ;
+        pthread_mutex_lock(&_clients_mutex) ;
+        _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end()) ;
+        pthread_mutex_unlock(&_clients_mutex) ;
+        close(client->timer_fd) ;
+        delete client ;
+        return -1 ;
+    }
+
+    return 0 ;
+}
+
+unsigned int Trick::VariableServerEventWorker::get_num_clients() {
+    pthread_mutex_lock(&_clients_mutex) ;
+    unsigned int num = _clients.size() ;
+    pthread_mutex_unlock(&_clients_mutex) ;
+    return num ;
+}
+
+void Trick::VariableServerEventWorker::get_connections(std::vector<std::string> & connections) {
+    pthread_mutex_lock(&_clients_mutex) ;
+    for ( VariableServerEventClient * client : _clients ) {
+        std::stringstream s ;
+        s << "  \"connection\":{\n";
+        s << "    \"client_tag\":\"" << client->connection->getClientTag() << "\",\n";
+        s << "    \"client_IP_address\":\"" << client->connection->getClientHostname() << "\",\n";
+        s << "    \"client_port\":\"" << client->connection->getClientPort() << "\",\n";
+        s << *(client->session);
+        s << "  }" << std::endl;
+        connections.push_back(s.str()) ;
+    }
+    pthread_mutex_unlock(&_clients_mutex) ;
+}
+
+// Gets called from the main thread as a job
+void Trick::VariableServerEventWorker::preload_checkpoint() {
+
+    // Stop handling events at the top of the event loop.
+    force_thread_to_pause() ;
+
+    pthread_mutex_lock(&_clients_mutex) ;
+    for ( VariableServerEventClient * client : _clients ) {
+        // Let the session complete any data copying it has to do
+        // and then suspend data copying until the checkpoint is reloaded.
+        client->session->pause_copy() ;
+        client->saved_pause = client->session->get_pause() ;
+        client->session->set_pause(true) ;
+        client->session->disconnect_references() ;
+        client->session->unpause_copy() ;
+    }
+    pthread_mutex_unlock(&_clients_mutex) ;
+}
+
+// Gets called from the main thread as a job
+void Trick::VariableServerEventWorker::restart() {
+
+    pthread_mutex_lock(&_clients_mutex) ;
+    for ( VariableServerEventClient * client : _clients ) {
+        client->connection->restart() ;
+        client->session->set_pause(client->saved_pause) ;
+    }
+    pthread_mutex_unlock(&_clients_mutex) ;
+
+    unpause_thread() ;
+}
+
+void Trick::VariableServerEventWorker::close_all_clients() {
+    std::vector < VariableServerEventClient * > clients ;
+    pthread_mutex_lock(&_clients_mutex) ;
+    clients = _clients ;
+    pthread_mutex_unlock(&_clients_mutex) ;
+
+    for ( VariableServerEventClient * client : clients ) {
+        close_client(client) ;
+    }
+    delete_closed_clients() ;
+}
+
+int Trick::VariableServerEventWorker::update_timer(VariableServerEventClient * client) {
+
+    double period = client->session->get_update_rate() ;
+    if ( period == client->timer_period ) {
+        return 0 ;
+    }
+
+    long long usecs = (long long)(period * 1000000) ;
+    if ( usecs < 1 ) {
+        usecs = 1 ;
+    }
+
+    struct itimerspec spec ;
+    spec.it_interval.tv_sec = usecs / 1000000 ;
+    spec.it_interval.tv_nsec = (usecs % 1000000) * 1000 ;
+    spec.it_value = spec.it_interval ;
+    if ( timerfd_settime(client->timer_fd, 0, &spec, NULL) != 0 ) {
+        return -1 ;
+    }
+    client->timer_period = period ;
+
+    return 0 ;
+}
+
+/**
+@details
+-# Send the session's queued messages if the socket drained
+-# Read everything on the socket and run the complete commands, even if the client closed the connection after
+   sending them
+-# Close the client if the connection closed or the session was told to exit, otherwise follow any change of
+   update rate
+*/
+void Trick::VariableServerEventWorker::handle_socket(VariableServerEventClient * client , unsigned int events) {
+
+    if ( events & EPOLLERR ) {
+        close_client(client) ;
+        return ;
+    }
+
+    if ( events & EPOLLOUT ) {
+        if ( client->session->flush_send_queue() < 0 ) {
+            close_client(client) ;
+            return ;
+        }
+    }
+
+    if ( events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP) ) {
+        int status = client->connection->receive() ;
+        while ( client->session->handle_message() > 0 ) {
+            if ( client->session->get_exit_cmd() ) {
+                break ;
+            }
+        }
+        if ( status < 0 ) {
+            close_client(client) ;
+            return ;
+        }
+    }
+
+    if ( client->session->get_exit_cmd() or update_timer(client) != 0 ) {
+        close_client(client) ;
+    }
+}
+
+void Trick::VariableServerEventWorker::handle_timer(VariableServerEventClient * client) {
+
+    uint64_t expirations ;
+    if ( ::read(client->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations) ) {
+        return ;
+    }
+
+    // Missed periods are not made up, the session copies and writes once
+    int ret = client->session->copy_and_write_async() ;
+    if ( ret < 0 or client->session->get_exit_cmd() or update_timer(client) != 0 ) {
+        close_client(client) ;
+    }
+}
+
+/**
+@details
+-# Stop waiting on the client and remove the session from the variable server.  Once removed, the copy jobs no
+   longer use the session.
+-# Close the connection.  The client is deleted after the events in hand, which may refer to it.
+*/
+void Trick::VariableServerEventWorker::close_client(VariableServerEventClient * client) {
+
+    if ( client->closed ) {
+        return ;
+    }
+    client->closed = true ;
+
+    pthread_mutex_lock(&_clients_mutex) ;
+    _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end()) ;
+    pthread_mutex_unlock(&_clients_mutex) ;
+
+    _engine->get_vs()->delete_session(session_key(client->session)) ;
+
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client->connection->getSocket(), NULL) ;
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, client->timer_fd, NULL) ;
+    close(client->timer_fd) ;
+    client->connection->disconnect() ;
+
+    _closed_clients.push_back(client) ;
+}
+
+void Trick::VariableServerEventWorker::delete_closed_clients() {
+    for ( VariableServerEventClient * client : _closed_clients ) {
+        delete client->session ;
+        delete client->connection ;
+        delete client ;
+    }
+    _closed_clients.clear() ;
+}
+
+void * Trick::VariableServerEventWorker::thread_body() {
+
+    const int max_events = 64 ;
+    struct epoll_event events[max_events] ;
+
+    try {
+        while (1) {
+            // Shutdown here if it's time
+            test_shutdown(exit_event_worker, (void *) this) ;
+
+            // Pause here if we are in a restart condition
+            test_pause() ;
+
+            // Wake at least every 100ms to check for shutdown and pause
+            int num_events = epoll_wait(_epoll_fd, events, max_events, 100) ;
+            if ( num_events < 0 and errno != EINTR ) {
+                perror("Variable server event worker epoll_wait") ;
+                break ;
+            }
+
+            for ( int ii = 0 ; ii < num_events ; ii++ ) {
+                VariableServerEventClient::Source * source = (VariableServerEventClient::Source *)events[ii].data.ptr ;
+                VariableServerEventClient * client = source->client ;
+                if ( client->closed ) {
+                    continue ;
+                }
+
+                // Commands run by the session find it through the engine
+                VariableServerEventEngine::set_current_client(client) ;
+                if ( source->timer ) {
+                    handle_timer(client) ;
+                } else {
+                    handle_socket(client, events[ii].events) ;
+                }
+                VariableServerEventEngine::set_current_client(NULL) ;
+            }
+
+            delete_closed_clients() ;
+        }
+    } catch (Trick::ExecutiveException & ex ) {
+        message_publish(MSG_ERROR, "\nVARIABLE SERVER COMMANDED exec_terminate\n  ROUTINE: %s\n  DIAGNOSTIC: %s\n" ,
+         ex.file.c_str(), ex.message.c_str()) ;
+
+        exec_signal_terminate();
+
+    } catch (const std::exception &ex) {
+        message_publish(MSG_ERROR, "\nVARIABLE SERVER caught std::exception\n  DIAGNOSTIC: %s\n" ,
+         ex.what()) ;
+
+        exec_signal_terminate();
+
+    } catch (abi::__forced_unwind&) {
+        //pthread_exit and pthread_cancel will cause an abi::__forced_unwind to be thrown. Rethrow it.
+        throw;
+    }
+
+    VariableServerEventEngine::set_current_client(NULL) ;
+    thread_shutdown(exit_event_worker, this) ;
+    return NULL ;
+}
+
+#endif
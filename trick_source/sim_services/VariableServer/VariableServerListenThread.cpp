@@ -21,7 +21,8 @@ Trick::VariableServerListenThread::VariableServerListenThread(TCPClientListener
  _user_requested_address(false),
  _broadcast(true),
  _listener(listener),
- _multicast(new MulticastGroup())
+ _multicast(new MulticastGroup()),
+ _event_engine(NULL)
 {
     if (_listener != NULL) {
         // If we were passed a listener
@@ -52,6 +53,10 @@ void Trick::VariableServerListenThread::set_multicast_group (MulticastGroup * gr
     _multicast = group;
 }
 
+void Trick::VariableServerListenThread::set_event_engine (VariableServerEventEngine * engine) {
+    _event_engine = engine;
+}
+
 const char * Trick::VariableServerListenThread::get_hostname() {
     std::string hostname = _requested_source_address;
     char * ret = (char *) malloc(hostname.length() + 1);
@@ -169,17 +174,22 @@ void * Trick::VariableServerListenThread::thread_body() {
                 pthread_mutex_lock(&connectionMutex);
                 pendingConnections ++;
 
-                VariableServerSessionThread * vst = new Trick::VariableServerSessionThread() ;
-                vst->set_connection(_listener->setUpNewConnection());
-                vst->copy_cpus(get_cpus()) ;
-                vst->create_thread() ;
-                ConnectionStatus status = vst->wait_for_accept() ;
-
-                if (status == CONNECTION_FAIL) {
-                    // If the connection failed, the thread will exit.
-                    // Make sure it joins fully before deleting the vst object
-                    vst->join_thread();
-                    delete vst;
+                if (_event_engine != NULL && _event_engine->is_running()) {
+                    // The event engine accepts the connection and serves it with its workers
+                    _event_engine->add_connection(_listener->setUpNewConnection());
+                } else {
+                    VariableServerSessionThread * vst = new Trick::VariableServerSessionThread() ;
+                    vst->set_connection(_listener->setUpNewConnection());
+                    vst->copy_cpus(get_cpus()) ;
+                    vst->create_thread() ;
+                    ConnectionStatus status = vst->wait_for_accept() ;
+
+                    if (status == CONNECTION_FAIL) {
+                        // If the connection failed, the thread will exit.
+                        // Make sure it joins fully before deleting the vst object
+                        vst->join_thread();
+                        delete vst;
+                    }
                 }
                 pendingConnections --;
                 if ( pendingConnections == 0 ) {
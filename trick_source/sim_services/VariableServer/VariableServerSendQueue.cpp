@@ -0,0 +1,294 @@
+
+#include <errno.h>
+#include <limits.h>
+
+#include "trick/VariableServerSendQueue.hh"
+
+Trick::VariableServerSendQueue::VariableServerSendQueue() :
+ _connection(NULL),
+ _queued_bytes(0),
+ _frame(0),
+ _last_frame(0),
+ _max_bytes(DEFAULT_MAX_BYTES),
+ _policy(VS_QUEUE_COALESCE),
+ _failed(false),
+ _dropped_frames(0),
+ _coalesced_frames(0) {
+    pthread_mutex_init(&_queue_mutex, NULL) ;
+}
+
+Trick::VariableServerSendQueue::~VariableServerSendQueue() {
+    pthread_mutex_destroy(&_queue_mutex) ;
+}
+
+void Trick::VariableServerSendQueue::set_connection(ClientConnection * connection) {
+    pthread_mutex_lock(&_queue_mutex) ;
+    _connection = connection ;
+    _queued.clear() ;
+    _queued_bytes = 0 ;
+    _failed = false ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+}
+
+/**
+@details
+-# If nothing is queued, send straight to the connection and queue what it did not take
+-# Otherwise queue the message behind the others so messages stay in order, apply the policy if the queue is
+   over its limit, and send what the connection will take
+*/
+int Trick::VariableServerSendQueue::write(const std::string& message) {
+
+    if ( message.empty() ) {
+        return 0 ;
+    }
+
+    int ret ;
+    pthread_mutex_lock(&_queue_mutex) ;
+    if ( _failed ) {
+        ret = -1 ;
+    } else if ( _queued.empty() ) {
+        // Connections that fail without a system call, like a TCP connection that is not connected, leave errno
+        // alone.  Clear it so an EAGAIN left from before does not look like a full socket.
+        errno = 0 ;
+        ret = queue_unsent(message.data(), message.size(), _connection->write(message)) ;
+    } else {
+        push(message.data(), message.size(), false) ;
+        ret = ( check_limit() < 0 or send_queued() < 0 ) ? -1 : message.size() ;
+    }
+    pthread_mutex_unlock(&_queue_mutex) ;
+
+    return ret ;
+}
+
+int Trick::VariableServerSendQueue::write(char * message, int size) {
+
+    if ( size <= 0 ) {
+        return 0 ;
+    }
+
+    int ret ;
+    pthread_mutex_lock(&_queue_mutex) ;
+    if ( _failed ) {
+        ret = -1 ;
+    } else if ( _queued.empty() ) {
+        errno = 0 ;
+        ret = queue_unsent(message, size, _connection->write(message, size)) ;
+    } else {
+        push(message, size, false) ;
+        ret = ( check_limit() < 0 or send_queued() < 0 ) ? -1 : size ;
+    }
+    pthread_mutex_unlock(&_queue_mutex) ;
+
+    return ret ;
+}
+
+/**
+@details
+-# A connection that would block took nothing, queue the whole message
+-# A connection that returns 0 discarded the message, like a shared memory connection without a client
+-# Queue the rest of a message the connection took part of.  The rest must be sent, the client has the start.
+*/
+int Trick::VariableServerSendQueue::queue_unsent(const char * message, int size, int sent) {
+
+    if ( sent < 0 ) {
+        if ( errno != EAGAIN and errno != EWOULDBLOCK ) {
+            _failed = true ;
+            return -1 ;
+        }
+        sent = 0 ;
+    } else if ( sent == 0 ) {
+        return 0 ;
+    }
+
+    if ( sent < size ) {
+        push(message + sent, size - sent, sent > 0) ;
+        if ( check_limit() < 0 ) {
+            return -1 ;
+        }
+    }
+
+    return size ;
+}
+
+void Trick::VariableServerSendQueue::push(const char * message, int size, bool started) {
+    Message queued_message ;
+    queued_message.bytes.assign(message, size) ;
+    queued_message.frame = _frame ;
+    queued_message.started = started ;
+    _queued.push_back(queued_message) ;
+    _queued_bytes += size ;
+}
+
+int Trick::VariableServerSendQueue::send_queued() {
+
+    while ( ! _queued.empty() ) {
+        Message & front = _queued.front() ;
+        int size = front.bytes.size() < (size_t)INT_MAX ? (int)front.bytes.size() : INT_MAX ;
+        errno = 0 ;
+        int sent = _connection->write(&front.bytes[0], size) ;
+        if ( sent < 0 ) {
+            if ( errno == EAGAIN or errno == EWOULDBLOCK ) {
+                break ;
+            }
+            _failed = true ;
+            return -1 ;
+        }
+        if ( sent == 0 ) {
+            break ;
+        }
+        _queued_bytes -= sent ;
+        if ( sent < (int)front.bytes.size() ) {
+            front.bytes.erase(0, sent) ;
+            front.started = true ;
+            break ;
+        }
+        _queued.pop_front() ;
+    }
+
+    return 0 ;
+}
+
+bool Trick::VariableServerSendQueue::over_limit() const {
+    return _max_bytes > 0 and _queued_bytes > _max_bytes ;
+}
+
+/**
+@details
+-# Find the oldest frame that is complete, that has not started to go out and that is not keep_frame
+-# Remove all of its messages
+*/
+bool Trick::VariableServerSendQueue::drop_oldest_frame(unsigned int keep_frame) {
+
+    // Only the front message can be partly sent
+    unsigned int started_frame = ( ! _queued.empty() and _queued.front().started ) ? _queued.front().frame : 0 ;
+
+    unsigned int drop_frame = 0 ;
+    for ( std::deque<Message>::iterator it = _queued.begin() ; it != _queued.end() ; ++it ) {
+        if ( it->frame != 0 and it->frame != started_frame and it->frame != _frame and it->frame != keep_frame ) {
+            drop_frame = it->frame ;
+            break ;
+        }
+    }
+    if ( drop_frame == 0 ) {
+        return false ;
+    }
+
+    std::deque<Message>::iterator it = _queued.begin() ;
+    while ( it != _queued.end() ) {
+        if ( it->frame == drop_frame ) {
+            _queued_bytes -= it->bytes.size() ;
+            it = _queued.erase(it) ;
+        } else {
+            ++it ;
+        }
+    }
+    return true ;
+}
+
+/**
+@details
+-# Under VS_QUEUE_DISCONNECT the queue fails
+-# Otherwise drop frames from the oldest until the queue is under its limit.  Messages that are not frames are
+   kept even if the queue stays over its limit.
+*/
+int Trick::VariableServerSendQueue::check_limit() {
+
+    if ( ! over_limit() ) {
+        return 0 ;
+    }
+
+    if ( _policy == VS_QUEUE_DISCONNECT ) {
+        _failed = true ;
+        return -1 ;
+    }
+
+    while ( over_limit() and drop_oldest_frame() ) {
+        _dropped_frames++ ;
+    }
+    return 0 ;
+}
+
+void Trick::VariableServerSendQueue::begin_frame() {
+    pthread_mutex_lock(&_queue_mutex) ;
+    if ( ++_last_frame == 0 ) {
+        _last_frame = 1 ;
+    }
+    _frame = _last_frame ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+}
+
+/**
+@details
+-# Under VS_QUEUE_COALESCE the frame just written replaces every older frame still waiting
+-# Apply the policy if the queue is over its limit.  The frame just written may be dropped too.
+*/
+int Trick::VariableServerSendQueue::end_frame() {
+    int ret = 0 ;
+    pthread_mutex_lock(&_queue_mutex) ;
+    _frame = 0 ;
+    if ( _failed ) {
+        ret = -1 ;
+    } else {
+        if ( _policy == VS_QUEUE_COALESCE ) {
+            while ( drop_oldest_frame(_last_frame) ) {
+                _coalesced_frames++ ;
+            }
+        }
+        ret = check_limit() ;
+    }
+    pthread_mutex_unlock(&_queue_mutex) ;
+    return ret ;
+}
+
+int Trick::VariableServerSendQueue::flush() {
+    int ret ;
+    pthread_mutex_lock(&_queue_mutex) ;
+    if ( _failed or send_queued() < 0 ) {
+        ret = -1 ;
+    } else {
+        ret = _queued_bytes < (size_t)INT_MAX ? (int)_queued_bytes : INT_MAX ;
+    }
+    pthread_mutex_unlock(&_queue_mutex) ;
+    return ret ;
+}
+
+void Trick::VariableServerSendQueue::set_max_bytes(unsigned int max_bytes) {
+    pthread_mutex_lock(&_queue_mutex) ;
+    _max_bytes = max_bytes ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+}
+
+unsigned int Trick::VariableServerSendQueue::get_max_bytes() {
+    return _max_bytes ;
+}
+
+void Trick::VariableServerSendQueue::set_policy(VS_QUEUE_POLICY policy) {
+    pthread_mutex_lock(&_queue_mutex) ;
+    _policy = policy ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+}
+
+VS_QUEUE_POLICY Trick::VariableServerSendQueue::get_policy() {
+    return _policy ;
+}
+
+size_t Trick::VariableServerSendQueue::get_queued_bytes() {
+    pthread_mutex_lock(&_queue_mutex) ;
+    size_t ret = _queued_bytes ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+    return ret ;
+}
+
+unsigned long long Trick::VariableServerSendQueue::get_dropped_frames() {
+    pthread_mutex_lock(&_queue_mutex) ;
+    unsigned long long ret = _dropped_frames ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+    return ret ;
+}
+
+unsigned long long Trick::VariableServerSendQueue::get_coalesced_frames() {
+    pthread_mutex_lock(&_queue_mutex) ;
+    unsigned long long ret = _coalesced_frames ;
+    pthread_mutex_unlock(&_queue_mutex) ;
+    return ret ;
+}
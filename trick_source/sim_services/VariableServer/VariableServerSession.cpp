@@ -1,9 +1,9 @@
 #include "trick/VariableServerSession.hh"
+#include "trick/VariableServerCommandParser.hh"
 #include "trick/TrickConstant.hh"
 #include "trick/exec_proto.h"
 #include "trick/Message_proto.hh"
 #include "trick/message_proto.h"
-#include "trick/input_processor_proto.h"
 #include "trick/realtimesync_proto.h"
 
 int Trick::VariableServerSession::instance_counter = 0;
@@ -37,24 +37,78 @@ Trick::VariableServerSession::VariableServerSession() {
     _binary_data = false;
     _byteswap = false;
     _binary_data_nonames = false;
+    _max_message_size = 8192;
+    _send_on_change = false;
+    _keyframe_interval = 100;
+    _cycles_to_keyframe = 0;
+    _sequenced = false;
+    _sequence = 0;
+    _lost_frames = 0;
 
     _exit_cmd = false;
     _pause_cmd = false;
 
     _instance_num = instance_counter++;
 
+    _snapshot = NULL;
+    _frame = NULL;
+
     pthread_mutex_init(&_copy_mutex, NULL);
 }
 
 Trick::VariableServerSession::~VariableServerSession() {
+    clear_snapshot_slots();
     for (unsigned int ii = 0 ; ii < _session_variables.size() ; ii++ ) {
         delete _session_variables[ii];
     }
  }
 
+void Trick::VariableServerSession::set_snapshot(VariableServerSnapshot * snapshot) {
+    pthread_mutex_lock(&_copy_mutex);
+    clear_snapshot_slots();
+    _snapshot = snapshot;
+    for (VariableReference * variable : _session_variables) {
+        add_snapshot_slot(variable);
+    }
+    update_unshared_variables();
+    pthread_mutex_unlock(&_copy_mutex);
+}
+
+void Trick::VariableServerSession::add_snapshot_slot(VariableReference * variable) {
+    VariableServerSnapshot::Slot slot;
+    slot.id = -1;
+    slot.offset = 0;
+    slot.version = 0;
+    if (_snapshot != NULL and variable->isShareable()) {
+        slot = _snapshot->add_value(variable->getAddress(), variable->getSizeBinary());
+    }
+    _snapshot_slots.push_back(slot);
+}
+
+void Trick::VariableServerSession::clear_snapshot_slots() {
+    if (_snapshot != NULL) {
+        for (const VariableServerSnapshot::Slot& slot : _snapshot_slots) {
+            _snapshot->remove_value(slot);
+        }
+    }
+    _snapshot_slots.clear();
+    VariableServerSnapshot::release(_frame);
+    _frame = NULL;
+}
+
+void Trick::VariableServerSession::update_unshared_variables() {
+    _unshared_variables.clear();
+    for (unsigned int ii = 0 ; ii < _session_variables.size() ; ii++ ) {
+        if (ii >= _snapshot_slots.size() or _snapshot_slots[ii].id < 0) {
+            _unshared_variables.push_back(_session_variables[ii]);
+        }
+    }
+}
+
 
 void Trick::VariableServerSession::set_connection(ClientConnection * conn) {
     _connection = conn;
+    _send_queue.set_connection(conn);
     log_connection_opened();
 }
 
@@ -101,10 +155,19 @@ void Trick::VariableServerSession::unpause_copy() {
     pthread_mutex_unlock(&_copy_mutex);
 }
 
+// Called with the copy paused.  The references are looked up again when they are next copied, so
+// they are no longer shared.
 void Trick::VariableServerSession::disconnect_references() {
+    clear_snapshot_slots();
     for (VariableReference * variable : _session_variables) {
         variable->tagAsInvalid();
+        add_snapshot_slot(variable);
     }
+    update_unshared_variables();
+}
+
+void Trick::VariableServerSession::set_sequenced(bool on_off) {
+    _sequenced = on_off;
 }
 
 long long Trick::VariableServerSession::get_next_tics() const {
@@ -159,7 +222,7 @@ int Trick::VariableServerSession::handle_message() {
     int nbytes = _connection->read(received_message);
     if (nbytes > 0) {
         log_received_message(received_message);
-        ip_parse(received_message.c_str()); /* returns 0 if no parsing error */
+        VariableServerCommandParser::run(received_message); /* returns 0 if no parsing error */
     }
 
     return nbytes;
@@ -238,6 +301,10 @@ std::ostream& Trick::operator<< (std::ostream& s, const Trick::VariableServerSes
         s << "    \"format\":\"ASCII\",\n";
     }
     s << "    \"update_rate\":" << session.get_update_rate() << ",\n";
+    Trick::VariableServerSendQueue & send_queue = const_cast<Trick::VariableServerSendQueue &>(session._send_queue);
+    s << "    \"queued_bytes\":" << send_queue.get_queued_bytes() << ",\n";
+    s << "    \"dropped_frames\":" << send_queue.get_dropped_frames() << ",\n";
+    s << "    \"coalesced_frames\":" << send_queue.get_coalesced_frames() << ",\n";
 
     s << "    \"variables\":[\n";
 
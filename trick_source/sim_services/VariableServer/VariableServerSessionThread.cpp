@@ -17,7 +17,8 @@ static int instance_num = 0;
 Trick::VariableServerSessionThread::VariableServerSessionThread() : VariableServerSessionThread (new VariableServerSession()) {}
 
 Trick::VariableServerSessionThread::VariableServerSessionThread(VariableServerSession * session) :
- Trick::SysThread(std::string("VarServer" + std::to_string(instance_num++))) , _debug(0), _session(session), _connection(NULL) {
+ Trick::SysThread(std::string("VarServer" + std::to_string(instance_num++))) , _debug(0), _session(session), _connection(NULL),
+ _read_commands(true) {
 
     _connection_status = CONNECTION_PENDING ;
 
@@ -66,6 +67,10 @@ void Trick::VariableServerSessionThread::set_connection(Trick::ClientConnection
     _connection = in_connection;
 }
 
+void Trick::VariableServerSessionThread::set_read_commands(bool on_off) {
+    _read_commands = on_off;
+}
+
 Trick::ConnectionStatus Trick::VariableServerSessionThread::wait_for_accept() {
 
     pthread_mutex_lock(&_connection_status_mutex);
@@ -11,9 +11,59 @@
 #include "trick/exec_proto.h"
 
 #include "trick/VariableServerSessionThread.hh"
+#include "trick/SharedMemoryConnection.hh"
 
 void exit_var_thread(void *in_vst) ;
 
+void Trick::VariableServerSessionThread::start_session() {
+
+    // if log is set on for variable server (e.g., in input file), turn log on for each client
+    if (_vs->get_log()) {
+        _session->set_log(true);
+    }
+
+    if (_vs->get_session_log()) {
+        _session->set_session_log(true);
+    }
+
+    if (_vs->get_info_msg()) {
+        _session->set_info_message(true);
+    }
+
+    // Give the initialized connection to the session
+    // Don't touch the connection anymore until we shut them both down
+    _session->set_connection(_connection);
+    _vs->add_session( pthread_self(), _session );
+}
+
+/**
+@details
+-# Only a shared memory connection serves another client when its session ends
+-# Wait for the client to be gone.  A client that sent var_exit may still be connected.
+-# Release the segment for the next client and replace the session with a new one
+*/
+bool Trick::VariableServerSessionThread::next_client() {
+
+    SharedMemoryConnection * shm_connection = dynamic_cast<SharedMemoryConnection *>(_connection) ;
+    if ( shm_connection == NULL or !shm_connection->isInitialized() ) {
+        return false ;
+    }
+
+    while ( shm_connection->release_client() != 0 ) {
+        test_shutdown(exit_var_thread, (void *) this);
+        usleep(100000) ;
+    }
+
+    pthread_mutex_lock(&_connection_status_mutex);
+    _vs->delete_session(pthread_self());
+    delete _session ;
+    _session = new VariableServerSession() ;
+    start_session() ;
+    pthread_mutex_unlock(&_connection_status_mutex);
+
+    return true ;
+}
+
 void * Trick::VariableServerSessionThread::thread_body() {
 
     // Check for short running sims
@@ -39,23 +89,7 @@ void * Trick::VariableServerSessionThread::thread_body() {
         thread_shutdown();
     }
 
-    // if log is set on for variable server (e.g., in input file), turn log on for each client
-    if (_vs->get_log()) {
-        _session->set_log(true);
-    }
-
-    if (_vs->get_session_log()) {
-        _session->set_session_log(true);
-    }
-
-    if (_vs->get_info_msg()) {
-        _session->set_info_message(true);
-    }
-
-    // Give the initialized connection to the session
-    // Don't touch the connection anymore until we shut them both down
-    _session->set_connection(_connection);
-    _vs->add_session( pthread_self(), _session );
+    start_session() ;
 
     // Tell main that we are ready
     pthread_mutex_lock(&_connection_status_mutex);
@@ -64,34 +98,44 @@ void * Trick::VariableServerSessionThread::thread_body() {
     pthread_mutex_unlock(&_connection_status_mutex);
 
     try {
-        while (1) {
-            // Shutdown here if it's time
-            test_shutdown(exit_var_thread, (void *) this);
-
-            // Pause here if we are in a restart condition
-            test_pause();
-
-            // Look for a message from the client
-            // Parse and execute if one is availible
-            int read_status = _session->handle_message();
-            if ( read_status < 0 ) {
-                break ;
-            }
-
-            // Check to see if exit is necessary
-            if (_session->get_exit_cmd() == true) {
-                break;
+        // A shared memory connection outlives its client, the next client gets a new session
+        do {
+            while (1) {
+                // Shutdown here if it's time
+                test_shutdown(exit_var_thread, (void *) this);
+
+                // Pause here if we are in a restart condition
+                test_pause();
+
+                // Look for a message from the client
+                // Parse and execute if one is availible
+                if ( _read_commands ) {
+                    int read_status = _session->handle_message();
+                    if ( read_status < 0 ) {
+                        break ;
+                    }
+                }
+
+                // Check to see if exit is necessary
+                if (_session->get_exit_cmd() == true) {
+                    break;
+                }
+
+                // Tell session it's time to copy and write if the mode is correct
+                int ret =_session->copy_and_write_async(); 
+                if (ret < 0) {
+                    break;
+                }
+
+                // Send what a slow client did not take earlier
+                if (_session->flush_send_queue() < 0) {
+                    break;
+                }
+
+                // Sleep for the appropriate cycle time
+                usleep((unsigned int) (_session->get_update_rate() * 1000000));
             }
-
-            // Tell session it's time to copy and write if the mode is correct
-            int ret =_session->copy_and_write_async(); 
-            if (ret < 0) {
-                break;
-            }
-
-            // Sleep for the appropriate cycle time
-            usleep((unsigned int) (_session->get_update_rate() * 1000000));
-        }
+        } while ( next_client() ) ;
     } catch (Trick::ExecutiveException & ex ) {
         message_publish(MSG_ERROR, "\nVARIABLE SERVER COMMANDED exec_terminate\n  ROUTINE: %s\n  DIAGNOSTIC: %s\n" ,
          ex.file.c_str(), ex.message.c_str()) ;
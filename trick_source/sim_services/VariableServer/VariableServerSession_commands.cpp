@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <udunits2.h>
 #include "trick/VariableServerSession.hh"
+#include "trick/UDPConnection.hh"
 #include "trick/variable_server_message_types.h"
 #include "trick/memorymanager_c_intf.h"
 #include "trick/exec_proto.h"
@@ -25,7 +26,13 @@ int Trick::VariableServerSession::var_add(std::string in_name) {
         new_var = new VariableReference(in_name);
     }
 
+    pthread_mutex_lock(&_copy_mutex) ;
     _session_variables.push_back(new_var) ;
+    add_snapshot_slot(new_var) ;
+    update_unshared_variables() ;
+    // Indexes of changed variables refer to the new list
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
 
     return(0) ;
 }
@@ -74,14 +81,22 @@ int Trick::VariableServerSession::var_send_once(std::string in_name, int num_var
 
 int Trick::VariableServerSession::var_remove(std::string in_name) {
 
+    pthread_mutex_lock(&_copy_mutex) ;
     for (unsigned int ii = 0 ; ii < _session_variables.size() ; ii++ ) {
         std::string var_name = _session_variables[ii]->getName();
         if ( ! var_name.compare(in_name) ) {
+            if (_snapshot != NULL) {
+                _snapshot->remove_value(_snapshot_slots[ii]) ;
+            }
+            _snapshot_slots.erase(_snapshot_slots.begin() + ii) ;
             delete _session_variables[ii];
             _session_variables.erase(_session_variables.begin() + ii) ;
             break ;
         }
     }
+    update_unshared_variables() ;
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
 
     return(0) ;
 
@@ -120,7 +135,7 @@ int Trick::VariableServerSession::var_exists(std::string in_name) {
             message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending 1 binary byte\n", _connection, _connection->getClientTag().c_str());
         }
 
-        _connection->write(buf1, 5);
+        _send_queue.write(buf1, 5);
     } else {
         /* send ascii "1" or "0" */
         sprintf(buf1, "%d\t%d\n", VS_VAR_EXISTS, (error==false));
@@ -131,7 +146,7 @@ int Trick::VariableServerSession::var_exists(std::string in_name) {
         if (write_string.length() != strlen(buf1)) {
             std::cout << "PROBLEM WITH STRING LENGTH: VAR_EXISTS ASCII" << std::endl;
         }
-        _connection->write(write_string);
+        _send_queue.write(write_string);
     }
 
     return(0) ;
@@ -139,16 +154,24 @@ int Trick::VariableServerSession::var_exists(std::string in_name) {
 
 int Trick::VariableServerSession::var_clear() {
 
+    pthread_mutex_lock(&_copy_mutex) ;
+    clear_snapshot_slots() ;
     while( !_session_variables.empty() ) {
         delete _session_variables.back();
         _session_variables.pop_back();
     }
+    _unshared_variables.clear() ;
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
 
     return(0) ;
 }
 
 int Trick::VariableServerSession::var_send() {
     copy_sim_data();
+    pthread_mutex_lock(&_copy_mutex) ;
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
     write_data();
     return(0) ;
 }
@@ -181,12 +204,18 @@ int Trick::VariableServerSession::var_ascii() {
 
 int Trick::VariableServerSession::var_binary() {
     _binary_data = 1 ;
+    pthread_mutex_lock(&_copy_mutex) ;
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
     return(0) ;
 }
 
 int Trick::VariableServerSession::var_binary_nonames() {
     _binary_data = 1 ;
     _binary_data_nonames = 1 ;
+    pthread_mutex_lock(&_copy_mutex) ;
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
     return(0) ;
 }
 
@@ -267,6 +296,63 @@ int Trick::VariableServerSession::var_byteswap(bool on_off) {
     return(0) ;
 }
 
+int Trick::VariableServerSession::var_send_on_change(bool on_off) {
+    _send_on_change = on_off ;
+    pthread_mutex_lock(&_copy_mutex) ;
+    _cycles_to_keyframe = 0 ;
+    pthread_mutex_unlock(&_copy_mutex) ;
+    return(0) ;
+}
+
+int Trick::VariableServerSession::var_set_keyframe_interval(int cycles) {
+    if ( cycles < 0 ) {
+        message_publish(MSG_ERROR, "tag=<%s> var_set_keyframe_interval %d must not be negative.\n",
+                        _connection->getClientTag().c_str(), cycles) ;
+        return(-1) ;
+    }
+    pthread_mutex_lock(&_copy_mutex) ;
+    _keyframe_interval = cycles ;
+    pthread_mutex_unlock(&_copy_mutex) ;
+    return(0) ;
+}
+
+int Trick::VariableServerSession::var_set_send_queue_size(int bytes) {
+    if ( bytes < 0 ) {
+        message_publish(MSG_ERROR, "tag=<%s> var_set_send_queue_size %d must not be negative.\n",
+                        _connection->getClientTag().c_str(), bytes) ;
+        return(-1) ;
+    }
+    _send_queue.set_max_bytes(bytes) ;
+    return(0) ;
+}
+
+int Trick::VariableServerSession::var_set_send_queue_policy(int policy) {
+    if ( policy != VS_QUEUE_DROP_OLDEST and policy != VS_QUEUE_COALESCE and policy != VS_QUEUE_DISCONNECT ) {
+        message_publish(MSG_ERROR, "tag=<%s> var_set_send_queue_policy %d is not a send queue policy.\n",
+                        _connection->getClientTag().c_str(), policy) ;
+        return(-1) ;
+    }
+    _send_queue.set_policy((VS_QUEUE_POLICY)policy) ;
+    return(0) ;
+}
+
+int Trick::VariableServerSession::var_set_max_message_size(int size) {
+    // A binary message header is 12 bytes
+    if ( size < 16 ) {
+        message_publish(MSG_ERROR, "tag=<%s> var_set_max_message_size %d is too small, keeping %d.\n",
+                        _connection->getClientTag().c_str(), size, _max_message_size) ;
+        return(-1) ;
+    }
+    ClientConnection::ConnectionType type = _connection->getConnectionType() ;
+    if ( (type == ClientConnection::UDP or type == ClientConnection::MCAST) and size > UDPConnection::MAX_DATAGRAM_SIZE ) {
+        message_publish(MSG_ERROR, "tag=<%s> var_set_max_message_size %d does not fit in a UDP datagram, keeping %d.\n",
+                        _connection->getClientTag().c_str(), size, _max_message_size) ;
+        return(-1) ;
+    }
+    _max_message_size = size ;
+    return(0) ;
+}
+
 bool Trick::VariableServerSession::get_send_stdio() {
     return _send_stdio ;
 }
@@ -297,7 +383,7 @@ int Trick::VariableServerSession::send_list_size() {
             message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %d event variables\n", _connection, _connection->getClientTag().c_str(), var_count);
         }
 
-        _connection->write(buf1, sizeof (buf1));
+        _send_queue.write(buf1, sizeof (buf1));
     } else {
         std::stringstream write_string;
         write_string << VS_LIST_SIZE << "\t" << var_count << "\n";
@@ -306,7 +392,37 @@ int Trick::VariableServerSession::send_list_size() {
             message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending number of event variables:\n%s\n", _connection, _connection->getClientTag().c_str(), write_string.str().c_str()) ;
         }
 
-        _connection->write(write_string.str());
+        _send_queue.write(write_string.str());
+    }
+
+    return 0 ;
+}
+
+int Trick::VariableServerSession::send_channel_info(std::string address, int port) {
+
+    if (_binary_data) {
+        // send in the binary message header format, with the port in place of the number of variables:
+        // <message_indicator><message_size><port><address>
+        std::vector<char> buf(12 + address.size()) ;
+        char * out = &buf[0] ;
+        out = write_binary_int(out, VS_CHANNEL_INFO, _byteswap) ;
+        out = write_binary_int(out, 8 + address.size(), _byteswap) ;
+        out = write_binary_int(out, port, _byteswap) ;
+        memcpy(out, address.data(), address.size()) ;
+
+        if (_debug >= 2) {
+            message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending channel %s:%d\n", _connection, _connection->getClientTag().c_str(), address.c_str(), port);
+        }
+
+        _send_queue.write(&buf[0], buf.size());
+    } else {
+        std::stringstream write_string;
+        write_string << VS_CHANNEL_INFO << "\t" << address << "\t" << port << "\n";
+        if (_debug >= 2) {
+            message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending channel:\n%s\n", _connection, _connection->getClientTag().c_str(), write_string.str().c_str()) ;
+        }
+
+        _send_queue.write(write_string.str());
     }
 
     return 0 ;
@@ -329,7 +445,7 @@ int Trick::VariableServerSession::transmit_file(std::string filename) {
         message_publish(MSG_ERROR,"Variable Server Error: Cannot open %s.\n", filename.c_str()) ;
         sprintf(buffer, "%d\t-1\n", VS_SIE_RESOURCE) ;
         std::string message(buffer);
-        _connection->write(message);
+        _send_queue.write(message);
         return(-1) ;
     }
 
@@ -338,7 +454,7 @@ int Trick::VariableServerSession::transmit_file(std::string filename) {
 
     sprintf(buffer, "%d\t%u\n\0" , VS_SIE_RESOURCE, file_size) ;
     std::string message(buffer);
-    _connection->write(message);
+    _send_queue.write(message);
     rewind(fp) ;
 
     // Switch to blocking writes since this could be a large transfer.
@@ -350,7 +466,7 @@ int Trick::VariableServerSession::transmit_file(std::string filename) {
         bytes_read = fread(buffer , 1 , packet_size , fp) ;
         message = std::string(buffer);
         message.resize(bytes_read);
-        ret = _connection->write(message);
+        ret = _send_queue.write(message);
         if (ret != (int)bytes_read) {
             message_publish(MSG_ERROR,"Variable Server Error: Failed to send file. Bytes read: %d Bytes sent: %d\n", bytes_read, ret) ;
             return(-1);
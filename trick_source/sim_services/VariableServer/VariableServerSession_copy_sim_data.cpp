@@ -10,9 +10,44 @@
 // These actually do the copying
 
 int Trick::VariableServerSession::copy_sim_data() {
+    // During a variable server copy job the shared variables come from the snapshot
+    if (_snapshot != NULL and _snapshot->in_copy()) {
+        return copy_snapshot_data();
+    }
     return copy_sim_data(_session_variables, true);
 }
 
+int Trick::VariableServerSession::copy_snapshot_data() {
+
+    if (_session_variables.size() == 0) {
+        return 0;
+    }
+
+    if ( pthread_mutex_trylock(&_copy_mutex) == 0 ) {
+        VariableServerSnapshot::Frame * frame = _snapshot->get_frame(_snapshot_slots);
+        if (frame == NULL) {
+            // A session is registering variables, copy everything this time
+            pthread_mutex_unlock(&_copy_mutex) ;
+            return copy_sim_data(_session_variables, true);
+        }
+
+        // Get the simulation time we start this copy
+        _time = (double)exec_get_time_tics() / exec_get_time_tic_value() ;
+
+        for (auto curr_var : _unshared_variables ) {
+            curr_var->stageValue();
+        }
+
+        // The shared values are staged from the frame when they are written
+        VariableServerSnapshot::release(_frame);
+        _frame = frame;
+
+        pthread_mutex_unlock(&_copy_mutex) ;
+    }
+
+    return 0;
+}
+
 int Trick::VariableServerSession::copy_sim_data(std::vector<VariableReference *>& given_vars, bool cyclical) {
 
     if (given_vars.size() == 0) {
@@ -28,6 +63,12 @@ int Trick::VariableServerSession::copy_sim_data(std::vector<VariableReference *>
             curr_var->stageValue();
         }
 
+        // The values just staged are newer than the snapshot frame
+        if (&given_vars == &_session_variables) {
+            VariableServerSnapshot::release(_frame);
+            _frame = NULL;
+        }
+
         pthread_mutex_unlock(&_copy_mutex) ;
     }
 
@@ -5,8 +5,10 @@ PROGRAMMERS: (((Alex Lin) (NASA) (8/06) (--)))
 
 #include <iostream>
 #include <sstream>
+#include <string.h>
 #include <pthread.h>
 #include <iomanip> // for setprecision
+#include <limits>
 #include "trick/VariableServerSession.hh"
 #include "trick/parameter_types.h"
 #include "trick/bitfield_proto.h"
@@ -15,31 +17,79 @@ PROGRAMMERS: (((Alex Lin) (NASA) (8/06) (--)))
 #include "trick/message_proto.h"
 #include "trick/message_type.h"
 
-#define MAX_MSG_LEN    8192
+char * Trick::VariableServerSession::write_binary_int(char * out, int value, bool byteswap) {
+    if (byteswap) {
+        value = trick_byteswap_int(value);
+    }
+    memcpy(out, &value, sizeof(int));
+    return out + sizeof(int);
+}
 
+bool Trick::VariableServerSession::fits_in_message(int size) const {
+    return size <= _max_message_size;
+}
 
+/**
+@details
+-# Fill in the header of the message built in the message buffer
+-# Send the message
+*/
+int Trick::VariableServerSession::write_binary_message(VS_MESSAGE_TYPE message_type, int message_size, int num_vars) {
+
+    // Header format:
+    // <message_indicator><message_size><num_vars>
+    // VS_CHANNEL_LIST messages add <sequence> so receivers can tell when they missed one
+    char * out = &_message_buffer[0];
+    out = write_binary_int(out, message_type, _byteswap);
+    out = write_binary_int(out, message_size - 4, _byteswap);
+    out = write_binary_int(out, num_vars, _byteswap);
+    if (message_type == VS_CHANNEL_LIST) {
+        write_binary_int(out, _sequence++, _byteswap);
+    }
 
-int Trick::VariableServerSession::write_binary_data(const std::vector<VariableReference *>& given_vars, VS_MESSAGE_TYPE message_type) {
-    typedef std::vector<VariableReference *> VarList;
-    typedef std::pair<int,VarList> MessageData;
+    if (_debug >= 2) {
+        message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %u binary bytes containing %d variables.\n",
+                        _connection, _connection->getClientTag().c_str(), message_size, num_vars);
+    }
+
+    return _send_queue.write(&_message_buffer[0], message_size);
+}
+
+/**
+@details
+-# Serialize each variable straight into the session's message buffer, preceded by its index when indices are
+   given.  The buffer is kept between calls, so
+   it is only allocated while it grows to the largest message the client receives.
+-# When the next variable would make the message larger than the client allows, send the message built so far
+   and start a new one.  Variables too large for any message are skipped.
+-# Send the last message
+*/
+int Trick::VariableServerSession::write_binary_data(const std::vector<VariableReference *>& given_vars, VS_MESSAGE_TYPE message_type,
+                                                    const std::vector<int> * indices) {
 
     // Some constants to make size calculations more readable
-    static const int header_size = 12;
+    const int header_size = (message_type == VS_CHANNEL_LIST) ? 16 : 12;
     static const int sizeof_size = 4;
     static const int type_size = 4;
+    static const int index_size = 4;
 
-    std::vector<MessageData> message_sizes_and_vars;
+    int message_size = header_size;
+    int num_vars = 0;
+    if (_message_buffer.size() < header_size) {
+        _message_buffer.resize(header_size);
+    }
 
-    // Calculate how many messages and what vars in each
-    int total_size = header_size;
-    VarList curr_message_vars;
-    for (int i = 0; i < given_vars.size(); i++) {
-        VariableReference * var = given_vars[i];
+    for (unsigned int ii = 0; ii < given_vars.size(); ii++) {
+        VariableReference * var = given_vars[ii];
+        const std::string& name = var->getName();
 
         int total_var_size = 0;
+        if (indices != NULL) {
+            total_var_size += index_size;
+        }
         if (!_binary_data_nonames) {
             total_var_size += sizeof_size;
-            total_var_size += var->getName().size();
+            total_var_size += name.size();
         }
 
         total_var_size += type_size;
@@ -47,83 +97,52 @@ int Trick::VariableServerSession::write_binary_data(const std::vector<VariableRe
         total_var_size += var->getSizeBinary();
 
         // Check if this variable will fit in a message at all
-        if (header_size + total_var_size > MAX_MSG_LEN) {
+        if (!fits_in_message(header_size + total_var_size)) {
             message_publish(MSG_WARNING, "tag=<%s> Variable Server buffer[%d] too small (need %d) for symbol %s, SKIPPING IT.\n", 
-                                _connection->getClientTag().c_str(), MAX_MSG_LEN, header_size + total_var_size, var->getName().c_str());
+                                _connection->getClientTag().c_str(), _max_message_size, header_size + total_var_size, name.c_str());
             
             continue;
         }
 
-        // If this variable won't fit in the current message, truncate the message and plan to put this var in a new one
-        if (total_size + total_var_size > MAX_MSG_LEN) {
-            message_sizes_and_vars.emplace_back(MessageData(total_size, curr_message_vars));
-            
+        // If this variable won't fit in the current message, send the message and put this var in a new one
+        if (!fits_in_message(message_size + total_var_size)) {
             if (_debug >= 2) {
                 message_publish(MSG_DEBUG, "%p tag=<%s> var_server buffer[%d] too small (need %d), sending multiple binary packets.\n",
-                                _connection, _connection->getClientTag().c_str(), MAX_MSG_LEN, total_size + total_var_size);
+                                _connection, _connection->getClientTag().c_str(), _max_message_size, message_size + total_var_size);
             }
 
-            total_size = header_size;
-            curr_message_vars.clear();
+            write_binary_message(message_type, message_size, num_vars);
+            message_size = header_size;
+            num_vars = 0;
         }
-        total_size += total_var_size;
-        curr_message_vars.push_back(var);
-    }
 
-    message_sizes_and_vars.emplace_back(MessageData(total_size, curr_message_vars));
-    
-    // Now write out all of these messages
-    int var_index = 0;
-    for (const auto& message_info : message_sizes_and_vars) {
-        int curr_message_size = message_info.first;
-        VarList curr_message_vars = message_info.second;
-
-        std::stringstream stream;
-
-        int written_message_type = message_type;
-        int written_header_size = curr_message_size - 4;
-        int written_num_vars = curr_message_vars.size();
-
-        if (_byteswap) {
-            written_message_type = trick_byteswap_int(written_message_type);
-            written_header_size = trick_byteswap_int(written_header_size);
-            written_num_vars = trick_byteswap_int(written_num_vars);
+        if (_message_buffer.size() < message_size + total_var_size) {
+            _message_buffer.resize(message_size + total_var_size);
         }
 
-        // Header format:
-        // <message_indicator><message_size><num_vars>
-
-        // Write the header first
-        stream.write((char *)(&written_message_type), sizeof(int)); 
-        stream.write((char *)(&written_header_size), sizeof(int)); 
-        stream.write((char *)(&written_num_vars), sizeof(int));
-
-        // Write variables next
-        for (VariableReference * var : curr_message_vars) {
-            // Each variable is formatted as:
-            // <namelength><name><type><size><value
-            // namelength and name are omitted if _binary_data_nonames is on
-
-            if (!_binary_data_nonames) {
-                var->writeNameLengthBinary(stream, _byteswap);
-                var->writeNameBinary(stream, _byteswap);
-            }
-            var->writeTypeBinary(stream, _byteswap);
-            var->writeSizeBinary(stream, _byteswap);
-            var->writeValueBinary(stream, _byteswap);
+        // Each variable is formatted as:
+        // <index><namelength><name><type><size><value>
+        // index is only sent with indices, namelength and name are omitted if _binary_data_nonames is on
+        char * out = &_message_buffer[message_size];
+        if (indices != NULL) {
+            out = write_binary_int(out, (*indices)[ii], _byteswap);
         }
-
-        if (_debug >= 2) {
-            message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %u binary bytes containing %d variables.\n",
-                            _connection, _connection->getClientTag().c_str(), curr_message_size, curr_message_vars.size());
+        if (!_binary_data_nonames) {
+            out = write_binary_int(out, name.size(), _byteswap);
+            memcpy(out, name.data(), name.size());
+            out += name.size();
         }
+        out = write_binary_int(out, var->getType(), _byteswap);
+        out = write_binary_int(out, var->getSizeBinary(), _byteswap);
+        var->writeValueBinary(out, _byteswap);
 
-        // Send it out!
-        char write_buf[MAX_MSG_LEN];
-        stream.read(write_buf, curr_message_size);
-        _connection->write(write_buf, curr_message_size);
+        message_size += total_var_size;
+        num_vars++;
     }
 
+    // Send it out!
+    write_binary_message(message_type, message_size, num_vars);
+
     return 0;
 }
 
@@ -146,29 +165,29 @@ int Trick::VariableServerSession::write_ascii_data(const std::vector<VariableRef
         int var_size = var_string.size();
 
         // Check if this single variable is too big, truncate if so
-        if (var_size + 2 > MAX_MSG_LEN) {
+        if (!fits_in_message(var_size + 2)) {
             message_publish(MSG_WARNING, "tag=<%s> Variable Server buffer[%d] too small for symbol %s, TRUNCATED IT.\n",
-                            _connection->getClientTag().c_str(), MAX_MSG_LEN, given_vars[i]->getName().c_str());
+                            _connection->getClientTag().c_str(), _max_message_size, given_vars[i]->getName().c_str());
             
-            var_string = var_string.substr(0, MAX_MSG_LEN-2);
+            var_string = var_string.substr(0, _max_message_size-2);
             var_size = var_string.size();
         }
 
         // Check that there's enough room for the next variable, tab character, and possible newline
-        if (message_size + var_size + 2 > MAX_MSG_LEN) {
+        if (!fits_in_message(message_size + var_size + 2)) {
     
             // Write out an incomplete message
             std::string message = message_stream.str();
 
             if (_debug >= 2) {
                 message_publish(MSG_DEBUG, "%p tag=<%s> var_server buffer[%d] too small (need %d), sending multiple ascii packets.\n",
-                                _connection, _connection->getClientTag().c_str(), MAX_MSG_LEN, message_size + var_size + 2);
+                                _connection, _connection->getClientTag().c_str(), _max_message_size, message_size + var_size + 2);
 
                 message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %d ascii bytes:\n%s\n",
                                 _connection, _connection->getClientTag().c_str(), message_size, message.c_str());
             }
 
-            int result = _connection->write(message);
+            int result = _send_queue.write(message);
             if (result < 0) {
                 return result;
             }
@@ -193,12 +212,12 @@ int Trick::VariableServerSession::write_ascii_data(const std::vector<VariableRef
                         _connection, _connection->getClientTag().c_str(), message.size(), message.c_str());
     }
 
-    int result = _connection->write(message);
+    int result = _send_queue.write(message);
     return result;
 }
 
 int Trick::VariableServerSession::write_data() {
-    return write_data(_session_variables, VS_VAR_LIST);
+    return write_data(_session_variables, _sequenced ? VS_CHANNEL_LIST : VS_VAR_LIST);
 }
 
 int Trick::VariableServerSession::write_data(std::vector<VariableReference *>& given_vars, VS_MESSAGE_TYPE message_type) { 
@@ -210,6 +229,18 @@ int Trick::VariableServerSession::write_data(std::vector<VariableReference *>& g
     int result = 0;
 
     if ( pthread_mutex_trylock(&_copy_mutex) == 0 ) {
+        // Stage the shared variables from the snapshot frame taken by the last copy
+        if (_frame != NULL and &given_vars == &_session_variables) {
+            for (unsigned int ii = 0 ; ii < _session_variables.size() ; ii++ ) {
+                const char * value = VariableServerSnapshot::value(_frame, _snapshot_slots[ii]);
+                if (value != NULL) {
+                    _session_variables[ii]->stageValueFrom(value);
+                }
+            }
+            VariableServerSnapshot::release(_frame);
+            _frame = NULL;
+        }
+
         // Check that all of the variables are staged
         for (VariableReference * variable : given_vars ) {
             if (!variable->isStaged()) {
@@ -223,16 +254,69 @@ int Trick::VariableServerSession::write_data(std::vector<VariableReference *>& g
             variable->prepareForWrite();
         }
 
+        // In send on change mode pick the cyclic updates that changed, or send all of them as a keyframe
+        bool send_changes = (_send_on_change and _binary_data and &given_vars == &_session_variables);
+        if (send_changes) {
+            if (_cycles_to_keyframe <= 0) {
+                _cycles_to_keyframe = (_keyframe_interval > 0) ? _keyframe_interval - 1 : std::numeric_limits<int>::max();
+                for (VariableReference * variable : given_vars ) {
+                    variable->markWriteValueSent();
+                }
+                send_changes = false;
+            } else {
+                _cycles_to_keyframe--;
+                _changed_variables.clear();
+                _changed_indices.clear();
+                for (unsigned int ii = 0 ; ii < given_vars.size() ; ii++ ) {
+                    if (given_vars[ii]->writeValueChanged()) {
+                        given_vars[ii]->markWriteValueSent();
+                        _changed_variables.push_back(given_vars[ii]);
+                        _changed_indices.push_back(ii);
+                    }
+                }
+            }
+        }
+
         pthread_mutex_unlock(&_copy_mutex) ;
 
+        // The messages of a cyclic update are a frame the send queue may drop if the client falls behind
+        bool frame = (&given_vars == &_session_variables);
+        if (frame) {
+            _send_queue.begin_frame();
+        }
+
         // Send out in correct format
-        if (_binary_data) {
+        if (send_changes) {
+            if (!_changed_variables.empty()) {
+                result = write_binary_data(_changed_variables, VS_VAR_LIST_CHANGES, &_changed_indices);
+            }
+        } else if (_binary_data) {
             result = write_binary_data(given_vars, message_type );
         } else {
             // ascii mode
             result = write_ascii_data(given_vars, message_type );
         }
+
+        if (frame) {
+            if (_send_queue.end_frame() < 0) {
+                result = -1;
+            }
+            // Changes in a dropped frame never reach the client, send everything next time.  Like the copy above
+            // this does not wait for the lock, a frame lost now is still counted on the next update.
+            unsigned long long lost_frames = _send_queue.get_dropped_frames() + _send_queue.get_coalesced_frames();
+            if ( pthread_mutex_trylock(&_copy_mutex) == 0 ) {
+                if (lost_frames != _lost_frames) {
+                    _lost_frames = lost_frames;
+                    _cycles_to_keyframe = 0;
+                }
+                pthread_mutex_unlock(&_copy_mutex) ;
+            }
+        }
     }
 
     return result;
 }
+
+int Trick::VariableServerSession::flush_send_queue() {
+    return _send_queue.flush();
+}
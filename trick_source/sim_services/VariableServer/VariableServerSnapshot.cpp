@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "trick/VariableServerSnapshot.hh"
+
+Trick::VariableServerSnapshot::VariableServerSnapshot() :
+ num_values(0) ,
+ frame_bytes(0) ,
+ current(NULL) ,
+ current_taken(false) ,
+ copying(false) ,
+ copy_thread(pthread_t()) ,
+ version(0) {
+    pthread_mutex_init(&values_mutex, NULL) ;
+}
+
+Trick::VariableServerSnapshot::~VariableServerSnapshot() {
+    for ( Frame * frame : frames ) {
+        free(frame->values) ;
+        delete frame ;
+    }
+    pthread_mutex_destroy(&values_mutex) ;
+}
+
+Trick::VariableServerSnapshot::Slot Trick::VariableServerSnapshot::add_value( void * address , int size ) {
+
+    Slot slot ;
+
+    pthread_mutex_lock(&values_mutex) ;
+
+    auto it = slot_ids.find(std::make_pair(address, size)) ;
+    if ( it != slot_ids.end() ) {
+        slot.id = it->second ;
+    } else {
+        // Reuse a released slot of the same size, its offset fits the value
+        slot.id = -1 ;
+        for ( unsigned int ii = 0 ; ii < values.size() ; ii++ ) {
+            if ( values[ii].refs == 0 and values[ii].size == size ) {
+                slot.id = ii ;
+                break ;
+            }
+        }
+        if ( slot.id == -1 ) {
+            Value new_value ;
+            new_value.size = size ;
+            new_value.offset = frame_bytes ;
+            new_value.refs = 0 ;
+            new_value.copied = 0 ;
+            // keep every value 8 byte aligned in the frames
+            frame_bytes += (size + 7) & ~(size_t)7 ;
+            slot.id = values.size() ;
+            values.push_back(new_value) ;
+        }
+        values[slot.id].address = address ;
+        values[slot.id].copied = 0 ;
+        slot_ids[std::make_pair(address, size)] = slot.id ;
+    }
+
+    if ( values[slot.id].refs++ == 0 ) {
+        num_values++ ;
+    }
+    slot.offset = values[slot.id].offset ;
+    slot.version = version ;
+
+    pthread_mutex_unlock(&values_mutex) ;
+
+    return slot ;
+}
+
+void Trick::VariableServerSnapshot::remove_value( const Slot & slot ) {
+
+    if ( slot.id < 0 ) {
+        return ;
+    }
+
+    pthread_mutex_lock(&values_mutex) ;
+    Value & old_value = values[slot.id] ;
+    if ( old_value.refs > 0 and --old_value.refs == 0 ) {
+        slot_ids.erase(std::make_pair(old_value.address, old_value.size)) ;
+        num_values-- ;
+    }
+    pthread_mutex_unlock(&values_mutex) ;
+}
+
+void Trick::VariableServerSnapshot::begin_copy() {
+    current = NULL ;
+    current_taken = false ;
+    copy_thread = pthread_self() ;
+    copying = true ;
+}
+
+bool Trick::VariableServerSnapshot::in_copy() {
+    return copying and pthread_equal(copy_thread, pthread_self()) ;
+}
+
+/**
+@details
+-# Try the values lock, return NULL if a session holds it
+-# On the first call of a copy job, take a frame.  Later calls get the same frame.
+-# Copy each of the caller's values that is not in the frame yet.  Values registered after the frame was taken
+   do not fit in it and are left out.
+-# Hold the frame for the caller
+*/
+Trick::VariableServerSnapshot::Frame * Trick::VariableServerSnapshot::get_frame( const std::vector < Slot > & slots ) {
+
+    if ( pthread_mutex_trylock(&values_mutex) != 0 ) {
+        return NULL ;
+    }
+
+    if ( ! current_taken ) {
+        current = take() ;
+        current_taken = true ;
+    }
+
+    for ( const Slot & slot : slots ) {
+        if ( slot.id < 0 or slot.version >= current->version ) {
+            continue ;
+        }
+        Value & curr_value = values[slot.id] ;
+        if ( curr_value.refs > 0 and curr_value.copied != current->version ) {
+            memcpy(current->values + curr_value.offset, curr_value.address, curr_value.size) ;
+            curr_value.copied = current->version ;
+        }
+    }
+    __atomic_add_fetch(&current->refs, 1, __ATOMIC_RELAXED) ;
+
+    pthread_mutex_unlock(&values_mutex) ;
+
+    return current ;
+}
+
+void Trick::VariableServerSnapshot::end_copy() {
+    if ( current != NULL ) {
+        release(current) ;
+        current = NULL ;
+    }
+    current_taken = false ;
+    copying = false ;
+}
+
+/**
+@details
+-# Find a frame no session holds, or allocate one.  The acquire load of the holders pairs with the
+   release in release() so the last holder is done reading the frame.
+-# Grow the frame if values were registered since it was last used
+-# Stamp the frame with the next version.  The values are copied in by get_frame.
+*/
+Trick::VariableServerSnapshot::Frame * Trick::VariableServerSnapshot::take() {
+
+    Frame * frame = NULL ;
+
+    for ( Frame * candidate : frames ) {
+        if ( __atomic_load_n(&candidate->refs, __ATOMIC_ACQUIRE) == 0 ) {
+            frame = candidate ;
+            break ;
+        }
+    }
+    if ( frame == NULL ) {
+        frame = new Frame() ;
+        frame->values = NULL ;
+        frame->capacity = 0 ;
+        frames.push_back(frame) ;
+    }
+    if ( frame->capacity < frame_bytes ) {
+        free(frame->values) ;
+        frame->values = (char *)calloc(frame_bytes, 1) ;
+        frame->capacity = frame_bytes ;
+    }
+
+    frame->version = ++version ;
+    frame->refs = 1 ;
+
+    return frame ;
+}
+
+void Trick::VariableServerSnapshot::release( Frame * frame ) {
+    if ( frame != NULL ) {
+        __atomic_sub_fetch(&frame->refs, 1, __ATOMIC_RELEASE) ;
+    }
+}
+
+const char * Trick::VariableServerSnapshot::value( const Frame * frame , const Slot & slot ) {
+    if ( frame == NULL or slot.id < 0 or frame->version <= slot.version ) {
+        return NULL ;
+    }
+    return frame->values + slot.offset ;
+}
+
+unsigned int Trick::VariableServerSnapshot::get_num_values() {
+    return num_values ;
+}
+
+unsigned long long Trick::VariableServerSnapshot::get_version() {
+    return version ;
+}
@@ -4,9 +4,12 @@
 int Trick::VariableServer::copy_and_write_freeze() {
 
     pthread_mutex_lock(&map_mutex) ;
+    // the sessions due in this job share one copy of their common variables
+    snapshot.begin_copy() ;
     for ( auto it = var_server_sessions.begin() ; it != var_server_sessions.end() ; ++it ) {
         (*it).second->copy_and_write_freeze(exec_get_freeze_frame_count()) ;
     }
+    snapshot.end_copy() ;
     pthread_mutex_unlock(&map_mutex) ;
 
     return 0 ;
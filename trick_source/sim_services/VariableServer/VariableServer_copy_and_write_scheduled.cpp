@@ -10,6 +10,8 @@ int Trick::VariableServer::copy_and_write_scheduled() {
     long long next_call_tics = TRICK_MAX_LONG_LONG;
 
     pthread_mutex_lock(&map_mutex) ;
+    // the sessions due in this job share one copy of their common variables
+    snapshot.begin_copy() ;
     for ( auto it = var_server_sessions.begin() ; it != var_server_sessions.end() ; ++it ) {
         VariableServerSession *  session = (*it).second ;
         session->copy_and_write_scheduled(copy_data_job->next_tics) ;
@@ -17,6 +19,7 @@ int Trick::VariableServer::copy_and_write_scheduled() {
             next_call_tics = session->get_next_tics() ;
         }
     }
+    snapshot.end_copy() ;
     pthread_mutex_unlock(&map_mutex) ;
 
     //reschedule the current job. TODO: a call needs to be created to do this the OO way
@@ -10,6 +10,10 @@ int Trick::VariableServer::init() {
         if ( ret != 0 ) {
             return ret ;
         }
+        // Start the event engine first so the listen thread gives it the first client
+        if ( event_engine.get_enabled() ) {
+            event_engine.start(listen_thread) ;
+        }
         listen_thread.create_thread() ;
     }
 
@@ -6,6 +6,7 @@
 
 #include "trick/TCPConnection.hh"
 #include "trick/UDPConnection.hh"
+#include "trick/SharedMemoryConnection.hh"
 #include "trick/TCPClientListener.hh"
 
 int Trick::VariableServer::create_tcp_socket(const char * address, unsigned short in_port ) {
@@ -25,6 +26,7 @@ int Trick::VariableServer::create_tcp_socket(const char * address, unsigned shor
 
     Trick::VariableServerListenThread * new_listen_thread = new Trick::VariableServerListenThread(listener) ;
 
+    new_listen_thread->set_event_engine(&event_engine) ;
     new_listen_thread->copy_cpus(listen_thread.get_cpus()) ;
     new_listen_thread->create_thread() ;
     additional_listen_threads[new_listen_thread->get_pthread_id()] = new_listen_thread ;
@@ -94,3 +96,113 @@ int Trick::VariableServer::create_multicast_socket(const char * mcast_address, c
     return 0 ;
 }
 
+int Trick::VariableServer::create_shared_memory(const char * name ) {
+
+    // Shared memory connections are created without a listen thread, and represent only 1 session
+    // Create a VariableServerSessionThread to manage this session
+
+    if (name == NULL || name[0] == '\0') {
+        message_publish(MSG_ERROR, "Shared memory connection name must be defined.\n");
+        return -1;
+    }
+
+    SharedMemoryConnection * shm_conn = new SharedMemoryConnection();
+    int status = shm_conn->initialize(name);
+    if ( status != 0 ) {
+        message_publish(MSG_ERROR, "ERROR: Could not establish shared memory connection %s for Variable Server.\n", name);
+        delete shm_conn;
+        return -1;
+    }
+
+    Trick::VariableServerSessionThread * vst = new Trick::VariableServerSessionThread() ;
+
+    vst->set_connection(shm_conn);
+    vst->copy_cpus(listen_thread.get_cpus()) ;
+    vst->create_thread() ;
+
+    message_publish(MSG_INFO, "Created shared memory variable server %s\n", name);
+
+    return 0 ;
+}
+
+int Trick::VariableServer::create_channel(const char * name, const char * mcast_address, unsigned short in_port ) {
+
+    // A channel is 1 session that sends to a multicast group and never reads commands
+
+    if (name == NULL || name[0] == '\0') {
+        message_publish(MSG_ERROR, "Variable server channel name must be defined.\n");
+        return -1;
+    }
+    if (mcast_address == NULL || mcast_address[0] == '\0') {
+        message_publish(MSG_ERROR, "Multicast address must be defined.\n");
+        return -1;
+    }
+    if ( get_channel(name) != NULL ) {
+        message_publish(MSG_ERROR, "Variable server channel %s already exists.\n", name);
+        return -1;
+    }
+
+    VariableServerChannel * channel = new VariableServerChannel(name) ;
+    int status = channel->initialize(mcast_address, in_port) ;
+    if ( status != 0 ) {
+        message_publish(MSG_ERROR, "ERROR: Could not establish channel %s at address %s and port %d for Variable Server.\n", name, mcast_address, in_port);
+        delete channel;
+        return -1;
+    }
+
+    pthread_mutex_lock(&map_mutex) ;
+    channels[name] = channel ;
+    pthread_mutex_unlock(&map_mutex) ;
+
+    Trick::VariableServerSessionThread * vst = channel->get_thread() ;
+    vst->copy_cpus(listen_thread.get_cpus()) ;
+    vst->create_thread() ;
+
+    message_publish(MSG_INFO, "Created variable server channel %s at %s:%d\n", name, mcast_address, in_port);
+
+    return 0 ;
+}
+
+int Trick::VariableServer::channel_add(const char * name, const char * var_name, const char * units_name ) {
+
+    VariableServerChannel * channel = get_channel(name == NULL ? "" : name) ;
+    if ( channel == NULL ) {
+        message_publish(MSG_ERROR, "Variable server channel %s does not exist.\n", name == NULL ? "" : name);
+        return -1;
+    }
+    if (var_name == NULL || var_name[0] == '\0') {
+        message_publish(MSG_ERROR, "Variable server channel %s variable name must be defined.\n", name);
+        return -1;
+    }
+
+    return channel->add(var_name, units_name == NULL ? "" : units_name) ;
+}
+
+int Trick::VariableServer::channel_set_cycle(const char * name, double period ) {
+
+    VariableServerChannel * channel = get_channel(name == NULL ? "" : name) ;
+    if ( channel == NULL ) {
+        message_publish(MSG_ERROR, "Variable server channel %s does not exist.\n", name == NULL ? "" : name);
+        return -1;
+    }
+
+    int status = channel->set_cycle(period) ;
+    if ( status == 0 and copy_data_job != NULL ) {
+        get_next_sync_call_time() ;
+    }
+    return status ;
+}
+
+Trick::VariableServerChannel * Trick::VariableServer::get_channel(std::string name) {
+
+    VariableServerChannel * channel = NULL ;
+
+    pthread_mutex_lock(&map_mutex) ;
+    auto it = channels.find(name) ;
+    if ( it != channels.end() ) {
+        channel = it->second ;
+    }
+    pthread_mutex_unlock(&map_mutex) ;
+
+    return channel ;
+}
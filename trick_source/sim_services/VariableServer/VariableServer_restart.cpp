@@ -5,6 +5,10 @@
 #include "trick/tc_proto.h"
 
 int Trick::VariableServer::restart() {
+    if ( enabled and event_engine.get_enabled() ) {
+        event_engine.start(listen_thread) ;
+    }
+
     listen_thread.restart() ;
     if ( listen_thread.get_pthread_id() == 0 ) {
         listen_thread.create_thread() ;
@@ -40,6 +44,9 @@ int Trick::VariableServer::suspendPreCheckpointReload() {
     }
     pthread_mutex_unlock(&map_mutex) ;
 
+    // Suspend the event engine workers
+    event_engine.preload_checkpoint() ;
+
     return 0;
 }
 
@@ -47,13 +54,21 @@ int Trick::VariableServer::suspendPreCheckpointReload() {
 int Trick::VariableServer::resumePostCheckpointReload() {
     std::map<pthread_t, VariableServerSessionThread*>::iterator pos ;
 
-    // Resume all session threads
+    // Add the channel variables again, the session threads disconnected them before the reload
     pthread_mutex_lock(&map_mutex) ;
+    for (const auto& channel_it : channels ) {
+        channel_it.second->restart() ;
+    }
+
+    // Resume all session threads
     for (const auto& vst_it : var_server_threads ) {
         vst_it.second->restart() ;
     }
     pthread_mutex_unlock(&map_mutex) ;
 
+    // Resume the event engine workers
+    event_engine.restart() ;
+
     // Restart listening on all listening threads
     listen_thread.restart_listening() ;
     for (const auto& listen_it : additional_listen_threads) {
@@ -16,6 +16,9 @@ int Trick::VariableServer::shutdown() {
     }
     pthread_mutex_unlock(&map_mutex) ;
 
+    // Shutdown the event engine workers, they close their clients
+    event_engine.shutdown() ;
+
     return 0 ;
 }
 
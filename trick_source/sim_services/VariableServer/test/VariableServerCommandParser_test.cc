@@ -0,0 +1,195 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the VariableServerCommandParser class )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <pthread.h>
+
+#include "trick/MemoryManager.hh"
+#include "trick/VariableServer.hh"
+#include "trick/VariableServerCommandParser.hh"
+
+#include "trick/Mock/MockInputProcessor.hh"
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+
+/*
+ Test Fixture.
+ */
+class VariableServerCommandParser_test : public ::testing::Test {
+	protected:
+        Trick::MemoryManager memmgr;
+        Trick::VariableServer vs;
+        Trick::VariableServerSession session;
+        MockInputProcessor input_processor;
+
+		VariableServerCommandParser_test() {}
+
+		~VariableServerCommandParser_test() {}
+
+		void SetUp() {
+            // Commands find the session of the calling thread
+            vs.add_session(pthread_self(), &session);
+        }
+
+		void TearDown() {
+            vs.delete_session(pthread_self());
+            Trick::VariableServerCommandParser::set_enabled(true);
+        }
+
+        bool parses(const std::string& line) {
+            std::vector<Trick::VariableServerCommandParser::Command> commands;
+            return Trick::VariableServerCommandParser::parse_line(line, commands);
+        }
+};
+
+TEST_F(VariableServerCommandParser_test, parses_commands) {
+    // ARRANGE
+    std::vector<Trick::VariableServerCommandParser::Command> commands;
+
+    // ACT
+    bool parsed = Trick::VariableServerCommandParser::parse_line(
+     "trick.var_add(\"ball.obj.state.output.position[0]\") ; trick.var_cycle( 1 );trick.var_pause()  # start", commands);
+
+    // ASSERT
+    ASSERT_TRUE(parsed);
+    ASSERT_EQ(commands.size(), 3);
+    EXPECT_STREQ(Trick::VariableServerCommandParser::get_name(commands[0]), "var_add");
+    EXPECT_EQ(commands[0].args[0].string_value, "ball.obj.state.output.position[0]");
+    EXPECT_STREQ(Trick::VariableServerCommandParser::get_name(commands[1]), "var_cycle");
+    EXPECT_EQ(commands[1].args[0].type, Trick::VariableServerCommandParser::Argument::INTEGER);
+    EXPECT_EQ(commands[1].args[0].integer_value, 1);
+    EXPECT_STREQ(Trick::VariableServerCommandParser::get_name(commands[2]), "var_pause");
+}
+
+TEST_F(VariableServerCommandParser_test, parses_literals) {
+    // ARRANGE
+    std::vector<Trick::VariableServerCommandParser::Command> commands;
+
+    // ACT
+    bool parsed = Trick::VariableServerCommandParser::parse_line("trick.var_set('a.b', -2.5e3, \"m\",)\r\n", commands);
+
+    // ASSERT
+    ASSERT_TRUE(parsed);
+    ASSERT_EQ(commands[0].args.size(), 3);
+    EXPECT_EQ(commands[0].args[0].string_value, "a.b");
+    EXPECT_EQ(commands[0].args[1].type, Trick::VariableServerCommandParser::Argument::FLOAT);
+    EXPECT_EQ(commands[0].args[1].float_value, -2500.0);
+    EXPECT_EQ(commands[0].args[2].string_value, "m");
+
+    EXPECT_TRUE(parses("trick.var_set(\"a\", \"say \\\"hi\\\"\\n\")"));
+    EXPECT_TRUE(parses("trick.var_byteswap(False)"));
+    EXPECT_TRUE(parses("trick.var_sync(True)"));
+    EXPECT_TRUE(parses("trick.var_cycle(.5)"));
+}
+
+TEST_F(VariableServerCommandParser_test, leaves_other_lines_to_input_processor) {
+    EXPECT_FALSE(parses("    trick.var_add(\"a\")"));
+    EXPECT_FALSE(parses("x = trick.var_add(\"a\")"));
+    EXPECT_FALSE(parses("trick.var_add(name)"));
+    EXPECT_FALSE(parses("trick.var_add(f\"a\")"));
+    EXPECT_FALSE(parses("trick.var_add(\"a\", units=\"m\")"));
+    EXPECT_FALSE(parses("trick.var_add(\"a\\x41\")"));
+    EXPECT_FALSE(parses("trick.var_add(\"a\") x"));
+    EXPECT_FALSE(parses("trick.var_add(\"a\""));
+    EXPECT_FALSE(parses("trick.var_cycle(\"a\")"));
+    EXPECT_FALSE(parses("trick.var_cycle(010)"));
+    EXPECT_FALSE(parses("trick.var_cycle(1 + 2)"));
+    EXPECT_FALSE(parses("trick.var_byteswap(1)"));
+    EXPECT_FALSE(parses("trick.var_set_frame_multiple(-1)"));
+    EXPECT_FALSE(parses("trick.var_set_copy_mode(trick.VS_COPY_SCHEDULED)"));
+    EXPECT_FALSE(parses("trick.var_pause(1)"));
+    EXPECT_FALSE(parses("trick.exec_terminate()"));
+}
+
+TEST_F(VariableServerCommandParser_test, continues) {
+    EXPECT_TRUE(Trick::VariableServerCommandParser::continues("foo(\n"));
+    EXPECT_TRUE(Trick::VariableServerCommandParser::continues("x = 1 + \\\n"));
+    EXPECT_FALSE(Trick::VariableServerCommandParser::continues("foo(\")\") # (\n"));
+    EXPECT_FALSE(Trick::VariableServerCommandParser::continues("if x:\n    y = [1,\n 2]\n"));
+}
+
+TEST_F(VariableServerCommandParser_test, runs_commands_in_order) {
+    // ARRANGE
+    InSequence sequence;
+    EXPECT_CALL(input_processor, parse("x = 1\n"))
+        .WillOnce(Invoke([this](std::string) { EXPECT_FALSE(session.get_pause()); return 0; }));
+    EXPECT_CALL(input_processor, parse("if x:\n    print(x)\n\n"))
+        .WillOnce(Invoke([this](std::string) { EXPECT_TRUE(session.get_pause()); return 0; }));
+
+    // ACT
+    int ret = Trick::VariableServerCommandParser::run("x = 1\ntrick.var_pause()\nif x:\n    print(x)\n\n");
+
+    // ASSERT
+    EXPECT_EQ(ret, 0);
+    EXPECT_TRUE(session.get_pause());
+}
+
+TEST_F(VariableServerCommandParser_test, runs_native_only_message) {
+    // ARRANGE
+    EXPECT_CALL(input_processor, parse(_))
+        .Times(0);
+
+    // ACT
+    Trick::VariableServerCommandParser::run("trick.var_pause()\n\ntrick.var_binary() ; trick.var_exit()\n");
+
+    // ASSERT
+    EXPECT_TRUE(session.get_pause());
+    EXPECT_TRUE(session.get_exit_cmd());
+}
+
+TEST_F(VariableServerCommandParser_test, gives_unparsed_message_whole) {
+    // ARRANGE
+    std::string continued = "foo(1,\ntrick.var_pause())\n";
+    std::string quoted = "s = '''\ntrick.var_pause()\n'''\n";
+    EXPECT_CALL(input_processor, parse(continued))
+        .WillOnce(Return(0));
+    EXPECT_CALL(input_processor, parse(quoted))
+        .WillOnce(Return(0));
+    EXPECT_CALL(input_processor, parse("some_python_command"))
+        .WillOnce(Return(1));
+
+    // ACT
+    Trick::VariableServerCommandParser::run(continued);
+    Trick::VariableServerCommandParser::run(quoted);
+    int ret = Trick::VariableServerCommandParser::run("some_python_command");
+
+    // ASSERT
+    EXPECT_FALSE(session.get_pause());
+    EXPECT_EQ(ret, 1);
+}
+
+TEST_F(VariableServerCommandParser_test, disabled) {
+    // ARRANGE
+    EXPECT_CALL(input_processor, parse("trick.var_pause()\n"))
+        .WillOnce(Return(0));
+
+    // ACT
+    vs.set_native_commands(false);
+    Trick::VariableServerCommandParser::run("trick.var_pause()\n");
+
+    // ASSERT
+    EXPECT_FALSE(vs.get_native_commands());
+    EXPECT_FALSE(session.get_pause());
+}
+
+TEST_F(VariableServerCommandParser_test, var_set) {
+    // ARRANGE
+    double * d = (double *)memmgr.declare_var("double d");
+    int * i = (int *)memmgr.declare_var("int i");
+    EXPECT_CALL(input_processor, parse(_))
+        .Times(0);
+
+    // ACT
+    Trick::VariableServerCommandParser::run("trick.var_set(\"d\", 2.5)\ntrick.var_set(\"i\", 3)\n");
+
+    // ASSERT
+    EXPECT_EQ(*d, 2.5);
+    EXPECT_EQ(*i, 3);
+}
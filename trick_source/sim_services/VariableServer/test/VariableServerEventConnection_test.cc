@@ -0,0 +1,137 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the VariableServerEventConnection class )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "trick/VariableServerEventConnection.hh"
+#include "trick/Mock/MockClientConnection.hh"
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::InSequence;
+
+
+/*
+ Test Fixture.
+ */
+class VariableServerEventConnection_test : public ::testing::Test {
+	protected:
+        // Owned by the connection under test
+        MockClientConnection * wrapped;
+        Trick::VariableServerEventConnection * connection;
+
+		VariableServerEventConnection_test() {
+            wrapped = new MockClientConnection;
+            connection = new Trick::VariableServerEventConnection(wrapped);
+        }
+
+		~VariableServerEventConnection_test() {
+            delete connection;
+        }
+
+		void SetUp() {}
+		void TearDown() {}
+};
+
+TEST_F(VariableServerEventConnection_test, write_all_sent) {
+    // ARRANGE
+    EXPECT_CALL(*wrapped, write(_, 5))
+        .WillOnce(Return(5));
+
+    // ACT
+    int result = connection->write(std::string("Hello"));
+
+    // ASSERT
+    EXPECT_EQ(result, 5);
+}
+
+TEST_F(VariableServerEventConnection_test, write_returns_what_socket_took) {
+    // ARRANGE
+    auto would_block = [&] (char *, int) -> int {
+        errno = EAGAIN;
+        return -1;
+    };
+    {
+        InSequence seq;
+        // The socket only takes 3 bytes, then it is full
+        EXPECT_CALL(*wrapped, write(_, 10)).WillOnce(Return(3));
+        EXPECT_CALL(*wrapped, write(_, 5)).WillOnce(Invoke(would_block));
+    }
+    char first[] = "0123456789";
+    char second[] = "abcde";
+
+    // ACT
+    int partial = connection->write(first, 10);
+    int full = connection->write(second, 5);
+    int full_errno = errno;
+
+    // ASSERT
+    // Nothing is queued here, the session's send queue keeps the rest
+    EXPECT_EQ(partial, 3);
+    EXPECT_EQ(full, -1);
+    EXPECT_EQ(full_errno, EAGAIN);
+}
+
+TEST_F(VariableServerEventConnection_test, write_error) {
+    // ARRANGE
+    auto broken = [&] (char *, int) -> int {
+        errno = EPIPE;
+        return -1;
+    };
+    EXPECT_CALL(*wrapped, write(_, _))
+        .WillOnce(Invoke(broken));
+
+    // ACT
+    int result = connection->write(std::string("Hello"));
+
+    // ASSERT
+    EXPECT_EQ(result, -1);
+}
+
+TEST_F(VariableServerEventConnection_test, read_complete_commands) {
+    // ARRANGE
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+    EXPECT_CALL(*wrapped, getSocket())
+        .WillRepeatedly(Return(sockets[0]));
+
+    std::string commands = "trick.var_add(\"a\")\r\ntrick.var_add(\"b\")\ntrick.var_";
+    ASSERT_EQ(::write(sockets[1], commands.data(), commands.size()), (ssize_t)commands.size());
+
+    // ACT
+    std::string message;
+    EXPECT_EQ(connection->receive(), 0);
+    connection->read(message);
+
+    // ASSERT
+    EXPECT_EQ(message, "trick.var_add(\"a\")\ntrick.var_add(\"b\")\n");
+
+    // ACT
+    // The rest of the partial command arrives
+    std::string rest = "cycle(0.1)\n";
+    ASSERT_EQ(::write(sockets[1], rest.data(), rest.size()), (ssize_t)rest.size());
+    EXPECT_EQ(connection->receive(), 0);
+    connection->read(message);
+
+    // ASSERT
+    EXPECT_EQ(message, "trick.var_cycle(0.1)\n");
+    EXPECT_EQ(connection->read(message), 0);
+
+    // ACT
+    // Client closes the connection
+    close(sockets[1]);
+
+    // ASSERT
+    EXPECT_EQ(connection->receive(), -1);
+    close(sockets[0]);
+}
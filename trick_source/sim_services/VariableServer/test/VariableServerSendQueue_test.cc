@@ -0,0 +1,247 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the VariableServerSendQueue class )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <errno.h>
+#include <string>
+
+#include "trick/VariableServerSendQueue.hh"
+#include "trick/Mock/MockClientConnection.hh"
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::Invoke;
+
+
+/*
+ Test Fixture.  The mock connection acts like a non-blocking socket that takes at most capacity bytes.
+ */
+class VariableServerSendQueue_test : public ::testing::Test {
+	protected:
+        MockClientConnection connection;
+        Trick::VariableServerSendQueue queue;
+        std::string sent;
+        int capacity;
+
+		VariableServerSendQueue_test() : capacity(1000) {}
+		~VariableServerSendQueue_test() {}
+
+		void SetUp() {
+            auto send_some = [&] (char * message, int size) -> int {
+                if (capacity == 0) {
+                    errno = EAGAIN;
+                    return -1;
+                }
+                int n = size < capacity ? size : capacity;
+                sent.append(message, n);
+                capacity -= n;
+                return n;
+            };
+            auto send_string = [=] (const std::string& message) -> int {
+                return send_some((char *)message.data(), message.size());
+            };
+            EXPECT_CALL(connection, write(_, _)).WillRepeatedly(Invoke(send_some));
+            EXPECT_CALL(connection, write(_)).WillRepeatedly(Invoke(send_string));
+            queue.set_connection(&connection);
+        }
+		void TearDown() {}
+
+        int write_frame(std::string message) {
+            queue.begin_frame();
+            int ret = queue.write((char *)message.data(), message.size());
+            queue.end_frame();
+            return ret;
+        }
+};
+
+TEST_F(VariableServerSendQueue_test, write_all_sent) {
+    // ACT
+    int result = queue.write(std::string("Hello"));
+
+    // ASSERT
+    EXPECT_EQ(result, 5);
+    EXPECT_EQ(queue.get_queued_bytes(), 0);
+    EXPECT_EQ(sent, "Hello");
+}
+
+TEST_F(VariableServerSendQueue_test, partial_write_queues_rest) {
+    // ARRANGE
+    capacity = 3;
+
+    // ACT
+    EXPECT_EQ(queue.write(std::string("0123456789")), 10);
+    EXPECT_EQ(queue.write(std::string("abcde")), 5);
+    EXPECT_EQ(queue.get_queued_bytes(), 12);
+    capacity = 1000;
+    int remaining = queue.flush();
+
+    // ASSERT
+    EXPECT_EQ(remaining, 0);
+    EXPECT_EQ(sent, "0123456789abcde");
+}
+
+TEST_F(VariableServerSendQueue_test, discarded_message_not_queued) {
+    // ARRANGE
+    MockClientConnection no_client;
+    EXPECT_CALL(no_client, write(_)).WillOnce(Return(0));
+    queue.set_connection(&no_client);
+
+    // ACT
+    int result = queue.write(std::string("Hello"));
+
+    // ASSERT
+    EXPECT_EQ(result, 0);
+    EXPECT_EQ(queue.get_queued_bytes(), 0);
+}
+
+TEST_F(VariableServerSendQueue_test, write_error) {
+    // ARRANGE
+    MockClientConnection broken;
+    auto broken_pipe = [&] (char *, int) -> int {
+        errno = EPIPE;
+        return -1;
+    };
+    EXPECT_CALL(broken, write(_, _)).WillOnce(Invoke(broken_pipe));
+    queue.set_connection(&broken);
+    char message[] = "Hello";
+
+    // ACT
+    int result = queue.write(message, 5);
+
+    // ASSERT
+    EXPECT_EQ(result, -1);
+    EXPECT_EQ(queue.flush(), -1);
+}
+
+TEST_F(VariableServerSendQueue_test, stale_errno_not_queued) {
+    // ARRANGE
+    // A connection that is not connected fails without setting errno
+    MockClientConnection not_connected;
+    EXPECT_CALL(not_connected, write(_, _)).WillOnce(Return(-1));
+    queue.set_connection(&not_connected);
+    char message[] = "Hello";
+    errno = EAGAIN;
+
+    // ACT
+    int result = queue.write(message, 5);
+
+    // ASSERT
+    EXPECT_EQ(result, -1);
+    EXPECT_EQ(queue.get_queued_bytes(), 0);
+}
+
+TEST_F(VariableServerSendQueue_test, coalesce_to_latest_frame) {
+    // ARRANGE
+    queue.set_policy(VS_QUEUE_COALESCE);
+    capacity = 2;
+
+    // ACT
+    // The first frame has started to go out, it must be finished
+    write_frame("frame1\n");
+    write_frame("frame2\n");
+    write_frame("frame3\n");
+    capacity = 1000;
+    queue.flush();
+
+    // ASSERT
+    EXPECT_EQ(sent, "frame1\nframe3\n");
+    EXPECT_EQ(queue.get_coalesced_frames(), 1);
+    EXPECT_EQ(queue.get_dropped_frames(), 0);
+}
+
+TEST_F(VariableServerSendQueue_test, replies_never_dropped) {
+    // ARRANGE
+    queue.set_policy(VS_QUEUE_COALESCE);
+    queue.set_max_bytes(10);
+    capacity = 0;
+
+    // ACT
+    write_frame("frame1\n");
+    queue.write(std::string("reply1\n"));
+    write_frame("frame2\n");
+    queue.write(std::string("reply2\n"));
+    capacity = 1000;
+    queue.flush();
+
+    // ASSERT
+    // The frames are dropped to make room for the replies
+    EXPECT_EQ(sent, "reply1\nreply2\n");
+    EXPECT_EQ(queue.get_dropped_frames(), 2);
+}
+
+TEST_F(VariableServerSendQueue_test, drop_oldest_when_full) {
+    // ARRANGE
+    queue.set_policy(VS_QUEUE_DROP_OLDEST);
+    queue.set_max_bytes(14);
+    capacity = 0;
+
+    // ACT
+    write_frame("frame1\n");
+    write_frame("frame2\n");
+    write_frame("frame3\n");
+    capacity = 1000;
+    queue.flush();
+
+    // ASSERT
+    EXPECT_EQ(sent, "frame2\nframe3\n");
+    EXPECT_EQ(queue.get_dropped_frames(), 1);
+    EXPECT_EQ(queue.get_coalesced_frames(), 0);
+}
+
+TEST_F(VariableServerSendQueue_test, frame_of_several_messages) {
+    // ARRANGE
+    queue.set_policy(VS_QUEUE_DROP_OLDEST);
+    queue.set_max_bytes(8);
+    capacity = 0;
+
+    // ACT
+    queue.begin_frame();
+    queue.write(std::string("part1"));
+    queue.write(std::string("part2\n"));
+    queue.end_frame();
+    queue.write(std::string("reply\n"));
+    capacity = 1000;
+    queue.flush();
+
+    // ASSERT
+    // The whole frame is dropped, not only the part over the limit
+    EXPECT_EQ(sent, "reply\n");
+    EXPECT_EQ(queue.get_dropped_frames(), 1);
+}
+
+TEST_F(VariableServerSendQueue_test, disconnect_when_full) {
+    // ARRANGE
+    queue.set_policy(VS_QUEUE_DISCONNECT);
+    queue.set_max_bytes(10);
+    capacity = 0;
+
+    // ACT
+    write_frame("frame1\n");
+    queue.begin_frame();
+    int result = queue.write(std::string("frame2\n"));
+    int end_result = queue.end_frame();
+
+    // ASSERT
+    EXPECT_EQ(result, -1);
+    EXPECT_EQ(end_result, -1);
+    EXPECT_EQ(queue.flush(), -1);
+}
+
+TEST_F(VariableServerSendQueue_test, unlimited) {
+    // ARRANGE
+    queue.set_policy(VS_QUEUE_DROP_OLDEST);
+    queue.set_max_bytes(0);
+    capacity = 0;
+
+    // ACT
+    for (int ii = 0; ii < 100; ii++) {
+        write_frame("frame\n");
+    }
+
+    // ASSERT
+    EXPECT_EQ(queue.get_queued_bytes(), 600);
+    EXPECT_EQ(queue.get_dropped_frames(), 0);
+}
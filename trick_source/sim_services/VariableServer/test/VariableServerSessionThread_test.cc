@@ -224,6 +224,30 @@ TEST_F(VariableServerSessionThread_test, exit_commanded) {
     EXPECT_EQ(varserver->get_session(id), (Trick::VariableServerSession *) NULL);
 }
 
+TEST_F(VariableServerSessionThread_test, no_read_commands) {
+    // ARRANGE
+    setup_normal_connection_expectations(&connection);
+    set_session_exit_after_some_loops(session);
+
+    EXPECT_CALL(*session, handle_message())
+        .Times(0);
+    EXPECT_CALL(*session, copy_and_write_async())
+        .Times(AtLeast(1));
+
+    // Set up VariableServerSessionThread
+    Trick::VariableServerSessionThread * vst = new Trick::VariableServerSessionThread(session) ;
+    vst->set_connection(&connection);
+    vst->set_read_commands(false);
+
+    // ACT
+    vst->create_thread();
+    Trick::ConnectionStatus status = vst->wait_for_accept();
+    ASSERT_EQ(status, Trick::ConnectionStatus::CONNECTION_SUCCESS);
+
+    // Runs for a few loops without reading, then exits
+    vst->join_thread();
+}
+
 TEST_F(VariableServerSessionThread_test, thread_cancelled) {
     // ARRANGE
     setup_normal_connection_expectations(&connection);
@@ -5,6 +5,7 @@ PURPOSE:                     ( Tests for the VariableServerSession class )
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <errno.h>
 #include <iostream>
 #include <iomanip>
 #include <limits>
@@ -277,6 +278,309 @@ TEST_F(VariableServerSession_test, large_message_binary) {
     }
 }
 
+TEST_F(VariableServerSession_test, large_message_binary_one_message) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+    session.var_binary();
+    session.var_set_max_message_size(1000000);
+
+    const static int big_arr_size = 4000;
+
+    int big_arr[big_arr_size];
+    for (int i = 0; i < big_arr_size; i++) {
+        big_arr[i] = i;
+    }
+
+    (void) memmgr.declare_extern_var(&big_arr, "int big_arr[4000]");
+
+    std::vector <Trick::VariableReference *> vars;
+    for (int i = 0; i < big_arr_size; i++) {
+        std::string var_name = "big_arr[" + std::to_string(i) + "]";
+        Trick::VariableReference * var = new Trick::VariableReference(var_name);
+        var->stageValue();
+        vars.push_back(var);
+    } 
+
+    ParsedBinaryMessage full_message;
+    auto binaryConstructedCorrectly = [&] (std::tuple<char *, int> msg_tuple) -> bool {
+        char * message;
+        int size;
+        std::tie(message, size) = msg_tuple;
+
+        std::vector<unsigned char> bytes(message, message + size);
+        try {
+            full_message.parse(bytes);
+        } catch (const MalformedMessageException& ex) {
+            std::cout << "Parser failed with message: " << ex.what();
+            return false;
+        }
+
+        return true;
+    };
+
+    // Everything goes out in one message
+    EXPECT_CALL(connection, write(_, _)).With(Args<0,1>(Truly(binaryConstructedCorrectly))).Times(1);
+
+    // ACT
+    session.write_data(vars, (VS_MESSAGE_TYPE) 0);
+
+    // ASSERT
+    ASSERT_EQ(full_message.getNumVars(), big_arr_size);
+    for (int i = 0; i < big_arr_size; i++) {
+        Var variable = full_message.getVariable(i);
+        EXPECT_EQ(variable.getValue<int>(), i);
+    }
+}
+
+TEST_F(VariableServerSession_test, max_message_size_too_small) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+
+    EXPECT_CALL(message_publisher, publish(MSG_ERROR,_));
+
+    // ACT
+    int ret = session.var_set_max_message_size(4);
+
+    // ASSERT
+    EXPECT_EQ(ret, -1);
+}
+
+TEST_F(VariableServerSession_test, max_message_size_zero) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+
+    EXPECT_CALL(message_publisher, publish(MSG_ERROR,_));
+
+    // ACT
+    int ret = session.var_set_max_message_size(0);
+
+    // ASSERT
+    EXPECT_EQ(ret, -1);
+}
+
+TEST_F(VariableServerSession_test, max_message_size_too_large_for_udp) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+
+    EXPECT_CALL(connection, getConnectionType()).WillRepeatedly(Return(Trick::ClientConnection::UDP));
+    EXPECT_CALL(message_publisher, publish(MSG_ERROR,_));
+
+    // ACT
+    int too_large = session.var_set_max_message_size(65508);
+    int largest = session.var_set_max_message_size(65507);
+
+    // ASSERT
+    EXPECT_EQ(too_large, -1);
+    EXPECT_EQ(largest, 0);
+}
+
+TEST_F(VariableServerSession_test, send_on_change) {
+    // ARRANGE
+    int a = 5;
+    double b = 6;
+    (void) memmgr.declare_extern_var(&a, "int a");
+    (void) memmgr.declare_extern_var(&b, "double b");
+
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+    session.var_binary();
+    session.var_send_on_change(true);
+    session.var_set_keyframe_interval(3);
+    session.var_add("a");
+    session.var_add("b");
+
+    std::vector<ParsedBinaryMessage> messages;
+    EXPECT_CALL(connection, write(_, _))
+        .WillRepeatedly(Invoke([&] (char * message, int size) -> int {
+            ParsedBinaryMessage parsed;
+            parsed.parse(std::vector<unsigned char>(message, message + size));
+            messages.push_back(parsed);
+            return size;
+        }));
+
+    // ACT
+    // First a full message, then nothing while no value changes, then only the changed value
+    session.copy_sim_data();
+    session.write_data();
+    session.copy_sim_data();
+    session.write_data();
+    b = 7;
+    session.copy_sim_data();
+    session.write_data();
+    // The keyframe interval is up, everything goes out again
+    session.copy_sim_data();
+    session.write_data();
+
+    // ASSERT
+    ASSERT_EQ(messages.size(), 3);
+    EXPECT_EQ(messages[0].getMessageType(), VS_VAR_LIST);
+    EXPECT_EQ(messages[0].getNumVars(), 2);
+    EXPECT_EQ(messages[1].getMessageType(), VS_VAR_LIST_CHANGES);
+    ASSERT_EQ(messages[1].getNumVars(), 1);
+    EXPECT_EQ(messages[1].variables[0].getIndex(), 1);
+    EXPECT_EQ(messages[1].variables[0].getName(), "b");
+    EXPECT_EQ(messages[1].variables[0].getValue<double>(), 7);
+    EXPECT_EQ(messages[2].getMessageType(), VS_VAR_LIST);
+    EXPECT_EQ(messages[2].getNumVars(), 2);
+}
+
+TEST_F(VariableServerSession_test, keyframe_interval_negative) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+
+    EXPECT_CALL(message_publisher, publish(MSG_ERROR,_));
+
+    // ACT
+    int ret = session.var_set_keyframe_interval(-1);
+
+    // ASSERT
+    EXPECT_EQ(ret, -1);
+}
+
+TEST_F(VariableServerSession_test, send_queue_policy_invalid) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+
+    EXPECT_CALL(message_publisher, publish(MSG_ERROR,_))
+        .Times(2);
+
+    // ACT
+    int policy_ret = session.var_set_send_queue_policy(3);
+    int size_ret = session.var_set_send_queue_size(-1);
+
+    // ASSERT
+    EXPECT_EQ(policy_ret, -1);
+    EXPECT_EQ(size_ret, -1);
+    EXPECT_EQ(session.var_set_send_queue_policy(VS_QUEUE_DROP_OLDEST), 0);
+    EXPECT_EQ(session.var_set_send_queue_size(0), 0);
+}
+
+TEST_F(VariableServerSession_test, slow_client_gets_latest_values) {
+    // ARRANGE
+    int a = 5;
+    (void) memmgr.declare_extern_var(&a, "int a");
+
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+    session.var_binary();
+    session.var_send_on_change(true);
+    session.var_set_keyframe_interval(0);
+    session.var_add("a");
+
+    bool blocked = true;
+    std::vector<ParsedBinaryMessage> messages;
+    EXPECT_CALL(connection, write(_, _))
+        .WillRepeatedly(Invoke([&] (char * message, int size) -> int {
+            if (blocked) {
+                errno = EAGAIN;
+                return -1;
+            }
+            ParsedBinaryMessage parsed;
+            parsed.parse(std::vector<unsigned char>(message, message + size));
+            messages.push_back(parsed);
+            return size;
+        }));
+
+    // ACT
+    // The client takes nothing while a changes three times
+    for (int ii = 0; ii < 3; ii++) {
+        a = 6 + ii;
+        session.copy_sim_data();
+        session.write_data();
+    }
+    blocked = false;
+    int remaining = session.flush_send_queue();
+
+    // ASSERT
+    // Only the latest frame is sent, and it is a full message
+    EXPECT_EQ(remaining, 0);
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0].getMessageType(), VS_VAR_LIST);
+    EXPECT_EQ(messages[0].variables[0].getValue<int>(), 8);
+}
+
+TEST_F(VariableServerSession_test, sequenced) {
+    // ARRANGE
+    int a = 5;
+    (void) memmgr.declare_extern_var(&a, "int a");
+
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+    session.var_binary();
+    session.set_sequenced(true);
+    session.var_add("a");
+
+    std::vector<ParsedBinaryMessage> messages;
+    EXPECT_CALL(connection, write(_, _))
+        .WillRepeatedly(Invoke([&] (char * message, int size) -> int {
+            ParsedBinaryMessage parsed;
+            parsed.parse(std::vector<unsigned char>(message, message + size));
+            messages.push_back(parsed);
+            return size;
+        }));
+
+    // ACT
+    session.copy_sim_data();
+    session.write_data();
+    session.copy_sim_data();
+    session.write_data();
+
+    // ASSERT
+    ASSERT_EQ(messages.size(), 2);
+    EXPECT_EQ(messages[0].getMessageType(), VS_CHANNEL_LIST);
+    EXPECT_EQ(messages[0].getSequence(), 0);
+    EXPECT_EQ(messages[1].getSequence(), 1);
+    ASSERT_EQ(messages[1].getNumVars(), 1);
+    EXPECT_EQ(messages[1].variables[0].getName(), "a");
+    EXPECT_EQ(messages[1].variables[0].getValue<int>(), 5);
+}
+
+TEST_F(VariableServerSession_test, send_channel_info) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+
+    EXPECT_CALL(connection, write("8\t239.3.14.15\t9001\n"));
+
+    // ACT
+    int ret = session.send_channel_info("239.3.14.15", 9001);
+
+    // ASSERT
+    EXPECT_EQ(ret, 0);
+}
+
+TEST_F(VariableServerSession_test, send_channel_info_binary_byteswap) {
+    // ARRANGE
+    Trick::VariableServerSession session;
+    session.set_connection(&connection);
+    session.var_binary();
+    session.var_byteswap(true);
+
+    std::vector<unsigned char> sent;
+    EXPECT_CALL(connection, write(_, _))
+        .WillOnce(Invoke([&] (char * message, int size) -> int {
+            sent.assign(message, message + size);
+            return size;
+        }));
+
+    // ACT
+    int ret = session.send_channel_info("239.3.14.15", 9001);
+
+    // ASSERT
+    // The header and port are swapped like every other binary message, the address is not
+    EXPECT_EQ(ret, 0);
+    std::vector<unsigned char> expected = { 0, 0, 0, VS_CHANNEL_INFO, 0, 0, 0, 19, 0, 0, 0x23, 0x29 };
+    std::string address = "239.3.14.15";
+    expected.insert(expected.end(), address.begin(), address.end());
+    EXPECT_EQ(sent, expected);
+}
+
 TEST_F(VariableServerSession_test, log_on) {
     // ARRANGE
     int fake_logstream = 200;
@@ -1394,4 +1698,46 @@ TEST_F(VariableServerSession_test, copy_and_write_freeze_scheduled_write_fails)
 
     // ASSERT
     EXPECT_EQ(result, -1);
-}
\ No newline at end of file
+}
+
+TEST_F(VariableServerSession_test, snapshot_shared_between_sessions) {
+    // ARRANGE
+    int a = 5;
+    double b = 6;
+    (void) memmgr.declare_extern_var(&a, "int a");
+    (void) memmgr.declare_extern_var(&b, "double b");
+
+    Trick::VariableServerSnapshot snapshot;
+    Trick::VariableServerSession session1;
+    Trick::VariableServerSession session2;
+    session1.set_connection(&connection);
+    session2.set_connection(&connection);
+    session1.set_snapshot(&snapshot);
+    session2.set_snapshot(&snapshot);
+
+    session1.var_add("a");
+    session1.var_add("b");
+    session2.var_add("b");
+
+    // Both sessions write the values from the copy job, not the values changed after it
+    EXPECT_CALL(connection, write(std::string("0\t5\t6\n")))
+        .Times(1);
+    EXPECT_CALL(connection, write(std::string("0\t6\n")))
+        .Times(1);
+
+    // ACT
+    snapshot.begin_copy();
+    session1.copy_sim_data();
+    session2.copy_sim_data();
+    snapshot.end_copy();
+
+    a = 7;
+    b = 8;
+
+    session1.write_data();
+    session2.write_data();
+
+    // ASSERT
+    EXPECT_EQ(snapshot.get_num_values(), 2);
+    EXPECT_EQ(snapshot.get_version(), 1);
+}
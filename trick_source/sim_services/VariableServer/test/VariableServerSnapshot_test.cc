@@ -0,0 +1,191 @@
+/******************************TRICK HEADER*************************************
+PURPOSE:                     ( Tests for the VariableServerSnapshot class )
+*******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "trick/VariableServerSnapshot.hh"
+
+
+/*
+ Test Fixture.
+ */
+class VariableServerSnapshot_test : public ::testing::Test {
+	protected:
+        Trick::VariableServerSnapshot snapshot;
+
+		VariableServerSnapshot_test() {}
+
+		~VariableServerSnapshot_test() {}
+
+		void SetUp() {}
+		void TearDown() {}
+};
+
+TEST_F(VariableServerSnapshot_test, shares_same_value) {
+    // ARRANGE
+    int a = 5;
+    double b = 6;
+
+    // ACT
+    Trick::VariableServerSnapshot::Slot slot_a1 = snapshot.add_value(&a, sizeof(a));
+    Trick::VariableServerSnapshot::Slot slot_a2 = snapshot.add_value(&a, sizeof(a));
+    Trick::VariableServerSnapshot::Slot slot_b = snapshot.add_value(&b, sizeof(b));
+
+    // ASSERT
+    EXPECT_EQ(slot_a1.id, slot_a2.id);
+    EXPECT_EQ(slot_a1.offset, slot_a2.offset);
+    EXPECT_NE(slot_a1.id, slot_b.id);
+    EXPECT_EQ(slot_b.offset % 8, 0);
+    EXPECT_EQ(snapshot.get_num_values(), 2);
+}
+
+TEST_F(VariableServerSnapshot_test, remove_value) {
+    // ARRANGE
+    int a = 5;
+    int c = 7;
+    Trick::VariableServerSnapshot::Slot slot_a1 = snapshot.add_value(&a, sizeof(a));
+    Trick::VariableServerSnapshot::Slot slot_a2 = snapshot.add_value(&a, sizeof(a));
+
+    // ACT
+    snapshot.remove_value(slot_a1);
+
+    // ASSERT
+    EXPECT_EQ(snapshot.get_num_values(), 1);
+
+    // ACT
+    snapshot.remove_value(slot_a2);
+    Trick::VariableServerSnapshot::Slot slot_c = snapshot.add_value(&c, sizeof(c));
+
+    // ASSERT
+    // The released slot is reused for a value of the same size
+    EXPECT_EQ(slot_c.id, slot_a1.id);
+    EXPECT_EQ(snapshot.get_num_values(), 1);
+}
+
+TEST_F(VariableServerSnapshot_test, one_copy_per_job) {
+    // ARRANGE
+    int a = 5;
+    double b = 6;
+    Trick::VariableServerSnapshot::Slot slot_a = snapshot.add_value(&a, sizeof(a));
+    Trick::VariableServerSnapshot::Slot slot_b = snapshot.add_value(&b, sizeof(b));
+
+    // ACT
+    std::vector<Trick::VariableServerSnapshot::Slot> slots = {slot_a, slot_b};
+    snapshot.begin_copy();
+    ASSERT_TRUE(snapshot.in_copy());
+    Trick::VariableServerSnapshot::Frame * frame1 = snapshot.get_frame(slots);
+    a = 10;
+    Trick::VariableServerSnapshot::Frame * frame2 = snapshot.get_frame(slots);
+    snapshot.end_copy();
+
+    // ASSERT
+    ASSERT_TRUE(frame1 != NULL);
+    EXPECT_EQ(frame1, frame2);
+    EXPECT_FALSE(snapshot.in_copy());
+    EXPECT_EQ(snapshot.get_version(), 1);
+
+    int a_copy;
+    double b_copy;
+    memcpy(&a_copy, Trick::VariableServerSnapshot::value(frame1, slot_a), sizeof(a_copy));
+    memcpy(&b_copy, Trick::VariableServerSnapshot::value(frame1, slot_b), sizeof(b_copy));
+    EXPECT_EQ(a_copy, 5);
+    EXPECT_EQ(b_copy, 6);
+
+    Trick::VariableServerSnapshot::release(frame1);
+    Trick::VariableServerSnapshot::release(frame2);
+}
+
+TEST_F(VariableServerSnapshot_test, value_registered_after_frame) {
+    // ARRANGE
+    int a = 5;
+    int c = 7;
+    Trick::VariableServerSnapshot::Slot slot_a = snapshot.add_value(&a, sizeof(a));
+    std::vector<Trick::VariableServerSnapshot::Slot> slots = {slot_a};
+
+    snapshot.begin_copy();
+    Trick::VariableServerSnapshot::Frame * frame = snapshot.get_frame(slots);
+    snapshot.end_copy();
+
+    // ACT
+    Trick::VariableServerSnapshot::Slot slot_c = snapshot.add_value(&c, sizeof(c));
+
+    // ASSERT
+    EXPECT_TRUE(Trick::VariableServerSnapshot::value(frame, slot_a) != NULL);
+    EXPECT_TRUE(Trick::VariableServerSnapshot::value(frame, slot_c) == NULL);
+
+    Trick::VariableServerSnapshot::release(frame);
+}
+
+TEST_F(VariableServerSnapshot_test, held_frame_not_reused) {
+    // ARRANGE
+    int a = 5;
+    Trick::VariableServerSnapshot::Slot slot_a = snapshot.add_value(&a, sizeof(a));
+    std::vector<Trick::VariableServerSnapshot::Slot> slots = {slot_a};
+
+    snapshot.begin_copy();
+    Trick::VariableServerSnapshot::Frame * held = snapshot.get_frame(slots);
+    snapshot.end_copy();
+
+    // ACT
+    a = 6;
+    snapshot.begin_copy();
+    Trick::VariableServerSnapshot::Frame * next = snapshot.get_frame(slots);
+    snapshot.end_copy();
+
+    // ASSERT
+    EXPECT_NE(held, next);
+    int a_copy;
+    memcpy(&a_copy, Trick::VariableServerSnapshot::value(held, slot_a), sizeof(a_copy));
+    EXPECT_EQ(a_copy, 5);
+    memcpy(&a_copy, Trick::VariableServerSnapshot::value(next, slot_a), sizeof(a_copy));
+    EXPECT_EQ(a_copy, 6);
+
+    // ACT
+    Trick::VariableServerSnapshot::release(held);
+    snapshot.begin_copy();
+    Trick::VariableServerSnapshot::Frame * reused = snapshot.get_frame(slots);
+    snapshot.end_copy();
+
+    // ASSERT
+    EXPECT_EQ(reused, held);
+    EXPECT_EQ(snapshot.get_version(), 3);
+
+    Trick::VariableServerSnapshot::release(next);
+    Trick::VariableServerSnapshot::release(reused);
+}
+
+TEST_F(VariableServerSnapshot_test, copies_only_requested_values) {
+    // ARRANGE
+    int a = 5;
+    int b = 6;
+    int c = 7;
+    Trick::VariableServerSnapshot::Slot slot_a = snapshot.add_value(&a, sizeof(a));
+    Trick::VariableServerSnapshot::Slot slot_b = snapshot.add_value(&b, sizeof(b));
+    Trick::VariableServerSnapshot::Slot slot_c = snapshot.add_value(&c, sizeof(c));
+    std::vector<Trick::VariableServerSnapshot::Slot> session1 = {slot_a, slot_b};
+    std::vector<Trick::VariableServerSnapshot::Slot> session2 = {slot_b, slot_c};
+
+    // ACT
+    snapshot.begin_copy();
+    Trick::VariableServerSnapshot::Frame * frame1 = snapshot.get_frame(session1);
+    b = 60;
+    c = 70;
+    Trick::VariableServerSnapshot::Frame * frame2 = snapshot.get_frame(session2);
+    snapshot.end_copy();
+
+    // ASSERT
+    // The second session shares the frame and the value of b the first session copied
+    EXPECT_EQ(frame1, frame2);
+    int copy;
+    memcpy(&copy, Trick::VariableServerSnapshot::value(frame1, slot_a), sizeof(copy));
+    EXPECT_EQ(copy, 5);
+    memcpy(&copy, Trick::VariableServerSnapshot::value(frame1, slot_b), sizeof(copy));
+    EXPECT_EQ(copy, 6);
+    memcpy(&copy, Trick::VariableServerSnapshot::value(frame2, slot_c), sizeof(copy));
+    EXPECT_EQ(copy, 70);
+
+    Trick::VariableServerSnapshot::release(frame1);
+    Trick::VariableServerSnapshot::release(frame2);
+}
@@ -16,6 +16,11 @@ Trick::VariableServerSessionThread * get_vst() {
 }
 
 Trick::VariableServerSession * get_session() {
+    // Event engine workers serve many sessions, the worker knows which one is running a command
+    Trick::VariableServerSession * session = Trick::VariableServerEventEngine::get_current_session() ;
+    if ( session != NULL ) {
+        return session ;
+    }
     return the_vs->get_session(pthread_self()) ;
 }
 
@@ -271,6 +276,59 @@ Trick::VariableServerSession * session = get_session();
     return(0) ;
 }
 
+int var_send_on_change(int on_off) {
+Trick::VariableServerSession * session = get_session();
+    if (session != NULL ) {
+        session->var_send_on_change((bool)on_off) ;
+    }
+    return(0) ;
+}
+
+int var_set_keyframe_interval(int cycles) {
+Trick::VariableServerSession * session = get_session();
+    if (session != NULL ) {
+        return session->var_set_keyframe_interval(cycles) ;
+    }
+    return(0) ;
+}
+
+int var_set_send_queue_size(int bytes) {
+Trick::VariableServerSession * session = get_session();
+    if (session != NULL ) {
+        return session->var_set_send_queue_size(bytes) ;
+    }
+    return(0) ;
+}
+
+int var_set_send_queue_policy(int policy) {
+Trick::VariableServerSession * session = get_session();
+    if (session != NULL ) {
+        return session->var_set_send_queue_policy(policy) ;
+    }
+    return(0) ;
+}
+
+int var_join_channel(std::string name) {
+Trick::VariableServerSession * session = get_session();
+    if (session != NULL ) {
+        Trick::VariableServerChannel * channel = the_vs->get_channel(name) ;
+        if ( channel == NULL ) {
+            message_publish(MSG_ERROR, "Variable Server: var_join_channel cannot find channel %s.\n", name.c_str()) ;
+            return session->send_channel_info("", 0) ;
+        }
+        return session->send_channel_info(channel->get_address(), channel->get_port()) ;
+    }
+    return(0) ;
+}
+
+int var_set_max_message_size(int size) {
+Trick::VariableServerSession * session = get_session();
+    if (session != NULL ) {
+        return session->var_set_max_message_size(size) ;
+    }
+    return(0) ;
+}
+
 int var_write_stdio(int stream , std::string text ) {
     // std::cout << "Executing var_write_stdio" << std::endl;
     Trick::VariableServerSession * session = get_session();
@@ -300,6 +358,8 @@ int var_set_client_tag( std::string text ) {
 #endif
 #endif
 #endif
+    } else if (Trick::VariableServerEventEngine::get_current_connection() != NULL) {
+        Trick::VariableServerEventEngine::get_current_connection()->setClientTag(text);
     }
     return(0) ;
 }
@@ -471,6 +531,51 @@ extern "C" void var_server_set_enabled(int on_off) {
     the_vs->set_enabled((bool)on_off) ;
 }
 
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::set_event_engine
+ * C wrapper Trick::VariableServer::set_event_engine
+ */
+extern "C" void var_server_set_event_engine(int on_off) {
+    the_vs->set_event_engine((bool)on_off) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::get_event_engine
+ * C wrapper Trick::VariableServer::get_event_engine
+ */
+extern "C" int var_server_get_event_engine(void) {
+    return(the_vs->get_event_engine()) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::set_event_workers
+ * C wrapper Trick::VariableServer::set_event_workers
+ */
+extern "C" void var_server_set_event_workers(unsigned int num) {
+    the_vs->set_event_workers(num) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::set_native_commands
+ * C wrapper Trick::VariableServer::set_native_commands
+ */
+extern "C" void var_server_set_native_commands(int on_off) {
+    the_vs->set_native_commands((bool)on_off) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::get_native_commands
+ * C wrapper Trick::VariableServer::get_native_commands
+ */
+extern "C" int var_server_get_native_commands(void) {
+    return(the_vs->get_native_commands()) ;
+}
+
 /**
  * @relates Trick::VariableServer
  * @copydoc Trick::VariableServer::create_udp_socket
@@ -501,6 +606,42 @@ extern "C" int var_server_create_multicast_socket(const char * mcast_address,
     return the_vs->create_multicast_socket(mcast_address, source_address, port) ;
 }
 
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::create_shared_memory
+ * C wrapper Trick::VariableServer::create_shared_memory
+ */
+extern "C" int var_server_create_shared_memory(const char * name) {
+    return the_vs->create_shared_memory(name) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::create_channel
+ * C wrapper Trick::VariableServer::create_channel
+ */
+extern "C" int var_server_create_channel(const char * name, const char * mcast_address, unsigned short port) {
+    return the_vs->create_channel(name, mcast_address, port) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::channel_add
+ * C wrapper Trick::VariableServer::channel_add
+ */
+extern "C" int var_server_channel_add(const char * name, const char * var_name, const char * units_name) {
+    return the_vs->channel_add(name, var_name, units_name) ;
+}
+
+/**
+ * @relates Trick::VariableServer
+ * @copydoc Trick::VariableServer::channel_set_cycle
+ * C wrapper Trick::VariableServer::channel_set_cycle
+ */
+extern "C" int var_server_channel_set_cycle(const char * name, double period) {
+    return the_vs->channel_set_cycle(name, period) ;
+}
+
 template<class T>
 void var_set_value( V_DATA & v_data , T value ) ;
 
@@ -43,8 +43,10 @@
 #include "trick/clock_proto.h"
 #include "trick/CommandLineArguments.hh"
 #include "trick/command_line_protos.h"
+#include "trick/DRArrow.hh"
 #include "trick/DRAscii.hh"
 #include "trick/DRBinary.hh"
+#include "trick/DRColumnar.hh"
 #ifdef HDF5
 #include "trick/DRHDF5.hh"
 #endif
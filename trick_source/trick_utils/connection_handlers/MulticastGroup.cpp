@@ -6,15 +6,15 @@
 
 Trick::MulticastGroup::MulticastGroup() : MulticastGroup(new SystemInterface) {}
 
-Trick::MulticastGroup::MulticastGroup (SystemInterface * system_interface) : _initialized(false), _system_interface(system_interface) {}
+Trick::MulticastGroup::MulticastGroup (SystemInterface * system_interface) : _initialized(false), _system_interface(system_interface) {
+    _connection_type = MCAST;
+}
 
 Trick::MulticastGroup::~MulticastGroup() {}
 
+// The socket and address list are kept across a checkpoint reload
 int Trick::MulticastGroup::restart () {
-    // Keep address list the same, but we may need to get a new socket
-    _system_interface = new SystemInterface();
-    // return initialize();
-    // return 0;
+    return 0;
 }
 
 
@@ -117,6 +117,36 @@ int Trick::MulticastGroup::initialize_with_receiving(std::string addr, std::stri
     return 0;    
 }
 
+// Opens a socket that only writes to the multicast address, for servers that publish to any number of receivers
+int Trick::MulticastGroup::initialize_sender(std::string mcast_addr, int port) {
+    if (initialize() != 0) {
+        return -1;
+    }
+
+    auto in_addr = _system_interface->inet_addr(mcast_addr.c_str());
+    if (in_addr == -1) {
+        std::string error_msg = "MulticastGroup: Cannot send to address " + mcast_addr;
+        perror(error_msg.c_str());
+        return -1;
+    }
+
+    memset(&_remote_serv_addr, 0, sizeof(struct sockaddr_in));
+    _remote_serv_addr.sin_family = AF_INET;
+    _remote_serv_addr.sin_addr.s_addr = in_addr;
+    _remote_serv_addr.sin_port = htons((uint16_t) port);
+
+    // A receiver that falls behind loses datagrams, it never slows down the sender
+    int flag = _system_interface->fcntl(_socket, F_GETFL, 0);
+    if (flag != -1) {
+        _system_interface->fcntl(_socket, F_SETFL, flag | O_NONBLOCK);
+    }
+
+    _hostname = mcast_addr;
+    _port = port;
+    _started = true;
+    return 0;
+}
+
 int Trick::MulticastGroup::disconnect() {
     if (_initialized) {
         _system_interface->close(_socket);
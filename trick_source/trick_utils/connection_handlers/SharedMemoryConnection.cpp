@@ -0,0 +1,521 @@
+#include "trick/SharedMemoryConnection.hh"
+
+#include <iostream>
+#include <cstring>
+#include <climits>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux
+#include <linux/futex.h>
+#include <syscall.h>
+#endif
+
+// Waits up to 100ms at a time so a peer that died without disconnecting is noticed
+static const double max_wait_slice = 0.1;
+
+static uint32_t load(const uint32_t * value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static void store(uint32_t * value, uint32_t new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0e9;
+}
+
+// Copies between a ring's data and a buffer, wrapping around the end of the data
+static void copy_out(const char * data, uint32_t ring_size, uint32_t position, char * buffer, uint32_t size) {
+    uint32_t offset = position & (ring_size - 1);
+    uint32_t first = (size < ring_size - offset) ? size : ring_size - offset;
+    memcpy(buffer, data + offset, first);
+    memcpy(buffer + first, data, size - first);
+}
+
+static void copy_in(char * data, uint32_t ring_size, uint32_t position, const char * buffer, uint32_t size) {
+    uint32_t offset = position & (ring_size - 1);
+    uint32_t first = (size < ring_size - offset) ? size : ring_size - offset;
+    memcpy(data + offset, buffer, first);
+    memcpy(data, buffer + first, size - first);
+}
+
+Trick::SharedMemoryConnection::SharedMemoryConnection () : _server(false), _initialized(false), _started(false), _blocking(false),
+ _name(""), _fd(-1), _segment(NULL), _segment_size(0), _in(NULL), _out(NULL), _in_data(NULL), _out_data(NULL), _ring_size(0) {
+    _connection_type = SHM;
+}
+
+Trick::SharedMemoryConnection::~SharedMemoryConnection () {
+    disconnect();
+}
+
+// A segment left by a server that is gone, like a simulation that crashed, may be removed and created again
+static bool segment_in_use(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool in_use = false;
+    struct stat status;
+    if (fstat(fd, &status) == 0 and (size_t)status.st_size >= sizeof(Trick::SharedMemorySegment)) {
+        void * addr = mmap(NULL, sizeof(Trick::SharedMemorySegment), PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            Trick::SharedMemorySegment * segment = (Trick::SharedMemorySegment *)addr;
+            pid_t pid = load(&segment->server_pid);
+            in_use = memcmp(segment->keyword, SHARED_MEMORY_CONNECTION_KEYWORD, sizeof(segment->keyword)) == 0 and
+                     load(&segment->server_open) and (kill(pid, 0) == 0 or errno == EPERM);
+            munmap(addr, sizeof(Trick::SharedMemorySegment));
+        }
+    }
+    close(fd);
+    return in_use;
+}
+
+/**
+@details
+-# Round the ring size up to a power of 2
+-# Fail if a server that is still running has a segment of the same name.  Otherwise remove any segment left
+   over with the name and create it.
+-# Size and map the segment, then write the header.  The keyword is written last, a client that sees it sees
+   a complete header.
+*/
+int Trick::SharedMemoryConnection::initialize(const std::string& name, unsigned int ring_size) {
+
+    if (_initialized) {
+        return -1;
+    }
+
+    uint32_t size = 4096;
+    while (size < ring_size && size < 0x40000000) {
+        size <<= 1;
+    }
+
+    if (segment_in_use(name)) {
+        std::cerr << "Shared memory connection " << name << " is in use by another server" << std::endl;
+        return -1;
+    }
+    shm_unlink(name.c_str());
+
+    if ((_fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)) < 0) {
+        std::string error_message = "Unable to create shared memory connection " + name;
+        perror(error_message.c_str());
+        return -1;
+    }
+
+    // Do not replicate the segment's handle if this process is forked
+    fcntl(_fd, F_SETFD, FD_CLOEXEC);
+
+    _segment_size = sizeof(SharedMemorySegment) + 2 * (size_t)size;
+    if (ftruncate(_fd, _segment_size) != 0) {
+        std::string error_message = "Unable to size shared memory connection " + name;
+        perror(error_message.c_str());
+        close(_fd);
+        shm_unlink(name.c_str());
+        _fd = -1;
+        return -1;
+    }
+
+    void * addr = mmap(NULL, _segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (addr == MAP_FAILED) {
+        std::string error_message = "Unable to map shared memory connection " + name;
+        perror(error_message.c_str());
+        close(_fd);
+        shm_unlink(name.c_str());
+        _fd = -1;
+        return -1;
+    }
+
+    _segment = (SharedMemorySegment *)addr;
+    memset(_segment, 0, sizeof(SharedMemorySegment));
+    _segment->version = SHARED_MEMORY_CONNECTION_VERSION;
+    _segment->ring_size = size;
+    _segment->server_pid = getpid();
+    _segment->server_open = 1;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(_segment->keyword, SHARED_MEMORY_CONNECTION_KEYWORD, sizeof(_segment->keyword));
+
+    _server = true;
+    _name = name;
+    _ring_size = size;
+    _in = &_segment->to_server;
+    _out = &_segment->to_client;
+    _in_data = (char *)addr + sizeof(SharedMemorySegment);
+    _out_data = _in_data + size;
+
+    _initialized = true;
+    return 0;
+}
+
+/**
+@details
+-# Map the segment the server created and check its header
+-# Claim the segment.  Only one client may connect to a segment until the server releases it.
+*/
+int Trick::SharedMemoryConnection::connect(const std::string& name) {
+
+    if (_initialized) {
+        return -1;
+    }
+
+    if ((_fd = shm_open(name.c_str(), O_RDWR, 0)) < 0) {
+        std::string error_message = "Unable to open shared memory connection " + name;
+        perror(error_message.c_str());
+        return -1;
+    }
+
+    fcntl(_fd, F_SETFD, FD_CLOEXEC);
+
+    struct stat status;
+    if (fstat(_fd, &status) != 0 or (size_t)status.st_size < sizeof(SharedMemorySegment)) {
+        std::cerr << "Shared memory connection " << name << " is not ready" << std::endl;
+        close(_fd);
+        _fd = -1;
+        return -1;
+    }
+
+    _segment_size = status.st_size;
+    void * addr = mmap(NULL, _segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (addr == MAP_FAILED) {
+        std::string error_message = "Unable to map shared memory connection " + name;
+        perror(error_message.c_str());
+        close(_fd);
+        _fd = -1;
+        return -1;
+    }
+    _segment = (SharedMemorySegment *)addr;
+
+    uint32_t expected = 0;
+    if (memcmp(_segment->keyword, SHARED_MEMORY_CONNECTION_KEYWORD, sizeof(_segment->keyword)) != 0 or
+        _segment->version != SHARED_MEMORY_CONNECTION_VERSION or
+        _segment_size != sizeof(SharedMemorySegment) + 2 * (size_t)_segment->ring_size or
+        !__atomic_compare_exchange_n(&_segment->client_pid, &expected, (uint32_t)getpid(), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        std::cerr << "Shared memory connection " << name << " is not available" << std::endl;
+        munmap(addr, _segment_size);
+        close(_fd);
+        _segment = NULL;
+        _fd = -1;
+        return -1;
+    }
+    store(&_segment->client_open, SHARED_MEMORY_CLIENT_OPEN);
+
+    _server = false;
+    _name = name;
+    _ring_size = _segment->ring_size;
+    _in = &_segment->to_client;
+    _out = &_segment->to_server;
+    _out_data = (char *)addr + sizeof(SharedMemorySegment);
+    _in_data = _out_data + _ring_size;
+
+    _initialized = true;
+    _started = true;
+    return 0;
+}
+
+int Trick::SharedMemoryConnection::start() {
+    // We've already set everything up, just make sure it was successful
+    if (_initialized) {
+        _started = true;
+        return 0;
+    }
+    return -1;
+}
+
+// Whether the other side disconnected, without the system call that checks its process
+bool Trick::SharedMemoryConnection::peer_closed() {
+    if (_server) {
+        return load(&_segment->client_open) == SHARED_MEMORY_CLIENT_CLOSED;
+    }
+    return !load(&_segment->server_open);
+}
+
+// The other side is open until it disconnects or its process is gone
+bool Trick::SharedMemoryConnection::peer_open() {
+    pid_t pid = load(_server ? &_segment->client_pid : &_segment->server_pid);
+    return !peer_closed() and (kill(pid, 0) == 0 or errno == EPERM);
+}
+
+/**
+@details
+-# Refuse while a client is connected and its process runs
+-# Empty both rings.  Nothing reads or writes them until the next client connects.
+-# Clear client_open, then client_pid.  A client that claims the segment after that finds empty rings.
+*/
+int Trick::SharedMemoryConnection::release_client() {
+    if (!_server or !_initialized) {
+        return -1;
+    }
+    if (load(&_segment->client_pid) == 0) {
+        return 0;
+    }
+    if (peer_open()) {
+        return -1;
+    }
+
+    store(&_in->tail, load(&_in->head));
+    store(&_out->tail, load(&_out->head));
+    store(&_segment->client_open, SHARED_MEMORY_CLIENT_NONE);
+    store(&_segment->client_pid, 0);
+    return 0;
+}
+
+/**
+@details
+-# Wait until the ring's signal differs from @c signal or the timeout passes.  The caller read @c signal before
+   finding it had to wait, so a change made since then ends the wait at once.
+*/
+int Trick::SharedMemoryConnection::wait(SharedMemoryRing * ring, uint32_t signal, double timeout) {
+    __atomic_add_fetch(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux
+    struct timespec ts;
+    ts.tv_sec = (time_t)timeout;
+    ts.tv_nsec = (long)((timeout - ts.tv_sec) * 1.0e9);
+    syscall(SYS_futex, &ring->signal, FUTEX_WAIT, signal, &ts, NULL, 0);
+#else
+    // Without futexes, poll
+    if (load(&ring->signal) == signal) {
+        usleep(timeout < 0.001 ? (unsigned int)(timeout * 1.0e6) : 1000);
+    }
+#endif
+    __atomic_sub_fetch(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+void Trick::SharedMemoryConnection::notify(SharedMemoryRing * ring) {
+    __atomic_add_fetch(&ring->signal, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux
+    // Only make the system call when the other side waits
+    if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST) != 0) {
+        syscall(SYS_futex, &ring->signal, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+#endif
+}
+
+/**
+@details
+-# Copy as much of the message as fits into the outgoing ring and tell the reader
+-# In non-blocking mode return what was copied, or -1 with errno set to EAGAIN if the ring is full, like a
+   non-blocking socket
+-# In blocking mode wait for the reader to make room.  Messages larger than the ring go out in pieces.
+-# Give up if the other side disconnects.  Its process is only checked when the ring is full, a write that
+   fits makes no system call.
+*/
+int Trick::SharedMemoryConnection::write_bytes(const char * message, int size) {
+    if (!_started) {
+        return -1;
+    }
+
+    // The server drops messages while no client is connected
+    if (_server and load(&_segment->client_pid) == 0) {
+        return 0;
+    }
+    if (peer_closed()) {
+        return -1;
+    }
+
+    uint32_t sent = 0;
+    while (sent < (uint32_t)size) {
+        uint32_t signal = load(&_out->signal);
+        uint32_t head = _out->head;
+        uint32_t space = _ring_size - (head - load(&_out->tail));
+        if (space == 0) {
+            if (!peer_open()) {
+                return -1;
+            }
+            if (!_blocking) {
+                if (sent == 0) {
+                    errno = EAGAIN;
+                    return -1;
+                }
+                return (int)sent;
+            }
+            wait(_out, signal, max_wait_slice);
+            continue;
+        }
+
+        uint32_t count = (size - sent < space) ? size - sent : space;
+        copy_in(_out_data, _ring_size, head, message + sent, count);
+        store(&_out->head, head + count);
+        notify(_out);
+        sent += count;
+    }
+
+    return size;
+}
+
+int Trick::SharedMemoryConnection::write (char * message, int size) {
+    return write_bytes(message, size);
+}
+
+int Trick::SharedMemoryConnection::write (const std::string& message) {
+    return write_bytes(message.data(), message.length());
+}
+
+/**
+@details
+-# Take everything in the incoming ring up to and including its last newline, at most @c max_len bytes.  In
+   blocking mode wait for a complete line.
+-# Strip out \\r characters
+-# Return -1 once the other side disconnected and everything it sent was read
+*/
+int Trick::SharedMemoryConnection::read (std::string& message, int max_len) {
+    message = "";
+    if (!_started) {
+        return 0;
+    }
+
+    while (1) {
+        uint32_t signal = load(&_in->signal);
+        uint32_t tail = _in->tail;
+        uint32_t available = load(&_in->head) - tail;
+        if (available > (uint32_t)max_len) {
+            available = max_len;
+        }
+
+        std::string incoming(available, '\0');
+        copy_out(_in_data, _ring_size, tail, &incoming[0], available);
+
+        size_t last_newline = incoming.rfind('\n');
+        if (last_newline != std::string::npos) {
+            store(&_in->tail, tail + last_newline + 1);
+            notify(_in);
+            for (size_t ii = 0; ii <= last_newline; ii++) {
+                if (incoming[ii] != '\r') {
+                    message += incoming[ii];
+                }
+            }
+            return message.size();
+        }
+
+        bool connected = !_server or load(&_segment->client_pid) != 0;
+        if (connected and !peer_open()) {
+            return -1;
+        }
+        if (!_blocking) {
+            return 0;
+        }
+        wait(_in, signal, max_wait_slice);
+    }
+}
+
+int Trick::SharedMemoryConnection::receive (char * buffer, int size, double timeout) {
+    if (!_started) {
+        return -1;
+    }
+
+    double end_time = now() + timeout;
+    while (1) {
+        uint32_t signal = load(&_in->signal);
+        uint32_t tail = _in->tail;
+        uint32_t available = load(&_in->head) - tail;
+        if (available > 0) {
+            uint32_t count = (available < (uint32_t)size) ? available : size;
+            copy_out(_in_data, _ring_size, tail, buffer, count);
+            store(&_in->tail, tail + count);
+            notify(_in);
+            return count;
+        }
+
+        if (!peer_open()) {
+            return -1;
+        }
+
+        double wait_time = max_wait_slice;
+        if (timeout >= 0.0) {
+            double remaining = end_time - now();
+            if (remaining <= 0.0) {
+                return 0;
+            }
+            if (remaining < wait_time) {
+                wait_time = remaining;
+            }
+        }
+        wait(_in, signal, wait_time);
+    }
+}
+
+/**
+@details
+-# Mark this side closed and wake the other side so it sees it
+-# Unmap the segment.  The server also removes it, a client that still has it mapped keeps its memory until it
+   disconnects.
+*/
+int Trick::SharedMemoryConnection::disconnect () {
+    if (!_initialized) {
+        return -1;
+    }
+
+    if (_server) {
+        store(&_segment->server_open, 0);
+    } else {
+        store(&_segment->client_open, SHARED_MEMORY_CLIENT_CLOSED);
+    }
+    notify(_in);
+    notify(_out);
+
+    munmap(_segment, _segment_size);
+    close(_fd);
+    if (_server) {
+        shm_unlink(_name.c_str());
+    }
+
+    _segment = NULL;
+    _in = _out = NULL;
+    _in_data = _out_data = NULL;
+    _fd = -1;
+    _initialized = false;
+    _started = false;
+
+    return 0;
+}
+
+int Trick::SharedMemoryConnection::setBlockMode(bool blocking) {
+    _blocking = blocking;
+    return 0;
+}
+
+int Trick::SharedMemoryConnection::restart() {
+    return 0;
+}
+
+bool Trick::SharedMemoryConnection::isInitialized() {
+    return _started;
+}
+
+std::string Trick::SharedMemoryConnection::getName() {
+    return _name;
+}
+
+std::string Trick::SharedMemoryConnection::getClientTag () {
+    return _client_tag;
+}
+
+int Trick::SharedMemoryConnection::setClientTag (std::string tag) {
+    _client_tag = tag;
+    return 0;
+}
+
+std::string Trick::SharedMemoryConnection::getClientHostname() {
+    if (!_initialized) {
+        return "";
+    }
+
+    return "localhost";
+}
+
+// Clients on the same host have no port, report the process of the client instead
+int Trick::SharedMemoryConnection::getClientPort() {
+    if (!_initialized) {
+        return 0;
+    }
+
+    return load(&_segment->client_pid);
+}
@@ -198,4 +198,12 @@ int Trick::TCPConnection::getClientPort() {
         return 0;
 
     return ntohs(otherside.sin_port);
-}
\ No newline at end of file
+}
+
+int Trick::TCPConnection::getSocket() {
+    if (!_connected) {
+        return -1;
+    }
+
+    return _socket;
+}
@@ -7,7 +7,9 @@
 #include <arpa/inet.h>
 
 Trick::UDPConnection::UDPConnection () : UDPConnection(new SystemInterface()) {}
-Trick::UDPConnection::UDPConnection (SystemInterface * system_interface) : _started(false), _initialized(false), _port(0), _hostname(""), _system_interface(system_interface), _socket(0) {}
+Trick::UDPConnection::UDPConnection (SystemInterface * system_interface) : _started(false), _initialized(false), _port(0), _hostname(""), _system_interface(system_interface), _socket(0) {
+    _connection_type = UDP;
+}
 
 int Trick::UDPConnection::initialize(const std::string& in_hostname, int in_port) {
 
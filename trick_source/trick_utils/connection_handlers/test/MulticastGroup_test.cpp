@@ -97,6 +97,49 @@ TEST_F(MulticastGroupTest, add_address_fails) {
     EXPECT_EQ(result, -1);
 }
 
+TEST_F(MulticastGroupTest, initialize_sender) {
+    // ARRANGE
+    // ACT
+    int result = mcast.initialize_sender("239.3.14.15", 9266);
+
+    // ASSERT
+    EXPECT_EQ(result, 0);
+    EXPECT_EQ(mcast.isInitialized(), 1);
+    EXPECT_EQ(mcast.getClientHostname(), "239.3.14.15");
+    EXPECT_EQ(mcast.getClientPort(), 9266);
+}
+
+TEST_F(MulticastGroupTest, initialize_sender_bad_address) {
+    // ARRANGE
+    system_context->register_inet_addr_impl([](const char * addr) {
+        return -1;
+    });
+
+    // ACT
+    int result = mcast.initialize_sender("not an address", 9266);
+
+    // ASSERT
+    EXPECT_EQ(result, -1);
+}
+
+TEST_F(MulticastGroupTest, write_sender) {
+    // ARRANGE
+    struct sockaddr_in destination;
+    system_context->register_sendto_impl([&](int socket, const void * buffer, size_t length, int flags, const struct sockaddr * dest_addr, socklen_t dest_len) {
+        memcpy(&destination, dest_addr, sizeof(destination));
+        return length;
+    });
+    mcast.initialize_sender("239.3.14.15", 9266);
+    char message[] = {0x07, 0x00, 0x00, 0x00};
+
+    // ACT
+    int result = mcast.write(message, sizeof(message));
+
+    // ASSERT
+    EXPECT_EQ(result, 4);
+    EXPECT_EQ(ntohs(destination.sin_port), 9266);
+}
+
 TEST_F(MulticastGroupTest, broadcast_uninitialized) {
     // ARRANGE
     // ACT
@@ -133,4 +176,16 @@ TEST_F(MulticastGroupTest, broadcast_send_fails) {
 
     // ASSERT
     EXPECT_EQ(result, 0);
-}
\ No newline at end of file
+}
+
+TEST_F(MulticastGroupTest, restart) {
+    // ARRANGE
+    mcast.initialize();
+
+    // ACT
+    int result = mcast.restart();
+
+    // ASSERT
+    EXPECT_EQ(result, 0);
+    EXPECT_EQ(mcast.isInitialized(), 1);
+}
@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trick/SharedMemoryConnection.hh"
+
+
+class SharedMemoryConnectionTest : public testing::Test {
+
+   protected:
+      SharedMemoryConnectionTest() : name("/trick_shm_test_" + std::to_string(getpid())) {}
+      ~SharedMemoryConnectionTest() {}
+
+      std::string name;
+      Trick::SharedMemoryConnection server;
+      Trick::SharedMemoryConnection client;
+};
+
+
+TEST_F( SharedMemoryConnectionTest, initialize_and_connect ) {
+    // ACT
+    int server_status = server.initialize(name);
+    server.start();
+    int client_status = client.connect(name);
+
+    // ASSERT
+    EXPECT_EQ(server_status, 0);
+    EXPECT_EQ(client_status, 0);
+    EXPECT_EQ(server.isInitialized(), true);
+    EXPECT_EQ(client.isInitialized(), true);
+    EXPECT_EQ(server.getClientPort(), getpid());
+}
+
+TEST_F( SharedMemoryConnectionTest, connect_missing ) {
+    // ACT
+    int status = client.connect(name);
+
+    // ASSERT
+    EXPECT_EQ(status, -1);
+    EXPECT_EQ(client.isInitialized(), false);
+}
+
+TEST_F( SharedMemoryConnectionTest, one_client ) {
+    // ARRANGE
+    Trick::SharedMemoryConnection second_client;
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+
+    // ACT
+    int status = second_client.connect(name);
+
+    // ASSERT
+    EXPECT_EQ(status, -1);
+}
+
+TEST_F( SharedMemoryConnectionTest, initialize_existing ) {
+    // ARRANGE
+    Trick::SharedMemoryConnection second_server;
+    server.initialize(name);
+
+    // ACT
+    int status = second_server.initialize(name);
+
+    // ASSERT
+    EXPECT_EQ(status, -1);
+}
+
+TEST_F( SharedMemoryConnectionTest, read_complete_lines ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+    std::string message;
+
+    // ACT
+    client.write(std::string("trick.var_add(\"a\")\r\ntrick.var_"));
+    int first = server.read(message);
+    std::string first_message = message;
+    client.write(std::string("pause()\n"));
+    int second = server.read(message);
+
+    // ASSERT
+    EXPECT_EQ(first, 19);
+    EXPECT_EQ(first_message, "trick.var_add(\"a\")\n");
+    EXPECT_EQ(second, 18);
+    EXPECT_EQ(message, "trick.var_pause()\n");
+}
+
+TEST_F( SharedMemoryConnectionTest, read_nothing ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    std::string message;
+
+    // ACT
+    int before_connect = server.read(message);
+    client.connect(name);
+    int after_connect = server.read(message);
+
+    // ASSERT
+    EXPECT_EQ(before_connect, 0);
+    EXPECT_EQ(after_connect, 0);
+    EXPECT_EQ(message, "");
+}
+
+TEST_F( SharedMemoryConnectionTest, write_before_connect_dropped ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    char buffer[16];
+
+    // ACT
+    int written = server.write(std::string("dropped"));
+    client.connect(name);
+    int received = client.receive(buffer, sizeof(buffer), 0.0);
+
+    // ASSERT
+    EXPECT_EQ(written, 0);
+    EXPECT_EQ(received, 0);
+}
+
+TEST_F( SharedMemoryConnectionTest, receive_binary ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+    char message[] = {0x00, 0x01, 0x02, '\n', 0x00};
+    char buffer[16];
+
+    // ACT
+    int written = server.write(message, sizeof(message));
+    int received = client.receive(buffer, sizeof(buffer), 1.0);
+
+    // ASSERT
+    EXPECT_EQ(written, 5);
+    ASSERT_EQ(received, 5);
+    EXPECT_EQ(memcmp(buffer, message, sizeof(message)), 0);
+}
+
+TEST_F( SharedMemoryConnectionTest, message_larger_than_ring ) {
+    // ARRANGE
+    server.initialize(name, 4096);
+    server.start();
+    server.setBlockMode(true);
+    client.connect(name);
+    std::vector<char> message(100000);
+    for (unsigned int ii = 0; ii < message.size(); ii++) {
+        message[ii] = (char)(ii * 7);
+    }
+
+    // ACT
+    // The server waits for the client to make room
+    std::thread writer([&] { server.write(message.data(), message.size()); });
+    std::vector<char> received;
+    char buffer[1000];
+    while (received.size() < message.size()) {
+        int count = client.receive(buffer, sizeof(buffer), 1.0);
+        if (count <= 0) {
+            break;
+        }
+        received.insert(received.end(), buffer, buffer + count);
+    }
+    writer.join();
+
+    // ASSERT
+    EXPECT_EQ(received, message);
+}
+
+TEST_F( SharedMemoryConnectionTest, write_full_ring ) {
+    // ARRANGE
+    server.initialize(name, 4096);
+    server.start();
+    client.connect(name);
+    std::vector<char> message(10000, 'x');
+
+    // ACT
+    int first = server.write(message.data(), message.size());
+    int second = server.write(message.data(), message.size());
+    int error = errno;
+
+    // ASSERT
+    EXPECT_EQ(first, 4096);
+    EXPECT_EQ(second, -1);
+    EXPECT_EQ(error, EAGAIN);
+}
+
+TEST_F( SharedMemoryConnectionTest, initialize_stale ) {
+    // ARRANGE
+    // A server that exits without disconnecting leaves its segment
+    server.initialize(name);
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    void * addr = mmap(NULL, sizeof(Trick::SharedMemorySegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ((Trick::SharedMemorySegment *)addr)->server_open = 0;
+    munmap(addr, sizeof(Trick::SharedMemorySegment));
+    close(fd);
+
+    // ACT
+    Trick::SharedMemoryConnection second_server;
+    int status = second_server.initialize(name);
+
+    // ASSERT
+    EXPECT_EQ(status, 0);
+}
+
+TEST_F( SharedMemoryConnectionTest, receive_timeout ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+    char buffer[16];
+
+    // ACT
+    int received = client.receive(buffer, sizeof(buffer), 0.01);
+
+    // ASSERT
+    EXPECT_EQ(received, 0);
+}
+
+TEST_F( SharedMemoryConnectionTest, client_disconnect ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+    client.write(std::string("trick.var_exit()\n"));
+    std::string message;
+
+    // ACT
+    client.disconnect();
+    int first = server.read(message);
+    int second = server.read(message);
+
+    // ASSERT
+    // What the client sent before disconnecting is still read
+    EXPECT_EQ(first, 17);
+    EXPECT_EQ(second, -1);
+    EXPECT_EQ(server.write(std::string("x")), -1);
+}
+
+TEST_F( SharedMemoryConnectionTest, server_disconnect ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+    char buffer[16];
+
+    // ACT
+    server.disconnect();
+    int received = client.receive(buffer, sizeof(buffer));
+    int status = Trick::SharedMemoryConnection().connect(name);
+
+    // ASSERT
+    EXPECT_EQ(received, -1);
+    EXPECT_EQ(status, -1);
+}
+
+TEST_F( SharedMemoryConnectionTest, release_connected_client ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+
+    // ACT
+    int status = server.release_client();
+
+    // ASSERT
+    EXPECT_EQ(status, -1);
+    EXPECT_EQ(Trick::SharedMemoryConnection().connect(name), -1);
+}
+
+TEST_F( SharedMemoryConnectionTest, reconnect_after_release ) {
+    // ARRANGE
+    server.initialize(name);
+    server.start();
+    client.connect(name);
+    client.write(std::string("trick.var_add(\"first\")\n"));
+    server.write(std::string("left for the first client"));
+    client.disconnect();
+    std::string message;
+    server.read(message);
+
+    // ACT
+    int read_status = server.read(message);
+    int refused = Trick::SharedMemoryConnection().connect(name);
+    int release_status = server.release_client();
+    Trick::SharedMemoryConnection next_client;
+    int connect_status = next_client.connect(name);
+    next_client.write(std::string("trick.var_add(\"second\")\n"));
+    int next_read = server.read(message);
+    server.write(std::string("ok\n"));
+    char buffer[64];
+    int received = next_client.receive(buffer, sizeof(buffer), 1.0);
+
+    // ASSERT
+    // The next client starts with empty rings
+    EXPECT_EQ(read_status, -1);
+    EXPECT_EQ(refused, -1);
+    EXPECT_EQ(release_status, 0);
+    EXPECT_EQ(connect_status, 0);
+    EXPECT_EQ(next_read, 24);
+    EXPECT_EQ(message, "trick.var_add(\"second\")\n");
+    ASSERT_EQ(received, 3);
+    EXPECT_EQ(std::string(buffer, received), "ok\n");
+}
+
+TEST_F( SharedMemoryConnectionTest, release_client_gone ) {
+    // ARRANGE
+    // A client process that exits without disconnecting
+    server.initialize(name);
+    server.start();
+    pid_t pid = fork();
+    if (pid == 0) {
+        Trick::SharedMemoryConnection child;
+        _exit(child.connect(name) == 0 ? 0 : 1);
+    }
+    int child_status;
+    waitpid(pid, &child_status, 0);
+    std::string message;
+
+    // ACT
+    int read_status = server.read(message);
+    int release_status = server.release_client();
+    int connect_status = client.connect(name);
+
+    // ASSERT
+    EXPECT_EQ(WEXITSTATUS(child_status), 0);
+    EXPECT_EQ(read_status, -1);
+    EXPECT_EQ(release_status, 0);
+    EXPECT_EQ(connect_status, 0);
+}
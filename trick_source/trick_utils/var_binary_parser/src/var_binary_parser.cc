@@ -47,6 +47,14 @@ Number Var::getInterpreter() const {
     return interpreted_val;
 }
 
+void Var::setIndex(int index) {
+    _index = index;
+}
+
+int Var::getIndex() const {
+    return _index;
+}
+
 std::string Var::getName() const {
     if (_has_name) {
         return _name;
@@ -267,10 +275,12 @@ class MessageIterator {
 const size_t ParsedBinaryMessage::header_size = 12;
 const size_t ParsedBinaryMessage::message_indicator_size = 4;
 const size_t ParsedBinaryMessage::variable_num_size = 4;
+const size_t ParsedBinaryMessage::sequence_size = 4;
 const size_t ParsedBinaryMessage::message_size_size = 4;
 const size_t ParsedBinaryMessage::variable_name_length_size = 4;
 const size_t ParsedBinaryMessage::variable_type_size = 4;
 const size_t ParsedBinaryMessage::variable_size_size = 4;
+const size_t ParsedBinaryMessage::variable_index_size = 4;
 
 int ParsedBinaryMessage::parse (const std::vector<unsigned char>& bytes) {
     if (bytes.size() < header_size) {
@@ -300,10 +310,22 @@ int ParsedBinaryMessage::parse (const std::vector<unsigned char>& bytes) {
     _num_vars = bytesToInt(messageIterator.slice(variable_num_size), _byteswap);
     messageIterator += variable_num_size;
 
+    // Channel messages are numbered, so receivers can tell when they missed one
+    if (_message_type == VS_CHANNEL_LIST) {
+        _sequence = bytesToInt(messageIterator.slice(sequence_size), _byteswap);
+        messageIterator += sequence_size;
+    }
+
     // Pull out all of the variables
     for (unsigned int i = 0; i < _num_vars; i++) {
         Var variable;
 
+        // Messages of changed values give the index of each variable first
+        if (_message_type == VS_VAR_LIST_CHANGES) {
+            variable.setIndex(bytesToInt(messageIterator.slice(variable_index_size), _byteswap));
+            messageIterator += variable_index_size;
+        }
+
         if (!_nonames) {
             // Get the name
             size_t name_length = bytesToInt(messageIterator.slice(variable_name_length_size), _byteswap);
@@ -337,6 +359,9 @@ void ParsedBinaryMessage::combine (const ParsedBinaryMessage& other) {
 
     // Combined size - subtract the header size from other message size
     _message_size += other._message_size - message_size_size - variable_num_size;
+    if (_message_type == VS_CHANNEL_LIST) {
+        _message_size -= sequence_size;
+    }
     
     // Combine variables
     _num_vars += other._num_vars;
@@ -377,6 +402,10 @@ unsigned int ParsedBinaryMessage::getNumVars() const {
     return _num_vars; 
 }
 
+unsigned int ParsedBinaryMessage::getSequence() const {
+    return _sequence;
+}
+
 // Static methods
 
 bool ParsedBinaryMessage::validateMessageType(int message_type) {
@@ -240,6 +240,82 @@ TEST (BinaryParserTest, ParseVariableNoname) {
     EXPECT_EQ(message.variables[1].getValue<std::string>(), "99 red balloons");
 }
 
+TEST (BinaryParserTest, ParseChangedVariables) {
+    std::vector<unsigned char> bytes = {0x06, 0x00, 0x00, 0x00};
+    char message_size = 8;
+
+    // Each variable of a message of changed values starts with its index
+    std::vector<unsigned char> index = {0x03, 0x00, 0x00, 0x00};
+    message_size += index.size() + test_var_1.size();
+    bytes.push_back(message_size);
+    bytes.push_back(0);
+    bytes.push_back(0);
+    bytes.push_back(0);
+
+    // Push number of variables
+    bytes.push_back(1);
+    bytes.push_back(0);
+    bytes.push_back(0);
+    bytes.push_back(0);
+
+    // Push variable
+    bytes.insert(bytes.end(), index.begin(), index.end());
+    bytes.insert(bytes.end(), test_var_1.begin(), test_var_1.end());
+
+    ParsedBinaryMessage message;
+    try {
+        message.parse(bytes);
+    } catch (const std::exception& ex) {
+        FAIL() << "Exception thrown: " << ex.what();
+    }
+
+    EXPECT_EQ(message.getMessageType(), 6);
+    ASSERT_EQ(message.variables.size(), 1);
+    EXPECT_EQ(message.variables[0].getIndex(), 3);
+    EXPECT_EQ(message.variables[0].getName(), "hi");
+    EXPECT_EQ(message.variables[0].getValue<int>(), 161);
+}
+
+TEST (BinaryParserTest, ParseChannelSequence) {
+    std::vector<unsigned char> bytes = {0x07, 0x00, 0x00, 0x00};
+    char message_size = 12;
+
+    // Channel messages give a sequence number after the number of variables
+    message_size += test_var_1.size();
+    bytes.push_back(message_size);
+    bytes.push_back(0);
+    bytes.push_back(0);
+    bytes.push_back(0);
+
+    // Push number of variables
+    bytes.push_back(1);
+    bytes.push_back(0);
+    bytes.push_back(0);
+    bytes.push_back(0);
+
+    // Push sequence number
+    bytes.push_back(0x2a);
+    bytes.push_back(0x01);
+    bytes.push_back(0);
+    bytes.push_back(0);
+
+    // Push variable
+    bytes.insert(bytes.end(), test_var_1.begin(), test_var_1.end());
+
+    ParsedBinaryMessage message;
+    try {
+        message.parse(bytes);
+    } catch (const std::exception& ex) {
+        FAIL() << "Exception thrown: " << ex.what();
+    }
+
+    EXPECT_EQ(message.getMessageType(), 7);
+    EXPECT_EQ(message.getSequence(), 298);
+    ASSERT_EQ(message.variables.size(), 1);
+    EXPECT_EQ(message.variables[0].getName(), "hi");
+    EXPECT_EQ(message.variables[0].getValue<int>(), 161);
+}
+
 TEST (BinaryParserTest, GetByNameNoname) {
     std::vector<unsigned char> bytes = {0x01, 0x00, 0x00, 0x00};
     char message_size = 8;